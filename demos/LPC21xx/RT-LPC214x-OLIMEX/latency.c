@@ -0,0 +1,147 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Interrupt latency benchmark, the same Timer1 match interrupt is served
+ * first as a vectored IRQ and then as FIQ. The handler wakes the main
+ * thread, directly in the IRQ case and through a FIQ deferred request in
+ * the FIQ case. Two latencies are measured in timer cycles from the match:
+ * the handler entry latency, sampled on top of the handler, and the total
+ * latency, sampled when the woken thread returns from chSemWait(), the
+ * latter includes the handler and the context switch.
+ * NOTE: This file must be compiled in ARM mode because of the FIQ handler.
+ */
+
+#include "ch.h"
+#include "lpc214x.h"
+#include "latency.h"
+
+#define LATENCY_SAMPLES         64
+#define LATENCY_DELAY           1000
+
+latency_results_t latency_irq, latency_fiq;
+
+static semaphore_t sem;
+static port_fiqreq_t fiqreq;
+static volatile uint32_t entry;
+
+/*
+ * IRQ path, the main thread is woken directly.
+ */
+static CH_IRQ_HANDLER(Timer1IrqHandler) {
+
+  CH_IRQ_PROLOGUE();
+
+  entry = T1TC - T1MR0;
+  T1IR = 1;
+
+  chSysLockFromISR();
+  chSemSignalI(&sem);
+  chSysUnlockFromISR();
+
+  VICVectAddr = 0;
+
+  CH_IRQ_EPILOGUE();
+}
+
+/*
+ * FIQ path, the main thread is woken by the deferred callback.
+ */
+PORT_FAST_IRQ_HANDLER(FiqHandler) {
+
+  entry = T1TC - T1MR0;
+  T1IR = 1;
+
+  port_fiq_pend(&fiqreq);
+}
+
+static void fiq_deferred(void *p) {
+
+  (void)p;
+  chSemSignalI(&sem);
+}
+
+static void reset(latency_stats_t *lsp) {
+
+  lsp->best       = (uint32_t)-1;
+  lsp->worst      = 0;
+  lsp->cumulative = 0;
+}
+
+static void sample(latency_stats_t *lsp, uint32_t last) {
+
+  lsp->cumulative += last;
+  if (last < lsp->best)
+    lsp->best = last;
+  if (last > lsp->worst)
+    lsp->worst = last;
+}
+
+static void run(latency_results_t *lrp) {
+  unsigned i;
+
+  lrp->n = 0;
+  reset(&lrp->entry);
+  reset(&lrp->total);
+  for (i = 0; i < LATENCY_SAMPLES; i++) {
+    uint32_t last;
+
+    T1MR0 = T1TC + LATENCY_DELAY;
+    T1MCR = 1;                              /* Interrupt on MR0.            */
+    chSemWait(&sem);
+    last = T1TC - T1MR0;
+    T1MCR = 0;
+
+    lrp->n++;
+    sample(&lrp->entry, entry);
+    sample(&lrp->total, last);
+  }
+}
+
+/*
+ * Runs both the measurements, the results are left in the latency_irq and
+ * latency_fiq structures.
+ */
+void latencyRun(void) {
+
+  chSemObjectInit(&sem, 0);
+  port_fiq_object_init(&fiqreq, fiq_deferred, NULL);
+
+  /* Timer1 free running at PCLK.*/
+  PCONP |= PCTIM1;
+  T1TCR = 2;
+  T1PR  = 0;
+  T1MCR = 0;
+  T1IR  = 0xFF;
+  T1TCR = 1;
+
+  /* IRQ path, vectored slot 0.*/
+  VICVectAddrs(0) = (uint32_t)Timer1IrqHandler;
+  VICVectCntls(0) = 0x20 | SOURCE_Timer1;
+  VICIntSelect &= ~INTMASK(SOURCE_Timer1);
+  VICIntEnable = INTMASK(SOURCE_Timer1);
+  run(&latency_irq);
+
+  /* FIQ path.*/
+  VICIntEnClear = INTMASK(SOURCE_Timer1);
+  VICIntSelect |= INTMASK(SOURCE_Timer1);
+  VICIntEnable = INTMASK(SOURCE_Timer1);
+  run(&latency_fiq);
+
+  VICIntEnClear = INTMASK(SOURCE_Timer1);
+  VICIntSelect &= ~INTMASK(SOURCE_Timer1);
+  T1TCR = 0;
+}
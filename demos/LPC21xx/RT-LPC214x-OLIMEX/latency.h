@@ -0,0 +1,49 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef _LATENCY_H_
+#define _LATENCY_H_
+
+/**
+ * @brief   Latency statistics.
+ * @note    Values are in peripheral clock cycles.
+ */
+typedef struct {
+  uint32_t              best;       /**< @brief Best latency.               */
+  uint32_t              worst;      /**< @brief Worst latency.              */
+  uint32_t              cumulative; /**< @brief Cumulative latency.         */
+} latency_stats_t;
+
+/**
+ * @brief   Latency measurement results.
+ */
+typedef struct {
+  uint32_t              n;          /**< @brief Number of samples.          */
+  latency_stats_t       entry;      /**< @brief Match to handler entry.     */
+  latency_stats_t       total;      /**< @brief Match to thread wakeup.     */
+} latency_results_t;
+
+extern latency_results_t latency_irq, latency_fiq;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void latencyRun(void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _LATENCY_H_ */
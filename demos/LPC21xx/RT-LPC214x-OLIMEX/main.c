@@ -18,6 +18,8 @@
 //#include "hal.h"
 //#include "test.h"
 
+#include "latency.h"
+
 #if 0
 #define BOTH_BUTTONS (PAL_PORT_BIT(PA_BUTTON1) | PAL_PORT_BIT(PA_BUTTON2))
 
@@ -75,6 +77,13 @@ int main(void) {
 //  halInit();
   chSysInit();
 
+  /*
+   * Interrupt latency benchmark, IRQ versus FIQ, the handler entry and
+   * thread wakeup results are left in the latency_irq and latency_fiq
+   * structures.
+   */
+  latencyRun();
+
   /*
    * Activates the serial driver 1 using the driver default configuration.
    */
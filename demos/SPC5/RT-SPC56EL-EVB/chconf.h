@@ -102,6 +102,14 @@
  *          infinite loop. */
 #define CH_CFG_NO_IDLE_THREAD               FALSE
 
+/**
+ * @brief   SMP mode.
+ * @details When this option is activated each core runs its own kernel
+ *          instance, the device must be configured in decoupled parallel
+ *          mode.
+ */
+#define CH_CFG_SMP_MODE                     FALSE
+
 /** @} */
 
 /*===========================================================================*/
@@ -156,6 +156,32 @@ static msg_t Thread1(void *arg) {
   return 0;
 }
 
+#if CH_CFG_SMP_MODE
+/*
+ * Inter-core semaphore, signaled by the core zero main thread.
+ */
+static SEMAPHORE_DECL(sem_ping, 0);
+static volatile uint32_t pings;
+
+/*
+ * Core one entry point, it must be invoked by the core one startup code
+ * when the device is in decoupled parallel mode.
+ */
+void main_core1(void) {
+
+  /*
+   * Kernel initialization for the core one, the main_core1() function
+   * becomes a thread running on the core one.
+   */
+  chSysInitCore();
+
+  while (TRUE) {
+    chSemWait(&sem_ping);
+    pings++;
+  }
+}
+#endif
+
 /*
  * Application entry point.
  */
@@ -197,6 +223,9 @@ int main(void) {
       chThdRelease(shelltp);    /* Recovers memory of the previous shell.   */
       shelltp = NULL;           /* Triggers spawning of a new shell.        */
     }
+#if CH_CFG_SMP_MODE
+    chSemSignal(&sem_ping);     /* Wakes up the core one main thread.       */
+#endif
     chThdSleepMilliseconds(1000);
   }
   return 0;
@@ -104,17 +104,35 @@ THD_FUNCTION(Thread3, arg) {
   }
 }
 
+/*
+ * Tasks shared stack.
+ */
+static THD_WORKING_AREA(waTasks, 256);
+
 /*
  * Threads static table, one entry per thread. The number of entries must
  * match NIL_CFG_NUM_THREADS.
  */
 THD_TABLE_BEGIN
+  THD_TABLE_TASKS(waTasks)
   THD_TABLE_ENTRY(waThread1, "blinker1", Thread1, NULL)
   THD_TABLE_ENTRY(waThread2, "blinker2", Thread2, NULL)
-  THD_TABLE_ENTRY(wa_test_support, "test_support", test_support, (void *)&nil.threads[3])
+  THD_TABLE_ENTRY(wa_test_support, "test_support", test_support, (void *)&nil.threads[5])
+  THD_TABLE_ENTRY(wa_test_consumer, "test_consumer", test_consumer, NULL)
   THD_TABLE_ENTRY(waThread3, "tester", Thread3, NULL)
 THD_TABLE_END
 
+/*
+ * Tasks static table, one entry per task. The number of entries must
+ * match NIL_CFG_NUM_TASKS.
+ */
+TASK_TABLE_BEGIN
+  TASK_TABLE_ENTRY("high", test_task_high, NULL)
+  TASK_TABLE_ENTRY("mid", test_task_mid, NULL)
+  TASK_TABLE_ENTRY("low", test_task_low, NULL)
+  TASK_TABLE_ENTRY("counter", test_task_counter, NULL)
+TASK_TABLE_END
+
 /*
  * Application entry point.
  */
@@ -40,7 +40,7 @@
  * @note    This number is not inclusive of the idle thread which is
  *          Implicitly handled.
  */
-#define NIL_CFG_NUM_THREADS                 4
+#define NIL_CFG_NUM_THREADS                 6
 
 /** @} */
 
@@ -92,6 +92,37 @@
  */
 #define NIL_CFG_USE_EVENTS                  TRUE
 
+/**
+ * @brief   Mailboxes APIs.
+ * @details If enabled then the mailboxes APIs are included in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ */
+#define NIL_CFG_USE_MAILBOXES               TRUE
+
+/**
+ * @brief   Byte queues APIs.
+ * @details If enabled then the byte queues APIs are included in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ */
+#define NIL_CFG_USE_QUEUES                  TRUE
+
+/**
+ * @brief   Run-to-completion tasks APIs.
+ * @details If enabled then the tasks APIs are included in the kernel. Tasks
+ *          are executed by a single server thread and share its stack,
+ *          preemption among tasks follows the Stack Resource Policy.
+ *
+ * @note    The default is @p FALSE.
+ */
+#define NIL_CFG_USE_TASKS                   TRUE
+
+/**
+ * @brief   Number of tasks in the application.
+ */
+#define NIL_CFG_NUM_TASKS                   4
+
 /** @} */
 
 /*===========================================================================*/
@@ -302,3 +302,6 @@
 #define STM32_USB_OTG_THREAD_PRIO           LOWPRIO
 #define STM32_USB_OTG_THREAD_STACK_SIZE     128
 #define STM32_USB_OTGFIFO_FILL_BASEPRI      0
+#define STM32_USB_OTG2_USE_DMA              FALSE
+#define STM32_USB_OTG2_DMA_BUFFER_SIZE      64
+#define STM32_USB_OTG_USE_COUNTERS          FALSE
@@ -27,6 +27,14 @@ ifeq ($(USE_LTO),yes)
   OPT += -flto
 endif
 
+# Stack usage analysis, the .su files are placed along the object files
+ifeq ($(USE_STACK_USAGE),yes)
+  OPT += -fstack-usage
+endif
+ifeq ($(PYTHON),)
+  PYTHON = python
+endif
+
 # Undefined state stack size
 ifeq ($(USE_UND_STACKSIZE),)
   LDOPT := $(LDOPT),--defsym=__und_stack_size__=8
@@ -268,6 +276,18 @@ else
 	@echo Done
 endif
 
+stackusage: $(BUILDDIR)/$(PROJECT).elf
+ifneq ($(USE_STACK_USAGE),yes)
+	@echo USE_STACK_USAGE must be set to yes
+	@exit 1
+else
+	@echo Stack usage analysis
+	@$(PYTHON) $(CHIBIOS)/tools/stackusage/stackusage.py \
+	           --objdump $(OD) --su $(OBJDIR) $< $(USE_STACK_ENTRIES)
+	@echo
+	@echo Done
+endif
+
 clean:
 	@echo Cleaning
 	-rm -fR .dep $(BUILDDIR)
@@ -57,6 +57,54 @@
  */
 #define ARM_IRQ_VECTOR_REG      0xFFFFF030
 
+/**
+ * @brief   End of interrupt notification to the interrupt controller.
+ */
+#define ARM_IRQ_EOI()           (*((volatile uint32_t *)0xFFFFF030) = 0)
+
+/**
+ * @brief   FIQ deferred requests support.
+ * @details The requests are served by a software-triggered IRQ on the VIC
+ *          channel reserved to software interrupts.
+ */
+#define ARM_SUPPORTS_FIQ_PEND   1
+
+/**
+ * @brief   VIC channel used by the FIQ deferred requests.
+ * @note    Channel 1 is reserved to software interrupts on the LPC214x.
+ */
+#define ARM_FIQ_PEND_CHANNEL    1
+
+/**
+ * @brief   VIC vectored slot used by the FIQ deferred requests.
+ */
+#if !defined(ARM_FIQ_PEND_SLOT)
+#define ARM_FIQ_PEND_SLOT       15
+#endif
+
+/**
+ * @brief   Triggers the FIQ deferred requests IRQ.
+ */
+#define ARM_FIQ_PEND_TRIGGER()                                              \
+  (*((volatile uint32_t *)0xFFFFF018) = (1U << ARM_FIQ_PEND_CHANNEL))
+
+/**
+ * @brief   Clears the FIQ deferred requests IRQ.
+ */
+#define ARM_FIQ_PEND_CLEAR()                                                \
+  (*((volatile uint32_t *)0xFFFFF01C) = (1U << ARM_FIQ_PEND_CHANNEL))
+
+/**
+ * @brief   Associates the FIQ deferred requests IRQ to its handler.
+ */
+#define ARM_FIQ_PEND_SETUP(handler) {                                       \
+  *((volatile uint32_t *)(0xFFFFF100 + (ARM_FIQ_PEND_SLOT * 4))) =          \
+                                                    (uint32_t)(handler);    \
+  *((volatile uint32_t *)(0xFFFFF200 + (ARM_FIQ_PEND_SLOT * 4))) =          \
+                                          0x20U | ARM_FIQ_PEND_CHANNEL;     \
+  *((volatile uint32_t *)0xFFFFF010) = (1U << ARM_FIQ_PEND_CHANNEL);        \
+}
+
 #endif /* _ARMPARAMS_H_ */
 
 /** @} */
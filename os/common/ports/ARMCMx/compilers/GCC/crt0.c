@@ -42,6 +42,12 @@
 #define FPCCR_ASPEN             (0x1U << 31)
 #define FPCCR_LSPEN             (0x1U << 30)
 
+#define DEMCR                   *((volatile uint32_t *)0xE000EDFCU)
+#define DWT_CTRL                *((volatile uint32_t *)0xE0001000U)
+#define DWT_CYCCNT              *((volatile uint32_t *)0xE0001004U)
+#define DEMCR_TRCENA            (0x1U << 24)
+#define DWT_CTRL_CYCCNTENA      (0x1U << 0)
+
 typedef void (*funcp_t)(void);
 typedef funcp_t * funcpp_t;
 
@@ -58,6 +64,20 @@ typedef funcp_t * funcpp_t;
     *p1++ = (filler);                                                       \
 }
 
+/**
+ * @name    Boot phases
+ * @{
+ */
+#define CRT0_PHASE_STACKS           0   /**< @brief Stacks painting.        */
+#define CRT0_PHASE_EARLY_INIT       1   /**< @brief @p __early_init().      */
+#define CRT0_PHASE_DATA             2   /**< @brief DATA initialization.    */
+#define CRT0_PHASE_BSS              3   /**< @brief BSS initialization.     */
+#define CRT0_PHASE_LATE_INIT        4   /**< @brief @p __late_init().       */
+#define CRT0_PHASE_CONSTRUCTORS     5   /**< @brief Constructors.           */
+#define CRT0_PHASE_TOTAL            6   /**< @brief Reset to @p main().     */
+#define CRT0_NUM_PHASES             7
+/** @} */
+
 /*===========================================================================*/
 /**
  * @name    Startup settings
@@ -95,6 +115,19 @@ typedef funcp_t * funcpp_t;
 #define CRT0_INIT_DATA              TRUE
 #endif
 
+/**
+ * @brief   Compressed DATA segment switch.
+ * @details If enabled the DATA segment is decoded from an LZ4 block stream
+ *          placed in the @p .zdata section instead of being copied from its
+ *          ROM image. The stream is generated after linking by
+ *          @p tools/lzdata/lzdata.py, this is done automatically by the
+ *          makefile rules when @p USE_DATA_COMPRESSION is set to @p yes,
+ *          the option is also defined there.
+ */
+#if !defined(CRT0_DATA_COMPRESSED) || defined(__DOXYGEN__)
+#define CRT0_DATA_COMPRESSED        FALSE
+#endif
+
 /**
  * @brief   BSS segment initialization switch.
  */
@@ -102,6 +135,32 @@ typedef funcp_t * funcpp_t;
 #define CRT0_INIT_BSS               TRUE
 #endif
 
+/**
+ * @brief   Lazily zeroed BSS segment deferral switch.
+ * @details Variables placed in the @p .lazybss section are zeroed together
+ *          with the BSS segment unless this option is enabled, in that case
+ *          the zeroing is left to the application that has to invoke
+ *          @p __lazy_bss_init() before accessing those variables. This is
+ *          meant for large buffers not needed at boot.
+ */
+#if !defined(CRT0_DEFER_LAZY_BSS) || defined(__DOXYGEN__)
+#define CRT0_DEFER_LAZY_BSS         FALSE
+#endif
+
+/**
+ * @brief   Boot time measurement switch.
+ * @details If enabled the DWT cycle counter is started on reset and the
+ *          cycles spent in each startup phase are stored in the
+ *          @p __boot_cycles array, indexed by the @p CRT0_PHASE_xxx
+ *          constants, then @p __boot_report() is invoked before
+ *          @p main().
+ * @note    Requires an ARMv7-M core, the cycle counter is not present on
+ *          ARMv6-M cores.
+ */
+#if !defined(CRT0_MEASURE_BOOT) || defined(__DOXYGEN__)
+#define CRT0_MEASURE_BOOT           FALSE
+#endif
+
 /**
  * @brief   Constructors invocation switch.
  */
@@ -118,6 +177,11 @@ typedef funcp_t * funcpp_t;
 
 /** @} */
 
+#if CRT0_MEASURE_BOOT && !defined(__ARM_ARCH_7M__) &&                       \
+    !defined(__ARM_ARCH_7EM__)
+#error "CRT0_MEASURE_BOOT requires an ARMv7-M core"
+#endif
+
 /*===========================================================================*/
 /**
  * @name    Symbols from the scatter file
@@ -183,6 +247,39 @@ extern uint32_t _bss_start;
  */
 extern uint32_t _bss_end;
 
+/**
+ * @brief   Lazily zeroed BSS segment start.
+ * @pre     The symbol must be aligned to a 32 bits boundary.
+ */
+extern uint32_t _lazybss_start;
+
+/**
+ * @brief   Lazily zeroed BSS segment end.
+ * @pre     The symbol must be aligned to a 32 bits boundary.
+ */
+extern uint32_t _lazybss_end;
+
+/**
+ * @brief   Core coupled memory segment start.
+ * @details The segment is zeroed together with the BSS segment, on devices
+ *          without core coupled memory it is placed in RAM.
+ * @pre     The symbol must be aligned to a 32 bits boundary.
+ */
+extern uint32_t _ccm_start;
+
+/**
+ * @brief   Core coupled memory segment end.
+ * @pre     The symbol must be aligned to a 32 bits boundary.
+ */
+extern uint32_t _ccm_end;
+
+#if CRT0_DATA_COMPRESSED || defined(__DOXYGEN__)
+/**
+ * @brief   Compressed DATA segment image start.
+ */
+extern uint8_t _textzdata;
+#endif
+
 /**
  * @brief   Constructors table start.
  * @pre     The symbol must be aligned to a 32 bits boundary.
@@ -214,6 +311,104 @@ extern funcp_t __fini_array_end;
  */
 extern void main(void);
 
+#if CRT0_MEASURE_BOOT || defined(__DOXYGEN__)
+/**
+ * @brief   Cycles spent in each startup phase.
+ * @details The array is indexed by the @p CRT0_PHASE_xxx constants, the
+ *          last entry is the total from reset to @p main().
+ * @note    The array is placed in the @p .noinit section because it is
+ *          written before the BSS segment initialization.
+ */
+__attribute__((section(".noinit")))
+uint32_t __boot_cycles[CRT0_NUM_PHASES];
+
+/* Marks the end of a phase, the counter value is converted in a duration
+   before invoking the report hook.*/
+#define boot_stamp(phase) (__boot_cycles[phase] = DWT_CYCCNT)
+#else
+#define boot_stamp(phase)
+#endif
+
+/*
+ * Block copy, four words are moved by each multiple load/store pair, the
+ * remainder is copied one word at time.
+ * Note, it cannot be used before the stacks initialization.
+ */
+__attribute__((noinline))
+static void copy32blk(uint32_t *dp, const uint32_t *sp, uint32_t *end) {
+
+  while (end - dp >= 4) {
+    asm volatile ("ldmia   %1!, {r4-r7}\n\t"
+                  "stmia   %0!, {r4-r7}"
+                  : "+r" (dp), "+r" (sp) : : "r4", "r5", "r6", "r7", "memory");
+  }
+  while (dp < end)
+    *dp++ = *sp++;
+}
+
+/*
+ * Block fill, four words are written by each multiple store, the remainder
+ * is written one word at time.
+ * Note, it cannot be used before the stacks initialization.
+ */
+__attribute__((noinline))
+static void fill32blk(uint32_t *p, uint32_t *end, uint32_t filler) {
+  register uint32_t r4 asm ("r4") = filler;
+  register uint32_t r5 asm ("r5") = filler;
+  register uint32_t r6 asm ("r6") = filler;
+  register uint32_t r7 asm ("r7") = filler;
+
+  while (end - p >= 4) {
+    asm volatile ("stmia   %0!, {%1, %2, %3, %4}"
+                  : "+r" (p) : "r" (r4), "r" (r5), "r" (r6), "r" (r7)
+                  : "memory");
+  }
+  while (p < end)
+    *p++ = filler;
+}
+
+#if CRT0_DATA_COMPRESSED
+/*
+ * LZ4 block decoder, the stream is decoded until the end of the destination
+ * area is reached, the stream is assumed to be valid.
+ */
+__attribute__((noinline))
+static void lz4dec(uint8_t *dp, uint8_t *end, const uint8_t *sp) {
+
+  while (dp < end) {
+    uint32_t token = *sp++;
+    uint32_t n, b;
+    const uint8_t *mp;
+
+    /* Literals run.*/
+    n = token >> 4;
+    if (n == 15U) {
+      do {
+        b = *sp++;
+        n += b;
+      } while (b == 255U);
+    }
+    while (n-- > 0U)
+      *dp++ = *sp++;
+    if (dp >= end)
+      break;
+
+    /* Match, it can overlap the output so it is copied byte by byte.*/
+    mp = dp - (sp[0] | ((uint32_t)sp[1] << 8));
+    sp += 2;
+    n = (token & 15U) + 4U;
+    if ((token & 15U) == 15U) {
+      do {
+        b = *sp++;
+        n += b;
+      } while (b == 255U);
+    }
+    while (n-- > 0U)
+      *dp++ = *mp++;
+  }
+}
+#endif
+
 /**
  * @brief   Early initialization.
  * @details This hook is invoked immediately after the stack initialization
@@ -238,6 +433,40 @@ __attribute__((weak))
 #endif
 void __late_init(void) {}
 
+#if CRT0_MEASURE_BOOT || defined(__DOXYGEN__)
+/**
+ * @brief   Boot time report.
+ * @details This hook is invoked after the constructors and before
+ *          @p main(), the cycles spent in each startup phase are available
+ *          in the @p __boot_cycles array. The default behavior is to do
+ *          nothing, the array can also be read later by the application.
+ * @note    This function is a weak symbol.
+ *
+ * @param[in] cycles    pointer to the @p __boot_cycles array
+ * @param[in] n         number of entries in the array
+ */
+#if !defined(__DOXYGEN__)
+__attribute__((weak))
+#endif
+void __boot_report(const uint32_t *cycles, unsigned n) {
+
+  (void)cycles;
+  (void)n;
+}
+#endif
+
+/**
+ * @brief   Lazily zeroed BSS segment initialization.
+ * @details Zeroes the variables placed in the @p .lazybss section, it must
+ *          be invoked by the application before accessing them if
+ *          @p CRT0_DEFER_LAZY_BSS is enabled, otherwise it is invoked by
+ *          the startup code.
+ */
+void __lazy_bss_init(void) {
+
+  fill32blk(&_lazybss_start, &_lazybss_end, 0);
+}
+
 /**
  * @brief   Default @p main() function exit handler.
  * @details This handler is invoked or the @p main() function exit. The
@@ -265,6 +494,14 @@ void Reset_Handler(void) {
      symbol __process_stack_end__ and its lower limit is the symbol
      __process_stack_base__.*/
   asm volatile ("cpsid   i");
+
+#if CRT0_MEASURE_BOOT
+  /* Cycle counter started from zero, it is not reset by a system reset.*/
+  DEMCR |= DEMCR_TRCENA;
+  DWT_CYCCNT = 0;
+  DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+#endif
+
   psp = SYMVAL(__process_stack_end__);
   asm volatile ("msr     PSP, %0" : : "r" (psp));
 
@@ -298,29 +535,35 @@ void Reset_Handler(void) {
          &__process_stack_end__,
          CRT0_STACKS_FILL_PATTERN);
 #endif
+  boot_stamp(CRT0_PHASE_STACKS);
 
   /* Early initialization hook invocation.*/
   __early_init();
+  boot_stamp(CRT0_PHASE_EARLY_INIT);
 
 #if CRT0_INIT_DATA
   /* DATA segment initialization.*/
-  {
-    uint32_t *tp, *dp;
-
-    tp = &_textdata;
-    dp = &_data;
-    while (dp < &_edata)
-      *dp++ = *tp++;
-  }
+#if CRT0_DATA_COMPRESSED
+  lz4dec((uint8_t *)&_data, (uint8_t *)&_edata, &_textzdata);
+#else
+  copy32blk(&_data, &_textdata, &_edata);
+#endif
 #endif
+  boot_stamp(CRT0_PHASE_DATA);
 
 #if CRT0_INIT_BSS
   /* BSS segment initialization.*/
-  fill32(&_bss_start, &_bss_end, 0);
+  fill32blk(&_bss_start, &_bss_end, 0);
+  fill32blk(&_ccm_start, &_ccm_end, 0);
+#if !CRT0_DEFER_LAZY_BSS
+  __lazy_bss_init();
+#endif
 #endif
+  boot_stamp(CRT0_PHASE_BSS);
 
   /* Late initialization hook invocation.*/
   __late_init();
+  boot_stamp(CRT0_PHASE_LATE_INIT);
 
 #if CRT0_CALL_CONSTRUCTORS
   /* Constructors invocation.*/
@@ -332,6 +575,19 @@ void Reset_Handler(void) {
     }
   }
 #endif
+  boot_stamp(CRT0_PHASE_CONSTRUCTORS);
+
+#if CRT0_MEASURE_BOOT
+  /* Time stamps converted in durations, the last entry is the total.*/
+  {
+    unsigned i;
+
+    __boot_cycles[CRT0_PHASE_TOTAL] = __boot_cycles[CRT0_PHASE_TOTAL - 1];
+    for (i = CRT0_PHASE_TOTAL - 1; i > 0; i--)
+      __boot_cycles[i] -= __boot_cycles[i - 1];
+    __boot_report(__boot_cycles, CRT0_NUM_PHASES);
+  }
+#endif
 
   /* Invoking application main() function.*/
   main();
@@ -27,6 +27,23 @@ ifeq ($(USE_LTO),yes)
   OPT += -flto
 endif
 
+# Stack usage analysis, the .su files are placed along the object files
+ifeq ($(USE_STACK_USAGE),yes)
+  OPT += -fstack-usage
+endif
+ifeq ($(PYTHON),)
+  PYTHON = python
+endif
+
+# Compressed DATA segment, the ROM image is replaced by an LZ4 stream
+# decoded by the startup code, the ROM image is not written in the HEX and
+# BIN files
+ifeq ($(USE_DATA_COMPRESSION),yes)
+  DDEFS += -DCRT0_DATA_COMPRESSED=TRUE
+  HEX += -R .data
+  BIN += -R .data
+endif
+
 # FPU-related options
 ifeq ($(USE_FPU),)
   USE_FPU = no
@@ -216,6 +233,7 @@ else
 	@$(CC) -c $(ASXFLAGS) $(TOPT) -I. $(IINCDIR) $< -o $@
 endif
 
+ifneq ($(USE_DATA_COMPRESSION),yes)
 %.elf: $(OBJS) $(LDSCRIPT)
 ifeq ($(USE_VERBOSE_COMPILE),yes)
 	@echo
@@ -224,6 +242,24 @@ else
 	@echo Linking $@
 	@$(LD) $(OBJS) $(LDFLAGS) $(LIBS) -o $@
 endif
+else
+# Two passes link, the DATA segment of the first pass is compressed into
+# the .zdata section of the second pass. The layout of the DATA segment
+# does not depend on .zdata, this is verified after the second pass.
+%.elf: $(OBJS) $(LDSCRIPT)
+	@echo Linking $@, first pass
+	@$(LD) $(OBJS) $(LDFLAGS) $(LIBS) -o $*.pass1.elf
+	@$(CP) -O binary -j .data $*.pass1.elf $*.data.bin
+	@$(PYTHON) $(CHIBIOS)/tools/lzdata/lzdata.py $*.data.bin $*.data.lz
+	@$(CP) -I binary -O elf32-littlearm -B arm \
+	       --rename-section .data=.zdata,alloc,load,readonly,data,contents \
+	       $*.data.lz $(OBJDIR)/zdata.o
+	@echo Linking $@, second pass
+	@$(LD) $(OBJS) $(OBJDIR)/zdata.o $(LDFLAGS) $(LIBS) -o $@
+	@$(CP) -O binary -j .data $@ $*.data2.bin
+	@cmp -s $*.data.bin $*.data2.bin || \
+	 (echo DATA segment changed in the second pass; rm -f $@; exit 1)
+endif
 
 %.hex: %.elf $(LDSCRIPT)
 ifeq ($(USE_VERBOSE_COMPILE),yes)
@@ -253,6 +289,18 @@ else
 	@echo Done
 endif
 
+stackusage: $(BUILDDIR)/$(PROJECT).elf
+ifneq ($(USE_STACK_USAGE),yes)
+	@echo USE_STACK_USAGE must be set to yes
+	@exit 1
+else
+	@echo Stack usage analysis
+	@$(PYTHON) $(CHIBIOS)/tools/stackusage/stackusage.py \
+	           --objdump $(OD) --su $(OBJDIR) $< $(USE_STACK_ENTRIES)
+	@echo
+	@echo Done
+endif
+
 clean:
 	@echo Cleaning
 	-rm -fR .dep $(BUILDDIR)
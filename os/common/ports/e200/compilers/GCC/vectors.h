@@ -39,9 +39,22 @@
    asm module.*/
 #if !defined(_FROM_ASM_)
 
-#define INTC_MCR        *((volatile uint32_t *)0xfff48000)
-#define INTC_CPR        *((volatile uint32_t *)0xfff48008)
-#define INTC_IACKR      *((volatile uint32_t *)0xfff48010)
+#define INTC_BASE       0xfff48000U
+
+#define INTC_MCR_OF(b)      *((volatile uint32_t *)((b) + 0x00U))
+#define INTC_CPR_OF(b)      *((volatile uint32_t *)((b) + 0x08U))
+#define INTC_IACKR_OF(b)    *((volatile uint32_t *)((b) + 0x10U))
+#define INTC_SSCIR_OF(b, n) *((volatile uint8_t *)((b) + 0x20U + (n)))
+#define INTC_PSR_OF(b, n)   *((volatile uint8_t *)((b) + 0x40U + (n)))
+
+#define INTC_MCR        INTC_MCR_OF(INTC_BASE)
+#define INTC_CPR        INTC_CPR_OF(INTC_BASE)
+#define INTC_IACKR      INTC_IACKR_OF(INTC_BASE)
+
+#define INTC_MCR_HVEN   (1U << 0)
+
+#define INTC_SSCIR_CLR  (1U << 0)
+#define INTC_SSCIR_SET  (1U << 1)
 
 #endif /* !defined(_FROM_ASM_) */
 
@@ -91,11 +104,16 @@ extern "C" {
    asm module.*/
 #if !defined(_FROM_ASM_)
 
+static inline void intc_init_at(uint32_t base) {
+
+  INTC_MCR_OF(base)   = 0;
+  INTC_CPR_OF(base)   = 0;
+  INTC_IACKR_OF(base) = (uint32_t)_vectors;
+}
+
 static inline void intc_init(void) {
 
-  INTC_MCR   = 0;
-  INTC_CPR   = 0;
-  INTC_IACKR = (uint32_t)_vectors;
+  intc_init_at(INTC_BASE);
 }
 
 #endif /* !defined(_FROM_ASM_) */
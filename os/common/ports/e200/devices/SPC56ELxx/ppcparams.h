@@ -72,6 +72,23 @@
  */
 #define PPC_NUM_VECTORS             256
 
+/**
+ * @brief   Number of cores.
+ * @note    Both cores are available in decoupled parallel mode, in lockstep
+ *          mode the second core is not visible to the software.
+ */
+#define PPC_CORES_NUMBER            2
+
+/**
+ * @brief   INTC base address of the second core.
+ */
+#define PPC_INTC1_BASE              0x8ff48000
+
+/**
+ * @brief   SEMA4 hardware semaphores base address.
+ */
+#define PPC_SEMA4_BASE              0xfff24000
+
 #endif /* _PPCPARAMS_H_ */
 
 /** @} */
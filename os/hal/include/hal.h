@@ -54,7 +54,7 @@
 #include "i2c.h"
 #include "i2s.h"
 #include "icu.h"
-//#include "mac.h"
+#include "mac.h"
 #include "pwm.h"
 #include "rtc.h"
 #include "serial.h"
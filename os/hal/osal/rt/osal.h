@@ -102,7 +102,9 @@
 /**
  * @brief   Systick mode required by the underlying OS.
  */
-#if (CH_CFG_ST_TIMEDELTA == 0) || defined(__DOXYGEN__)
+#if CH_DBG_SIMULATED_TIME
+#define OSAL_ST_MODE                        OSAL_ST_MODE_NONE
+#elif (CH_CFG_ST_TIMEDELTA == 0) || defined(__DOXYGEN__)
 #define OSAL_ST_MODE                        OSAL_ST_MODE_PERIODIC
 #else
 #define OSAL_ST_MODE                        OSAL_ST_MODE_FREERUNNING
@@ -36,6 +36,21 @@
 
 #define EP0_MAX_INSIZE          64
 
+#if STM32_USB_OTG2_USE_DMA || defined(__DOXYGEN__)
+/**
+ * @brief   Checks if a driver operates in internal DMA mode.
+ */
+#define otg_use_dma(usbp)       ((usbp) == &USBD2)
+
+/**
+ * @brief   Largest transaction fitting a bounce buffer.
+ */
+#define otg_dma_chunk(maxsize)                                              \
+  ((STM32_USB_OTG2_DMA_BUFFER_SIZE / (maxsize)) * (maxsize))
+#else
+#define otg_use_dma(usbp)       false
+#endif
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -107,6 +122,27 @@ static const stm32_otg_params_t hsparams = {
 };
 #endif
 
+#if STM32_USB_OTG2_USE_DMA || defined(__DOXYGEN__)
+/**
+ * @brief   OTG2 DMA area for the EP0 setup packets.
+ * @note    It is sized for a whole EP0 packet so that unexpected data
+ *          cannot overflow it.
+ */
+static uint32_t otg2_setup_area[EP0_MAX_INSIZE / 4];
+
+/**
+ * @brief   OTG2 IN endpoints DMA bounce buffers.
+ */
+static uint32_t otg2_in_bounce[USB_MAX_ENDPOINTS + 1]
+                              [STM32_USB_OTG2_DMA_BUFFER_SIZE / 4];
+
+/**
+ * @brief   OTG2 OUT endpoints DMA bounce buffers.
+ */
+static uint32_t otg2_out_bounce[USB_MAX_ENDPOINTS + 1]
+                               [STM32_USB_OTG2_DMA_BUFFER_SIZE / 4];
+#endif
+
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
@@ -423,6 +459,216 @@ static void otg_fifo_read_to_queue(volatile uint32_t *fifop,
   osalSysUnlock();
 }
 
+#if STM32_USB_OTG_USE_COUNTERS || defined(__DOXYGEN__)
+/**
+ * @brief   Accounts a completed transaction.
+ *
+ * @param[in] cp        pointer to the @p stm32_otg_counters_t structure
+ * @param[in] n         number of bytes transferred
+ * @param[in] maxsize   endpoint packet size
+ *
+ * @notapi
+ */
+static void otg_count(stm32_otg_counters_t *cp, size_t n, size_t maxsize) {
+
+  cp->bytes   += n;
+  cp->packets += n == 0 ? 1 : (n + maxsize - 1) / maxsize;
+}
+#endif /* STM32_USB_OTG_USE_COUNTERS */
+
+#if STM32_USB_OTG2_USE_DMA || defined(__DOXYGEN__)
+/**
+ * @brief   Checks if a buffer can be accessed in place by the OTG DMA.
+ * @details The buffer must be word aligned and must not be located in the
+ *          CCM RAM which is not reachable by the OTG_HS bus master.
+ *
+ * @param[in] buf       pointer to the buffer
+ * @return              The buffer capability.
+ * @retval false        if a bounce buffer is required.
+ * @retval true         if the buffer can be used in place.
+ *
+ * @notapi
+ */
+static bool otg_dma_capable(const uint8_t *buf) {
+
+  if (((uint32_t)buf & 3) != 0)
+    return false;
+#if defined(CCMDATARAM_BASE)
+  if (((uint32_t)buf >= CCMDATARAM_BASE) &&
+      ((uint32_t)buf < CCMDATARAM_BASE + 0x10000))
+    return false;
+#endif
+  return true;
+}
+
+/**
+ * @brief   Checks if the current IN transaction requires a bounce buffer.
+ *
+ * @param[in] isp       pointer to the @p USBInEndpointState structure
+ * @return              The bounce buffer requirement.
+ *
+ * @notapi
+ */
+static bool otg_dma_in_bounce(USBInEndpointState *isp) {
+
+  return isp->txqueued || !otg_dma_capable(isp->mode.linear.txbuf);
+}
+
+/**
+ * @brief   Size of the current OUT DMA transaction.
+ * @details Transfers into linear buffers whose size is a multiple of the
+ *          packet size are performed in place, everything else goes
+ *          through the bounce buffer rounded up to whole packets because
+ *          the DMA always writes complete packets.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ * @param[out] bouncep  set to @p true if the bounce buffer is used
+ * @return              The transaction size.
+ *
+ * @notapi
+ */
+static size_t otg_dma_out_size(USBDriver *usbp, usbep_t ep, bool *bouncep) {
+  USBOutEndpointState *osp = usbp->epc[ep]->out_state;
+  size_t maxsize = usbp->epc[ep]->out_maxsize;
+  size_t n = osp->rxsize - osp->rxcnt;
+
+  if (!osp->rxqueued && otg_dma_capable(osp->mode.linear.rxbuf) &&
+      ((n % maxsize) == 0)) {
+    *bouncep = false;
+    return n;
+  }
+  *bouncep = true;
+  n = ((n + maxsize - 1) / maxsize) * maxsize;
+  if (n > otg_dma_chunk(maxsize))
+    n = otg_dma_chunk(maxsize);
+  return n;
+}
+
+/**
+ * @brief   Reads data from an output queue into a linear buffer.
+ *
+ * @param[in] oqp       pointer to an @p output_queue_t object
+ * @param[out] buf      destination buffer
+ * @param[in] n         number of bytes to move
+ *
+ * @iclass
+ */
+static void otg_queue_read_to_buffer(output_queue_t *oqp,
+                                     uint8_t *buf,
+                                     size_t n) {
+  size_t s1 = oqp->q_top - oqp->q_rdptr;
+
+  if (n < s1) {
+    memcpy(buf, oqp->q_rdptr, n);
+    oqp->q_rdptr += n;
+  }
+  else {
+    memcpy(buf, oqp->q_rdptr, s1);
+    memcpy(buf + s1, oqp->q_buffer, n - s1);
+    oqp->q_rdptr = oqp->q_buffer + (n - s1);
+  }
+  oqp->q_counter += n;
+  osalThreadDequeueAllI(&oqp->q_waiting, Q_OK);
+}
+
+/**
+ * @brief   Writes data from a linear buffer into an input queue.
+ *
+ * @param[in] iqp       pointer to an @p input_queue_t object
+ * @param[in] buf       source buffer
+ * @param[in] n         number of bytes to move
+ *
+ * @iclass
+ */
+static void otg_queue_write_from_buffer(input_queue_t *iqp,
+                                        const uint8_t *buf,
+                                        size_t n) {
+  size_t s1 = iqp->q_top - iqp->q_wrptr;
+
+  if (n < s1) {
+    memcpy(iqp->q_wrptr, buf, n);
+    iqp->q_wrptr += n;
+  }
+  else {
+    memcpy(iqp->q_wrptr, buf, s1);
+    memcpy(iqp->q_buffer, buf + s1, n - s1);
+    iqp->q_wrptr = iqp->q_buffer + (n - s1);
+  }
+  iqp->q_counter += n;
+  osalThreadDequeueAllI(&iqp->q_waiting, Q_OK);
+}
+
+/**
+ * @brief   Arms the EP0 OUT endpoint for the reception of setup packets.
+ * @note    In DMA mode the endpoint must be enabled in order to store
+ *          setup packets into memory.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ *
+ * @notapi
+ */
+static void otg_dma_ep0_setup_arm(USBDriver *usbp) {
+  stm32_otg_t *otgp = usbp->otg;
+
+  otgp->oe[0].DOEPTSIZ = DOEPTSIZ_STUPCNT(3) | DOEPTSIZ_PKTCNT(1) |
+                         DOEPTSIZ_XFRSIZ(3 * 8);
+  otgp->oe[0].DOEPDMA  = (uint32_t)otg2_setup_area;
+  otgp->oe[0].DOEPCTL |= DOEPCTL_EPENA;
+}
+
+/**
+ * @brief   Completes an OUT DMA transaction.
+ * @details Data received in the bounce buffer is moved to its final
+ *          destination. If a bounce transaction has been completely filled
+ *          and the transfer is not over then another transaction is
+ *          started.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ * @return              The transfer state.
+ * @retval false        if the transfer continues.
+ * @retval true         if the transfer is complete.
+ *
+ * @notapi
+ */
+static bool otg_dma_out_complete(USBDriver *usbp, usbep_t ep) {
+  USBOutEndpointState *osp = usbp->epc[ep]->out_state;
+  size_t size, n;
+  bool bounce;
+
+  size = otg_dma_out_size(usbp, ep, &bounce);
+  n = size - (usbp->otg->oe[ep].DOEPTSIZ & DOEPTSIZ_XFRSIZ_MASK);
+  if (n > osp->rxsize - osp->rxcnt)
+    n = osp->rxsize - osp->rxcnt;
+
+  if (osp->rxqueued) {
+    osalSysLockFromISR();
+    otg_queue_write_from_buffer(osp->mode.queue.rxqueue,
+                                (const uint8_t *)otg2_out_bounce[ep], n);
+    osalSysUnlockFromISR();
+  }
+  else {
+    if (bounce)
+      memcpy(osp->mode.linear.rxbuf, otg2_out_bounce[ep], n);
+    osp->mode.linear.rxbuf += n;
+  }
+  osp->rxcnt += n;
+#if STM32_USB_OTG_USE_COUNTERS
+  otg_count(&usbp->out_counters[ep], n, usbp->epc[ep]->out_maxsize);
+#endif
+
+  if ((n == size) && (osp->rxcnt < osp->rxsize)) {
+    usb_lld_prepare_receive(usbp, ep);
+    osalSysLockFromISR();
+    usb_lld_start_out(usbp, ep);
+    osalSysUnlockFromISR();
+    return false;
+  }
+  return true;
+}
+#endif /* STM32_USB_OTG2_USE_DMA */
+
 /**
  * @brief   Incoming packets handler.
  *
@@ -538,10 +784,28 @@ static void otg_epin_handler(USBDriver *usbp, usbep_t ep) {
   if (epint & DIEPINT_TOC) {
     /* Timeouts not handled yet, not sure how to handle.*/
   }
+#if STM32_USB_OTG_USE_COUNTERS
+  if ((epint & DIEPINT_ITTXFE) && (otgp->DIEPMSK & DIEPMSK_ITTXFEMSK)) {
+    /* IN token NAKed because there was nothing to transmit.*/
+    usbp->in_counters[ep].naks++;
+  }
+#endif
   if ((epint & DIEPINT_XFRC) && (otgp->DIEPMSK & DIEPMSK_XFRCM)) {
     /* Transmit transfer complete.*/
     USBInEndpointState *isp = usbp->epc[ep]->in_state;
 
+#if STM32_USB_OTG_USE_COUNTERS
+    otg_count(&usbp->in_counters[ep], isp->txsize, usbp->epc[ep]->in_maxsize);
+#endif
+#if STM32_USB_OTG2_USE_DMA
+    if (otg_use_dma(usbp)) {
+      /* In DMA mode the whole transaction has been fetched by the core,
+         the linear buffer pointer is advanced here.*/
+      isp->txcnt = isp->txsize;
+      if (!isp->txqueued)
+        isp->mode.linear.txbuf += isp->txsize;
+    }
+#endif
     if (isp->txsize < isp->totsize) {
       /* In case the transaction covered only part of the total transfer
          then another transaction is immediately started in order to
@@ -584,13 +848,41 @@ static void otg_epout_handler(USBDriver *usbp, usbep_t ep) {
   /* Resets all EP IRQ sources.*/
   otgp->oe[ep].DOEPINT = epint;
 
+#if STM32_USB_OTG_USE_COUNTERS
+  if ((epint & DOEPINT_OTEPDIS) && (otgp->DOEPMSK & DOEPMSK_OTEPDM)) {
+    /* OUT token NAKed because the endpoint was not enabled.*/
+    usbp->out_counters[ep].naks++;
+  }
+#endif
   if ((epint & DOEPINT_STUP) && (otgp->DOEPMSK & DOEPMSK_STUPM)) {
+#if STM32_USB_OTG2_USE_DMA
+    if (otg_use_dma(usbp)) {
+      /* The DMA address register is advanced after each setup packet,
+         the last received one is the valid one.*/
+      memcpy(usbp->epc[ep]->setup_buf,
+             (const uint8_t *)otgp->oe[ep].DOEPDMA - 8, 8);
+      otg_dma_ep0_setup_arm(usbp);
+    }
+#endif
     /* Setup packets handling, setup packets are handled using a
        specific callback.*/
     _usb_isr_invoke_setup_cb(usbp, ep);
 
   }
   if ((epint & DOEPINT_XFRC) && (otgp->DOEPMSK & DOEPMSK_XFRCM)) {
+#if STM32_USB_OTG2_USE_DMA
+    if (otg_use_dma(usbp)) {
+      if (!otg_dma_out_complete(usbp, ep))
+        return;
+      if (ep == 0)
+        otg_dma_ep0_setup_arm(usbp);
+    }
+#endif
+#if STM32_USB_OTG_USE_COUNTERS
+    if (!otg_use_dma(usbp))
+      otg_count(&usbp->out_counters[ep], usbp->epc[ep]->out_state->rxcnt,
+                usbp->epc[ep]->out_maxsize);
+#endif
     /* Receive transfer complete.*/
     _usb_isr_invoke_out_cb(usbp, ep);
   }
@@ -839,8 +1131,17 @@ void usb_lld_start(USBDriver *usbp) {
     /* Soft core reset.*/
     otg_core_reset(usbp);
 
-    /* Interrupts on TXFIFOs half empty.*/
-    otgp->GAHBCFG = 0;
+    /* Interrupts on TXFIFOs half empty or, in DMA mode, internal DMA
+       enabled with 4 beats bursts.*/
+    if (otg_use_dma(usbp))
+      otgp->GAHBCFG = GAHBCFG_DMAEN | GAHBCFG_HBSTLEN_INCR4;
+    else
+      otgp->GAHBCFG = 0;
+
+#if STM32_USB_OTG_USE_COUNTERS
+    memset(usbp->in_counters, 0, sizeof usbp->in_counters);
+    memset(usbp->out_counters, 0, sizeof usbp->out_counters);
+#endif
 
     /* Endpoints re-initialization.*/
     otg_disable_ep(usbp);
@@ -859,8 +1160,9 @@ void usb_lld_start(USBDriver *usbp) {
     otgp->GINTSTS  = 0xFFFFFFFF;         /* Clears all pending IRQs, if any. */
 
 #if defined(_CHIBIOS_RT_)
-    /* Creates the data pump thread. Note, it is created only once.*/
-    if (usbp->tr == NULL) {
+    /* Creates the data pump thread. Note, it is created only once and it
+       is not required in DMA mode.*/
+    if ((usbp->tr == NULL) && !otg_use_dma(usbp)) {
       usbp->tr = chThdCreateI(usbp->wa_pump, sizeof usbp->wa_pump,
                               STM32_USB_OTG_THREAD_PRIO,
                               usb_lld_pump, usbp);
@@ -949,10 +1251,17 @@ void usb_lld_reset(USBDriver *usbp) {
   /* Resets the device address to zero.*/
   otgp->DCFG = (otgp->DCFG & ~DCFG_DAD_MASK) | DCFG_DAD(0);
 
-  /* Enables also EP-related interrupt sources.*/
-  otgp->GINTMSK  |= GINTMSK_RXFLVLM | GINTMSK_OEPM  | GINTMSK_IEPM;
+  /* Enables also EP-related interrupt sources, in DMA mode the RX FIFO
+     is emptied by the core.*/
+  otgp->GINTMSK  |= GINTMSK_OEPM    | GINTMSK_IEPM;
+  if (!otg_use_dma(usbp))
+    otgp->GINTMSK |= GINTMSK_RXFLVLM;
   otgp->DIEPMSK   = DIEPMSK_TOCM    | DIEPMSK_XFRCM;
   otgp->DOEPMSK   = DOEPMSK_STUPM   | DOEPMSK_XFRCM;
+#if STM32_USB_OTG_USE_COUNTERS
+  otgp->DIEPMSK  |= DIEPMSK_ITTXFEMSK;
+  otgp->DOEPMSK  |= DOEPMSK_OTEPDM;
+#endif
 
   /* EP0 initialization, it is a special case.*/
   usbp->epc[0] = &ep0config;
@@ -965,6 +1274,11 @@ void usb_lld_reset(USBDriver *usbp) {
   otgp->DIEPTXF0 = DIEPTXF_INEPTXFD(ep0config.in_maxsize / 4) |
                    DIEPTXF_INEPTXSA(otg_ram_alloc(usbp,
                                                   ep0config.in_maxsize / 4));
+
+#if STM32_USB_OTG2_USE_DMA
+  if (otg_use_dma(usbp))
+    otg_dma_ep0_setup_arm(usbp);
+#endif
 }
 
 /**
@@ -1142,6 +1456,22 @@ void usb_lld_prepare_receive(USBDriver *usbp, usbep_t ep) {
   uint32_t pcnt;
   USBOutEndpointState *osp = usbp->epc[ep]->out_state;
 
+#if STM32_USB_OTG2_USE_DMA
+  if (otg_use_dma(usbp)) {
+    bool bounce;
+    size_t n = otg_dma_out_size(usbp, ep, &bounce);
+
+    /* In DMA mode the transfer can be split in several transactions, the
+       size is the one of the current transaction.*/
+    pcnt = (n + usbp->epc[ep]->out_maxsize - 1) / usbp->epc[ep]->out_maxsize;
+    if (pcnt == 0)
+      pcnt = 1;
+    usbp->otg->oe[ep].DOEPTSIZ = DOEPTSIZ_STUPCNT(3) | DOEPTSIZ_PKTCNT(pcnt) |
+                                 DOEPTSIZ_XFRSIZ(n);
+    return;
+  }
+#endif
+
   /* Transfer initialization.*/
   pcnt = (osp->rxsize + usbp->epc[ep]->out_maxsize - 1) /
          usbp->epc[ep]->out_maxsize;
@@ -1170,6 +1500,12 @@ void usb_lld_prepare_transmit(USBDriver *usbp, usbep_t ep) {
   else {
     if ((ep == 0) && (isp->txsize  > EP0_MAX_INSIZE))
       isp->txsize = EP0_MAX_INSIZE;
+#if STM32_USB_OTG2_USE_DMA
+    /* Transactions through the bounce buffer are limited to its size.*/
+    if (otg_use_dma(usbp) && otg_dma_in_bounce(isp) &&
+        (isp->txsize > otg_dma_chunk(usbp->epc[ep]->in_maxsize)))
+      isp->txsize = otg_dma_chunk(usbp->epc[ep]->in_maxsize);
+#endif
 
     /* Normal case.*/
     uint32_t pcnt = (isp->txsize + usbp->epc[ep]->in_maxsize - 1) /
@@ -1189,6 +1525,23 @@ void usb_lld_prepare_transmit(USBDriver *usbp, usbep_t ep) {
  */
 void usb_lld_start_out(USBDriver *usbp, usbep_t ep) {
 
+#if STM32_USB_OTG2_USE_DMA
+  if (otg_use_dma(usbp)) {
+    USBOutEndpointState *osp = usbp->epc[ep]->out_state;
+    bool bounce;
+
+    (void)otg_dma_out_size(usbp, ep, &bounce);
+    if ((ep == 0) && (osp->rxsize == 0))
+      usbp->otg->oe[ep].DOEPDMA = (uint32_t)otg2_setup_area;
+    else if (bounce)
+      usbp->otg->oe[ep].DOEPDMA = (uint32_t)otg2_out_bounce[ep];
+    else
+      usbp->otg->oe[ep].DOEPDMA = (uint32_t)osp->mode.linear.rxbuf;
+    usbp->otg->oe[ep].DOEPCTL |= DOEPCTL_EPENA | DOEPCTL_CNAK;
+    return;
+  }
+#endif
+
   usbp->otg->oe[ep].DOEPCTL |= DOEPCTL_CNAK;
 }
 
@@ -1202,6 +1555,28 @@ void usb_lld_start_out(USBDriver *usbp, usbep_t ep) {
  */
 void usb_lld_start_in(USBDriver *usbp, usbep_t ep) {
 
+#if STM32_USB_OTG2_USE_DMA
+  if (otg_use_dma(usbp)) {
+    USBInEndpointState *isp = usbp->epc[ep]->in_state;
+
+    /* The core fetches the data autonomously, no TX FIFO empty interrupt
+       is required.*/
+    if (otg_dma_in_bounce(isp)) {
+      uint8_t *bp = (uint8_t *)otg2_in_bounce[ep];
+
+      if (isp->txqueued)
+        otg_queue_read_to_buffer(isp->mode.queue.txqueue, bp, isp->txsize);
+      else
+        memcpy(bp, isp->mode.linear.txbuf, isp->txsize);
+      usbp->otg->ie[ep].DIEPDMA = (uint32_t)bp;
+    }
+    else
+      usbp->otg->ie[ep].DIEPDMA = (uint32_t)isp->mode.linear.txbuf;
+    usbp->otg->ie[ep].DIEPCTL |= DIEPCTL_EPENA | DIEPCTL_CNAK;
+    return;
+  }
+#endif
+
   usbp->otg->ie[ep].DIEPCTL |= DIEPCTL_EPENA | DIEPCTL_CNAK;
   usbp->otg->DIEPEMPMSK |= DIEPEMPMSK_INEPTXFEM(ep);
 }
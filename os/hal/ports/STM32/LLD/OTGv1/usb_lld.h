@@ -137,6 +137,46 @@
 #define STM32_USB_OTGFIFO_FILL_BASEPRI      0
 #endif
 
+/**
+ * @brief   OTG2 internal DMA mode enable switch.
+ * @details If set to @p TRUE the OTG_HS cell moves the endpoints data
+ *          between its FIFOs and RAM using its internal DMA engine, the
+ *          data pump thread is not used for OTG2 in this mode.
+ * @note    Linear buffers that are word aligned, whose size is a multiple
+ *          of the packet size and that are not located in the CCM RAM are
+ *          transferred in place. Queues and other buffers are transferred
+ *          through per-endpoint bounce buffers.
+ */
+#if !defined(STM32_USB_OTG2_USE_DMA) || defined(__DOXYGEN__)
+#define STM32_USB_OTG2_USE_DMA              FALSE
+#endif
+
+/**
+ * @brief   Size of the OTG2 DMA bounce buffers.
+ * @details Each endpoint has a bounce buffer of this size for each
+ *          direction, longer transfers using bounce buffers are split in
+ *          multiple transactions.
+ * @note    Must be a multiple of 4 and not less than the largest packet
+ *          size used by the application.
+ */
+#if !defined(STM32_USB_OTG2_DMA_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define STM32_USB_OTG2_DMA_BUFFER_SIZE      64
+#endif
+
+/**
+ * @brief   Enables the per-endpoint traffic counters.
+ * @details Packets, bytes and NAKs are counted for each endpoint and
+ *          direction, see @p usb_lld_get_in_counters() and
+ *          @p usb_lld_get_out_counters().
+ * @note    NAKs are counted using the "IN token received when TxFIFO
+ *          empty" and "OUT token received when endpoint disabled"
+ *          interrupts, a polling host can generate a large number of
+ *          those so enable this option only while tuning.
+ */
+#if !defined(STM32_USB_OTG_USE_COUNTERS) || defined(__DOXYGEN__)
+#define STM32_USB_OTG_USE_COUNTERS          FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -171,6 +211,18 @@
 #error "OTG2 RX FIFO size must be a multiple of 4"
 #endif
 
+#if STM32_USB_OTG2_USE_DMA && !STM32_USB_USE_OTG2
+#error "OTG2 DMA mode enabled but OTG2 not in use"
+#endif
+
+#if (STM32_USB_OTG2_DMA_BUFFER_SIZE & 3) != 0
+#error "OTG2 DMA bounce buffer size must be a multiple of 4"
+#endif
+
+#if STM32_USB_OTG2_DMA_BUFFER_SIZE < 64
+#error "OTG2 DMA bounce buffer size must be at least 64"
+#endif
+
 #if defined(STM32F4XX) || defined(STM32F2XX)
 #define STM32_USBCLK                        STM32_PLL48CLK
 #elif defined(STM32F10X_CL)
@@ -196,6 +248,24 @@ typedef struct {
   uint32_t                      num_endpoints;
 } stm32_otg_params_t;
 
+/**
+ * @brief   Per-endpoint traffic counters.
+ */
+typedef struct {
+  /**
+   * @brief   Transferred packets, zero length packets included.
+   */
+  uint32_t                      packets;
+  /**
+   * @brief   Transferred bytes.
+   */
+  uint32_t                      bytes;
+  /**
+   * @brief   Tokens NAKed because the endpoint was not ready.
+   */
+  uint32_t                      naks;
+} stm32_otg_counters_t;
+
 /**
  * @brief   Type of an IN endpoint state structure.
  */
@@ -454,6 +524,16 @@ struct USBDriver {
    * @brief   Pointer to the thread when it is sleeping or @p NULL.
    */
   thread_reference_t            wait;
+#if STM32_USB_OTG_USE_COUNTERS || defined(__DOXYGEN__)
+  /**
+   * @brief   IN endpoints traffic counters.
+   */
+  stm32_otg_counters_t          in_counters[USB_MAX_ENDPOINTS + 1];
+  /**
+   * @brief   OUT endpoints traffic counters.
+   */
+  stm32_otg_counters_t          out_counters[USB_MAX_ENDPOINTS + 1];
+#endif
 #if defined(_CHIBIOS_RT_)
   /**
    * @brief   Pointer to the thread.
@@ -487,6 +567,32 @@ struct USBDriver {
 #define usb_lld_get_transaction_size(usbp, ep)                              \
   ((usbp)->epc[ep]->out_state->rxcnt)
 
+#if STM32_USB_OTG_USE_COUNTERS || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the traffic counters of an IN endpoint.
+ * @note    The counters are cleared when the driver is started.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ * @return              Pointer to the @p stm32_otg_counters_t structure.
+ *
+ * @api
+ */
+#define usb_lld_get_in_counters(usbp, ep) (&(usbp)->in_counters[ep])
+
+/**
+ * @brief   Returns the traffic counters of an OUT endpoint.
+ * @note    The counters are cleared when the driver is started.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ * @return              Pointer to the @p stm32_otg_counters_t structure.
+ *
+ * @api
+ */
+#define usb_lld_get_out_counters(usbp, ep) (&(usbp)->out_counters[ep])
+#endif /* STM32_USB_OTG_USE_COUNTERS */
+
 /**
  * @brief   Connects the USB device.
  *
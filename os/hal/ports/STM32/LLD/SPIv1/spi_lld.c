@@ -144,6 +144,13 @@ static void spi_lld_serve_rx_interrupt(SPIDriver *spip, uint32_t flags) {
   dmaStreamDisable(spip->dmatx);
   dmaStreamDisable(spip->dmarx);
 
+#if STM32_DMA_USE_ARBITER
+  /* The receive stream is returned to the arbiter before invoking the
+     callback because a new operation could be started from there.*/
+  dmaStreamRelease(spip->dmarx);
+  spip->dmarx = NULL;
+#endif
+
   /* Portable SPI ISR code defined in the high level driver, note, it is
      a macro.*/
   _spi_isr_code(spip);
@@ -169,6 +176,84 @@ static void spi_lld_serve_tx_interrupt(SPIDriver *spip, uint32_t flags) {
 #endif
 }
 
+/**
+ * @brief   Programs and enables the DMA streams.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to be exchanged
+ * @param[in] txbuf     the pointer to the transmit buffer
+ * @param[out] rxbuf    the pointer to the receive buffer
+ */
+static void spi_lld_start_dma(SPIDriver *spip, size_t n,
+                              const void *txbuf, void *rxbuf) {
+  uint32_t rxmode = spip->rxdmamode, txmode = spip->txdmamode;
+
+  /* The dummy words are not incremented.*/
+  if (rxbuf != &dummyrx)
+    rxmode |= STM32_DMA_CR_MINC;
+  if (txbuf != &dummytx)
+    txmode |= STM32_DMA_CR_MINC;
+
+#if STM32_DMA_USE_ARBITER
+  /* The receive stream can be different for each operation.*/
+  rxmode = (rxmode & ~STM32_DMA_CR_CHSEL_MASK) |
+           STM32_DMA_CR_CHSEL(dmaStreamGetChannel(spip->dmarx,
+                                                  spip->rxdmachn));
+  dmaStreamSetPeripheral(spip->dmarx, &spip->spi->DR);
+#endif
+
+  dmaStreamSetMemory0(spip->dmarx, rxbuf);
+  dmaStreamSetTransactionSize(spip->dmarx, n);
+  dmaStreamSetMode(spip->dmarx, rxmode);
+
+  dmaStreamSetMemory0(spip->dmatx, txbuf);
+  dmaStreamSetTransactionSize(spip->dmatx, n);
+  dmaStreamSetMode(spip->dmatx, txmode);
+
+  dmaStreamEnable(spip->dmarx);
+  dmaStreamEnable(spip->dmatx);
+}
+
+#if STM32_DMA_USE_ARBITER || defined(__DOXYGEN__)
+/**
+ * @brief   Receive stream grant callback.
+ * @details The operation queued by @p spi_lld_request_dma() is started.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] dmastp    pointer to the granted stream
+ */
+static void spi_lld_serve_grant(SPIDriver *spip,
+                                const stm32_dma_stream_t *dmastp) {
+
+  spip->dmarx = dmastp;
+  spi_lld_start_dma(spip, spip->dmasize, spip->txbuf, spip->rxbuf);
+}
+
+/**
+ * @brief   Requests the receive stream and starts the operation.
+ * @details If the stream is not immediately available then the operation
+ *          is started when the arbiter grants it.
+ * @note    Only the receive stream is arbitrated, the transmit stream is
+ *          allocated by @p spi_lld_start() so the driver never waits for a
+ *          stream while owning another.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to be exchanged
+ * @param[in] txbuf     the pointer to the transmit buffer
+ * @param[out] rxbuf    the pointer to the receive buffer
+ */
+static void spi_lld_request_dma(SPIDriver *spip, size_t n,
+                                const void *txbuf, void *rxbuf) {
+
+  spip->dmasize = n;
+  spip->txbuf   = txbuf;
+  spip->rxbuf   = rxbuf;
+  spip->dmarx   = dmaStreamRequestI(&spip->rxrq);
+  if (spip->dmarx != NULL)
+    spi_lld_start_dma(spip, n, txbuf, rxbuf);
+}
+#endif /* STM32_DMA_USE_ARBITER */
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -202,6 +287,15 @@ void spi_lld_init(void) {
                     STM32_DMA_CR_DIR_M2P |
                     STM32_DMA_CR_DMEIE |
                     STM32_DMA_CR_TEIE;
+#if STM32_DMA_USE_ARBITER
+  SPID1.dmarx     = NULL;
+  SPID1.rxdmachn  = STM32_SPI1_RX_DMA_CHN;
+  dmaStreamRequestObjectInit(&SPID1.rxrq, STM32_SPI1_RX_DMA_MSK,
+                             STM32_SPI_SPI1_IRQ_PRIORITY,
+                             (stm32_dmaisr_t)spi_lld_serve_rx_interrupt,
+                             (stm32_dmagrant_t)spi_lld_serve_grant,
+                             (void *)&SPID1);
+#endif
 #endif
 
 #if STM32_SPI_USE_SPI2
@@ -220,6 +314,15 @@ void spi_lld_init(void) {
                     STM32_DMA_CR_DIR_M2P |
                     STM32_DMA_CR_DMEIE |
                     STM32_DMA_CR_TEIE;
+#if STM32_DMA_USE_ARBITER
+  SPID2.dmarx     = NULL;
+  SPID2.rxdmachn  = STM32_SPI2_RX_DMA_CHN;
+  dmaStreamRequestObjectInit(&SPID2.rxrq, STM32_SPI2_RX_DMA_MSK,
+                             STM32_SPI_SPI2_IRQ_PRIORITY,
+                             (stm32_dmaisr_t)spi_lld_serve_rx_interrupt,
+                             (stm32_dmagrant_t)spi_lld_serve_grant,
+                             (void *)&SPID2);
+#endif
 #endif
 
 #if STM32_SPI_USE_SPI3
@@ -238,6 +341,15 @@ void spi_lld_init(void) {
                     STM32_DMA_CR_DIR_M2P |
                     STM32_DMA_CR_DMEIE |
                     STM32_DMA_CR_TEIE;
+#if STM32_DMA_USE_ARBITER
+  SPID3.dmarx     = NULL;
+  SPID3.rxdmachn  = STM32_SPI3_RX_DMA_CHN;
+  dmaStreamRequestObjectInit(&SPID3.rxrq, STM32_SPI3_RX_DMA_MSK,
+                             STM32_SPI_SPI3_IRQ_PRIORITY,
+                             (stm32_dmaisr_t)spi_lld_serve_rx_interrupt,
+                             (stm32_dmagrant_t)spi_lld_serve_grant,
+                             (void *)&SPID3);
+#endif
 #endif
 
 #if STM32_SPI_USE_SPI4
@@ -256,6 +368,15 @@ void spi_lld_init(void) {
                     STM32_DMA_CR_DIR_M2P |
                     STM32_DMA_CR_DMEIE |
                     STM32_DMA_CR_TEIE;
+#if STM32_DMA_USE_ARBITER
+  SPID4.dmarx     = NULL;
+  SPID4.rxdmachn  = STM32_SPI4_RX_DMA_CHN;
+  dmaStreamRequestObjectInit(&SPID4.rxrq, STM32_SPI4_RX_DMA_MSK,
+                             STM32_SPI_SPI4_IRQ_PRIORITY,
+                             (stm32_dmaisr_t)spi_lld_serve_rx_interrupt,
+                             (stm32_dmagrant_t)spi_lld_serve_grant,
+                             (void *)&SPID4);
+#endif
 #endif
 
 #if STM32_SPI_USE_SPI5
@@ -274,6 +395,15 @@ void spi_lld_init(void) {
                     STM32_DMA_CR_DIR_M2P |
                     STM32_DMA_CR_DMEIE |
                     STM32_DMA_CR_TEIE;
+#if STM32_DMA_USE_ARBITER
+  SPID5.dmarx     = NULL;
+  SPID5.rxdmachn  = STM32_SPI5_RX_DMA_CHN;
+  dmaStreamRequestObjectInit(&SPID5.rxrq, STM32_SPI5_RX_DMA_MSK,
+                             STM32_SPI_SPI5_IRQ_PRIORITY,
+                             (stm32_dmaisr_t)spi_lld_serve_rx_interrupt,
+                             (stm32_dmagrant_t)spi_lld_serve_grant,
+                             (void *)&SPID5);
+#endif
 #endif
 
 #if STM32_SPI_USE_SPI6
@@ -292,6 +422,15 @@ void spi_lld_init(void) {
                     STM32_DMA_CR_DIR_M2P |
                     STM32_DMA_CR_DMEIE |
                     STM32_DMA_CR_TEIE;
+#if STM32_DMA_USE_ARBITER
+  SPID6.dmarx     = NULL;
+  SPID6.rxdmachn  = STM32_SPI6_RX_DMA_CHN;
+  dmaStreamRequestObjectInit(&SPID6.rxrq, STM32_SPI6_RX_DMA_MSK,
+                             STM32_SPI_SPI6_IRQ_PRIORITY,
+                             (stm32_dmaisr_t)spi_lld_serve_rx_interrupt,
+                             (stm32_dmagrant_t)spi_lld_serve_grant,
+                             (void *)&SPID6);
+#endif
 #endif
 }
 
@@ -309,11 +448,13 @@ void spi_lld_start(SPIDriver *spip) {
 #if STM32_SPI_USE_SPI1
     if (&SPID1 == spip) {
       bool b;
+#if !STM32_DMA_USE_ARBITER
       b = dmaStreamAllocate(spip->dmarx,
                             STM32_SPI_SPI1_IRQ_PRIORITY,
                             (stm32_dmaisr_t)spi_lld_serve_rx_interrupt,
                             (void *)spip);
       osalDbgAssert(!b, "stream already allocated");
+#endif
       b = dmaStreamAllocate(spip->dmatx,
                             STM32_SPI_SPI1_IRQ_PRIORITY,
                             (stm32_dmaisr_t)spi_lld_serve_tx_interrupt,
@@ -325,11 +466,13 @@ void spi_lld_start(SPIDriver *spip) {
 #if STM32_SPI_USE_SPI2
     if (&SPID2 == spip) {
       bool b;
+#if !STM32_DMA_USE_ARBITER
       b = dmaStreamAllocate(spip->dmarx,
                             STM32_SPI_SPI2_IRQ_PRIORITY,
                             (stm32_dmaisr_t)spi_lld_serve_rx_interrupt,
                             (void *)spip);
       osalDbgAssert(!b, "stream already allocated");
+#endif
       b = dmaStreamAllocate(spip->dmatx,
                             STM32_SPI_SPI2_IRQ_PRIORITY,
                             (stm32_dmaisr_t)spi_lld_serve_tx_interrupt,
@@ -341,11 +484,13 @@ void spi_lld_start(SPIDriver *spip) {
 #if STM32_SPI_USE_SPI3
     if (&SPID3 == spip) {
       bool b;
+#if !STM32_DMA_USE_ARBITER
       b = dmaStreamAllocate(spip->dmarx,
                             STM32_SPI_SPI3_IRQ_PRIORITY,
                             (stm32_dmaisr_t)spi_lld_serve_rx_interrupt,
                             (void *)spip);
       osalDbgAssert(!b, "stream already allocated");
+#endif
       b = dmaStreamAllocate(spip->dmatx,
                             STM32_SPI_SPI3_IRQ_PRIORITY,
                             (stm32_dmaisr_t)spi_lld_serve_tx_interrupt,
@@ -357,11 +502,13 @@ void spi_lld_start(SPIDriver *spip) {
 #if STM32_SPI_USE_SPI4
     if (&SPID4 == spip) {
       bool b;
+#if !STM32_DMA_USE_ARBITER
       b = dmaStreamAllocate(spip->dmarx,
                             STM32_SPI_SPI4_IRQ_PRIORITY,
                             (stm32_dmaisr_t)spi_lld_serve_rx_interrupt,
                             (void *)spip);
       chDbgAssert(!b, "stream already allocated");
+#endif
       b = dmaStreamAllocate(spip->dmatx,
                             STM32_SPI_SPI4_IRQ_PRIORITY,
                             (stm32_dmaisr_t)spi_lld_serve_tx_interrupt,
@@ -373,11 +520,13 @@ void spi_lld_start(SPIDriver *spip) {
 #if STM32_SPI_USE_SPI5
     if (&SPID5 == spip) {
       bool b;
+#if !STM32_DMA_USE_ARBITER
       b = dmaStreamAllocate(spip->dmarx,
                             STM32_SPI_SPI5_IRQ_PRIORITY,
                             (stm32_dmaisr_t)spi_lld_serve_rx_interrupt,
                             (void *)spip);
       chDbgAssert(!b, "stream already allocated");
+#endif
       b = dmaStreamAllocate(spip->dmatx,
                             STM32_SPI_SPI5_IRQ_PRIORITY,
                             (stm32_dmaisr_t)spi_lld_serve_tx_interrupt,
@@ -389,11 +538,13 @@ void spi_lld_start(SPIDriver *spip) {
 #if STM32_SPI_USE_SPI6
     if (&SPID6 == spip) {
       bool b;
+#if !STM32_DMA_USE_ARBITER
       b = dmaStreamAllocate(spip->dmarx,
                             STM32_SPI_SPI6_IRQ_PRIORITY,
                             (stm32_dmaisr_t)spi_lld_serve_rx_interrupt,
                             (void *)spip);
       chDbgAssert(!b, "stream already allocated");
+#endif
       b = dmaStreamAllocate(spip->dmatx,
                             STM32_SPI_SPI6_IRQ_PRIORITY,
                             (stm32_dmaisr_t)spi_lld_serve_tx_interrupt,
@@ -404,7 +555,9 @@ void spi_lld_start(SPIDriver *spip) {
 #endif
 
     /* DMA setup.*/
+#if !STM32_DMA_USE_ARBITER
     dmaStreamSetPeripheral(spip->dmarx, &spip->spi->DR);
+#endif
     dmaStreamSetPeripheral(spip->dmatx, &spip->spi->DR);
   }
 
@@ -446,7 +599,19 @@ void spi_lld_stop(SPIDriver *spip) {
     /* SPI disable.*/
     spip->spi->CR1 = 0;
     spip->spi->CR2 = 0;
+#if STM32_DMA_USE_ARBITER
+    /* A request still queued in the arbiter is withdrawn, a later grant
+       would start the DMA on a stopped driver.*/
+    osalSysLock();
+    dmaStreamCancelI(&spip->rxrq);
+    osalSysUnlock();
+    if (spip->dmarx != NULL) {
+      dmaStreamRelease(spip->dmarx);
+      spip->dmarx = NULL;
+    }
+#else
     dmaStreamRelease(spip->dmarx);
+#endif
     dmaStreamRelease(spip->dmatx);
 
 #if STM32_SPI_USE_SPI1
@@ -514,16 +679,11 @@ void spi_lld_unselect(SPIDriver *spip) {
  */
 void spi_lld_ignore(SPIDriver *spip, size_t n) {
 
-  dmaStreamSetMemory0(spip->dmarx, &dummyrx);
-  dmaStreamSetTransactionSize(spip->dmarx, n);
-  dmaStreamSetMode(spip->dmarx, spip->rxdmamode);
-
-  dmaStreamSetMemory0(spip->dmatx, &dummytx);
-  dmaStreamSetTransactionSize(spip->dmatx, n);
-  dmaStreamSetMode(spip->dmatx, spip->txdmamode);
-
-  dmaStreamEnable(spip->dmarx);
-  dmaStreamEnable(spip->dmatx);
+#if STM32_DMA_USE_ARBITER
+  spi_lld_request_dma(spip, n, &dummytx, &dummyrx);
+#else
+  spi_lld_start_dma(spip, n, &dummytx, &dummyrx);
+#endif
 }
 
 /**
@@ -544,16 +704,11 @@ void spi_lld_ignore(SPIDriver *spip, size_t n) {
 void spi_lld_exchange(SPIDriver *spip, size_t n,
                       const void *txbuf, void *rxbuf) {
 
-  dmaStreamSetMemory0(spip->dmarx, rxbuf);
-  dmaStreamSetTransactionSize(spip->dmarx, n);
-  dmaStreamSetMode(spip->dmarx, spip->rxdmamode| STM32_DMA_CR_MINC);
-
-  dmaStreamSetMemory0(spip->dmatx, txbuf);
-  dmaStreamSetTransactionSize(spip->dmatx, n);
-  dmaStreamSetMode(spip->dmatx, spip->txdmamode | STM32_DMA_CR_MINC);
-
-  dmaStreamEnable(spip->dmarx);
-  dmaStreamEnable(spip->dmatx);
+#if STM32_DMA_USE_ARBITER
+  spi_lld_request_dma(spip, n, txbuf, rxbuf);
+#else
+  spi_lld_start_dma(spip, n, txbuf, rxbuf);
+#endif
 }
 
 /**
@@ -571,16 +726,11 @@ void spi_lld_exchange(SPIDriver *spip, size_t n,
  */
 void spi_lld_send(SPIDriver *spip, size_t n, const void *txbuf) {
 
-  dmaStreamSetMemory0(spip->dmarx, &dummyrx);
-  dmaStreamSetTransactionSize(spip->dmarx, n);
-  dmaStreamSetMode(spip->dmarx, spip->rxdmamode);
-
-  dmaStreamSetMemory0(spip->dmatx, txbuf);
-  dmaStreamSetTransactionSize(spip->dmatx, n);
-  dmaStreamSetMode(spip->dmatx, spip->txdmamode | STM32_DMA_CR_MINC);
-
-  dmaStreamEnable(spip->dmarx);
-  dmaStreamEnable(spip->dmatx);
+#if STM32_DMA_USE_ARBITER
+  spi_lld_request_dma(spip, n, txbuf, &dummyrx);
+#else
+  spi_lld_start_dma(spip, n, txbuf, &dummyrx);
+#endif
 }
 
 /**
@@ -598,16 +748,11 @@ void spi_lld_send(SPIDriver *spip, size_t n, const void *txbuf) {
  */
 void spi_lld_receive(SPIDriver *spip, size_t n, void *rxbuf) {
 
-  dmaStreamSetMemory0(spip->dmarx, rxbuf);
-  dmaStreamSetTransactionSize(spip->dmarx, n);
-  dmaStreamSetMode(spip->dmarx, spip->rxdmamode | STM32_DMA_CR_MINC);
-
-  dmaStreamSetMemory0(spip->dmatx, &dummytx);
-  dmaStreamSetTransactionSize(spip->dmatx, n);
-  dmaStreamSetMode(spip->dmatx, spip->txdmamode);
-
-  dmaStreamEnable(spip->dmarx);
-  dmaStreamEnable(spip->dmatx);
+#if STM32_DMA_USE_ARBITER
+  spi_lld_request_dma(spip, n, &dummytx, rxbuf);
+#else
+  spi_lld_start_dma(spip, n, &dummytx, rxbuf);
+#endif
 }
 
 /**
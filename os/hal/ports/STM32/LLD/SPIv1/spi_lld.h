@@ -396,6 +396,11 @@
 #define STM32_DMA_REQUIRED
 #endif
 
+/* The DMA streams arbiter is not available on all the platforms.*/
+#if !defined(STM32_DMA_USE_ARBITER)
+#define STM32_DMA_USE_ARBITER               FALSE
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -484,6 +489,31 @@ struct SPIDriver {
    * @brief TX DMA mode bit mask.
    */
   uint32_t                  txdmamode;
+#if STM32_DMA_USE_ARBITER || defined(__DOXYGEN__)
+  /**
+   * @brief Receive DMA stream request.
+   * @note  The receive stream is granted by the DMA arbiter for each
+   *        operation and released on completion, @p dmarx is @p NULL
+   *        when there is no operation in progress.
+   */
+  stm32_dma_request_t       rxrq;
+  /**
+   * @brief RX DMA stream/channel association word.
+   */
+  uint32_t                  rxdmachn;
+  /**
+   * @brief Size of the operation waiting for the receive stream.
+   */
+  size_t                    dmasize;
+  /**
+   * @brief Transmit buffer of the operation waiting for the receive stream.
+   */
+  const void                *txbuf;
+  /**
+   * @brief Receive buffer of the operation waiting for the receive stream.
+   */
+  void                      *rxbuf;
+#endif
 };
 
 /*===========================================================================*/
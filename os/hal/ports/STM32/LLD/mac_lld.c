@@ -34,7 +34,9 @@
 /* Driver local definitions.                                                 */
 /*===========================================================================*/
 
-#define BUFFER_SIZE ((((STM32_MAC_BUFFERS_SIZE - 1) | 3) + 1) / 4)
+/* Receive descriptors raising an interrupt when coalescing is enabled.*/
+#define RDES1_DIC(i)                                                        \
+  ((((i) + 1) % STM32_MAC_RX_COALESCE_FRAMES) != 0 ? STM32_RDES1_DIC : 0)
 
 /* MII divider optimal value.*/
 #if (STM32_HCLK >= 150000000)
@@ -70,13 +72,22 @@ static const uint8_t default_mac_address[] = {0xAA, 0x55, 0x13,
 static stm32_eth_rx_descriptor_t rd[STM32_MAC_RECEIVE_BUFFERS];
 static stm32_eth_tx_descriptor_t td[STM32_MAC_TRANSMIT_BUFFERS];
 
-static uint32_t rb[STM32_MAC_RECEIVE_BUFFERS][BUFFER_SIZE];
-static uint32_t tb[STM32_MAC_TRANSMIT_BUFFERS][BUFFER_SIZE];
+#if MAC_USE_ZERO_COPY
+static MACPacket pk[STM32_MAC_PACKET_BUFFERS];
+
+/* Packets currently attached to the descriptors.*/
+static MACPacket *rpk[STM32_MAC_RECEIVE_BUFFERS];
+static MACPacket *tpk[STM32_MAC_TRANSMIT_BUFFERS];
+#else
+static uint32_t rb[STM32_MAC_RECEIVE_BUFFERS][STM32_MAC_BUFFER_WORDS];
+static uint32_t tb[STM32_MAC_TRANSMIT_BUFFERS][STM32_MAC_BUFFER_WORDS];
+#endif
 
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if !STM32_MAC_LOOPBACK || defined(__DOXYGEN__)
 /**
  * @brief   Writes a PHY register.
  *
@@ -119,9 +130,10 @@ static void mii_find_phy(MACDriver *macp) {
   uint32_t i;
 
 #if STM32_MAC_PHY_TIMEOUT > 0
-  halrtcnt_t start = halGetCounterValue();
-  halrtcnt_t timeout  = start + MS2RTT(STM32_MAC_PHY_TIMEOUT);
-  while (halIsCounterWithin(start, timeout)) {
+  unsigned n = STM32_MAC_PHY_TIMEOUT;
+
+  /* A search pass every millisecond until the timeout.*/
+  do {
 #endif
     for (i = 0; i < 31; i++) {
       macp->phyaddr = i << 11;
@@ -132,12 +144,14 @@ static void mii_find_phy(MACDriver *macp) {
       }
     }
 #if STM32_MAC_PHY_TIMEOUT > 0
-  }
+    osalSysPolledDelayX(STM32_HCLK / 1000);
+  } while (--n > 0);
 #endif
   /* Wrong or defective board.*/
-  chSysHalt();
+  osalSysHalt("PHY not found");
 }
 #endif
+#endif /* !STM32_MAC_LOOPBACK */
 
 /**
  * @brief   MAC address setup.
@@ -165,36 +179,114 @@ static void mac_lld_set_address(const uint8_t *p) {
   ETH->MACHTLR   = 0;
 }
 
+/**
+ * @brief   Checks the status of a received frame.
+ *
+ * @param[in] rdes0     the descriptor first word
+ * @return              The frame status.
+ * @retval true         if the frame is valid.
+ * @retval false        if the frame must be discarded.
+ */
+static bool rx_frame_valid(uint32_t rdes0) {
+
+  return !(rdes0 & (STM32_RDES0_AFM | STM32_RDES0_ES))
+#if STM32_MAC_IP_CHECKSUM_OFFLOAD
+         && (rdes0 & STM32_RDES0_FT)
+         && !(rdes0 & (STM32_RDES0_IPHCE | STM32_RDES0_PCE))
+#endif
+         && (rdes0 & STM32_RDES0_FS) && (rdes0 & STM32_RDES0_LS);
+}
+
+/**
+ * @brief   Restarts the receive DMA if it is stalled.
+ */
+static void rx_resume(void) {
+
+  if ((ETH->DMASR & ETH_DMASR_RPS) == ETH_DMASR_RPS_Suspended) {
+    ETH->DMASR   = ETH_DMASR_RBUS;
+    ETH->DMARPDR = ETH_DMASR_RBUS; /* Any value is OK.*/
+  }
+}
+
+/**
+ * @brief   Gives a transmit descriptor to the DMA as a single frame.
+ *
+ * @param[in] tdes      pointer to the transmit descriptor
+ * @param[in] size      frame size
+ */
+static void tx_start(stm32_eth_tx_descriptor_t *tdes, size_t size) {
+
+  tdes->tdes1 = size;
+  tdes->tdes0 = STM32_TDES0_CIC(STM32_MAC_IP_CHECKSUM_OFFLOAD) |
+                STM32_TDES0_IC | STM32_TDES0_LS | STM32_TDES0_FS |
+                STM32_TDES0_TCH | STM32_TDES0_OWN;
+
+  /* If the DMA engine is stalled then a restart request is issued.*/
+  if ((ETH->DMASR & ETH_DMASR_TPS) == ETH_DMASR_TPS_Suspended) {
+    ETH->DMASR   = ETH_DMASR_TBUS;
+    ETH->DMATPDR = ETH_DMASR_TBUS; /* Any value is OK.*/
+  }
+}
+
+#if MAC_USE_ZERO_COPY
+/**
+ * @brief   Returns the packets of the transmitted frames to the pool.
+ * @details All the descriptors completed since the last invocation are
+ *          scanned and their packets are returned to the pool as a single
+ *          chain.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ */
+static void tx_reclaim(MACDriver *macp) {
+  stm32_eth_tx_descriptor_t *tdes = macp->txreclaim;
+  MACPacket *head = NULL;
+
+  while (!(tdes->tdes0 & (STM32_TDES0_OWN | STM32_TDES0_LOCKED)) &&
+         (tpk[tdes - td] != NULL)) {
+    tpk[tdes - td]->next = head;
+    head = tpk[tdes - td];
+    tpk[tdes - td] = NULL;
+    tdes = (stm32_eth_tx_descriptor_t *)tdes->tdes3;
+  }
+  macp->txreclaim = tdes;
+  if (head != NULL)
+    macFreePacketI(macp, head);
+}
+#endif /* MAC_USE_ZERO_COPY */
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
 
-CH_IRQ_HANDLER(ETH_IRQHandler) {
+OSAL_IRQ_HANDLER(ETH_IRQHandler) {
   uint32_t dmasr;
 
-  CH_IRQ_PROLOGUE();
+  OSAL_IRQ_PROLOGUE();
 
   dmasr = ETH->DMASR;
   ETH->DMASR = dmasr; /* Clear status bits.*/
 
   if (dmasr & ETH_DMASR_RS) {
     /* Data Received.*/
-    chSysLockFromIsr();
-    chSemResetI(&ETHD1.rdsem, 0);
+    osalSysLockFromISR();
+    osalThreadDequeueAllI(&ETHD1.rdqueue, MSG_OK);
 #if MAC_USE_EVENTS
-    chEvtBroadcastI(&ETHD1.rdevent);
+    osalEventBroadcastFlagsI(&ETHD1.rdevent, 0);
 #endif
-    chSysUnlockFromIsr();
+    osalSysUnlockFromISR();
   }
 
   if (dmasr & ETH_DMASR_TS) {
     /* Data Transmitted.*/
-    chSysLockFromIsr();
-    chSemResetI(&ETHD1.tdsem, 0);
-    chSysUnlockFromIsr();
+    osalSysLockFromISR();
+#if MAC_USE_ZERO_COPY
+    tx_reclaim(&ETHD1);
+#endif
+    osalThreadDequeueAllI(&ETHD1.tdqueue, MSG_OK);
+    osalSysUnlockFromISR();
   }
 
-  CH_IRQ_EPILOGUE();
+  OSAL_IRQ_EPILOGUE();
 }
 
 /*===========================================================================*/
@@ -210,21 +302,33 @@ void mac_lld_init(void) {
   unsigned i;
 
   macObjectInit(&ETHD1);
-  ETHD1.link_up = FALSE;
 
   /* Descriptor tables are initialized in chained mode, note that the first
-     word is not initialized here but in mac_lld_start().*/
+     word is not initialized here but in mac_lld_start(). In zero-copy mode
+     the buffers are attached to the descriptors by mac_lld_start().*/
   for (i = 0; i < STM32_MAC_RECEIVE_BUFFERS; i++) {
-    rd[i].rdes1 = STM32_RDES1_RCH | STM32_MAC_BUFFERS_SIZE;
+    rd[i].rdes1 = RDES1_DIC(i) | STM32_RDES1_RCH | STM32_MAC_BUFFERS_SIZE;
+#if !MAC_USE_ZERO_COPY
     rd[i].rdes2 = (uint32_t)rb[i];
+#endif
     rd[i].rdes3 = (uint32_t)&rd[(i + 1) % STM32_MAC_RECEIVE_BUFFERS];
   }
   for (i = 0; i < STM32_MAC_TRANSMIT_BUFFERS; i++) {
     td[i].tdes1 = 0;
+#if !MAC_USE_ZERO_COPY
     td[i].tdes2 = (uint32_t)tb[i];
+#endif
     td[i].tdes3 = (uint32_t)&td[(i + 1) % STM32_MAC_TRANSMIT_BUFFERS];
   }
 
+#if MAC_USE_ZERO_COPY
+  /* Packets pool.*/
+  for (i = 0; i < STM32_MAC_PACKET_BUFFERS; i++) {
+    pk[i].next   = ETHD1.pkfree;
+    ETHD1.pkfree = &pk[i];
+  }
+#endif
+
   /* Selection of the RMII or MII mode based on info exported by board.h.*/
 #if defined(STM32F10X_CL)
 #if defined(BOARD_PHY_RMII)
@@ -248,6 +352,14 @@ void mac_lld_init(void) {
   /* MAC clocks temporary activation.*/
   rccEnableETH(FALSE);
 
+#if !STM32_MAC_LOOPBACK
+#if (STM32_MAC_PHY_TIMEOUT > 0) || defined(BOARD_PHY_RESET_DELAY)
+  /* The polled delays use the realtime counter, the kernel has not yet
+     enabled it at this stage.*/
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
   /* PHY address setup.*/
 #if defined(BOARD_PHY_ADDRESS)
   ETHD1.phyaddr = BOARD_PHY_ADDRESS << 11;
@@ -262,7 +374,7 @@ void mac_lld_init(void) {
   /* PHY soft reset procedure.*/
   mii_write(&ETHD1, MII_BMCR, BMCR_RESET);
 #if defined(BOARD_PHY_RESET_DELAY)
-  halPolledDelay(BOARD_PHY_RESET_DELAY);
+  osalSysPolledDelayX(BOARD_PHY_RESET_DELAY);
 #endif
   while (mii_read(&ETHD1, MII_BMCR) & BMCR_RESET)
     ;
@@ -272,6 +384,7 @@ void mac_lld_init(void) {
   /* PHY in power down mode until the driver will be started.*/
   mii_write(&ETHD1, MII_BMCR, mii_read(&ETHD1, MII_BMCR) | BMCR_PDOWN);
 #endif
+#endif /* !STM32_MAC_LOOPBACK */
 
   /* MAC clocks stopped again.*/
   rccDisableETH(FALSE);
@@ -288,12 +401,26 @@ void mac_lld_start(MACDriver *macp) {
   unsigned i;
 
   /* Resets the state of all descriptors.*/
-  for (i = 0; i < STM32_MAC_RECEIVE_BUFFERS; i++)
+  for (i = 0; i < STM32_MAC_RECEIVE_BUFFERS; i++) {
+#if MAC_USE_ZERO_COPY
+    rpk[i] = macAllocPacketI(macp);
+    osalDbgAssert(rpk[i] != NULL, "packets pool exhausted");
+    rd[i].rdes2 = (uint32_t)rpk[i]->buffer;
+#endif
     rd[i].rdes0 = STM32_RDES0_OWN;
+  }
   macp->rxptr = (stm32_eth_rx_descriptor_t *)rd;
-  for (i = 0; i < STM32_MAC_TRANSMIT_BUFFERS; i++)
+  for (i = 0; i < STM32_MAC_TRANSMIT_BUFFERS; i++) {
+#if MAC_USE_ZERO_COPY
+    tpk[i] = NULL;
+#endif
     td[i].tdes0 = STM32_TDES0_TCH;
+  }
   macp->txptr = (stm32_eth_tx_descriptor_t *)td;
+#if MAC_USE_ZERO_COPY
+  macp->txreclaim = (stm32_eth_tx_descriptor_t *)td;
+  macp->rxdropped = 0;
+#endif
 
   /* MAC clocks activation and commanded reset procedure.*/
   rccEnableETH(FALSE);
@@ -304,10 +431,9 @@ void mac_lld_start(MACDriver *macp) {
 #endif
 
   /* ISR vector enabled.*/
-  nvicEnableVector(ETH_IRQn,
-                   CORTEX_PRIORITY_MASK(STM32_MAC_ETH1_IRQ_PRIORITY));
+  nvicEnableVector(ETH_IRQn, STM32_MAC_ETH1_IRQ_PRIORITY);
 
-#if STM32_MAC_ETH1_CHANGE_PHY_STATE
+#if STM32_MAC_ETH1_CHANGE_PHY_STATE && !STM32_MAC_LOOPBACK
   /* PHY in power up mode.*/
   mii_write(macp, MII_BMCR, mii_read(macp, MII_BMCR) & ~BMCR_PDOWN);
 #endif
@@ -331,6 +457,9 @@ void mac_lld_start(MACDriver *macp) {
 #else
   ETH->MACCR =                  ETH_MACCR_RE | ETH_MACCR_TE;
 #endif
+#if STM32_MAC_LOOPBACK
+  ETH->MACCR |= ETH_MACCR_LM;
+#endif
 
   /* DMA configuration:
      Descriptor chains pointers.*/
@@ -341,6 +470,12 @@ void mac_lld_start(MACDriver *macp) {
   ETH->DMASR    = ETH->DMASR;
   ETH->DMAIER   = ETH_DMAIER_NISE | ETH_DMAIER_RIE | ETH_DMAIER_TIE;
 
+#if STM32_MAC_RX_COALESCE_FRAMES > 1
+  /* Receive watchdog, it signals the frames received on descriptors with
+     the interrupt disabled.*/
+  ETH->DMARSWTR = STM32_MAC_RX_COALESCE_WATCHDOG;
+#endif
+
   /* DMA general settings.*/
   ETH->DMABMR   = ETH_DMABMR_AAB | ETH_DMABMR_RDP_1Beat | ETH_DMABMR_PBL_1Beat;
 
@@ -364,7 +499,7 @@ void mac_lld_start(MACDriver *macp) {
 void mac_lld_stop(MACDriver *macp) {
 
   if (macp->state != MAC_STOP) {
-#if STM32_MAC_ETH1_CHANGE_PHY_STATE
+#if STM32_MAC_ETH1_CHANGE_PHY_STATE && !STM32_MAC_LOOPBACK
     /* PHY in power down mode until the driver will be restarted.*/
     mii_write(macp, MII_BMCR, mii_read(macp, MII_BMCR) | BMCR_PDOWN);
 #endif
@@ -380,6 +515,28 @@ void mac_lld_stop(MACDriver *macp) {
 
     /* ISR vector disabled.*/
     nvicDisableVector(ETH_IRQn);
+
+#if MAC_USE_ZERO_COPY
+    {
+      unsigned i;
+      MACPacket *head = NULL;
+
+      /* All the packets attached to the descriptors are returned to the
+         pool, the DMA is stopped.*/
+      for (i = 0; i < STM32_MAC_RECEIVE_BUFFERS; i++) {
+        rpk[i]->next = head;
+        head = rpk[i];
+      }
+      for (i = 0; i < STM32_MAC_TRANSMIT_BUFFERS; i++) {
+        if (tpk[i] != NULL) {
+          tpk[i]->next = head;
+          head = tpk[i];
+          tpk[i] = NULL;
+        }
+      }
+      macFreePacketI(macp, head);
+    }
+#endif
   }
 }
 
@@ -391,8 +548,8 @@ void mac_lld_stop(MACDriver *macp) {
  * @param[in] macp      pointer to the @p MACDriver object
  * @param[out] tdp      pointer to a @p MACTransmitDescriptor structure
  * @return              The operation status.
- * @retval RDY_OK       the descriptor has been obtained.
- * @retval RDY_TIMEOUT  descriptor not available.
+ * @retval MSG_OK       the descriptor has been obtained.
+ * @retval MSG_TIMEOUT  descriptor not available.
  *
  * @notapi
  */
@@ -401,19 +558,26 @@ msg_t mac_lld_get_transmit_descriptor(MACDriver *macp,
   stm32_eth_tx_descriptor_t *tdes;
 
   if (!macp->link_up)
-    return RDY_TIMEOUT;
-
-  chSysLock();
+    return MSG_TIMEOUT;
 
   /* Get Current TX descriptor.*/
   tdes = macp->txptr;
 
   /* Ensure that descriptor isn't owned by the Ethernet DMA or locked by
      another thread.*/
-  if (tdes->tdes0 & (STM32_TDES0_OWN | STM32_TDES0_LOCKED)) {
-    chSysUnlock();
-    return RDY_TIMEOUT;
+  if (tdes->tdes0 & (STM32_TDES0_OWN | STM32_TDES0_LOCKED))
+    return MSG_TIMEOUT;
+
+#if MAC_USE_ZERO_COPY
+  /* A packet is attached to the descriptor, a packet still attached from
+     a previous, not yet reclaimed, transmission is simply reused.*/
+  if (tpk[tdes - td] == NULL) {
+    tpk[tdes - td] = macAllocPacketI(macp);
+    if (tpk[tdes - td] == NULL)
+      return MSG_TIMEOUT;
+    tdes->tdes2 = (uint32_t)tpk[tdes - td]->buffer;
   }
+#endif
 
   /* Marks the current descriptor as locked using a reserved bit.*/
   tdes->tdes0 |= STM32_TDES0_LOCKED;
@@ -421,14 +585,12 @@ msg_t mac_lld_get_transmit_descriptor(MACDriver *macp,
   /* Next TX descriptor to use.*/
   macp->txptr = (stm32_eth_tx_descriptor_t *)tdes->tdes3;
 
-  chSysUnlock();
-
   /* Set the buffer size and configuration.*/
   tdp->offset   = 0;
   tdp->size     = STM32_MAC_BUFFERS_SIZE;
   tdp->physdesc = tdes;
 
-  return RDY_OK;
+  return MSG_OK;
 }
 
 /**
@@ -441,25 +603,15 @@ msg_t mac_lld_get_transmit_descriptor(MACDriver *macp,
  */
 void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp) {
 
-  chDbgAssert(!(tdp->physdesc->tdes0 & STM32_TDES0_OWN),
-              "mac_lld_release_transmit_descriptor(), #1",
-              "attempt to release descriptor already owned by DMA");
+  osalDbgAssert(!(tdp->physdesc->tdes0 & STM32_TDES0_OWN),
+                "attempt to release descriptor already owned by DMA");
 
-  chSysLock();
+  osalSysLock();
 
   /* Unlocks the descriptor and returns it to the DMA engine.*/
-  tdp->physdesc->tdes1 = tdp->offset;
-  tdp->physdesc->tdes0 = STM32_TDES0_CIC(STM32_MAC_IP_CHECKSUM_OFFLOAD) |
-                         STM32_TDES0_IC | STM32_TDES0_LS | STM32_TDES0_FS |
-                         STM32_TDES0_TCH | STM32_TDES0_OWN;
+  tx_start(tdp->physdesc, tdp->offset);
 
-  /* If the DMA engine is stalled then a restart request is issued.*/
-  if ((ETH->DMASR & ETH_DMASR_TPS) == ETH_DMASR_TPS_Suspended) {
-    ETH->DMASR   = ETH_DMASR_TBUS;
-    ETH->DMATPDR = ETH_DMASR_TBUS; /* Any value is OK.*/
-  }
-
-  chSysUnlock();
+  osalSysUnlock();
 }
 
 /**
@@ -468,8 +620,8 @@ void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp) {
  * @param[in] macp      pointer to the @p MACDriver object
  * @param[out] rdp      pointer to a @p MACReceiveDescriptor structure
  * @return              The operation status.
- * @retval RDY_OK       the descriptor has been obtained.
- * @retval RDY_TIMEOUT  descriptor not available.
+ * @retval MSG_OK       the descriptor has been obtained.
+ * @retval MSG_TIMEOUT  descriptor not available.
  *
  * @notapi
  */
@@ -477,28 +629,19 @@ msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
                                      MACReceiveDescriptor *rdp) {
   stm32_eth_rx_descriptor_t *rdes;
 
-  chSysLock();
-
   /* Get Current RX descriptor.*/
   rdes = macp->rxptr;
 
   /* Iterates through received frames until a valid one is found, invalid
      frames are discarded.*/
   while (!(rdes->rdes0 & STM32_RDES0_OWN)) {
-    if (!(rdes->rdes0 & (STM32_RDES0_AFM | STM32_RDES0_ES))
-#if STM32_MAC_IP_CHECKSUM_OFFLOAD
-        && (rdes->rdes0 & STM32_RDES0_FT)
-        && !(rdes->rdes0 & (STM32_RDES0_IPHCE | STM32_RDES0_PCE))
-#endif
-        && (rdes->rdes0 & STM32_RDES0_FS) && (rdes->rdes0 & STM32_RDES0_LS)) {
+    if (rx_frame_valid(rdes->rdes0)) {
       /* Found a valid one.*/
       rdp->offset   = 0;
       rdp->size     = ((rdes->rdes0 & STM32_RDES0_FL_MASK) >> 16) - 4;
       rdp->physdesc = rdes;
       macp->rxptr   = (stm32_eth_rx_descriptor_t *)rdes->rdes3;
-
-      chSysUnlock();
-      return RDY_OK;
+      return MSG_OK;
     }
     /* Invalid frame found, purging.*/
     rdes->rdes0 = STM32_RDES0_OWN;
@@ -508,8 +651,7 @@ msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
   /* Next descriptor to check.*/
   macp->rxptr = rdes;
 
-  chSysUnlock();
-  return RDY_TIMEOUT;
+  return MSG_TIMEOUT;
 }
 
 /**
@@ -523,22 +665,18 @@ msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
  */
 void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp) {
 
-  chDbgAssert(!(rdp->physdesc->rdes0 & STM32_RDES0_OWN),
-              "mac_lld_release_receive_descriptor(), #1",
-              "attempt to release descriptor already owned by DMA");
+  osalDbgAssert(!(rdp->physdesc->rdes0 & STM32_RDES0_OWN),
+                "attempt to release descriptor already owned by DMA");
 
-  chSysLock();
+  osalSysLock();
 
   /* Give buffer back to the Ethernet DMA.*/
   rdp->physdesc->rdes0 = STM32_RDES0_OWN;
 
   /* If the DMA engine is stalled then a restart request is issued.*/
-  if ((ETH->DMASR & ETH_DMASR_RPS) == ETH_DMASR_RPS_Suspended) {
-    ETH->DMASR   = ETH_DMASR_RBUS;
-    ETH->DMARPDR = ETH_DMASR_RBUS; /* Any value is OK.*/
-  }
+  rx_resume();
 
-  chSysUnlock();
+  osalSysUnlock();
 }
 
 /**
@@ -546,12 +684,19 @@ void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp) {
  *
  * @param[in] macp      pointer to the @p MACDriver object
  * @return              The link status.
- * @retval TRUE         if the link is active.
- * @retval FALSE        if the link is down.
+ * @retval true         if the link is active.
+ * @retval false        if the link is down.
  *
  * @notapi
  */
-bool_t mac_lld_poll_link_status(MACDriver *macp) {
+bool mac_lld_poll_link_status(MACDriver *macp) {
+#if STM32_MAC_LOOPBACK
+  (void)macp;
+
+  /* Loopback mode, the link is always active at full speed.*/
+  ETH->MACCR |= ETH_MACCR_FES | ETH_MACCR_DM;
+  return true;
+#else
   uint32_t maccr, bmsr, bmcr;
 
   maccr = ETH->MACCR;
@@ -568,7 +713,7 @@ bool_t mac_lld_poll_link_status(MACDriver *macp) {
     /* Auto-negotiation must be finished without faults and link established.*/
     if ((bmsr & (BMSR_LSTATUS | BMSR_RFAULT | BMSR_ANEGCOMPLETE)) !=
         (BMSR_LSTATUS | BMSR_ANEGCOMPLETE))
-      return macp->link_up = FALSE;
+      return false;
 
     /* Auto-negotiation enabled, checks the LPA register.*/
     lpa = mii_read(macp, MII_LPA);
@@ -588,7 +733,7 @@ bool_t mac_lld_poll_link_status(MACDriver *macp) {
   else {
     /* Link must be established.*/
     if (!(bmsr & BMSR_LSTATUS))
-      return macp->link_up = FALSE;
+      return false;
 
     /* Check on link speed.*/
     if (bmcr & BMCR_SPEED100)
@@ -607,7 +752,8 @@ bool_t mac_lld_poll_link_status(MACDriver *macp) {
   ETH->MACCR = maccr;
 
   /* Returns the link status.*/
-  return macp->link_up = TRUE;
+  return true;
+#endif /* !STM32_MAC_LOOPBACK */
 }
 
 /**
@@ -628,9 +774,8 @@ size_t mac_lld_write_transmit_descriptor(MACTransmitDescriptor *tdp,
                                          uint8_t *buf,
                                          size_t size) {
 
-  chDbgAssert(!(tdp->physdesc->tdes0 & STM32_TDES0_OWN),
-              "mac_lld_write_transmit_descriptor(), #1",
-              "attempt to write descriptor already owned by DMA");
+  osalDbgAssert(!(tdp->physdesc->tdes0 & STM32_TDES0_OWN),
+                "attempt to write descriptor already owned by DMA");
 
   if (size > tdp->size - tdp->offset)
     size = tdp->size - tdp->offset;
@@ -659,9 +804,8 @@ size_t mac_lld_read_receive_descriptor(MACReceiveDescriptor *rdp,
                                        uint8_t *buf,
                                        size_t size) {
 
-  chDbgAssert(!(rdp->physdesc->rdes0 & STM32_RDES0_OWN),
-              "mac_lld_read_receive_descriptor(), #1",
-              "attempt to read descriptor already owned by DMA");
+  osalDbgAssert(!(rdp->physdesc->rdes0 & STM32_RDES0_OWN),
+                "attempt to read descriptor already owned by DMA");
 
   if (size > rdp->size - rdp->offset)
     size = rdp->size - rdp->offset;
@@ -734,6 +878,95 @@ const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
   *sizep = 0;
   return NULL;
 }
+
+/**
+ * @brief   Attaches a packet to a transmit descriptor and starts its
+ *          transmission.
+ * @details The packet is returned to the pool when the transmission is
+ *          complete.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] pkp       pointer to the packet to be transmitted
+ * @return              The operation status.
+ * @retval MSG_OK       the packet has been queued for transmission.
+ * @retval MSG_TIMEOUT  descriptor not available.
+ *
+ * @notapi
+ */
+msg_t mac_lld_transmit_packet(MACDriver *macp, MACPacket *pkp) {
+  stm32_eth_tx_descriptor_t *tdes;
+
+  if (!macp->link_up)
+    return MSG_TIMEOUT;
+
+  /* Get Current TX descriptor.*/
+  tdes = macp->txptr;
+  if (tdes->tdes0 & (STM32_TDES0_OWN | STM32_TDES0_LOCKED))
+    return MSG_TIMEOUT;
+
+  /* A packet still attached from a previous transmission is freed.*/
+  if (tpk[tdes - td] != NULL) {
+    tpk[tdes - td]->next = NULL;
+    macFreePacketI(macp, tpk[tdes - td]);
+  }
+
+  /* The packet buffer is swapped into the descriptor.*/
+  tpk[tdes - td] = pkp;
+  tdes->tdes2    = (uint32_t)pkp->buffer;
+  macp->txptr    = (stm32_eth_tx_descriptor_t *)tdes->tdes3;
+  tx_start(tdes, pkp->size);
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Detaches a received packet from its receive descriptor.
+ * @details The descriptor is armed again with a packet taken from the pool,
+ *          if the pool is empty then the frame is discarded.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] pkpp     pointer to a variable receiving the packet pointer
+ * @return              The operation status.
+ * @retval MSG_OK       a packet has been received.
+ * @retval MSG_TIMEOUT  no frames available.
+ *
+ * @notapi
+ */
+msg_t mac_lld_receive_packet(MACDriver *macp, MACPacket **pkpp) {
+  stm32_eth_rx_descriptor_t *rdes;
+  MACPacket *pkp;
+  msg_t msg = MSG_TIMEOUT;
+
+  /* Get Current RX descriptor.*/
+  rdes = macp->rxptr;
+
+  /* Iterates through received frames until a valid one is found, invalid
+     frames and frames not having a replacement packet are discarded.*/
+  while ((msg != MSG_OK) && !(rdes->rdes0 & STM32_RDES0_OWN)) {
+    if (rx_frame_valid(rdes->rdes0)) {
+      pkp = macAllocPacketI(macp);
+      if (pkp != NULL) {
+        *pkpp         = rpk[rdes - rd];
+        (*pkpp)->size = ((rdes->rdes0 & STM32_RDES0_FL_MASK) >> 16) - 4;
+        rpk[rdes - rd] = pkp;
+        rdes->rdes2   = (uint32_t)pkp->buffer;
+        msg = MSG_OK;
+      }
+      else
+        macp->rxdropped++;
+    }
+    rdes->rdes0 = STM32_RDES0_OWN;
+    rdes = (stm32_eth_rx_descriptor_t *)rdes->rdes3;
+  }
+
+  /* Next descriptor to check.*/
+  macp->rxptr = rdes;
+
+  /* The descriptors are returned to the DMA as a batch.*/
+  rx_resume();
+
+  return msg;
+}
 #endif /* MAC_USE_ZERO_COPY */
 
 #endif /* HAL_USE_MAC */
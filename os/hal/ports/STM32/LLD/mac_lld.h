@@ -150,6 +150,8 @@
  *          not explicitly set in the board header file using
  *          @p BOARD_PHY_ADDRESS. A zero value disables the timeout and a
  *          single search path is performed.
+ * @note    The timeout is approximated, a search pass is performed every
+ *          millisecond.
  */
 #if !defined(STM32_MAC_PHY_TIMEOUT) || defined(__DOXYGEN__)
 #define STM32_MAC_PHY_TIMEOUT               100
@@ -185,16 +187,88 @@
 #if !defined(STM32_MAC_IP_CHECKSUM_OFFLOAD) || defined(__DOXYGEN__)
 #define STM32_MAC_IP_CHECKSUM_OFFLOAD       0
 #endif
+
+/**
+ * @brief   Receive interrupt coalescing, frames.
+ * @details The receive interrupt is raised once every
+ *          @p STM32_MAC_RX_COALESCE_FRAMES descriptors, frames received
+ *          in between are signaled by the receive watchdog. A value of one
+ *          raises an interrupt for each frame.
+ * @note    Values greater than one are only supported on STM32F2xx and
+ *          STM32F4xx devices.
+ */
+#if !defined(STM32_MAC_RX_COALESCE_FRAMES) || defined(__DOXYGEN__)
+#define STM32_MAC_RX_COALESCE_FRAMES        1
+#endif
+
+/**
+ * @brief   Receive interrupt coalescing, watchdog.
+ * @details Maximum delay of a coalesced receive interrupt in units of 256
+ *          HCLK cycles, the range is 1..255.
+ */
+#if !defined(STM32_MAC_RX_COALESCE_WATCHDOG) || defined(__DOXYGEN__)
+#define STM32_MAC_RX_COALESCE_WATCHDOG      32
+#endif
+
+/**
+ * @brief   MAC internal loopback mode.
+ * @details If enabled then the transmitted frames are received back by the
+ *          MAC itself and never reach the PHY. The PHY registers are not
+ *          accessed and the link is always reported as active at 100Mbps
+ *          full duplex, this allows throughput measurements without a PHY
+ *          or a link partner.
+ * @note    The MII or RMII clocks must still be supplied to the MAC, on
+ *          boards where the PHY generates them the PHY must be powered.
+ */
+#if !defined(STM32_MAC_LOOPBACK) || defined(__DOXYGEN__)
+#define STM32_MAC_LOOPBACK                  FALSE
+#endif
+
+/**
+ * @brief   Number of packet buffers in the zero-copy pool.
+ * @details The pool feeds both the receive descriptors and the transmit
+ *          descriptors, buffers in excess can be held by the application.
+ */
+#if !defined(STM32_MAC_PACKET_BUFFERS) || defined(__DOXYGEN__)
+#define STM32_MAC_PACKET_BUFFERS            (STM32_MAC_RECEIVE_BUFFERS +    \
+                                             STM32_MAC_TRANSMIT_BUFFERS + 2)
+#endif
 /** @} */
 
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
-#if (STM32_MAC_PHY_TIMEOUT > 0) && !HAL_IMPLEMENTS_COUNTERS
-#error "STM32_MAC_PHY_TIMEOUT requires the realtime counter service"
+#if (STM32_MAC_RX_COALESCE_FRAMES < 1) ||                                   \
+    (STM32_MAC_RX_COALESCE_FRAMES > STM32_MAC_RECEIVE_BUFFERS)
+#error "invalid STM32_MAC_RX_COALESCE_FRAMES value"
+#endif
+
+#if (STM32_MAC_RX_COALESCE_FRAMES > 1) &&                                   \
+    !defined(STM32F2XX) && !defined(STM32F4XX)
+#error "receive interrupt coalescing not supported on this device"
+#endif
+
+#if (STM32_MAC_RX_COALESCE_WATCHDOG < 1) ||                                 \
+    (STM32_MAC_RX_COALESCE_WATCHDOG > 255)
+#error "invalid STM32_MAC_RX_COALESCE_WATCHDOG value"
+#endif
+
+#if MAC_USE_ZERO_COPY &&                                                    \
+    (STM32_MAC_PACKET_BUFFERS <= STM32_MAC_RECEIVE_BUFFERS)
+#error "STM32_MAC_PACKET_BUFFERS too small"
 #endif
 
+/**
+ * @brief   Size of a DMA buffer in words.
+ */
+#define STM32_MAC_BUFFER_WORDS  ((((STM32_MAC_BUFFERS_SIZE - 1) | 3) + 1) / 4)
+
+/**
+ * @brief   Size of a packet buffer.
+ */
+#define MAC_PACKET_SIZE         STM32_MAC_BUFFERS_SIZE
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -230,6 +304,25 @@ typedef struct {
   /* End of the mandatory fields.*/
 } MACConfig;
 
+/**
+ * @brief   Structure representing a packet buffer.
+ */
+typedef struct mac_packet {
+  /**
+   * @brief Next packet in a chain or in the pool.
+   */
+  struct mac_packet     *next;
+  /**
+   * @brief Frame size.
+   */
+  size_t                size;
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Frame buffer.
+   */
+  uint32_t              buffer[STM32_MAC_BUFFER_WORDS];
+} MACPacket;
+
 /**
  * @brief   Structure representing a MAC driver.
  */
@@ -243,28 +336,42 @@ struct MACDriver {
    */
   const MACConfig       *config;
   /**
-   * @brief Transmit semaphore.
+   * @brief Link status flag.
+   */
+  bool                  link_up;
+  /**
+   * @brief Transmit threads queue.
    */
-  Semaphore             tdsem;
+  threads_queue_t       tdqueue;
   /**
-   * @brief Receive semaphore.
+   * @brief Receive threads queue.
    */
-  Semaphore             rdsem;
+  threads_queue_t       rdqueue;
 #if MAC_USE_EVENTS || defined(__DOXYGEN__)
   /**
    * @brief Receive event.
    */
-  EventSource           rdevent;
+  event_source_t        rdevent;
+  /**
+   * @brief Link status event.
+   */
+  event_source_t        lsevent;
 #endif
-  /* End of the mandatory fields.*/
+#if MAC_USE_ZERO_COPY || defined(__DOXYGEN__)
   /**
-   * @brief Link status flag.
+   * @brief Free packets list.
+   */
+  MACPacket             *pkfree;
+  /**
+   * @brief Threads waiting for a free packet.
    */
-  bool_t                link_up;
+  threads_queue_t       pkqueue;
+#endif
+  /* End of the mandatory fields.*/
   /**
    * @brief PHY address (pre shifted).
    */
-  uint32_t phyaddr;
+  uint32_t              phyaddr;
   /**
    * @brief Receive next frame pointer.
    */
@@ -273,6 +380,16 @@ struct MACDriver {
    * @brief Transmit next frame pointer.
    */
   stm32_eth_tx_descriptor_t *txptr;
+#if MAC_USE_ZERO_COPY || defined(__DOXYGEN__)
+  /**
+   * @brief Transmit next descriptor to be reclaimed.
+   */
+  stm32_eth_tx_descriptor_t *txreclaim;
+  /**
+   * @brief Frames discarded because the pool was empty.
+   */
+  uint32_t              rxdropped;
+#endif
 };
 
 /**
@@ -317,6 +434,15 @@ typedef struct {
 /* Driver macros.                                                            */
 /*===========================================================================*/
 
+/**
+ * @brief   Returns a pointer to the frame data of a packet.
+ *
+ * @param[in] pkp       pointer to a @p MACPacket structure
+ *
+ * @notapi
+ */
+#define mac_lld_get_packet_buffer(pkp) ((uint8_t *)(pkp)->buffer)
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -337,7 +463,7 @@ extern "C" {
   msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
                                        MACReceiveDescriptor *rdp);
   void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp);
-  bool_t mac_lld_poll_link_status(MACDriver *macp);
+  bool mac_lld_poll_link_status(MACDriver *macp);
   size_t mac_lld_write_transmit_descriptor(MACTransmitDescriptor *tdp,
                                            uint8_t *buf,
                                            size_t size);
@@ -350,6 +476,8 @@ extern "C" {
                                             size_t *sizep);
   const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
                                                  size_t *sizep);
+  msg_t mac_lld_transmit_packet(MACDriver *macp, MACPacket *pkp);
+  msg_t mac_lld_receive_packet(MACDriver *macp, MACPacket **pkpp);
 #endif /* MAC_USE_ZERO_COPY */
 #ifdef __cplusplus
 }
@@ -96,6 +96,73 @@ static void adc_lld_serve_rx_interrupt(ADCDriver *adcp, uint32_t flags) {
   }
 }
 
+/**
+ * @brief   Programs the DMA stream and starts the conversion.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ */
+static void adc_lld_start_dma(ADCDriver *adcp) {
+  uint32_t mode;
+  const ADCConversionGroup *grpp = adcp->grpp;
+
+  /* DMA setup.*/
+  mode = adcp->dmamode;
+#if STM32_DMA_USE_ARBITER
+  /* The stream can be different for each conversion.*/
+  mode = (mode & ~STM32_DMA_CR_CHSEL_MASK) |
+         STM32_DMA_CR_CHSEL(dmaStreamGetChannel(adcp->dmastp, adcp->dmachn));
+  dmaStreamSetPeripheral(adcp->dmastp, &adcp->adc->DR);
+#endif
+  if (grpp->circular) {
+    mode |= STM32_DMA_CR_CIRC;
+    if (adcp->depth > 1) {
+      /* If circular buffer depth > 1, then the half transfer interrupt
+         is enabled in order to allow streaming processing.*/
+      mode |= STM32_DMA_CR_HTIE;
+    }
+  }
+  dmaStreamSetMemory0(adcp->dmastp, adcp->samples);
+  dmaStreamSetTransactionSize(adcp->dmastp, (uint32_t)grpp->num_channels *
+                                            (uint32_t)adcp->depth);
+  dmaStreamSetMode(adcp->dmastp, mode);
+  dmaStreamEnable(adcp->dmastp);
+
+  /* ADC setup.*/
+  adcp->adc->SR    = 0;
+  adcp->adc->SMPR1 = grpp->smpr1;
+  adcp->adc->SMPR2 = grpp->smpr2;
+  adcp->adc->SQR1  = grpp->sqr1;
+  adcp->adc->SQR2  = grpp->sqr2;
+  adcp->adc->SQR3  = grpp->sqr3;
+
+  /* ADC configuration and start, the start is performed using the method
+     specified in the CR2 configuration, usually ADC_CR2_SWSTART.*/
+  adcp->adc->CR1   = grpp->cr1 | ADC_CR1_OVRIE | ADC_CR1_SCAN;
+  if ((grpp->cr2 & ADC_CR2_SWSTART) != 0)
+    adcp->adc->CR2 = grpp->cr2 | ADC_CR2_CONT  | ADC_CR2_DMA |
+                                 ADC_CR2_DDS   | ADC_CR2_ADON;
+  else
+    adcp->adc->CR2 = grpp->cr2 |                 ADC_CR2_DMA |
+                                 ADC_CR2_DDS   | ADC_CR2_ADON;
+}
+
+#if STM32_DMA_USE_ARBITER || defined(__DOXYGEN__)
+/**
+ * @brief   DMA stream grant callback.
+ * @details The conversion queued by @p adc_lld_start_conversion() is
+ *          started.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ * @param[in] dmastp    pointer to the granted stream
+ */
+static void adc_lld_serve_grant(ADCDriver *adcp,
+                                const stm32_dma_stream_t *dmastp) {
+
+  adcp->dmastp = dmastp;
+  adc_lld_start_dma(adcp);
+}
+#endif /* STM32_DMA_USE_ARBITER */
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -117,7 +184,8 @@ OSAL_IRQ_HANDLER(ADC1_2_3_IRQHandler) {
   ADC1->SR = 0;
   /* Note, an overflow may occur after the conversion ended before the driver
      is able to stop the ADC, this is why the DMA channel is checked too.*/
-  if ((sr & ADC_SR_OVR) && (dmaStreamGetTransactionSize(ADCD1.dmastp) > 0)) {
+  if ((sr & ADC_SR_OVR) && (ADCD1.dmastp != NULL) &&
+      (dmaStreamGetTransactionSize(ADCD1.dmastp) > 0)) {
     /* ADC overflow condition, this could happen only if the DMA is unable
        to read data fast enough.*/
     if (ADCD1.grpp != NULL)
@@ -131,7 +199,8 @@ OSAL_IRQ_HANDLER(ADC1_2_3_IRQHandler) {
   ADC2->SR = 0;
   /* Note, an overflow may occur after the conversion ended before the driver
      is able to stop the ADC, this is why the DMA channel is checked too.*/
-  if ((sr & ADC_SR_OVR) && (dmaStreamGetTransactionSize(ADCD2.dmastp) > 0)) {
+  if ((sr & ADC_SR_OVR) && (ADCD2.dmastp != NULL) &&
+      (dmaStreamGetTransactionSize(ADCD2.dmastp) > 0)) {
     /* ADC overflow condition, this could happen only if the DMA is unable
        to read data fast enough.*/
     if (ADCD2.grpp != NULL)
@@ -145,7 +214,8 @@ OSAL_IRQ_HANDLER(ADC1_2_3_IRQHandler) {
   ADC3->SR = 0;
   /* Note, an overflow may occur after the conversion ended before the driver
      is able to stop the ADC, this is why the DMA channel is checked too.*/
-  if ((sr & ADC_SR_OVR) && (dmaStreamGetTransactionSize(ADCD3.dmastp) > 0)) {
+  if ((sr & ADC_SR_OVR) && (ADCD3.dmastp != NULL) &&
+      (dmaStreamGetTransactionSize(ADCD3.dmastp) > 0)) {
     /* ADC overflow condition, this could happen only if the DMA is unable
        to read data fast enough.*/
     if (ADCD3.grpp != NULL)
@@ -180,6 +250,15 @@ void adc_lld_init(void) {
                   STM32_DMA_CR_MSIZE_HWORD | STM32_DMA_CR_PSIZE_HWORD |
                   STM32_DMA_CR_MINC        | STM32_DMA_CR_TCIE        |
                   STM32_DMA_CR_DMEIE       | STM32_DMA_CR_TEIE;
+#if STM32_DMA_USE_ARBITER
+  ADCD1.dmastp  = NULL;
+  ADCD1.dmachn  = STM32_ADC1_DMA_CHN;
+  dmaStreamRequestObjectInit(&ADCD1.dmarq, STM32_ADC1_DMA_MSK,
+                             STM32_ADC_ADC1_DMA_IRQ_PRIORITY,
+                             (stm32_dmaisr_t)adc_lld_serve_rx_interrupt,
+                             (stm32_dmagrant_t)adc_lld_serve_grant,
+                             (void *)&ADCD1);
+#endif
 #endif
 
 #if STM32_ADC_USE_ADC2
@@ -193,6 +272,15 @@ void adc_lld_init(void) {
                   STM32_DMA_CR_MSIZE_HWORD | STM32_DMA_CR_PSIZE_HWORD |
                   STM32_DMA_CR_MINC        | STM32_DMA_CR_TCIE        |
                   STM32_DMA_CR_DMEIE       | STM32_DMA_CR_TEIE;
+#if STM32_DMA_USE_ARBITER
+  ADCD2.dmastp  = NULL;
+  ADCD2.dmachn  = STM32_ADC2_DMA_CHN;
+  dmaStreamRequestObjectInit(&ADCD2.dmarq, STM32_ADC2_DMA_MSK,
+                             STM32_ADC_ADC2_DMA_IRQ_PRIORITY,
+                             (stm32_dmaisr_t)adc_lld_serve_rx_interrupt,
+                             (stm32_dmagrant_t)adc_lld_serve_grant,
+                             (void *)&ADCD2);
+#endif
 #endif
 
 #if STM32_ADC_USE_ADC3
@@ -206,6 +294,15 @@ void adc_lld_init(void) {
                   STM32_DMA_CR_MSIZE_HWORD | STM32_DMA_CR_PSIZE_HWORD |
                   STM32_DMA_CR_MINC        | STM32_DMA_CR_TCIE        |
                   STM32_DMA_CR_DMEIE       | STM32_DMA_CR_TEIE;
+#if STM32_DMA_USE_ARBITER
+  ADCD3.dmastp  = NULL;
+  ADCD3.dmachn  = STM32_ADC3_DMA_CHN;
+  dmaStreamRequestObjectInit(&ADCD3.dmarq, STM32_ADC3_DMA_MSK,
+                             STM32_ADC_ADC3_DMA_IRQ_PRIORITY,
+                             (stm32_dmaisr_t)adc_lld_serve_rx_interrupt,
+                             (stm32_dmagrant_t)adc_lld_serve_grant,
+                             (void *)&ADCD3);
+#endif
 #endif
 
   /* The shared vector is initialized on driver initialization and never
@@ -226,6 +323,7 @@ void adc_lld_start(ADCDriver *adcp) {
   if (adcp->state == ADC_STOP) {
 #if STM32_ADC_USE_ADC1
     if (&ADCD1 == adcp) {
+#if !STM32_DMA_USE_ARBITER
       bool b;
       b = dmaStreamAllocate(adcp->dmastp,
                             STM32_ADC_ADC1_DMA_IRQ_PRIORITY,
@@ -233,12 +331,14 @@ void adc_lld_start(ADCDriver *adcp) {
                             (void *)adcp);
       osalDbgAssert(!b, "stream already allocated");
       dmaStreamSetPeripheral(adcp->dmastp, &ADC1->DR);
+#endif
       rccEnableADC1(FALSE);
     }
 #endif /* STM32_ADC_USE_ADC1 */
 
 #if STM32_ADC_USE_ADC2
     if (&ADCD2 == adcp) {
+#if !STM32_DMA_USE_ARBITER
       bool b;
       b = dmaStreamAllocate(adcp->dmastp,
                             STM32_ADC_ADC2_DMA_IRQ_PRIORITY,
@@ -246,12 +346,14 @@ void adc_lld_start(ADCDriver *adcp) {
                             (void *)adcp);
       osalDbgAssert(!b, "stream already allocated");
       dmaStreamSetPeripheral(adcp->dmastp, &ADC2->DR);
+#endif
       rccEnableADC2(FALSE);
     }
 #endif /* STM32_ADC_USE_ADC2 */
 
 #if STM32_ADC_USE_ADC3
     if (&ADCD3 == adcp) {
+#if !STM32_DMA_USE_ARBITER
       bool b;
       b = dmaStreamAllocate(adcp->dmastp,
                             STM32_ADC_ADC3_DMA_IRQ_PRIORITY,
@@ -259,6 +361,7 @@ void adc_lld_start(ADCDriver *adcp) {
                             (void *)adcp);
       osalDbgAssert(!b, "stream already allocated");
       dmaStreamSetPeripheral(adcp->dmastp, &ADC3->DR);
+#endif
       rccEnableADC3(FALSE);
     }
 #endif /* STM32_ADC_USE_ADC3 */
@@ -287,7 +390,19 @@ void adc_lld_stop(ADCDriver *adcp) {
 
   /* If in ready state then disables the ADC clock.*/
   if (adcp->state == ADC_READY) {
+#if STM32_DMA_USE_ARBITER
+    /* A request still queued in the arbiter is withdrawn, a later grant
+       would start the DMA on a stopped driver.*/
+    osalSysLock();
+    dmaStreamCancelI(&adcp->dmarq);
+    osalSysUnlock();
+    if (adcp->dmastp != NULL) {
+      dmaStreamRelease(adcp->dmastp);
+      adcp->dmastp = NULL;
+    }
+#else
     dmaStreamRelease(adcp->dmastp);
+#endif
     adcp->adc->CR1 = 0;
     adcp->adc->CR2 = 0;
 
@@ -316,42 +431,16 @@ void adc_lld_stop(ADCDriver *adcp) {
  * @notapi
  */
 void adc_lld_start_conversion(ADCDriver *adcp) {
-  uint32_t mode;
-  const ADCConversionGroup *grpp = adcp->grpp;
 
-  /* DMA setup.*/
-  mode = adcp->dmamode;
-  if (grpp->circular) {
-    mode |= STM32_DMA_CR_CIRC;
-    if (adcp->depth > 1) {
-      /* If circular buffer depth > 1, then the half transfer interrupt
-         is enabled in order to allow streaming processing.*/
-      mode |= STM32_DMA_CR_HTIE;
-    }
-  }
-  dmaStreamSetMemory0(adcp->dmastp, adcp->samples);
-  dmaStreamSetTransactionSize(adcp->dmastp, (uint32_t)grpp->num_channels *
-                                            (uint32_t)adcp->depth);
-  dmaStreamSetMode(adcp->dmastp, mode);
-  dmaStreamEnable(adcp->dmastp);
-
-  /* ADC setup.*/
-  adcp->adc->SR    = 0;
-  adcp->adc->SMPR1 = grpp->smpr1;
-  adcp->adc->SMPR2 = grpp->smpr2;
-  adcp->adc->SQR1  = grpp->sqr1;
-  adcp->adc->SQR2  = grpp->sqr2;
-  adcp->adc->SQR3  = grpp->sqr3;
-
-  /* ADC configuration and start, the start is performed using the method
-     specified in the CR2 configuration, usually ADC_CR2_SWSTART.*/
-  adcp->adc->CR1   = grpp->cr1 | ADC_CR1_OVRIE | ADC_CR1_SCAN;
-  if ((grpp->cr2 & ADC_CR2_SWSTART) != 0)
-    adcp->adc->CR2 = grpp->cr2 | ADC_CR2_CONT  | ADC_CR2_DMA |
-                                 ADC_CR2_DDS   | ADC_CR2_ADON;
-  else
-    adcp->adc->CR2 = grpp->cr2 |                 ADC_CR2_DMA |
-                                 ADC_CR2_DDS   | ADC_CR2_ADON;
+#if STM32_DMA_USE_ARBITER
+  /* If the stream is not immediately available then the conversion is
+     started when the arbiter grants it.*/
+  adcp->dmastp = dmaStreamRequestI(&adcp->dmarq);
+  if (adcp->dmastp != NULL)
+    adc_lld_start_dma(adcp);
+#else
+  adc_lld_start_dma(adcp);
+#endif
 }
 
 /**
@@ -363,10 +452,24 @@ void adc_lld_start_conversion(ADCDriver *adcp) {
  */
 void adc_lld_stop_conversion(ADCDriver *adcp) {
 
+#if STM32_DMA_USE_ARBITER
+  /* A conversion still waiting for the stream is just dequeued.*/
+  if (adcp->dmastp == NULL) {
+    dmaStreamCancelI(&adcp->dmarq);
+    return;
+  }
+#endif
+
   dmaStreamDisable(adcp->dmastp);
   adcp->adc->CR1 = 0;
   adcp->adc->CR2 = 0;
   adcp->adc->CR2 = ADC_CR2_ADON;
+
+#if STM32_DMA_USE_ARBITER
+  /* Circular conversions keep the stream until stopped.*/
+  dmaStreamRelease(adcp->dmastp);
+  adcp->dmastp = NULL;
+#endif
 }
 
 /**
@@ -461,6 +461,19 @@ struct ADCDriver {
    * @brief DMA mode bit mask.
    */
   uint32_t                  dmamode;
+#if STM32_DMA_USE_ARBITER || defined(__DOXYGEN__)
+  /**
+   * @brief DMA stream request.
+   * @note  The stream is granted by the DMA arbiter for each conversion
+   *        and released when the conversion is stopped, @p dmastp is
+   *        @p NULL when there is no conversion in progress.
+   */
+  stm32_dma_request_t       dmarq;
+  /**
+   * @brief DMA stream/channel association word.
+   */
+  uint32_t                  dmachn;
+#endif
 };
 
 /*===========================================================================*/
@@ -40,6 +40,28 @@
 /* Driver local variables.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   EXTI vectors classification table.
+ */
+static const nvic_vector_t ext_vectors[] = {
+  NVIC_OS_VECTOR(EXTI0_IRQn,       STM32_EXT_EXTI0_IRQ_PRIORITY),
+  NVIC_OS_VECTOR(EXTI1_IRQn,       STM32_EXT_EXTI1_IRQ_PRIORITY),
+  NVIC_OS_VECTOR(EXTI2_IRQn,       STM32_EXT_EXTI2_IRQ_PRIORITY),
+  NVIC_OS_VECTOR(EXTI3_IRQn,       STM32_EXT_EXTI3_IRQ_PRIORITY),
+  NVIC_OS_VECTOR(EXTI4_IRQn,       STM32_EXT_EXTI4_IRQ_PRIORITY),
+  NVIC_OS_VECTOR(EXTI9_5_IRQn,     STM32_EXT_EXTI5_9_IRQ_PRIORITY),
+  NVIC_OS_VECTOR(EXTI15_10_IRQn,   STM32_EXT_EXTI10_15_IRQ_PRIORITY),
+  NVIC_OS_VECTOR(PVD_IRQn,         STM32_EXT_EXTI16_IRQ_PRIORITY),
+  NVIC_OS_VECTOR(RTC_Alarm_IRQn,   STM32_EXT_EXTI17_IRQ_PRIORITY),
+  NVIC_OS_VECTOR(OTG_FS_WKUP_IRQn, STM32_EXT_EXTI18_IRQ_PRIORITY),
+  NVIC_OS_VECTOR(ETH_WKUP_IRQn,    STM32_EXT_EXTI19_IRQ_PRIORITY),
+#if !defined(STM32F401xx)
+  NVIC_OS_VECTOR(OTG_HS_WKUP_IRQn, STM32_EXT_EXTI20_IRQ_PRIORITY),
+  NVIC_OS_VECTOR(TAMP_STAMP_IRQn,  STM32_EXT_EXTI21_IRQ_PRIORITY),
+#endif /* !defined(STM32F401xx) */
+  NVIC_OS_VECTOR(RTC_WKUP_IRQn,    STM32_EXT_EXTI22_IRQ_PRIORITY)
+};
+
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
@@ -296,22 +318,7 @@ OSAL_IRQ_HANDLER(Vector4C) {
  */
 void ext_lld_exti_irq_enable(void) {
 
-  nvicEnableVector(EXTI0_IRQn, STM32_EXT_EXTI0_IRQ_PRIORITY);
-  nvicEnableVector(EXTI1_IRQn, STM32_EXT_EXTI1_IRQ_PRIORITY);
-  nvicEnableVector(EXTI2_IRQn, STM32_EXT_EXTI2_IRQ_PRIORITY);
-  nvicEnableVector(EXTI3_IRQn, STM32_EXT_EXTI3_IRQ_PRIORITY);
-  nvicEnableVector(EXTI4_IRQn, STM32_EXT_EXTI4_IRQ_PRIORITY);
-  nvicEnableVector(EXTI9_5_IRQn, STM32_EXT_EXTI5_9_IRQ_PRIORITY);
-  nvicEnableVector(EXTI15_10_IRQn, STM32_EXT_EXTI10_15_IRQ_PRIORITY);
-  nvicEnableVector(PVD_IRQn, STM32_EXT_EXTI16_IRQ_PRIORITY);
-  nvicEnableVector(RTC_Alarm_IRQn, STM32_EXT_EXTI17_IRQ_PRIORITY);
-  nvicEnableVector(OTG_FS_WKUP_IRQn, STM32_EXT_EXTI18_IRQ_PRIORITY);
-  nvicEnableVector(ETH_WKUP_IRQn, STM32_EXT_EXTI19_IRQ_PRIORITY);
-#if !defined(STM32F401xx)
-  nvicEnableVector(OTG_HS_WKUP_IRQn, STM32_EXT_EXTI20_IRQ_PRIORITY);
-  nvicEnableVector(TAMP_STAMP_IRQn, STM32_EXT_EXTI21_IRQ_PRIORITY);
-#endif /* !defined(STM32F401xx) */
-  nvicEnableVector(RTC_WKUP_IRQn, STM32_EXT_EXTI22_IRQ_PRIORITY);
+  nvicEnableVectors(ext_vectors, sizeof ext_vectors / sizeof ext_vectors[0]);
 }
 
 /**
@@ -321,22 +328,7 @@ void ext_lld_exti_irq_enable(void) {
  */
 void ext_lld_exti_irq_disable(void) {
 
-  nvicDisableVector(EXTI0_IRQn);
-  nvicDisableVector(EXTI1_IRQn);
-  nvicDisableVector(EXTI2_IRQn);
-  nvicDisableVector(EXTI3_IRQn);
-  nvicDisableVector(EXTI4_IRQn);
-  nvicDisableVector(EXTI9_5_IRQn);
-  nvicDisableVector(EXTI15_10_IRQn);
-  nvicDisableVector(PVD_IRQn);
-  nvicDisableVector(RTC_Alarm_IRQn);
-  nvicDisableVector(OTG_FS_WKUP_IRQn);
-  nvicDisableVector(ETH_WKUP_IRQn);
-#if !defined(STM32F401xx)
-  nvicDisableVector(OTG_HS_WKUP_IRQn);
-  nvicDisableVector(TAMP_STAMP_IRQn);
-#endif /* !defined(STM32F401xx) */
-  nvicDisableVector(RTC_WKUP_IRQn);
+  nvicDisableVectors(ext_vectors, sizeof ext_vectors / sizeof ext_vectors[0]);
 }
 
 #endif /* HAL_USE_EXT */
@@ -59,6 +59,11 @@
  */
 #define STM32_DMA_FCR_RESET_VALUE   0x00000021
 
+/**
+ * @brief   Checks if the code is running in thread context.
+ */
+#define dma_is_thread_context()     ((__get_IPSR() & 0x1FF) == 0)
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -111,10 +116,172 @@ static uint32_t dma_streams_mask;
  */
 static dma_isr_redir_t dma_isr_redir[STM32_DMA_STREAMS];
 
+#if STM32_DMA_USE_ARBITER || defined(__DOXYGEN__)
+/**
+ * @brief   Queue of the requests waiting for a stream.
+ */
+static stm32_dma_request_t *dma_waiting;
+#endif
+
+#if STM32_DMA_USE_STATISTICS || defined(__DOXYGEN__)
+/**
+ * @brief   Per-stream statistics.
+ * @note    Zeroed at startup, @p dmaInit() does not touch the statistics
+ *          because the kernel and the cycle counter are not yet running.
+ */
+static stm32_dma_stats_t dma_stats[STM32_DMA_STREAMS];
+
+/**
+ * @brief   Start of the statistics measurement window.
+ * @note    The first window starts at the system start.
+ */
+static systime_t dma_stats_window;
+#endif
+
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Marks a stream as allocated and puts it in a safe state.
+ *
+ * @param[in] dmastp    pointer to a stm32_dma_stream_t structure
+ * @param[in] priority  IRQ priority mask for the DMA stream
+ * @param[in] func      handling function pointer, can be @p NULL
+ * @param[in] param     a parameter to be passed to the handling function
+ *
+ * @notapi
+ */
+static void dma_stream_take(const stm32_dma_stream_t *dmastp,
+                            uint32_t priority,
+                            stm32_dmaisr_t func,
+                            void *param) {
+
+  /* Marks the stream as allocated.*/
+  dma_isr_redir[dmastp->selfindex].dma_func  = func;
+  dma_isr_redir[dmastp->selfindex].dma_param = param;
+  dma_streams_mask |= (1 << dmastp->selfindex);
+
+  /* Enabling DMA clocks required by the current streams set.*/
+  if ((dma_streams_mask & STM32_DMA1_STREAMS_MASK) != 0)
+    rccEnableDMA1(FALSE);
+  if ((dma_streams_mask & STM32_DMA2_STREAMS_MASK) != 0)
+    rccEnableDMA2(FALSE);
+
+  /* Putting the stream in a safe state.*/
+  dmaStreamDisable(dmastp);
+  dmastp->stream->CR = STM32_DMA_CR_RESET_VALUE;
+  dmastp->stream->FCR = STM32_DMA_FCR_RESET_VALUE;
+
+  /* Enables the associated IRQ vector if a callback is defined.*/
+  if (func != NULL)
+    nvicEnableVector(dmastp->vector, priority);
+
+#if STM32_DMA_USE_STATISTICS
+  dma_stats[dmastp->selfindex].allocations++;
+  dma_stats[dmastp->selfindex].start = DWT->CYCCNT;
+#endif
+}
+
+#if STM32_DMA_USE_ARBITER || defined(__DOXYGEN__)
+/**
+ * @brief   Allocates the first free stream in a mask.
+ *
+ * @param[in] mask      mask of the acceptable streams
+ * @param[in] priority  IRQ priority mask for the DMA stream
+ * @param[in] func      handling function pointer, can be @p NULL
+ * @param[in] param     a parameter to be passed to the handling function
+ * @return              The allocated stream or @p NULL if all the streams
+ *                      in the mask are busy.
+ *
+ * @notapi
+ */
+static const stm32_dma_stream_t *dma_stream_take_any(uint32_t mask,
+                                                     uint32_t priority,
+                                                     stm32_dmaisr_t func,
+                                                     void *param) {
+  uint32_t free = mask & ~dma_streams_mask;
+  unsigned i;
+
+  for (i = 0; i < STM32_DMA_STREAMS; i++) {
+    if ((free & (1 << i)) != 0) {
+      dma_stream_take(STM32_DMA_STREAM(i), priority, func, param);
+      return STM32_DMA_STREAM(i);
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief   Hands a released stream over to the first suitable request.
+ * @details The stream is allocated to the request, the requester is not
+ *          notified, see @p dma_request_notify().
+ *
+ * @param[in] dmastp    pointer to the released stm32_dma_stream_t structure
+ * @return              The request the stream has been handed over to.
+ * @retval NULL         if no queued request accepts the stream.
+ *
+ * @notapi
+ */
+static stm32_dma_request_t *dma_handover(const stm32_dma_stream_t *dmastp) {
+  stm32_dma_request_t **rqpp = &dma_waiting;
+
+  while (*rqpp != NULL) {
+    stm32_dma_request_t *rqp = *rqpp;
+
+    if ((rqp->mask & (1 << dmastp->selfindex)) != 0) {
+      *rqpp = rqp->next;
+      dma_stream_take(dmastp, rqp->priority, rqp->func, rqp->param);
+#if STM32_DMA_USE_STATISTICS
+      dma_stats[dmastp->selfindex].handovers++;
+#endif
+      rqp->dmastp = dmastp;
+      return rqp;
+    }
+    rqpp = &rqp->next;
+  }
+  return NULL;
+}
+
+/**
+ * @brief   Notifies a requester that its request has been granted.
+ * @details The grant callback is invoked or the waiting thread is resumed,
+ *          in thread context the thread is resumed with a reschedule.
+ * @note    Must be invoked from within the system lock after the stream
+ *          state has been completely updated because a context switch can
+ *          happen.
+ *
+ * @param[in] rqp       pointer to the granted @p stm32_dma_request_t object
+ *
+ * @notapi
+ */
+static void dma_request_notify(stm32_dma_request_t *rqp) {
+
+  if (rqp->grant != NULL)
+    rqp->grant(rqp->param, rqp->dmastp);
+  else if (dma_is_thread_context())
+    osalThreadResumeS(&rqp->thread, MSG_OK);
+  else
+    osalThreadResumeI(&rqp->thread, MSG_OK);
+}
+
+/**
+ * @brief   Memory to memory copies ISR callback.
+ *
+ * @param[in] p         pointer to the waiting thread reference
+ * @param[in] flags     pre-shifted content of the ISR register
+ *
+ * @notapi
+ */
+static void dma_m2m_serve_interrupt(void *p, uint32_t flags) {
+
+  osalSysLockFromISR();
+  osalThreadResumeI((thread_reference_t *)p,
+                    (flags & STM32_DMA_ISR_TEIF) != 0 ? MSG_RESET : MSG_OK);
+  osalSysUnlockFromISR();
+}
+#endif /* STM32_DMA_USE_ARBITER */
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -424,6 +591,9 @@ void dmaInit(void) {
     _stm32_dma_streams[i].stream->CR = 0;
     dma_isr_redir[i].dma_func = NULL;
   }
+#if STM32_DMA_USE_ARBITER
+  dma_waiting = NULL;
+#endif
   DMA1->LIFCR = 0xFFFFFFFF;
   DMA1->HIFCR = 0xFFFFFFFF;
   DMA2->LIFCR = 0xFFFFFFFF;
@@ -458,33 +628,30 @@ bool dmaStreamAllocate(const stm32_dma_stream_t *dmastp,
                        uint32_t priority,
                        stm32_dmaisr_t func,
                        void *param) {
+#if STM32_DMA_USE_ARBITER
+  syssts_t sts;
+#endif
 
   osalDbgCheck(dmastp != NULL);
 
+#if STM32_DMA_USE_ARBITER
+  /* Streams can be handed over from ISRs when the arbiter is enabled.*/
+  sts = osalSysGetStatusAndLockX();
+#endif
+
   /* Checks if the stream is already taken.*/
-  if ((dma_streams_mask & (1 << dmastp->selfindex)) != 0)
+  if ((dma_streams_mask & (1 << dmastp->selfindex)) != 0) {
+#if STM32_DMA_USE_ARBITER
+    osalSysRestoreStatusX(sts);
+#endif
     return TRUE;
+  }
 
-  /* Marks the stream as allocated.*/
-  dma_isr_redir[dmastp->selfindex].dma_func  = func;
-  dma_isr_redir[dmastp->selfindex].dma_param = param;
-  dma_streams_mask |= (1 << dmastp->selfindex);
-
-  /* Enabling DMA clocks required by the current streams set.*/
-  if ((dma_streams_mask & STM32_DMA1_STREAMS_MASK) != 0)
-    rccEnableDMA1(FALSE);
-  if ((dma_streams_mask & STM32_DMA2_STREAMS_MASK) != 0)
-    rccEnableDMA2(FALSE);
-
-  /* Putting the stream in a safe state.*/
-  dmaStreamDisable(dmastp);
-  dmastp->stream->CR = STM32_DMA_CR_RESET_VALUE;
-  dmastp->stream->FCR = STM32_DMA_FCR_RESET_VALUE;
-
-  /* Enables the associated IRQ vector if a callback is defined.*/
-  if (func != NULL)
-    nvicEnableVector(dmastp->vector, priority);
+  dma_stream_take(dmastp, priority, func, param);
 
+#if STM32_DMA_USE_ARBITER
+  osalSysRestoreStatusX(sts);
+#endif
   return FALSE;
 }
 
@@ -496,15 +663,26 @@ bool dmaStreamAllocate(const stm32_dma_stream_t *dmastp,
  * @pre     The stream must have been allocated using @p dmaStreamAllocate().
  * @post    The stream is again available.
  * @note    This function can be invoked in both ISR or thread context.
+ * @note    If the arbiter is enabled and a thread waiting for the stream
+ *          is resumed then, in thread context, a reschedule is performed
+ *          even if the function is invoked from within a critical zone.
  *
  * @param[in] dmastp    pointer to a stm32_dma_stream_t structure
  *
  * @special
  */
 void dmaStreamRelease(const stm32_dma_stream_t *dmastp) {
+#if STM32_DMA_USE_ARBITER
+  stm32_dma_request_t *rqp;
+  syssts_t sts;
+#endif
 
   osalDbgCheck(dmastp != NULL);
 
+#if STM32_DMA_USE_ARBITER
+  sts = osalSysGetStatusAndLockX();
+#endif
+
   /* Check if the streams is not taken.*/
   osalDbgAssert((dma_streams_mask & (1 << dmastp->selfindex)) != 0,
                 "not allocated");
@@ -515,12 +693,341 @@ void dmaStreamRelease(const stm32_dma_stream_t *dmastp) {
   /* Marks the stream as not allocated.*/
   dma_streams_mask &= ~(1 << dmastp->selfindex);
 
+#if STM32_DMA_USE_STATISTICS
+  dma_stats[dmastp->selfindex].busy += DWT->CYCCNT -
+                                       dma_stats[dmastp->selfindex].start;
+#endif
+
+#if STM32_DMA_USE_ARBITER
+  /* If there are requests waiting for this stream then the first one
+     takes it immediately.*/
+  rqp = dma_handover(dmastp);
+#endif
+
   /* Shutting down clocks that are no more required, if any.*/
   if ((dma_streams_mask & STM32_DMA1_STREAMS_MASK) == 0)
     rccDisableDMA1(FALSE);
   if ((dma_streams_mask & STM32_DMA2_STREAMS_MASK) == 0)
     rccDisableDMA2(FALSE);
+
+#if STM32_DMA_USE_ARBITER
+  /* The new owner is notified last because a context switch can happen.*/
+  if (rqp != NULL)
+    dma_request_notify(rqp);
+  osalSysRestoreStatusX(sts);
+#endif
+}
+
+#if STM32_DMA_USE_ARBITER || defined(__DOXYGEN__)
+/**
+ * @brief   Allocates a DMA stream among a set of alternatives.
+ * @details The first free stream among the ones specified in @p mask is
+ *          allocated, a peripheral DMA mask from the registry, for example
+ *          @p STM32_SPI1_RX_DMA_MSK, can be used directly. The channel to
+ *          be programmed can be obtained using @p dmaStreamGetChannel().
+ * @post    The stream is allocated as if @p dmaStreamAllocate() was used.
+ * @note    This function can be invoked in both ISR or thread context.
+ *
+ * @param[in] mask      mask of the acceptable streams
+ * @param[in] priority  IRQ priority mask for the DMA stream
+ * @param[in] func      handling function pointer, can be @p NULL
+ * @param[in] param     a parameter to be passed to the handling function
+ * @return              The allocated stream.
+ * @retval NULL         if all the streams in the mask are busy.
+ *
+ * @special
+ */
+const stm32_dma_stream_t *dmaStreamAllocateAny(uint32_t mask,
+                                               uint32_t priority,
+                                               stm32_dmaisr_t func,
+                                               void *param) {
+  const stm32_dma_stream_t *dmastp;
+  syssts_t sts;
+
+  osalDbgCheck(mask != 0);
+
+  sts = osalSysGetStatusAndLockX();
+  dmastp = dma_stream_take_any(mask, priority, func, param);
+  osalSysRestoreStatusX(sts);
+
+  return dmastp;
+}
+
+/**
+ * @brief   Initializes a @p stm32_dma_request_t object.
+ *
+ * @param[out] rqp      pointer to the @p stm32_dma_request_t object
+ * @param[in] mask      mask of the acceptable streams
+ * @param[in] priority  IRQ priority mask for the DMA stream
+ * @param[in] func      handling function pointer, can be @p NULL
+ * @param[in] grant     function invoked when a queued request is granted
+ *                      or @p NULL if a thread waits for the request
+ * @param[in] param     a parameter to be passed to the callbacks
+ *
+ * @init
+ */
+void dmaStreamRequestObjectInit(stm32_dma_request_t *rqp,
+                                uint32_t mask,
+                                uint32_t priority,
+                                stm32_dmaisr_t func,
+                                stm32_dmagrant_t grant,
+                                void *param) {
+
+  osalDbgCheck((rqp != NULL) && (mask != 0));
+
+  rqp->next     = NULL;
+  rqp->mask     = mask;
+  rqp->priority = priority;
+  rqp->func     = func;
+  rqp->grant    = grant;
+  rqp->param    = param;
+  rqp->thread   = NULL;
+  rqp->dmastp   = NULL;
+}
+
+/**
+ * @brief   Requests a DMA stream.
+ * @details If one of the requested streams is free then it is allocated
+ *          immediately, else the request is queued and granted when one of
+ *          the streams in its mask is released. Queued requests are served
+ *          in FIFO order, the grant callback is invoked by
+ *          @p dmaStreamRelease(), usually from the completion ISR of the
+ *          previous owner.
+ *
+ * @param[in] rqp       pointer to the @p stm32_dma_request_t object
+ * @return              The allocated stream.
+ * @retval NULL         if the request has been queued.
+ *
+ * @iclass
+ */
+const stm32_dma_stream_t *dmaStreamRequestI(stm32_dma_request_t *rqp) {
+  stm32_dma_request_t **rqpp;
+
+  osalDbgCheckClassI();
+  osalDbgCheck(rqp != NULL);
+
+  rqp->dmastp = dma_stream_take_any(rqp->mask, rqp->priority,
+                                    rqp->func, rqp->param);
+  if (rqp->dmastp == NULL) {
+    /* Queued at the end of the waiting list.*/
+    rqp->next = NULL;
+    rqpp = &dma_waiting;
+    while (*rqpp != NULL)
+      rqpp = &(*rqpp)->next;
+    *rqpp = rqp;
+  }
+  return rqp->dmastp;
+}
+
+/**
+ * @brief   Requests a DMA stream waiting for it if necessary.
+ * @pre     The request must have been initialized with a @p NULL grant
+ *          callback.
+ *
+ * @param[in] rqp       pointer to the @p stm32_dma_request_t object
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The allocated stream.
+ * @retval NULL         if the operation timed out.
+ *
+ * @api
+ */
+const stm32_dma_stream_t *dmaStreamRequestTimeout(stm32_dma_request_t *rqp,
+                                                  systime_t timeout) {
+
+  osalDbgCheck((rqp != NULL) && (rqp->grant == NULL));
+
+  osalSysLock();
+  if (dmaStreamRequestI(rqp) == NULL) {
+    if (osalThreadSuspendTimeoutS(&rqp->thread, timeout) != MSG_OK)
+      dmaStreamCancelI(rqp);
+  }
+  osalSysUnlock();
+
+  return rqp->dmastp;
+}
+
+/**
+ * @brief   Removes a request from the waiting queue.
+ * @note    The function has no effect if the request is not queued.
+ *
+ * @param[in] rqp       pointer to the @p stm32_dma_request_t object
+ *
+ * @iclass
+ */
+void dmaStreamCancelI(stm32_dma_request_t *rqp) {
+  stm32_dma_request_t **rqpp = &dma_waiting;
+
+  osalDbgCheckClassI();
+  osalDbgCheck(rqp != NULL);
+
+  while (*rqpp != NULL) {
+    if (*rqpp == rqp) {
+      *rqpp = rqp->next;
+      return;
+    }
+    rqpp = &(*rqpp)->next;
+  }
+}
+
+/**
+ * @brief   Copies a memory block using a DMA stream.
+ * @details A stream among @p STM32_DMA_M2M_STREAMS_MSK is requested, the
+ *          copy is performed using the largest data unit allowed by the
+ *          alignment of the addresses and size, the calling thread sleeps
+ *          until the copy is complete.
+ * @note    The DMA cannot access the CCM RAM.
+ *
+ * @param[out] dst      destination address
+ * @param[in] src       source address
+ * @param[in] n         number of bytes to copy
+ * @param[in] timeout   the number of ticks before the stream request
+ *                      timeouts, the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation result.
+ * @retval MSG_OK       if the copy has been performed.
+ * @retval MSG_TIMEOUT  if a stream was not available in time.
+ * @retval MSG_RESET    if a transfer error occurred.
+ *
+ * @api
+ */
+msg_t dmaMemCopy(void *dst, const void *src, size_t n, systime_t timeout) {
+  stm32_dma_request_t rq;
+  thread_reference_t tr = NULL;
+  const stm32_dma_stream_t *dmastp;
+  uint32_t mode, unit;
+  msg_t msg = MSG_OK;
+
+  osalDbgCheck((dst != NULL) && (src != NULL));
+
+  dmaStreamRequestObjectInit(&rq, STM32_DMA_M2M_STREAMS_MSK,
+                             STM32_DMA_M2M_IRQ_PRIORITY,
+                             dma_m2m_serve_interrupt, NULL, &tr);
+  dmastp = dmaStreamRequestTimeout(&rq, timeout);
+  if (dmastp == NULL)
+    return MSG_TIMEOUT;
+
+  /* Largest data unit compatible with addresses and size.*/
+  if ((((uint32_t)dst | (uint32_t)src | n) & 3) == 0) {
+    mode = STM32_DMA_CR_PSIZE_WORD | STM32_DMA_CR_MSIZE_WORD;
+    unit = 4;
+  }
+  else if ((((uint32_t)dst | (uint32_t)src | n) & 1) == 0) {
+    mode = STM32_DMA_CR_PSIZE_HWORD | STM32_DMA_CR_MSIZE_HWORD;
+    unit = 2;
+  }
+  else {
+    mode = STM32_DMA_CR_PSIZE_BYTE | STM32_DMA_CR_MSIZE_BYTE;
+    unit = 1;
+  }
+  mode |= STM32_DMA_CR_PL(STM32_DMA_M2M_DMA_PRIORITY) |
+          STM32_DMA_CR_TCIE | STM32_DMA_CR_TEIE;
+  n /= unit;
+
+  /* Memory to memory transfers require the FIFO.*/
+  dmaStreamSetFIFO(dmastp, STM32_DMA_FCR_DMDIS | STM32_DMA_FCR_FTH_FULL);
+
+  /* The transfer counter is limited to 16 bits, large blocks are copied
+     in multiple transfers.*/
+  while ((n > 0) && (msg == MSG_OK)) {
+    size_t chunk = n > 0xFFFF ? 0xFFFF : n;
+
+    osalSysLock();
+    dmaStartMemCopy(dmastp, mode, src, dst, chunk);
+    msg = osalThreadSuspendS(&tr);
+    osalSysUnlock();
+
+    src = (const uint8_t *)src + chunk * unit;
+    dst = (uint8_t *)dst + chunk * unit;
+    n  -= chunk;
+  }
+
+  dmaStreamDisable(dmastp);
+  dmaStreamRelease(dmastp);
+
+  return msg;
+}
+#endif /* STM32_DMA_USE_ARBITER */
+
+#if STM32_DMA_USE_STATISTICS || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the statistics of a DMA stream.
+ *
+ * @param[in] dmastp    pointer to a stm32_dma_stream_t structure
+ * @param[out] sp       pointer to the structure receiving the statistics
+ *
+ * @api
+ */
+void dmaStreamGetStatistics(const stm32_dma_stream_t *dmastp,
+                            stm32_dma_stats_t *sp) {
+
+  osalDbgCheck((dmastp != NULL) && (sp != NULL));
+
+  osalSysLock();
+  *sp = dma_stats[dmastp->selfindex];
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Returns the utilization of a DMA stream.
+ * @details The utilization is the fraction of the time the stream has been
+ *          allocated since the last call to @p dmaResetStatistics().
+ * @note    Allocations longer than the realtime counter wrap period are
+ *          not measured correctly.
+ *
+ * @param[in] dmastp    pointer to a stm32_dma_stream_t structure
+ * @return              The utilization in thousandths.
+ *
+ * @api
+ */
+uint32_t dmaStreamGetUtilization(const stm32_dma_stream_t *dmastp) {
+  uint64_t busy, window;
+
+  osalDbgCheck(dmastp != NULL);
+
+  osalSysLock();
+  busy = dma_stats[dmastp->selfindex].busy;
+  if ((dma_streams_mask & (1 << dmastp->selfindex)) != 0)
+    busy += DWT->CYCCNT - dma_stats[dmastp->selfindex].start;
+  window = (uint64_t)(osalOsGetSystemTimeX() - dma_stats_window) *
+           (STM32_HCLK / OSAL_ST_FREQUENCY);
+  osalSysUnlock();
+
+  if (window == 0)
+    return 0;
+  if (busy >= window)
+    return 1000;
+  return (uint32_t)((busy * 1000) / window);
+}
+
+/**
+ * @brief   Resets the statistics of all the DMA streams.
+ * @details A new utilization measurement window is started.
+ * @note    The statistics are zero at startup, this function is only
+ *          required in order to start a new measurement window.
+ *
+ * @special
+ */
+void dmaResetStatistics(void) {
+  syssts_t sts;
+  unsigned i;
+
+  sts = osalSysGetStatusAndLockX();
+  for (i = 0; i < STM32_DMA_STREAMS; i++) {
+    dma_stats[i].allocations = 0;
+    dma_stats[i].handovers   = 0;
+    dma_stats[i].busy        = 0;
+    dma_stats[i].start       = DWT->CYCCNT;
+  }
+  dma_stats_window = osalOsGetSystemTimeX();
+  osalSysRestoreStatusX(sts);
 }
+#endif /* STM32_DMA_USE_STATISTICS */
 
 #endif /* STM32_DMA_REQUIRED */
 
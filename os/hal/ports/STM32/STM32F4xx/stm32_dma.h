@@ -204,10 +204,83 @@
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   Enables the DMA streams arbiter.
+ * @details If enabled, streams can be allocated among a set of alternate
+ *          mappings and requests for busy streams are queued, a queued
+ *          request is granted when one of its streams is released. The
+ *          memory to memory copy API is also available.
+ * @note    When enabled the ADC drivers and the SPI receive side request
+ *          their streams for each operation, among all the streams
+ *          mapped to the peripheral, and release them on completion. The
+ *          stream settings in mcuconf.h are ignored for those streams.
+ */
+#if !defined(STM32_DMA_USE_ARBITER) || defined(__DOXYGEN__)
+#define STM32_DMA_USE_ARBITER               FALSE
+#endif
+
+/**
+ * @brief   Enables the per-stream utilization statistics.
+ * @note    The busy time is measured using the DWT cycle counter, the
+ *          counter is enabled by the RT kernel port initialization.
+ */
+#if !defined(STM32_DMA_USE_STATISTICS) || defined(__DOXYGEN__)
+#define STM32_DMA_USE_STATISTICS            FALSE
+#endif
+
+/**
+ * @brief   Streams usable for memory to memory copies.
+ * @note    Only DMA2 streams are able to perform memory to memory
+ *          transfers.
+ */
+#if !defined(STM32_DMA_M2M_STREAMS_MSK) || defined(__DOXYGEN__)
+#define STM32_DMA_M2M_STREAMS_MSK           0x0000FF00
+#endif
+
+/**
+ * @brief   Memory to memory copies IRQ priority.
+ */
+#if !defined(STM32_DMA_M2M_IRQ_PRIORITY) || defined(__DOXYGEN__)
+#define STM32_DMA_M2M_IRQ_PRIORITY          12
+#endif
+
+/**
+ * @brief   Memory to memory copies DMA priority (0..3|lowest..highest).
+ */
+#if !defined(STM32_DMA_M2M_DMA_PRIORITY) || defined(__DOXYGEN__)
+#define STM32_DMA_M2M_DMA_PRIORITY          0
+#endif
+/** @} */
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if STM32_DMA_USE_ARBITER || defined(__DOXYGEN__)
+#if (STM32_DMA_M2M_STREAMS_MSK == 0) ||                                     \
+    ((STM32_DMA_M2M_STREAMS_MSK & ~0x0000FF00) != 0)
+#error "STM32_DMA_M2M_STREAMS_MSK must specify DMA2 streams only"
+#endif
+
+#if !CORTEX_IS_VALID_KERNEL_PRIORITY(STM32_DMA_M2M_IRQ_PRIORITY)
+#error "Invalid IRQ priority assigned to DMA memory copies"
+#endif
+
+#if !STM32_DMA_IS_VALID_PRIORITY(STM32_DMA_M2M_DMA_PRIORITY)
+#error "Invalid DMA priority assigned to DMA memory copies"
+#endif
+
+/* The arbiter makes the DMA services available to the application even if
+   no driver requires them.*/
+#if !defined(STM32_DMA_REQUIRED)
+#define STM32_DMA_REQUIRED
+#endif
+#endif /* STM32_DMA_USE_ARBITER */
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -233,6 +306,57 @@ typedef struct {
  */
 typedef void (*stm32_dmaisr_t)(void *p, uint32_t flags);
 
+#if STM32_DMA_USE_ARBITER || defined(__DOXYGEN__)
+/**
+ * @brief   STM32 DMA grant function type.
+ * @note    The function is invoked from within the system lock, only
+ *          I-class functions can be used.
+ *
+ * @param[in] p         parameter for the registered function
+ * @param[in] dmastp    pointer to the granted stm32_dma_stream_t structure
+ */
+typedef void (*stm32_dmagrant_t)(void *p, const stm32_dma_stream_t *dmastp);
+
+/**
+ * @brief   Type of a DMA stream request.
+ */
+typedef struct stm32_dma_request stm32_dma_request_t;
+
+/**
+ * @brief   Structure representing a DMA stream request.
+ */
+struct stm32_dma_request {
+  stm32_dma_request_t   *next;          /**< @brief Next queued request.    */
+  uint32_t              mask;           /**< @brief Acceptable streams.     */
+  uint32_t              priority;       /**< @brief IRQ priority.           */
+  stm32_dmaisr_t        func;           /**< @brief DMA callback function.  */
+  stm32_dmagrant_t      grant;          /**< @brief Deferred grant callback
+                                             or @p NULL for a waiting
+                                             thread.                        */
+  void                  *param;         /**< @brief Callbacks parameter.    */
+  thread_reference_t    thread;         /**< @brief Waiting thread.         */
+  const stm32_dma_stream_t *dmastp;     /**< @brief Granted stream or
+                                             @p NULL.                       */
+};
+#endif /* STM32_DMA_USE_ARBITER */
+
+#if STM32_DMA_USE_STATISTICS || defined(__DOXYGEN__)
+/**
+ * @brief   DMA stream statistics.
+ */
+typedef struct {
+  uint32_t              allocations;    /**< @brief Number of allocations.  */
+  uint32_t              handovers;      /**< @brief Allocations granted to
+                                             queued requests.               */
+  uint64_t              busy;           /**< @brief Allocated time in
+                                             realtime counter cycles, the
+                                             current allocation is not
+                                             included.                      */
+  uint32_t              start;          /**< @brief Current allocation start
+                                             time.                          */
+} stm32_dma_stats_t;
+#endif /* STM32_DMA_USE_STATISTICS */
+
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
@@ -421,6 +545,22 @@ typedef void (*stm32_dmaisr_t)(void *p, uint32_t flags);
                            STM32_DMA_CR_DIR_M2M | STM32_DMA_CR_EN);         \
 }
 
+/**
+ * @brief   Returns the channel to be used with a stream.
+ * @details Helper for streams allocated with @p dmaStreamAllocateAny() or
+ *          granted by the arbiter, the channel is extracted from the
+ *          peripheral stream/channel association word.
+ *
+ * @param[in] dmastp    pointer to a stm32_dma_stream_t structure
+ * @param[in] c         a stream/channel association word, one channel per
+ *                      nibble
+ * @return              Returns the channel associated to the stream.
+ *
+ * @special
+ */
+#define dmaStreamGetChannel(dmastp, c)                                      \
+  STM32_DMA_GETCHANNEL((dmastp)->selfindex, c)
+
 /**
  * @brief   Polled wait for DMA transfer end.
  * @pre     The stream must have been allocated using @p dmaStreamAllocate().
@@ -452,6 +592,29 @@ extern "C" {
                          stm32_dmaisr_t func,
                          void *param);
   void dmaStreamRelease(const stm32_dma_stream_t *dmastp);
+#if STM32_DMA_USE_ARBITER
+  const stm32_dma_stream_t *dmaStreamAllocateAny(uint32_t mask,
+                                                 uint32_t priority,
+                                                 stm32_dmaisr_t func,
+                                                 void *param);
+  void dmaStreamRequestObjectInit(stm32_dma_request_t *rqp,
+                                  uint32_t mask,
+                                  uint32_t priority,
+                                  stm32_dmaisr_t func,
+                                  stm32_dmagrant_t grant,
+                                  void *param);
+  const stm32_dma_stream_t *dmaStreamRequestI(stm32_dma_request_t *rqp);
+  const stm32_dma_stream_t *dmaStreamRequestTimeout(stm32_dma_request_t *rqp,
+                                                    systime_t timeout);
+  void dmaStreamCancelI(stm32_dma_request_t *rqp);
+  msg_t dmaMemCopy(void *dst, const void *src, size_t n, systime_t timeout);
+#endif
+#if STM32_DMA_USE_STATISTICS
+  void dmaStreamGetStatistics(const stm32_dma_stream_t *dmastp,
+                              stm32_dma_stats_t *sp);
+  uint32_t dmaStreamGetUtilization(const stm32_dma_stream_t *dmastp);
+  void dmaResetStatistics(void);
+#endif
 #ifdef __cplusplus
 }
 #endif
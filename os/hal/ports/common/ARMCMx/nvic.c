@@ -85,4 +85,46 @@ void nvicSetSystemHandlerPriority(uint32_t handler, uint32_t prio) {
   SCB->SHP[handler] = NVIC_PRIORITY_MASK(prio);
 }
 
+/**
+ * @brief   Enables the vectors of a classification table.
+ * @details Each vector priority is checked against its class, OS-aware
+ *          vectors must be within the kernel-managed priority range, fast
+ *          vectors must be above it.
+ *
+ * @param[in] vtp       pointer to the classification table
+ * @param[in] n         number of entries in the table
+ */
+void nvicEnableVectors(const nvic_vector_t *vtp, size_t n) {
+
+  osalDbgCheck((vtp != NULL) || (n == 0));
+
+  while (n > 0) {
+    osalDbgAssert(CORTEX_IS_VALID_PRIORITY(vtp->prio) &&
+                  ((vtp->cls == NVIC_CLASS_OS) ==
+                   CORTEX_IS_VALID_KERNEL_PRIORITY(vtp->prio)),
+                  "priority not matching the vector class");
+
+    nvicEnableVector(vtp->n, vtp->prio);
+    vtp++;
+    n--;
+  }
+}
+
+/**
+ * @brief   Disables the vectors of a classification table.
+ *
+ * @param[in] vtp       pointer to the classification table
+ * @param[in] n         number of entries in the table
+ */
+void nvicDisableVectors(const nvic_vector_t *vtp, size_t n) {
+
+  osalDbgCheck((vtp != NULL) || (n == 0));
+
+  while (n > 0) {
+    nvicDisableVector(vtp->n);
+    vtp++;
+    n--;
+  }
+}
+
 /** @} */
@@ -47,6 +47,26 @@
 #define HANDLER_SYSTICK         11      /**< SYS TCK vector id.             */
 /** @} */
 
+/**
+ * @name    Vector classes
+ * @{
+ */
+/**
+ * @brief   OS-aware vector.
+ * @details The handler uses @p OSAL_IRQ_PROLOGUE() and
+ *          @p OSAL_IRQ_EPILOGUE() and can invoke I-class functions, the
+ *          priority must be within the kernel-managed range.
+ */
+#define NVIC_CLASS_OS           0
+/**
+ * @brief   Fast vector.
+ * @details The handler cannot invoke any OS function, the priority must be
+ *          above the kernel-managed range so that the vector is never
+ *          masked by the kernel critical zones.
+ */
+#define NVIC_CLASS_FAST         1
+/** @} */
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -59,6 +79,15 @@
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Type of a vector classification table entry.
+ */
+typedef struct {
+  uint16_t              n;          /**< @brief Interrupt number.           */
+  uint8_t               cls;        /**< @brief Vector class.               */
+  uint8_t               prio;       /**< @brief Interrupt priority.         */
+} nvic_vector_t;
+
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
@@ -68,6 +97,22 @@
  */
 #define NVIC_PRIORITY_MASK(prio) ((prio) << (8 - __NVIC_PRIO_BITS))
 
+/**
+ * @brief   Classification table entry for an OS-aware vector.
+ *
+ * @param[in] n         the interrupt number
+ * @param[in] prio      the interrupt priority
+ */
+#define NVIC_OS_VECTOR(n, prio) {(uint16_t)(n), NVIC_CLASS_OS, (prio)}
+
+/**
+ * @brief   Classification table entry for a fast vector.
+ *
+ * @param[in] n         the interrupt number
+ * @param[in] prio      the interrupt priority
+ */
+#define NVIC_FAST_VECTOR(n, prio) {(uint16_t)(n), NVIC_CLASS_FAST, (prio)}
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -78,6 +123,8 @@ extern "C" {
   void nvicEnableVector(uint32_t n, uint32_t prio);
   void nvicDisableVector(uint32_t n);
   void nvicSetSystemHandlerPriority(uint32_t handler, uint32_t prio);
+  void nvicEnableVectors(const nvic_vector_t *vtp, size_t n);
+  void nvicDisableVectors(const nvic_vector_t *vtp, size_t n);
 #ifdef __cplusplus
 }
 #endif
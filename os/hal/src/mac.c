@@ -0,0 +1,467 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    mac.c
+ * @brief   MAC Driver code.
+ *
+ * @addtogroup MAC
+ * @{
+ */
+
+#include "hal.h"
+
+#if HAL_USE_MAC || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   MAC Driver initialization.
+ * @note    This function is implicitly invoked by @p halInit(), there is
+ *          no need to explicitly initialize the driver.
+ *
+ * @init
+ */
+void macInit(void) {
+
+  mac_lld_init();
+}
+
+/**
+ * @brief   Initialize the standard part of a @p MACDriver structure.
+ *
+ * @param[out] macp     pointer to the @p MACDriver object
+ *
+ * @init
+ */
+void macObjectInit(MACDriver *macp) {
+
+  macp->state   = MAC_STOP;
+  macp->config  = NULL;
+  macp->link_up = false;
+  osalThreadQueueObjectInit(&macp->tdqueue);
+  osalThreadQueueObjectInit(&macp->rdqueue);
+#if MAC_USE_EVENTS
+  osalEventObjectInit(&macp->rdevent);
+  osalEventObjectInit(&macp->lsevent);
+#endif
+#if MAC_USE_ZERO_COPY
+  macp->pkfree  = NULL;
+  osalThreadQueueObjectInit(&macp->pkqueue);
+#endif
+}
+
+/**
+ * @brief   Configures and activates the MAC peripheral.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] config    pointer to the @p MACConfig object
+ *
+ * @api
+ */
+void macStart(MACDriver *macp, const MACConfig *config) {
+
+  osalDbgCheck((macp != NULL) && (config != NULL));
+
+  osalSysLock();
+  osalDbgAssert(macp->state == MAC_STOP, "invalid state");
+  macp->config = config;
+  mac_lld_start(macp);
+  macp->state = MAC_ACTIVE;
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Deactivates the MAC peripheral.
+ * @note    Threads waiting on the driver are released with @p MSG_RESET.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ *
+ * @api
+ */
+void macStop(MACDriver *macp) {
+
+  osalDbgCheck(macp != NULL);
+
+  osalSysLock();
+  osalDbgAssert((macp->state == MAC_STOP) || (macp->state == MAC_ACTIVE),
+                "invalid state");
+  mac_lld_stop(macp);
+  macp->state   = MAC_STOP;
+  macp->link_up = false;
+  osalThreadDequeueAllI(&macp->tdqueue, MSG_RESET);
+  osalThreadDequeueAllI(&macp->rdqueue, MSG_RESET);
+#if MAC_USE_ZERO_COPY
+  osalThreadDequeueAllI(&macp->pkqueue, MSG_RESET);
+#endif
+  osalOsRescheduleS();
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Allocates a transmission descriptor.
+ * @details One of the available transmission descriptors is locked and
+ *          returned. If a descriptor is not currently available then the
+ *          invoking thread is queued until one is freed.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] tdp      pointer to a @p MACTransmitDescriptor structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       the descriptor has been obtained.
+ * @retval MSG_TIMEOUT  the operation has timed out, descriptor not available.
+ * @retval MSG_RESET    the driver has been stopped while waiting.
+ *
+ * @api
+ */
+msg_t macWaitTransmitDescriptor(MACDriver *macp,
+                                MACTransmitDescriptor *tdp,
+                                systime_t timeout) {
+  msg_t msg;
+
+  osalDbgCheck((macp != NULL) && (tdp != NULL));
+
+  osalSysLock();
+  osalDbgAssert(macp->state == MAC_ACTIVE, "not active");
+  while ((msg = mac_lld_get_transmit_descriptor(macp, tdp)) != MSG_OK) {
+    msg = osalThreadEnqueueTimeoutS(&macp->tdqueue, timeout);
+    if (msg != MSG_OK)
+      break;
+  }
+  osalSysUnlock();
+  return msg;
+}
+
+/**
+ * @brief   Releases a transmit descriptor and starts the transmission of the
+ *          enqueued data as a single frame.
+ *
+ * @param[in] tdp       the pointer to the @p MACTransmitDescriptor structure
+ *
+ * @api
+ */
+void macReleaseTransmitDescriptor(MACTransmitDescriptor *tdp) {
+
+  osalDbgCheck(tdp != NULL);
+
+  mac_lld_release_transmit_descriptor(tdp);
+}
+
+/**
+ * @brief   Waits for a received frame.
+ * @details Stops until a frame is received and buffered. If a frame is
+ *          not immediately available then the invoking thread is queued
+ *          until one is received.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] rdp      pointer to a @p MACReceiveDescriptor structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       the descriptor has been obtained.
+ * @retval MSG_TIMEOUT  the operation has timed out, descriptor not available.
+ * @retval MSG_RESET    the driver has been stopped while waiting.
+ *
+ * @api
+ */
+msg_t macWaitReceiveDescriptor(MACDriver *macp,
+                               MACReceiveDescriptor *rdp,
+                               systime_t timeout) {
+  msg_t msg;
+
+  osalDbgCheck((macp != NULL) && (rdp != NULL));
+
+  osalSysLock();
+  osalDbgAssert(macp->state == MAC_ACTIVE, "not active");
+  while ((msg = mac_lld_get_receive_descriptor(macp, rdp)) != MSG_OK) {
+    msg = osalThreadEnqueueTimeoutS(&macp->rdqueue, timeout);
+    if (msg != MSG_OK)
+      break;
+  }
+  osalSysUnlock();
+  return msg;
+}
+
+/**
+ * @brief   Releases a receive descriptor.
+ * @details The descriptor and its buffer are made available for more incoming
+ *          frames.
+ *
+ * @param[in] rdp       the pointer to the @p MACReceiveDescriptor structure
+ *
+ * @api
+ */
+void macReleaseReceiveDescriptor(MACReceiveDescriptor *rdp) {
+
+  osalDbgCheck(rdp != NULL);
+
+  mac_lld_release_receive_descriptor(rdp);
+}
+
+/**
+ * @brief   Updates and returns the link status.
+ * @details If the link status changed since the previous invocation then
+ *          the link event source is broadcasted with the @p MAC_LINK_UP or
+ *          @p MAC_LINK_DOWN flags. Threads waiting for a transmit descriptor
+ *          are woken up when the link goes up.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The link status.
+ * @retval true         if the link is active.
+ * @retval false        if the link is down.
+ *
+ * @api
+ */
+bool macPollLinkStatus(MACDriver *macp) {
+  bool link_up;
+
+  osalDbgCheck(macp != NULL);
+  osalDbgAssert(macp->state == MAC_ACTIVE, "not active");
+
+  link_up = mac_lld_poll_link_status(macp);
+
+  osalSysLock();
+  if (link_up != macp->link_up) {
+    macp->link_up = link_up;
+    if (link_up)
+      osalThreadDequeueAllI(&macp->tdqueue, MSG_OK);
+#if MAC_USE_EVENTS
+    osalEventBroadcastFlagsI(&macp->lsevent,
+                             link_up ? MAC_LINK_UP : MAC_LINK_DOWN);
+#endif
+    osalOsRescheduleS();
+  }
+  osalSysUnlock();
+  return link_up;
+}
+
+#if MAC_USE_ZERO_COPY || defined(__DOXYGEN__)
+/**
+ * @brief   Allocates a packet from the driver pool.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The pointer to the allocated packet, its size is
+ *                      zero.
+ * @retval NULL         if the pool is empty.
+ *
+ * @iclass
+ */
+MACPacket *macAllocPacketI(MACDriver *macp) {
+  MACPacket *pkp;
+
+  osalDbgCheckClassI();
+  osalDbgCheck(macp != NULL);
+
+  pkp = macp->pkfree;
+  if (pkp != NULL) {
+    macp->pkfree = pkp->next;
+    pkp->next    = NULL;
+    pkp->size    = 0;
+  }
+  return pkp;
+}
+
+/**
+ * @brief   Allocates a packet from the driver pool.
+ * @details If the pool is empty then the invoking thread is queued until
+ *          a packet is returned to the pool.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The pointer to the allocated packet, its size is
+ *                      zero.
+ * @retval NULL         if the operation timed out or the driver has been
+ *                      stopped while waiting.
+ *
+ * @api
+ */
+MACPacket *macAllocPacket(MACDriver *macp, systime_t timeout) {
+  MACPacket *pkp;
+
+  osalDbgCheck(macp != NULL);
+
+  osalSysLock();
+  while ((pkp = macAllocPacketI(macp)) == NULL) {
+    if (osalThreadEnqueueTimeoutS(&macp->pkqueue, timeout) != MSG_OK)
+      break;
+  }
+  osalSysUnlock();
+  return pkp;
+}
+
+/**
+ * @brief   Returns a packet, or a chain of packets, to the driver pool.
+ * @details A chain of packets linked through the @p next field is returned
+ *          to the pool as a whole, this allows batched reclamation.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] pkp       pointer to the first packet to be freed
+ *
+ * @iclass
+ */
+void macFreePacketI(MACDriver *macp, MACPacket *pkp) {
+  MACPacket *last;
+
+  osalDbgCheckClassI();
+  osalDbgCheck((macp != NULL) && (pkp != NULL));
+
+  last = pkp;
+  while (last->next != NULL)
+    last = last->next;
+  last->next   = macp->pkfree;
+  macp->pkfree = pkp;
+
+  /* Transmitters can be waiting for a packet to be attached to a
+     descriptor too.*/
+  osalThreadDequeueAllI(&macp->pkqueue, MSG_OK);
+  osalThreadDequeueAllI(&macp->tdqueue, MSG_OK);
+}
+
+/**
+ * @brief   Returns a packet, or a chain of packets, to the driver pool.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] pkp       pointer to the first packet to be freed
+ *
+ * @api
+ */
+void macFreePacket(MACDriver *macp, MACPacket *pkp) {
+
+  osalSysLock();
+  macFreePacketI(macp, pkp);
+  osalOsRescheduleS();
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Zero-copy packet transmission.
+ * @details The packet buffer is attached to a transmit descriptor and
+ *          transmitted, after transmission the packet is returned to the
+ *          pool by the driver. If a descriptor is not currently available
+ *          then the invoking thread is queued until one is freed.
+ * @note    On failure the packet is still owned by the caller.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] pkp       pointer to the packet to be transmitted
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       the packet has been queued for transmission.
+ * @retval MSG_TIMEOUT  the operation has timed out.
+ * @retval MSG_RESET    the driver has been stopped while waiting.
+ *
+ * @api
+ */
+msg_t macTransmitPacket(MACDriver *macp, MACPacket *pkp,
+                        systime_t timeout) {
+  msg_t msg;
+
+  osalDbgCheck((macp != NULL) && (pkp != NULL) &&
+               (pkp->size <= MAC_PACKET_SIZE));
+
+  osalSysLock();
+  osalDbgAssert(macp->state == MAC_ACTIVE, "not active");
+  while ((msg = mac_lld_transmit_packet(macp, pkp)) != MSG_OK) {
+    msg = osalThreadEnqueueTimeoutS(&macp->tdqueue, timeout);
+    if (msg != MSG_OK)
+      break;
+  }
+  osalSysUnlock();
+  return msg;
+}
+
+/**
+ * @brief   Zero-copy packet reception.
+ * @details The packet buffer holding the received frame is detached from
+ *          its receive descriptor and returned, the descriptor is armed
+ *          again with a buffer taken from the pool. If a frame is not
+ *          immediately available then the invoking thread is queued until
+ *          one is received.
+ * @note    The returned packet must be returned to the pool using
+ *          @p macFreePacket() or reused for transmission.
+ * @note    Frames received while the pool is empty are discarded.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] pkpp     pointer to a variable receiving the packet pointer
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       a packet has been received.
+ * @retval MSG_TIMEOUT  the operation has timed out.
+ * @retval MSG_RESET    the driver has been stopped while waiting.
+ *
+ * @api
+ */
+msg_t macReceivePacket(MACDriver *macp, MACPacket **pkpp,
+                       systime_t timeout) {
+  msg_t msg;
+
+  osalDbgCheck((macp != NULL) && (pkpp != NULL));
+
+  osalSysLock();
+  osalDbgAssert(macp->state == MAC_ACTIVE, "not active");
+  while ((msg = mac_lld_receive_packet(macp, pkpp)) != MSG_OK) {
+    msg = osalThreadEnqueueTimeoutS(&macp->rdqueue, timeout);
+    if (msg != MSG_OK)
+      break;
+  }
+  osalSysUnlock();
+  return msg;
+}
+#endif /* MAC_USE_ZERO_COPY */
+
+#endif /* HAL_USE_MAC */
+
+/** @} */
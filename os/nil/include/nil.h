@@ -114,6 +114,16 @@ typedef struct nil_thread thread_t;
 #define EVENT_MASK(eid)         ((eventmask_t)(1 << (eid)))
 /** @} */
 
+/**
+ * @name    Tasks related macros
+ * @{
+ */
+/**
+ * @brief   Returns a tasks mask from a task identifier.
+ */
+#define TASK_MASK(id)           ((taskmask_t)1 << (id))
+/** @} */
+
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -167,6 +177,45 @@ typedef struct nil_thread thread_t;
 #define NIL_CFG_USE_EVENTS                  TRUE
 #endif
 
+/**
+ * @brief   Mailboxes APIs.
+ * @details If enabled then the mailboxes APIs are included in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(NIL_CFG_USE_MAILBOXES) || defined(__DOXYGEN__)
+#define NIL_CFG_USE_MAILBOXES               FALSE
+#endif
+
+/**
+ * @brief   Byte queues APIs.
+ * @details If enabled then the byte queues APIs are included in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(NIL_CFG_USE_QUEUES) || defined(__DOXYGEN__)
+#define NIL_CFG_USE_QUEUES                  FALSE
+#endif
+
+/**
+ * @brief   Run-to-completion tasks APIs.
+ * @details If enabled then the tasks APIs are included in the kernel. Tasks
+ *          are executed by a single server thread and share its stack,
+ *          preemption among tasks follows the Stack Resource Policy.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(NIL_CFG_USE_TASKS) || defined(__DOXYGEN__)
+#define NIL_CFG_USE_TASKS                   FALSE
+#endif
+
+/**
+ * @brief   Number of tasks in the application.
+ */
+#if !defined(NIL_CFG_NUM_TASKS) || defined(__DOXYGEN__)
+#define NIL_CFG_NUM_TASKS                   4
+#endif
+
 /**
  * @brief   System assertions.
  */
@@ -206,6 +255,11 @@ typedef struct nil_thread thread_t;
 #error "invalid NIL_CFG_ST_RESOLUTION specified, must be 16 or 32"
 #endif
 
+#if NIL_CFG_USE_TASKS &&                                                   \
+    ((NIL_CFG_NUM_TASKS < 1) || (NIL_CFG_NUM_TASKS > 32))
+#error "NIL_CFG_NUM_TASKS must be in the range 1..32"
+#endif
+
 #if NIL_CFG_ST_FREQUENCY <= 0
 #error "invalid NIL_CFG_ST_FREQUENCY specified, must be greated than zero"
 #endif
@@ -249,6 +303,40 @@ typedef struct {
   volatile cnt_t    cnt;        /**< @brief Semaphore counter.              */
 } semaphore_t;
 
+#if NIL_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a structure representing a mailbox.
+ * @note    The two counters have the semantic of semaphores, waiting
+ *          threads and timeouts are handled as for semaphores.
+ */
+typedef struct {
+  msg_t             *buffer;    /**< @brief Pointer to the mailbox buffer.  */
+  msg_t             *top;       /**< @brief Pointer to the location after
+                                            the buffer.                     */
+  msg_t             *wrptr;     /**< @brief Write pointer.                  */
+  msg_t             *rdptr;     /**< @brief Read pointer.                   */
+  semaphore_t       fullsem;    /**< @brief Messages in the buffer.         */
+  semaphore_t       emptysem;   /**< @brief Free slots in the buffer.       */
+} mailbox_t;
+#endif
+
+#if NIL_CFG_USE_QUEUES || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a structure representing a byte queue.
+ * @note    The two counters have the semantic of semaphores, waiting
+ *          threads and timeouts are handled as for semaphores.
+ */
+typedef struct {
+  uint8_t           *buffer;    /**< @brief Pointer to the queue buffer.    */
+  uint8_t           *top;       /**< @brief Pointer to the location after
+                                            the buffer.                     */
+  uint8_t           *wrptr;     /**< @brief Write pointer.                  */
+  uint8_t           *rdptr;     /**< @brief Read pointer.                   */
+  semaphore_t       fullsem;    /**< @brief Bytes in the buffer.            */
+  semaphore_t       emptysem;   /**< @brief Free bytes in the buffer.       */
+} byte_queue_t;
+#endif
+
 /**
  * @brief Thread function.
  */
@@ -280,6 +368,39 @@ struct nil_thread_cfg {
  */
 typedef thread_t * thread_reference_t;
 
+#if NIL_CFG_USE_TASKS || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a tasks mask, bit zero is the highest priority task.
+ */
+typedef uint32_t taskmask_t;
+
+/**
+ * @brief   Type of a structure representing a task static configuration.
+ */
+typedef struct nil_task_cfg task_config_t;
+
+/**
+ * @brief   Structure representing a task static configuration.
+ * @note    Tasks have no stack and no descriptor, the only RAM used by a
+ *          task is one bit in the system masks.
+ */
+struct nil_task_cfg {
+  const char        *namep;     /**< @brief Task name, for debugging.       */
+  tfunc_t           funcp;      /**< @brief Task function.                  */
+  void              *arg;       /**< @brief Task function argument.         */
+};
+
+/**
+ * @brief   Type of a structure representing a task resource.
+ */
+typedef struct {
+  taskmask_t        ceiling;    /**< @brief Tasks allowed to preempt the
+                                            holder of the resource.         */
+  taskmask_t        saved;      /**< @brief Preemption mask before the
+                                            resource was locked.            */
+} task_resource_t;
+#endif /* NIL_CFG_USE_TASKS */
+
 /**
  * @brief   Structure representing a thread.
  */
@@ -345,6 +466,25 @@ typedef struct {
    * @brief   Thread structures for all the defined threads.
    */
   thread_t              threads[NIL_CFG_NUM_THREADS + 1];
+#if NIL_CFG_USE_TASKS || defined(__DOXYGEN__)
+  /**
+   * @brief   Tasks server thread.
+   */
+  thread_t              *tasks_server;
+  /**
+   * @brief   Reference to the tasks server while waiting for activations.
+   */
+  thread_reference_t    tasks_tr;
+  /**
+   * @brief   Mask of the activated tasks.
+   */
+  taskmask_t            tasks_pending;
+  /**
+   * @brief   Mask of the tasks allowed to preempt, it represents the
+   *          current system ceiling.
+   */
+  taskmask_t            tasks_allowed;
+#endif
 #if NIL_DBG_ENABLED || defined(__DOXYGEN__)
   /**
    * @brief   Panic message.
@@ -381,7 +521,45 @@ typedef struct {
 #define THD_TABLE_END                                                       \
   {THD_IDLE_BASE, THD_IDLE_END, "idle", 0, NULL}                            \
 };
+
+#if NIL_CFG_USE_TASKS || defined(__DOXYGEN__)
+/**
+ * @brief   Entry of the tasks server in the threads table.
+ * @details The position of the entry in the table sets the priority of all
+ *          the tasks relative to the threads. The working area is shared by
+ *          all the tasks, it must be sized for the worst case nesting of
+ *          preempting tasks, interrupt frames included.
+ */
+#define THD_TABLE_TASKS(wap)                                                \
+  THD_TABLE_ENTRY(wap, "tasks", chTaskServer, NULL)
+#endif
+/** @} */
+
+#if NIL_CFG_USE_TASKS || defined(__DOXYGEN__)
+/**
+ * @name    Tasks tables definition macros
+ * @{
+ */
+/**
+ * @brief   Start of user tasks table.
+ */
+#define TASK_TABLE_BEGIN                                                    \
+  const task_config_t nil_task_configs[NIL_CFG_NUM_TASKS] = {
+
+/**
+ * @brief   Entry of user tasks table, the first entry is the highest
+ *          priority task.
+ */
+#define TASK_TABLE_ENTRY(name, funcp, arg)                                  \
+  {name, funcp, arg},
+
+/**
+ * @brief   End of user tasks table.
+ */
+#define TASK_TABLE_END                                                      \
+};
 /** @} */
+#endif /* NIL_CFG_USE_TASKS */
 
 /**
  * @name    Working Areas and Alignment
@@ -594,7 +772,14 @@ typedef struct {
  *
  * @iclass
  */
+#if NIL_CFG_USE_TASKS || defined(__DOXYGEN__)
+#define chSchIsRescRequiredI()                                              \
+  ((bool)((nil.current != nil.next) ||                                      \
+          ((nil.current == nil.tasks_server) &&                             \
+           ((nil.tasks_pending & nil.tasks_allowed) != 0))))
+#else
 #define chSchIsRescRequiredI() ((bool)(nil.current != nil.next))
+#endif
 
 /**
  * @brief   Returns a pointer to the current @p thread_t.
@@ -707,6 +892,180 @@ typedef struct {
  */
 #define chSemGetCounterI(sp) ((sp)->cnt)
 
+#if NIL_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
+/**
+ * @brief   Data part of a static mailbox initializer.
+ * @details This macro should be used when statically initializing a
+ *          mailbox that is part of a bigger structure.
+ *
+ * @param[in] name      the name of the mailbox variable
+ * @param[in] buffer    pointer to the mailbox buffer area
+ * @param[in] size      size of the mailbox buffer area
+ */
+#define _MAILBOX_DATA(name, buffer, size) {                                 \
+  (msg_t *)(buffer),                                                        \
+  (msg_t *)(buffer) + size,                                                 \
+  (msg_t *)(buffer),                                                        \
+  (msg_t *)(buffer),                                                        \
+  {0},                                                                      \
+  {size}                                                                    \
+}
+
+/**
+ * @brief   Static mailbox initializer.
+ * @details Statically initialized mailboxes require no explicit
+ *          initialization using @p chMBObjectInit().
+ *
+ * @param[in] name      the name of the mailbox variable
+ * @param[in] buffer    pointer to the mailbox buffer area
+ * @param[in] size      size of the mailbox buffer area
+ */
+#define MAILBOX_DECL(name, buffer, size)                                    \
+  mailbox_t name = _MAILBOX_DATA(name, buffer, size)
+
+/**
+ * @brief   Returns the number of free message slots into a mailbox.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @return              The number of empty message slots.
+ *
+ * @iclass
+ */
+#define chMBGetFreeCountI(mbp) chSemGetCounterI(&(mbp)->emptysem)
+
+/**
+ * @brief   Returns the number of used message slots into a mailbox.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @return              The number of queued messages.
+ *
+ * @iclass
+ */
+#define chMBGetUsedCountI(mbp) chSemGetCounterI(&(mbp)->fullsem)
+
+/**
+ * @brief   Posts a message into a mailbox.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msg       the message to be posted on the mailbox
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ *
+ * @api
+ */
+#define chMBPost(mbp, msg) chMBPostTimeout(mbp, msg, TIME_INFINITE)
+
+/**
+ * @brief   Retrieves a message from a mailbox.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgp     pointer to a message variable for the received
+ *                      message
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ *
+ * @api
+ */
+#define chMBFetch(mbp, msgp) chMBFetchTimeout(mbp, msgp, TIME_INFINITE)
+#endif /* NIL_CFG_USE_MAILBOXES */
+
+#if NIL_CFG_USE_QUEUES || defined(__DOXYGEN__)
+/**
+ * @brief   Data part of a static byte queue initializer.
+ * @details This macro should be used when statically initializing a
+ *          byte queue that is part of a bigger structure.
+ *
+ * @param[in] name      the name of the byte queue variable
+ * @param[in] buffer    pointer to the queue buffer area
+ * @param[in] size      size of the queue buffer area
+ */
+#define _BYTE_QUEUE_DATA(name, buffer, size) {                              \
+  (uint8_t *)(buffer),                                                      \
+  (uint8_t *)(buffer) + size,                                               \
+  (uint8_t *)(buffer),                                                      \
+  (uint8_t *)(buffer),                                                      \
+  {0},                                                                      \
+  {size}                                                                    \
+}
+
+/**
+ * @brief   Static byte queue initializer.
+ * @details Statically initialized byte queues require no explicit
+ *          initialization using @p chBQObjectInit().
+ *
+ * @param[in] name      the name of the byte queue variable
+ * @param[in] buffer    pointer to the queue buffer area
+ * @param[in] size      size of the queue buffer area
+ */
+#define BYTE_QUEUE_DECL(name, buffer, size)                                 \
+  byte_queue_t name = _BYTE_QUEUE_DATA(name, buffer, size)
+
+/**
+ * @brief   Returns the number of free bytes into a byte queue.
+ *
+ * @param[in] bqp       the pointer to an initialized @p byte_queue_t object
+ * @return              The number of free bytes.
+ *
+ * @iclass
+ */
+#define chBQGetFreeCountI(bqp) chSemGetCounterI(&(bqp)->emptysem)
+
+/**
+ * @brief   Returns the number of bytes into a byte queue.
+ *
+ * @param[in] bqp       the pointer to an initialized @p byte_queue_t object
+ * @return              The number of queued bytes.
+ *
+ * @iclass
+ */
+#define chBQGetUsedCountI(bqp) chSemGetCounterI(&(bqp)->fullsem)
+
+/**
+ * @brief   Byte queue write.
+ *
+ * @param[in] bqp       the pointer to an initialized @p byte_queue_t object
+ * @param[in] b         the byte value to be written in the queue
+ * @return              The operation status.
+ * @retval MSG_OK       if the operation succeeded.
+ * @retval MSG_RESET    if the queue has been reset while waiting.
+ *
+ * @api
+ */
+#define chBQPut(bqp, b) chBQPutTimeout(bqp, b, TIME_INFINITE)
+
+/**
+ * @brief   Byte queue read.
+ *
+ * @param[in] bqp       the pointer to an initialized @p byte_queue_t object
+ * @return              A byte value from the queue.
+ * @retval MSG_RESET    if the queue has been reset while waiting.
+ *
+ * @api
+ */
+#define chBQGet(bqp) chBQGetTimeout(bqp, TIME_INFINITE)
+#endif /* NIL_CFG_USE_QUEUES */
+
+#if NIL_CFG_USE_TASKS || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes a task resource.
+ * @details The ceiling of a resource is the highest priority among the tasks
+ *          using it, while the resource is locked only the tasks with
+ *          priority above the ceiling can preempt.
+ *
+ * @param[out] rp       pointer to a @p task_resource_t structure
+ * @param[in] id        identifier of the highest priority task using the
+ *                      resource
+ *
+ * @init
+ */
+#define chTaskResourceObjectInit(rp, id) {                                  \
+  (rp)->ceiling = TASK_MASK(id) - 1;                                        \
+  (rp)->saved   = 0;                                                        \
+}
+#endif
+
 /**
  * @brief   Current system time.
  * @details Returns the number of system ticks since the @p chSysInit()
@@ -783,6 +1142,9 @@ typedef struct {
 #if !defined(__DOXYGEN__)
 extern nil_system_t nil;
 extern const thread_config_t nil_thd_configs[NIL_CFG_NUM_THREADS + 1];
+#if NIL_CFG_USE_TASKS
+extern const task_config_t nil_task_configs[NIL_CFG_NUM_TASKS];
+#endif
 #endif
 
 #ifdef __cplusplus
@@ -810,6 +1172,35 @@ extern "C" {
   void chEvtSignalI(thread_t *tp, eventmask_t mask);
   eventmask_t chEvtWaitAnyTimeout(eventmask_t mask, systime_t timeout);
   eventmask_t chEvtWaitAnyTimeoutS(eventmask_t mask, systime_t timeout);
+#if NIL_CFG_USE_MAILBOXES
+  void chMBObjectInit(mailbox_t *mbp, msg_t *buf, cnt_t n);
+  void chMBReset(mailbox_t *mbp);
+  void chMBResetI(mailbox_t *mbp);
+  msg_t chMBPostTimeout(mailbox_t *mbp, msg_t msg, systime_t timeout);
+  msg_t chMBPostTimeoutS(mailbox_t *mbp, msg_t msg, systime_t timeout);
+  msg_t chMBPostI(mailbox_t *mbp, msg_t msg);
+  msg_t chMBFetchTimeout(mailbox_t *mbp, msg_t *msgp, systime_t timeout);
+  msg_t chMBFetchTimeoutS(mailbox_t *mbp, msg_t *msgp, systime_t timeout);
+  msg_t chMBFetchI(mailbox_t *mbp, msg_t *msgp);
+#endif
+#if NIL_CFG_USE_QUEUES
+  void chBQObjectInit(byte_queue_t *bqp, uint8_t *buf, cnt_t n);
+  void chBQReset(byte_queue_t *bqp);
+  void chBQResetI(byte_queue_t *bqp);
+  msg_t chBQPutTimeout(byte_queue_t *bqp, uint8_t b, systime_t timeout);
+  msg_t chBQPutTimeoutS(byte_queue_t *bqp, uint8_t b, systime_t timeout);
+  msg_t chBQPutI(byte_queue_t *bqp, uint8_t b);
+  msg_t chBQGetTimeout(byte_queue_t *bqp, systime_t timeout);
+  msg_t chBQGetTimeoutS(byte_queue_t *bqp, systime_t timeout);
+  msg_t chBQGetI(byte_queue_t *bqp);
+#endif
+#if NIL_CFG_USE_TASKS
+  void chTaskServer(void *arg);
+  void chTaskActivate(unsigned id);
+  void chTaskActivateI(unsigned id);
+  void chTaskResourceLock(task_resource_t *rp);
+  void chTaskResourceUnlock(task_resource_t *rp);
+#endif
 #ifdef __cplusplus
 }
 #endif
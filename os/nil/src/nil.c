@@ -32,6 +32,13 @@
 /* Module local definitions.                                                 */
 /*===========================================================================*/
 
+#if NIL_CFG_USE_TASKS || defined(__DOXYGEN__)
+/**
+ * @brief   Mask of all the defined tasks.
+ */
+#define NIL_TASKS_ALL   ((taskmask_t)-1 >> (32 - NIL_CFG_NUM_TASKS))
+#endif
+
 /*===========================================================================*/
 /* Module exported variables.                                                */
 /*===========================================================================*/
@@ -49,6 +56,42 @@ nil_system_t nil;
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if NIL_CFG_USE_TASKS || defined(__DOXYGEN__)
+/**
+ * @brief   Runs the activated tasks allowed by the current system ceiling.
+ * @details Tasks are executed as nested calls on the stack of the tasks
+ *          server, a running task raises the system ceiling to its own
+ *          priority so only higher priority tasks can preempt it. Because
+ *          tasks never block the preemptions are always properly nested.
+ * @note    This function is invoked with the kernel locked and returns with
+ *          the kernel locked, the tasks are executed unlocked.
+ *
+ * @notapi
+ */
+static void nil_tasks_dispatch(void) {
+  taskmask_t m;
+
+  while ((m = nil.tasks_pending & nil.tasks_allowed) != 0) {
+    taskmask_t saved = nil.tasks_allowed;
+    unsigned id = 0;
+
+    /* Highest priority task among the activated ones.*/
+    while ((m & TASK_MASK(id)) == 0)
+      id++;
+    nil.tasks_pending &= ~TASK_MASK(id);
+    nil.tasks_allowed = TASK_MASK(id) - 1;
+
+    chSysUnlock();
+    nil_task_configs[id].funcp(nil_task_configs[id].arg);
+    chSysLock();
+
+    chDbgAssert(nil.tasks_allowed == TASK_MASK(id) - 1,
+                "resource not released");
+    nil.tasks_allowed = saved;
+  }
+}
+#endif /* NIL_CFG_USE_TASKS */
+
 /*===========================================================================*/
 /* Module interrupt handlers.                                                */
 /*===========================================================================*/
@@ -100,6 +143,11 @@ void chSysInit(void) {
   tp->stklim  = THD_IDLE_BASE;
 #endif
 
+#if NIL_CFG_USE_TASKS
+  /* All tasks allowed to run initially.*/
+  nil.tasks_allowed = NIL_TASKS_ALL;
+#endif
+
   /* Runs the highest priority thread, the current one becomes the null
      thread.*/
   nil.current = nil.next = nil.threads;
@@ -296,7 +344,7 @@ thread_t *chSchReadyI(thread_t *tp, msg_t msg) {
  */
 void chSchRescheduleS(void) {
 
-  if (chSchIsRescRequiredI()) {
+  if (nil.current != nil.next) {
     thread_t *otp = nil.current;
 
     nil.current = nil.next;
@@ -307,6 +355,14 @@ void chSchRescheduleS(void) {
 #endif
     port_switch(nil.next, otp);
   }
+
+#if NIL_CFG_USE_TASKS
+  /* If the tasks server is running then tasks above the system ceiling
+     preempt the current task, this also happens when returning from an
+     interrupt because the port invokes this function on exit.*/
+  if (nil.current == nil.tasks_server)
+    nil_tasks_dispatch();
+#endif
 }
 
 /**
@@ -331,6 +387,11 @@ msg_t chSchGoSleepTimeoutS(tstate_t newstate, systime_t timeout) {
 
   chDbgAssert(otp != &nil.threads[NIL_CFG_NUM_THREADS],
                "idle cannot sleep");
+#if NIL_CFG_USE_TASKS
+  chDbgAssert((otp != nil.tasks_server) ||
+              (nil.tasks_allowed == NIL_TASKS_ALL),
+              "tasks cannot sleep");
+#endif
 
   /* Storing the wait object for the current thread.*/
   otp->state = newstate;
@@ -757,4 +818,609 @@ eventmask_t chEvtWaitAnyTimeoutS(eventmask_t mask, systime_t timeout) {
   return m;
 }
 
+#if NIL_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes a @p mailbox_t object.
+ *
+ * @param[out] mbp      the pointer to the @p mailbox_t structure to be
+ *                      initialized
+ * @param[in] buf       pointer to the messages buffer as an array of @p msg_t
+ * @param[in] n         number of elements in the buffer array
+ *
+ * @init
+ */
+void chMBObjectInit(mailbox_t *mbp, msg_t *buf, cnt_t n) {
+
+  chDbgAssert((mbp != NULL) && (buf != NULL) && (n > 0),
+              "invalid parameters");
+
+  mbp->buffer = mbp->rdptr = mbp->wrptr = buf;
+  mbp->top = &buf[n];
+  mbp->fullsem.cnt = 0;
+  mbp->emptysem.cnt = n;
+}
+
+/**
+ * @brief   Resets a @p mailbox_t object.
+ * @details All the waiting threads are resumed with status @p MSG_RESET and
+ *          the queued messages are lost.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ *
+ * @api
+ */
+void chMBReset(mailbox_t *mbp) {
+
+  chSysLock();
+
+  chMBResetI(mbp);
+  chSchRescheduleS();
+
+  chSysUnlock();
+}
+
+/**
+ * @brief   Resets a @p mailbox_t object.
+ * @details All the waiting threads are resumed with status @p MSG_RESET and
+ *          the queued messages are lost.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note that
+ *          interrupt handlers always reschedule on exit so an explicit
+ *          reschedule must not be performed in ISRs.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ *
+ * @iclass
+ */
+void chMBResetI(mailbox_t *mbp) {
+
+  mbp->wrptr = mbp->rdptr = mbp->buffer;
+  chSemResetI(&mbp->emptysem, (cnt_t)(mbp->top - mbp->buffer));
+  chSemResetI(&mbp->fullsem, 0);
+}
+
+/**
+ * @brief   Posts a message into a mailbox.
+ * @details The invoking thread waits until a empty slot in the mailbox
+ *          becomes available or the specified time runs out.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msg       the message to be posted on the mailbox
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chMBPostTimeout(mailbox_t *mbp, msg_t msg, systime_t timeout) {
+  msg_t rdymsg;
+
+  chSysLock();
+
+  rdymsg = chMBPostTimeoutS(mbp, msg, timeout);
+
+  chSysUnlock();
+  return rdymsg;
+}
+
+/**
+ * @brief   Posts a message into a mailbox.
+ * @details The invoking thread waits until a empty slot in the mailbox
+ *          becomes available or the specified time runs out.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msg       the message to be posted on the mailbox
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @sclass
+ */
+msg_t chMBPostTimeoutS(mailbox_t *mbp, msg_t msg, systime_t timeout) {
+  msg_t rdymsg;
+
+  /* The free slots counter is a semaphore, the wait, the timeout and the
+     reset are handled by the semaphore code.*/
+  rdymsg = chSemWaitTimeoutS(&mbp->emptysem, timeout);
+  if (rdymsg == MSG_OK) {
+    *mbp->wrptr++ = msg;
+    if (mbp->wrptr >= mbp->top)
+      mbp->wrptr = mbp->buffer;
+    chSemSignalI(&mbp->fullsem);
+    chSchRescheduleS();
+  }
+  return rdymsg;
+}
+
+/**
+ * @brief   Posts a message into a mailbox.
+ * @details This variant is non-blocking, the function returns a timeout
+ *          condition if the mailbox is full.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note that
+ *          interrupt handlers always reschedule on exit so an explicit
+ *          reschedule must not be performed in ISRs.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msg       the message to be posted on the mailbox
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_TIMEOUT  if the mailbox is full and the message cannot be
+ *                      posted.
+ *
+ * @iclass
+ */
+msg_t chMBPostI(mailbox_t *mbp, msg_t msg) {
+
+  if (mbp->emptysem.cnt <= 0)
+    return MSG_TIMEOUT;
+  mbp->emptysem.cnt--;
+  *mbp->wrptr++ = msg;
+  if (mbp->wrptr >= mbp->top)
+    mbp->wrptr = mbp->buffer;
+  chSemSignalI(&mbp->fullsem);
+  return MSG_OK;
+}
+
+/**
+ * @brief   Retrieves a message from a mailbox.
+ * @details The invoking thread waits until a message is posted in the mailbox
+ *          or the specified time runs out.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgp     pointer to a message variable for the received message
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chMBFetchTimeout(mailbox_t *mbp, msg_t *msgp, systime_t timeout) {
+  msg_t rdymsg;
+
+  chSysLock();
+
+  rdymsg = chMBFetchTimeoutS(mbp, msgp, timeout);
+
+  chSysUnlock();
+  return rdymsg;
+}
+
+/**
+ * @brief   Retrieves a message from a mailbox.
+ * @details The invoking thread waits until a message is posted in the mailbox
+ *          or the specified time runs out.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgp     pointer to a message variable for the received message
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @sclass
+ */
+msg_t chMBFetchTimeoutS(mailbox_t *mbp, msg_t *msgp, systime_t timeout) {
+  msg_t rdymsg;
+
+  rdymsg = chSemWaitTimeoutS(&mbp->fullsem, timeout);
+  if (rdymsg == MSG_OK) {
+    *msgp = *mbp->rdptr++;
+    if (mbp->rdptr >= mbp->top)
+      mbp->rdptr = mbp->buffer;
+    chSemSignalI(&mbp->emptysem);
+    chSchRescheduleS();
+  }
+  return rdymsg;
+}
+
+/**
+ * @brief   Retrieves a message from a mailbox.
+ * @details This variant is non-blocking, the function returns a timeout
+ *          condition if the mailbox is empty.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note that
+ *          interrupt handlers always reschedule on exit so an explicit
+ *          reschedule must not be performed in ISRs.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgp     pointer to a message variable for the received message
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_TIMEOUT  if the mailbox is empty and a message cannot be
+ *                      fetched.
+ *
+ * @iclass
+ */
+msg_t chMBFetchI(mailbox_t *mbp, msg_t *msgp) {
+
+  if (mbp->fullsem.cnt <= 0)
+    return MSG_TIMEOUT;
+  mbp->fullsem.cnt--;
+  *msgp = *mbp->rdptr++;
+  if (mbp->rdptr >= mbp->top)
+    mbp->rdptr = mbp->buffer;
+  chSemSignalI(&mbp->emptysem);
+  return MSG_OK;
+}
+#endif /* NIL_CFG_USE_MAILBOXES */
+
+#if NIL_CFG_USE_QUEUES || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes a @p byte_queue_t object.
+ *
+ * @param[out] bqp      the pointer to the @p byte_queue_t structure to be
+ *                      initialized
+ * @param[in] buf       pointer to the queue buffer
+ * @param[in] n         size of the queue buffer
+ *
+ * @init
+ */
+void chBQObjectInit(byte_queue_t *bqp, uint8_t *buf, cnt_t n) {
+
+  chDbgAssert((bqp != NULL) && (buf != NULL) && (n > 0),
+              "invalid parameters");
+
+  bqp->buffer = bqp->rdptr = bqp->wrptr = buf;
+  bqp->top = &buf[n];
+  bqp->fullsem.cnt = 0;
+  bqp->emptysem.cnt = n;
+}
+
+/**
+ * @brief   Resets a @p byte_queue_t object.
+ * @details All the waiting threads are resumed with status @p MSG_RESET and
+ *          the queued bytes are lost.
+ *
+ * @param[in] bqp       the pointer to an initialized @p byte_queue_t object
+ *
+ * @api
+ */
+void chBQReset(byte_queue_t *bqp) {
+
+  chSysLock();
+
+  chBQResetI(bqp);
+  chSchRescheduleS();
+
+  chSysUnlock();
+}
+
+/**
+ * @brief   Resets a @p byte_queue_t object.
+ * @details All the waiting threads are resumed with status @p MSG_RESET and
+ *          the queued bytes are lost.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note that
+ *          interrupt handlers always reschedule on exit so an explicit
+ *          reschedule must not be performed in ISRs.
+ *
+ * @param[in] bqp       the pointer to an initialized @p byte_queue_t object
+ *
+ * @iclass
+ */
+void chBQResetI(byte_queue_t *bqp) {
+
+  bqp->wrptr = bqp->rdptr = bqp->buffer;
+  chSemResetI(&bqp->emptysem, (cnt_t)(bqp->top - bqp->buffer));
+  chSemResetI(&bqp->fullsem, 0);
+}
+
+/**
+ * @brief   Byte queue write with timeout.
+ * @details The invoking thread waits until there is space in the queue or
+ *          the specified time runs out.
+ *
+ * @param[in] bqp       the pointer to an initialized @p byte_queue_t object
+ * @param[in] b         the byte value to be written in the queue
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the operation succeeded.
+ * @retval MSG_RESET    if the queue has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chBQPutTimeout(byte_queue_t *bqp, uint8_t b, systime_t timeout) {
+  msg_t rdymsg;
+
+  chSysLock();
+
+  rdymsg = chBQPutTimeoutS(bqp, b, timeout);
+
+  chSysUnlock();
+  return rdymsg;
+}
+
+/**
+ * @brief   Byte queue write with timeout.
+ * @details The invoking thread waits until there is space in the queue or
+ *          the specified time runs out.
+ *
+ * @param[in] bqp       the pointer to an initialized @p byte_queue_t object
+ * @param[in] b         the byte value to be written in the queue
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the operation succeeded.
+ * @retval MSG_RESET    if the queue has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @sclass
+ */
+msg_t chBQPutTimeoutS(byte_queue_t *bqp, uint8_t b, systime_t timeout) {
+  msg_t rdymsg;
+
+  rdymsg = chSemWaitTimeoutS(&bqp->emptysem, timeout);
+  if (rdymsg == MSG_OK) {
+    *bqp->wrptr++ = b;
+    if (bqp->wrptr >= bqp->top)
+      bqp->wrptr = bqp->buffer;
+    chSemSignalI(&bqp->fullsem);
+    chSchRescheduleS();
+  }
+  return rdymsg;
+}
+
+/**
+ * @brief   Byte queue write.
+ * @details This variant is non-blocking, the function returns a timeout
+ *          condition if the queue is full.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note that
+ *          interrupt handlers always reschedule on exit so an explicit
+ *          reschedule must not be performed in ISRs.
+ *
+ * @param[in] bqp       the pointer to an initialized @p byte_queue_t object
+ * @param[in] b         the byte value to be written in the queue
+ * @return              The operation status.
+ * @retval MSG_OK       if the operation succeeded.
+ * @retval MSG_TIMEOUT  if the queue is full.
+ *
+ * @iclass
+ */
+msg_t chBQPutI(byte_queue_t *bqp, uint8_t b) {
+
+  if (bqp->emptysem.cnt <= 0)
+    return MSG_TIMEOUT;
+  bqp->emptysem.cnt--;
+  *bqp->wrptr++ = b;
+  if (bqp->wrptr >= bqp->top)
+    bqp->wrptr = bqp->buffer;
+  chSemSignalI(&bqp->fullsem);
+  return MSG_OK;
+}
+
+/**
+ * @brief   Byte queue read with timeout.
+ * @details The invoking thread waits until a byte is available in the queue
+ *          or the specified time runs out.
+ *
+ * @param[in] bqp       the pointer to an initialized @p byte_queue_t object
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              A byte value from the queue.
+ * @retval MSG_RESET    if the queue has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chBQGetTimeout(byte_queue_t *bqp, systime_t timeout) {
+  msg_t msg;
+
+  chSysLock();
+
+  msg = chBQGetTimeoutS(bqp, timeout);
+
+  chSysUnlock();
+  return msg;
+}
+
+/**
+ * @brief   Byte queue read with timeout.
+ * @details The invoking thread waits until a byte is available in the queue
+ *          or the specified time runs out.
+ *
+ * @param[in] bqp       the pointer to an initialized @p byte_queue_t object
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              A byte value from the queue.
+ * @retval MSG_RESET    if the queue has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @sclass
+ */
+msg_t chBQGetTimeoutS(byte_queue_t *bqp, systime_t timeout) {
+  msg_t msg;
+
+  msg = chSemWaitTimeoutS(&bqp->fullsem, timeout);
+  if (msg == MSG_OK) {
+    msg = (msg_t)*bqp->rdptr++;
+    if (bqp->rdptr >= bqp->top)
+      bqp->rdptr = bqp->buffer;
+    chSemSignalI(&bqp->emptysem);
+    chSchRescheduleS();
+  }
+  return msg;
+}
+
+/**
+ * @brief   Byte queue read.
+ * @details This variant is non-blocking, the function returns a timeout
+ *          condition if the queue is empty.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note that
+ *          interrupt handlers always reschedule on exit so an explicit
+ *          reschedule must not be performed in ISRs.
+ *
+ * @param[in] bqp       the pointer to an initialized @p byte_queue_t object
+ * @return              A byte value from the queue.
+ * @retval MSG_TIMEOUT  if the queue is empty.
+ *
+ * @iclass
+ */
+msg_t chBQGetI(byte_queue_t *bqp) {
+  uint8_t b;
+
+  if (bqp->fullsem.cnt <= 0)
+    return MSG_TIMEOUT;
+  bqp->fullsem.cnt--;
+  b = *bqp->rdptr++;
+  if (bqp->rdptr >= bqp->top)
+    bqp->rdptr = bqp->buffer;
+  chSemSignalI(&bqp->emptysem);
+  return (msg_t)b;
+}
+#endif /* NIL_CFG_USE_QUEUES */
+
+#if NIL_CFG_USE_TASKS || defined(__DOXYGEN__)
+/**
+ * @brief   Tasks server thread.
+ * @details This thread executes the tasks on its own stack, it must be
+ *          declared in the threads table using @p THD_TABLE_TASKS().
+ *
+ * @param[in] arg       not used
+ *
+ * @special
+ */
+void chTaskServer(void *arg) {
+
+  (void)arg;
+
+  chSysLock();
+  nil.tasks_server = nil.current;
+  while (true) {
+    nil_tasks_dispatch();
+    (void) chThdSuspendTimeoutS(&nil.tasks_tr, TIME_INFINITE);
+  }
+}
+
+/**
+ * @brief   Activates a task.
+ * @details The task is executed immediately if its priority is above the
+ *          system ceiling and the tasks server has the highest priority
+ *          among the ready threads, else it is executed as soon as both
+ *          conditions are met.
+ *
+ * @param[in] id        task identifier, its position in the tasks table
+ *
+ * @api
+ */
+void chTaskActivate(unsigned id) {
+
+  chSysLock();
+
+  chTaskActivateI(id);
+  chSchRescheduleS();
+
+  chSysUnlock();
+}
+
+/**
+ * @brief   Activates a task.
+ * @note    Activating an already activated task has no effect, the
+ *          activations are not counted.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note that
+ *          interrupt handlers always reschedule on exit so an explicit
+ *          reschedule must not be performed in ISRs.
+ *
+ * @param[in] id        task identifier, its position in the tasks table
+ *
+ * @iclass
+ */
+void chTaskActivateI(unsigned id) {
+
+  chDbgAssert(id < NIL_CFG_NUM_TASKS, "invalid task");
+
+  nil.tasks_pending |= TASK_MASK(id);
+  if ((nil.tasks_allowed & TASK_MASK(id)) != 0)
+    chThdResumeI(&nil.tasks_tr, MSG_OK);
+}
+
+/**
+ * @brief   Locks a task resource.
+ * @details The system ceiling is raised to the resource ceiling, locking
+ *          never blocks because the tasks that could hold the resource
+ *          cannot be preempted by the caller.
+ * @note    This function can only be invoked from tasks, resources must be
+ *          released in reverse locking order.
+ *
+ * @param[in] rp        pointer to a @p task_resource_t structure
+ *
+ * @api
+ */
+void chTaskResourceLock(task_resource_t *rp) {
+
+  chDbgAssert(nil.current == nil.tasks_server, "not a task");
+
+  chSysLock();
+
+  rp->saved = nil.tasks_allowed;
+  nil.tasks_allowed &= rp->ceiling;
+
+  chSysUnlock();
+}
+
+/**
+ * @brief   Unlocks a task resource.
+ * @details The system ceiling is restored, activated tasks that were held
+ *          by the ceiling preempt the caller immediately.
+ *
+ * @param[in] rp        pointer to a @p task_resource_t structure
+ *
+ * @api
+ */
+void chTaskResourceUnlock(task_resource_t *rp) {
+
+  chDbgAssert(nil.current == nil.tasks_server, "not a task");
+
+  chSysLock();
+
+  chDbgAssert((nil.tasks_allowed & ~rp->ceiling) == 0,
+              "not locked or wrong order");
+
+  nil.tasks_allowed = rp->saved;
+  chSchRescheduleS();
+
+  chSysUnlock();
+}
+#endif /* NIL_CFG_USE_TASKS */
+
 /** @} */
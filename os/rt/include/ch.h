@@ -87,6 +87,7 @@ typedef struct thread thread_t;
 #include "chevents.h"
 #include "chmsg.h"
 #include "chmboxes.h"
+#include "chrings.h"
 #include "chmemcore.h"
 #include "chheap.h"
 #include "chmempools.h"
@@ -65,6 +65,18 @@
 #ifndef CH_DBG_THREAD_FILL_VALUE
 #define CH_DBG_THREAD_FILL_VALUE            0xFF
 #endif
+
+/**
+ * @brief   Simulated time mode.
+ * @details If enabled the system tick is no more generated by the port timer,
+ *          the system time advances only through @p chSysAdvanceTimeI().
+ *          The idle thread advances the time straight to the next virtual
+ *          timer deadline so that sleeping threads are awakened without
+ *          any real delay.
+ */
+#if !defined(CH_DBG_SIMULATED_TIME) || defined(__DOXYGEN__)
+#define CH_DBG_SIMULATED_TIME               FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -78,6 +90,14 @@
 #define CH_DBG_ENABLED              FALSE
 #endif
 
+#if CH_DBG_SIMULATED_TIME && (CH_CFG_ST_TIMEDELTA > 0)
+#error "CH_DBG_SIMULATED_TIME is not compatible with the tickless mode"
+#endif
+
+#if CH_DBG_SIMULATED_TIME && CH_CFG_NO_IDLE_THREAD
+#error "CH_DBG_SIMULATED_TIME requires the idle thread"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -129,8 +149,8 @@ typedef struct {
 /*===========================================================================*/
 
 #if CH_DBG_SYSTEM_STATE_CHECK
-#define _dbg_enter_lock() (ch.dbg_lock_cnt = 1)
-#define _dbg_leave_lock() (ch.dbg_lock_cnt = 0)
+#define _dbg_enter_lock() (currcore->dbg_lock_cnt = 1)
+#define _dbg_leave_lock() (currcore->dbg_lock_cnt = 0)
 #endif
 
 /* When the state checker feature is disabled then the following functions
@@ -64,6 +64,8 @@ struct event_listener {
   eventmask_t           el_mask;        /**< @brief Event identifiers mask. */
   eventflags_t          el_flags;       /**< @brief Flags added to the listener
                                                     by the event source.*/
+  eventflags_t          el_wflags;      /**< @brief Flags that wakeup the
+                                                    listener.               */
 };
 
 /**
@@ -118,9 +120,10 @@ typedef void (*evhandler_t)(eventid_t);
 #ifdef __cplusplus
 extern "C" {
 #endif
-  void chEvtRegisterMask(event_source_t *esp,
-                         event_listener_t *elp,
-                         eventmask_t mask);
+  void chEvtRegisterMaskWithFlags(event_source_t *esp,
+                                  event_listener_t *elp,
+                                  eventmask_t mask,
+                                  eventflags_t wflags);
   void chEvtUnregister(event_source_t *esp, event_listener_t *elp);
   eventmask_t chEvtGetAndClearEvents(eventmask_t mask);
   eventmask_t chEvtAddEvents(eventmask_t mask);
@@ -169,6 +172,27 @@ static inline void chEvtObjectInit(event_source_t *esp) {
   esp->es_next = (event_listener_t *)(void *)esp;
 }
 
+/**
+ * @brief   Registers an Event Listener on an Event Source.
+ * @details Once a thread has registered as listener on an event source it
+ *          will be notified of all events broadcasted there.
+ * @note    Multiple Event Listeners can specify the same bits to be ORed to
+ *          different threads.
+ *
+ * @param[in] esp       pointer to the  @p event_source_t structure
+ * @param[out] elp      pointer to the @p event_listener_t structure
+ * @param[in] mask      the mask of event flags to be ORed to the thread when
+ *                      the event source is broadcasted
+ *
+ * @api
+ */
+static inline void chEvtRegisterMask(event_source_t *esp,
+                                     event_listener_t *elp,
+                                     eventmask_t mask) {
+
+  chEvtRegisterMaskWithFlags(esp, elp, mask, (eventflags_t)-1);
+}
+
 /**
  * @brief   Registers an Event Listener on an Event Source.
  * @note    Multiple Event Listeners can use the same event identifier, the
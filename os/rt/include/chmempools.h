@@ -29,6 +29,10 @@
 #ifndef _CHMEMPOOLS_H_
 #define _CHMEMPOOLS_H_
 
+#if CH_CFG_USE_POOLCACHES && !CH_CFG_USE_MEMPOOLS
+#error "CH_CFG_USE_POOLCACHES requires CH_CFG_USE_MEMPOOLS"
+#endif
+
 #if CH_CFG_USE_MEMPOOLS || defined(__DOXYGEN__)
 
 /*===========================================================================*/
@@ -43,10 +47,24 @@
 #error "CH_CFG_USE_MEMPOOLS requires CH_CFG_USE_MEMCORE"
 #endif
 
+/**
+ * @brief   Default number of objects held by a pool cache.
+ * @details When a cache is found full on release half of its objects are
+ *          returned to the pool, when it is found empty on allocation it
+ *          is refilled with half of its capacity.
+ */
+#if !defined(CH_CFG_POOLCACHE_SIZE) || defined(__DOXYGEN__)
+#define CH_CFG_POOLCACHE_SIZE               8
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if CH_CFG_POOLCACHE_SIZE < 2
+#error "invalid CH_CFG_POOLCACHE_SIZE value"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -70,6 +88,32 @@ typedef struct {
                                                     for this pool.          */
 } memory_pool_t;
 
+#if CH_CFG_USE_POOLCACHES || defined(__DOXYGEN__)
+/**
+ * @brief   Memory pool cache descriptor.
+ * @details A pool cache is a small stack of free objects owned by a single
+ *          thread, allocations and releases are served from the cache
+ *          without entering the kernel, the pool is accessed in batches
+ *          only when the cache is found empty or full.
+ * @note    The cache stays linked to the owner thread until it is disposed
+ *          or the thread exits, it must not be allocated in a stack frame
+ *          that could end before.
+ */
+typedef struct pool_cache {
+  struct pool_cache     *pc_next;       /**< @brief Next cache owned by the
+                                                    same thread.            */
+  memory_pool_t         *pc_pool;       /**< @brief Underlying pool.        */
+  struct pool_header    *pc_objs;       /**< @brief Cached free objects.    */
+  cnt_t                 pc_cnt;         /**< @brief Number of cached
+                                                    objects.                */
+  cnt_t                 pc_size;        /**< @brief Cache capacity.         */
+  uint32_t              pc_hits;        /**< @brief Operations served by
+                                                    the cache.              */
+  uint32_t              pc_misses;      /**< @brief Operations that
+                                                    accessed the pool.      */
+} pool_cache_t;
+#endif /* CH_CFG_USE_POOLCACHES */
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
@@ -112,6 +156,15 @@ extern "C" {
   void *chPoolAlloc(memory_pool_t *mp);
   void chPoolFreeI(memory_pool_t *mp, void *objp);
   void chPoolFree(memory_pool_t *mp, void *objp);
+#if CH_CFG_USE_POOLCACHES
+  void chPoolCacheObjectInit(pool_cache_t *pcp, memory_pool_t *mp,
+                             cnt_t size);
+  void *chPoolCacheAlloc(pool_cache_t *pcp);
+  void chPoolCacheFree(pool_cache_t *pcp, void *objp);
+  void chPoolCacheFlush(pool_cache_t *pcp);
+  void chPoolCacheDispose(pool_cache_t *pcp);
+  void _pool_caches_release(thread_t *tp);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -162,6 +215,56 @@ static inline void chPoolAddI(memory_pool_t *mp, void *objp) {
   chPoolFreeI(mp, objp);
 }
 
+#if CH_CFG_USE_POOLCACHES || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the number of operations served by a pool cache.
+ *
+ * @param[in] pcp       pointer to a @p pool_cache_t structure
+ * @return              The number of cache hits.
+ *
+ * @xclass
+ */
+static inline uint32_t chPoolCacheGetHitsX(pool_cache_t *pcp) {
+
+  return pcp->pc_hits;
+}
+
+/**
+ * @brief   Returns the number of operations that accessed the pool.
+ *
+ * @param[in] pcp       pointer to a @p pool_cache_t structure
+ * @return              The number of cache misses.
+ *
+ * @xclass
+ */
+static inline uint32_t chPoolCacheGetMissesX(pool_cache_t *pcp) {
+
+  return pcp->pc_misses;
+}
+
+/**
+ * @brief   Returns the hit rate of a pool cache.
+ *
+ * @param[in] pcp       pointer to a @p pool_cache_t structure
+ * @return              The hit rate in percent.
+ * @retval 0            if the cache has never been used.
+ *
+ * @xclass
+ */
+static inline unsigned chPoolCacheGetHitRateX(pool_cache_t *pcp) {
+  uint32_t hits = pcp->pc_hits, misses = pcp->pc_misses;
+
+  /* Scaling down in order to not overflow the multiplication.*/
+  while ((hits > 0x01000000U) || (misses > 0x01000000U)) {
+    hits >>= 1;
+    misses >>= 1;
+  }
+  if (hits + misses == 0)
+    return 0;
+  return (unsigned)((hits * 100U) / (hits + misses));
+}
+#endif /* CH_CFG_USE_POOLCACHES */
+
 #endif /* CH_CFG_USE_MEMPOOLS */
 
 #endif /* _CHMEMPOOLS_H_ */
@@ -90,7 +90,7 @@ typedef struct {
  *
  * @api
  */
-#define chRegSetThreadName(p) (ch.rlist.r_current->p_name = (p))
+#define chRegSetThreadName(p) (currcore->rlist.r_current->p_name = (p))
 /** @} */
 #else /* !CH_CFG_USE_REGISTRY */
 #define chRegSetThreadName(p)
@@ -115,9 +115,9 @@ typedef struct {
  * @param[in] tp        thread to add to the registry
  */
 #define REG_INSERT(tp) {                                                    \
-  (tp)->p_newer = (thread_t *)&ch.rlist;                                    \
-  (tp)->p_older = ch.rlist.r_older;                                         \
-  (tp)->p_older->p_newer = ch.rlist.r_older = (tp);                         \
+  (tp)->p_newer = (thread_t *)&currcore->rlist;                             \
+  (tp)->p_older = currcore->rlist.r_older;                                  \
+  (tp)->p_older->p_newer = currcore->rlist.r_older = (tp);                  \
 }
 
 /*===========================================================================*/
@@ -130,6 +130,9 @@ extern "C" {
   extern ROMCONST chdebug_t ch_debug;
   thread_t *chRegFirstThread(void);
   thread_t *chRegNextThread(thread_t *tp);
+#if (CH_DBG_FILL_THREADS && CH_DBG_ENABLE_STACK_CHECK) || defined(__DOXYGEN__)
+  size_t chRegGetStackUnusedX(thread_t *tp);
+#endif
 #ifdef __cplusplus
 }
 #endif
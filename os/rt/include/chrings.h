@@ -0,0 +1,324 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    chrings.h
+ * @brief   Lock-free ring buffers macros and structures.
+ *
+ * @addtogroup ring_buffers
+ * @{
+ */
+
+#ifndef _CHRINGS_H_
+#define _CHRINGS_H_
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Ring buffers APIs.
+ * @details If enabled then the lock-free ring buffers APIs are included
+ *          in the kernel.
+ *
+ * @note    The default is @p TRUE.
+ */
+#if !defined(CH_CFG_USE_RINGBUFFERS) || defined(__DOXYGEN__)
+#define CH_CFG_USE_RINGBUFFERS              TRUE
+#endif
+
+#if CH_CFG_USE_RINGBUFFERS || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/**
+ * @brief   Atomic compare-and-swap support in the port layer.
+ * @details Ports not exporting @p port_atomic_cas() fall back on a short
+ *          critical zone in the multiple producers ring buffers.
+ */
+#if !defined(PORT_SUPPORTS_ATOMIC_CAS) || defined(__DOXYGEN__)
+#define PORT_SUPPORTS_ATOMIC_CAS            FALSE
+#endif
+
+/**
+ * @brief   Memory barrier used when publishing objects.
+ * @details Ports can export their own @p port_memory_barrier() macro, the
+ *          default is a compiler-only barrier which is enough on single core
+ *          architectures.
+ */
+#if !defined(port_memory_barrier) || defined(__DOXYGEN__)
+#if defined(__GNUC__) || defined(__DOXYGEN__)
+#define port_memory_barrier() __asm__ volatile ("" : : : "memory")
+#else
+#error "port_memory_barrier() not defined by the port"
+#endif
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Structure representing a single producer, single consumer, ring
+ *          buffer.
+ * @note    The write counter is only modified by the producer and the read
+ *          counter is only modified by the consumer, no critical zones are
+ *          required on either side.
+ */
+typedef struct {
+  uint8_t               *rb_buffer;     /**< @brief Pointer to the objects
+                                                    buffer.                 */
+  size_t                rb_objsize;     /**< @brief Size of a single object. */
+  uint32_t              rb_mask;        /**< @brief Number of objects minus
+                                                    one.                    */
+  volatile uint32_t     rb_wrcnt;       /**< @brief Free running write
+                                                    counter.                */
+  volatile uint32_t     rb_rdcnt;       /**< @brief Free running read
+                                                    counter.                */
+  thread_reference_t    rb_thread;      /**< @brief Waiting consumer or
+                                                    @p NULL.                */
+} ring_buffer_t;
+
+/**
+ * @brief   Structure representing a multiple producers, single consumer,
+ *          ring buffer.
+ * @details Each object slot has an associated sequence counter, producers
+ *          reserve slots by atomically advancing the write counter and
+ *          publish them by advancing the slot sequence counter. A producer
+ *          preempted between reserve and commit never blocks the other
+ *          producers, the consumer just sees the reserved slot as not yet
+ *          available.
+ * @note    The sequence counters are stored relative to the slot index so
+ *          a zero-filled array is a valid initial state, this allows static
+ *          initialization.
+ */
+typedef struct {
+  uint8_t               *mprb_buffer;   /**< @brief Pointer to the objects
+                                                    buffer.                 */
+  volatile uint32_t     *mprb_seq;      /**< @brief Pointer to the sequence
+                                                    counters array.         */
+  size_t                mprb_objsize;   /**< @brief Size of a single object. */
+  uint32_t              mprb_mask;      /**< @brief Number of objects minus
+                                                    one.                    */
+  volatile uint32_t     mprb_wrcnt;     /**< @brief Free running reservation
+                                                    counter.                */
+  volatile uint32_t     mprb_rdcnt;     /**< @brief Free running read
+                                                    counter.                */
+  thread_reference_t    mprb_thread;    /**< @brief Waiting consumer or
+                                                    @p NULL.                */
+} mp_ring_buffer_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Data part of a static ring buffer initializer.
+ * @details This macro should be used when statically initializing a
+ *          ring buffer that is part of a bigger structure.
+ *
+ * @param[in] name      the name of the ring buffer variable
+ * @param[in] buffer    pointer to the objects buffer
+ * @param[in] objsize   size of a single object
+ * @param[in] n         number of objects in the buffer, must be a power of
+ *                      two greater than one
+ */
+#define _RING_BUFFER_DATA(name, buffer, objsize, n) {                       \
+  (uint8_t *)(buffer),                                                      \
+  (objsize),                                                                \
+  (uint32_t)(n) - 1,                                                        \
+  0,                                                                        \
+  0,                                                                        \
+  NULL                                                                      \
+}
+
+/**
+ * @brief   Static ring buffer initializer.
+ * @details Statically initialized ring buffers require no explicit
+ *          initialization using @p chRBObjectInit().
+ *
+ * @param[in] name      the name of the ring buffer variable
+ * @param[in] buffer    pointer to the objects buffer
+ * @param[in] objsize   size of a single object
+ * @param[in] n         number of objects in the buffer, must be a power of
+ *                      two greater than one
+ */
+#define RING_BUFFER_DECL(name, buffer, objsize, n)                          \
+  ring_buffer_t name = _RING_BUFFER_DATA(name, buffer, objsize, n)
+
+/**
+ * @brief   Data part of a static multiple producers ring buffer initializer.
+ * @details This macro should be used when statically initializing a
+ *          ring buffer that is part of a bigger structure.
+ *
+ * @param[in] name      the name of the ring buffer variable
+ * @param[in] buffer    pointer to the objects buffer
+ * @param[in] seq       pointer to a zero-filled array of @p n @p uint32_t
+ *                      sequence counters
+ * @param[in] objsize   size of a single object
+ * @param[in] n         number of objects in the buffer, must be a power of
+ *                      two greater than one
+ */
+#define _MP_RING_BUFFER_DATA(name, buffer, seq, objsize, n) {               \
+  (uint8_t *)(buffer),                                                      \
+  (seq),                                                                    \
+  (objsize),                                                                \
+  (uint32_t)(n) - 1,                                                        \
+  0,                                                                        \
+  0,                                                                        \
+  NULL                                                                      \
+}
+
+/**
+ * @brief   Static multiple producers ring buffer initializer.
+ * @details Statically initialized ring buffers require no explicit
+ *          initialization using @p chMPRBObjectInit().
+ *
+ * @param[in] name      the name of the ring buffer variable
+ * @param[in] buffer    pointer to the objects buffer
+ * @param[in] seq       pointer to a zero-filled array of @p n @p uint32_t
+ *                      sequence counters
+ * @param[in] objsize   size of a single object
+ * @param[in] n         number of objects in the buffer, must be a power of
+ *                      two greater than one
+ */
+#define MP_RING_BUFFER_DECL(name, buffer, seq, objsize, n)                  \
+  mp_ring_buffer_t name = _MP_RING_BUFFER_DATA(name, buffer, seq, objsize, n)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chRBObjectInit(ring_buffer_t *rbp, void *buffer,
+                      size_t objsize, size_t n);
+  size_t chRBReserveX(ring_buffer_t *rbp, void **objpp, size_t n);
+  void chRBCommitX(ring_buffer_t *rbp, size_t n);
+  msg_t chRBPutX(ring_buffer_t *rbp, const void *objp);
+  size_t chRBFetchX(ring_buffer_t *rbp, void **objpp, size_t n);
+  void chRBReleaseX(ring_buffer_t *rbp, size_t n);
+  msg_t chRBGetX(ring_buffer_t *rbp, void *objp);
+  msg_t chRBWaitTimeout(ring_buffer_t *rbp, systime_t time);
+  void chMPRBObjectInit(mp_ring_buffer_t *mprbp, void *buffer,
+                        uint32_t *seq, size_t objsize, size_t n);
+  size_t chMPRBReserveX(mp_ring_buffer_t *mprbp, void **objpp, size_t n);
+  void chMPRBCommitX(mp_ring_buffer_t *mprbp, void *objp, size_t n);
+  msg_t chMPRBPutX(mp_ring_buffer_t *mprbp, const void *objp);
+  size_t chMPRBFetchX(mp_ring_buffer_t *mprbp, void **objpp, size_t n);
+  void chMPRBReleaseX(mp_ring_buffer_t *mprbp, size_t n);
+  msg_t chMPRBGetX(mp_ring_buffer_t *mprbp, void *objp);
+  msg_t chMPRBWaitTimeout(mp_ring_buffer_t *mprbp, systime_t time);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the number of objects in a ring buffer.
+ * @note    The value can change after reading if invoked out of a locked
+ *          state.
+ *
+ * @param[in] rbp       pointer to the @p ring_buffer_t structure
+ * @return              The number of objects in the ring buffer.
+ *
+ * @xclass
+ */
+static inline size_t chRBGetUsedCountX(ring_buffer_t *rbp) {
+
+  return (size_t)(rbp->rb_wrcnt - rbp->rb_rdcnt);
+}
+
+/**
+ * @brief   Returns the number of free object slots in a ring buffer.
+ * @note    The value can change after reading if invoked out of a locked
+ *          state.
+ *
+ * @param[in] rbp       pointer to the @p ring_buffer_t structure
+ * @return              The number of free slots in the ring buffer.
+ *
+ * @xclass
+ */
+static inline size_t chRBGetFreeCountX(ring_buffer_t *rbp) {
+
+  return (size_t)(rbp->rb_mask + 1) - chRBGetUsedCountX(rbp);
+}
+
+/**
+ * @brief   Evaluates to @p true if the specified ring buffer is empty.
+ *
+ * @param[in] rbp       pointer to the @p ring_buffer_t structure
+ * @return              The ring buffer status.
+ *
+ * @xclass
+ */
+static inline bool chRBIsEmptyX(ring_buffer_t *rbp) {
+
+  return (bool)(rbp->rb_wrcnt == rbp->rb_rdcnt);
+}
+
+/**
+ * @brief   Returns the number of reserved or committed objects in a
+ *          multiple producers ring buffer.
+ * @note    The value can change after reading if invoked out of a locked
+ *          state.
+ * @note    Reserved objects not yet committed are counted as used.
+ *
+ * @param[in] mprbp     pointer to the @p mp_ring_buffer_t structure
+ * @return              The number of objects in the ring buffer.
+ *
+ * @xclass
+ */
+static inline size_t chMPRBGetUsedCountX(mp_ring_buffer_t *mprbp) {
+
+  return (size_t)(mprbp->mprb_wrcnt - mprbp->mprb_rdcnt);
+}
+
+/**
+ * @brief   Evaluates to @p true if the next object to be read from a
+ *          multiple producers ring buffer has not been committed yet.
+ *
+ * @param[in] mprbp     pointer to the @p mp_ring_buffer_t structure
+ * @return              The ring buffer status.
+ *
+ * @xclass
+ */
+static inline bool chMPRBIsEmptyX(mp_ring_buffer_t *mprbp) {
+  uint32_t cnt = mprbp->mprb_rdcnt;
+
+  return (bool)(mprbp->mprb_seq[cnt & mprbp->mprb_mask] !=
+                (cnt & ~mprbp->mprb_mask) + 1);
+}
+
+#endif /* CH_CFG_USE_RINGBUFFERS */
+
+#endif /* _CHRINGS_H_ */
+
+/** @} */
@@ -60,10 +60,81 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Per-thread memory pool caches.
+ * @details If enabled then threads can keep private caches of free objects
+ *          layered on memory pools, see @p pool_cache_t.
+ * @note    The option is handled here because it affects the @p thread_t
+ *          structure.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_POOLCACHES) || defined(__DOXYGEN__)
+#define CH_CFG_USE_POOLCACHES               FALSE
+#endif
+
+/**
+ * @brief   SMP mode.
+ * @details If enabled the kernel keeps a separate @p ch_system_t instance
+ *          for each core, each core has its own ready list, virtual timers
+ *          list, main thread and idle thread. Threads are bound to the core
+ *          that created them, a thread made ready by another core is
+ *          inserted in the ready list of its own core and the owner core
+ *          is notified using an inter-core interrupt. The kernel lock is
+ *          extended with a spinlock shared by all the cores so the
+ *          synchronization objects can be shared.
+ * @note    Ports not supporting multiple cores, see @p PORT_SUPPORTS_SMP,
+ *          run this mode on a single core.
+ * @note    The option is handled here because it affects the @p thread_t
+ *          structure.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_SMP_MODE) || defined(__DOXYGEN__)
+#define CH_CFG_SMP_MODE                     FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+/**
+ * @brief   Hot code specifier.
+ * @details Ports can define this macro in order to place the kernel critical
+ *          paths, the scheduler and the system tick handling, in a faster
+ *          memory. The default is to leave the code in its normal section.
+ */
+#if !defined(PORT_HOT_CODE) || defined(__DOXYGEN__)
+#define PORT_HOT_CODE
+#endif
+
+/**
+ * @brief   System data specifier.
+ * @details Ports can define this macro in order to place the
+ *          @p ch_system_t structure in a faster memory, the memory must be
+ *          zeroed by the startup code like the BSS segment.
+ */
+#if !defined(PORT_SYSTEM_DATA) || defined(__DOXYGEN__)
+#define PORT_SYSTEM_DATA
+#endif
+
+#if !defined(PORT_SUPPORTS_SMP)
+#define PORT_SUPPORTS_SMP                   FALSE
+#endif
+
+/* Ports without multiple cores support can run the SMP mode on a single
+   core, the SMP code paths can then be tested on any target.*/
+#if CH_CFG_SMP_MODE && !PORT_SUPPORTS_SMP
+#if defined(PORT_CORES_NUMBER) && (PORT_CORES_NUMBER != 1)
+#error "CH_CFG_SMP_MODE requires a port supporting multiple cores"
+#endif
+#if !defined(PORT_CORES_NUMBER)
+#define PORT_CORES_NUMBER                   1
+#endif
+#define port_get_core_id()                  0U
+#define port_spin_lock()
+#define port_spin_unlock()
+#define port_notify_core(core)              (void)(core)
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -150,6 +221,12 @@ struct thread {
    * @brief Various thread flags.
    */
   tmode_t               p_flags;
+#if CH_CFG_SMP_MODE || defined(__DOXYGEN__)
+  /**
+   * @brief Instance of the core owning the thread.
+   */
+  struct ch_system      *p_core;
+#endif
 #if CH_CFG_USE_DYNAMIC || defined(__DOXYGEN__)
   /**
    * @brief References to this thread.
@@ -244,8 +321,25 @@ struct thread {
    */
   void                  *p_mpool;
 #endif
+#if CH_CFG_USE_POOLCACHES || defined(__DOXYGEN__)
+  /**
+   * @brief List of the memory pool caches owned by this thread.
+   * @note  The list is terminated by a @p NULL in this field.
+   */
+  struct pool_cache     *p_pcaches;
+#endif
 #if CH_DBG_STATISTICS || defined(__DOXYGEN__)
   time_measurement_t    p_stats;
+#if CH_DBG_STATS_HISTOGRAMS || defined(__DOXYGEN__)
+  /**
+   * @brief Time stamp of the last wakeup.
+   */
+  rtcnt_t               p_readyts;
+  /**
+   * @brief Wakeup pending measurement flag.
+   */
+  bool                  p_readymark;
+#endif
 #endif
 #if defined(CH_CFG_THREAD_EXTRA_FIELDS)
   /* Extra fields defined in chconf.h.*/
@@ -306,6 +400,8 @@ typedef struct {
  * @brief   System data structure.
  * @note    This structure contain all the data areas used by the OS except
  *          stacks.
+ * @note    In SMP mode there is an instance of this structure for each
+ *          core.
  */
 typedef struct ch_system {
   /**
@@ -367,6 +463,28 @@ typedef struct ch_system {
  */
 #define firstprio(rlp)  ((rlp)->p_next->p_prio)
 
+#if CH_CFG_SMP_MODE || defined(__DOXYGEN__)
+/**
+ * @brief   Pointer to the system data of the current core.
+ * @details The kernel code accesses the system data through this macro,
+ *          in SMP mode it selects the instance of the executing core else
+ *          it points to the single @p ch instance.
+ *
+ * @notapi
+ */
+#define currcore (&ch_cores[port_get_core_id()])
+
+/**
+ * @brief   Checks if a thread is owned by the current core.
+ *
+ * @notapi
+ */
+#define _sch_is_local(tp) ((tp)->p_core == currcore)
+#else
+#define currcore (&ch)
+#define _sch_is_local(tp) true
+#endif
+
 /**
  * @brief   Current thread pointer access macro.
  * @note    This macro is not meant to be used in the application code but
@@ -374,7 +492,7 @@ typedef struct ch_system {
  * @note    It is forbidden to use this macro in order to change the pointer
  *          (currp = something), use @p setcurrp() instead.
  */
-#define currp ch.rlist.r_current
+#define currp currcore->rlist.r_current
 
 /**
  * @brief   Current thread pointer change macro.
@@ -390,8 +508,12 @@ typedef struct ch_system {
 /*===========================================================================*/
 
 #if !defined(__DOXYGEN__)
+#if CH_CFG_SMP_MODE
+extern ch_system_t ch_cores[PORT_CORES_NUMBER];
+#else
 extern ch_system_t ch;
 #endif
+#endif
 
 /*
  * Scheduler APIs.
@@ -401,6 +523,7 @@ extern "C" {
 #endif
   void _scheduler_init(void);
   thread_t *chSchReadyI(thread_t *tp);
+  void chSchReadyListI(threads_list_t *tlp);
   void chSchGoSleepS(tstate_t newstate);
   msg_t chSchGoSleepTimeoutS(tstate_t newstate, systime_t time);
   void chSchWakeupS(thread_t *tp, msg_t msg);
@@ -544,7 +667,7 @@ static inline bool chSchIsRescRequiredI(void) {
 
   chDbgCheckClassI();
 
-  return firstprio(&ch.rlist.r_queue) > currp->p_prio;
+  return firstprio(&currcore->rlist.r_queue) > currp->p_prio;
 }
 
 /**
@@ -558,7 +681,7 @@ static inline bool chSchCanYieldS(void) {
 
   chDbgCheckClassI();
 
-  return firstprio(&ch.rlist.r_queue) >= currp->p_prio;
+  return firstprio(&currcore->rlist.r_queue) >= currp->p_prio;
 }
 
 /**
@@ -584,7 +707,7 @@ static inline void chSchDoYieldS(void) {
  * @special
  */
 static inline void chSchPreemption(void) {
-  tprio_t p1 = firstprio(&ch.rlist.r_queue);
+  tprio_t p1 = firstprio(&currcore->rlist.r_queue);
   tprio_t p2 = currp->p_prio;
 
 #if CH_CFG_TIME_QUANTUM > 0
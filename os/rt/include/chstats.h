@@ -35,10 +35,91 @@
 /* Module constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @name    Statistics records identifiers
+ * @{
+ */
+#define STATS_ID_CRIT_THD           0U  /**< @brief Threads critical zones. */
+#define STATS_ID_CRIT_ISR           1U  /**< @brief ISRs critical zones.    */
+#define STATS_ID_RESCHED            2U  /**< @brief Reschedule latency.     */
+#define STATS_ID_IRQ_BASE           3U  /**< @brief First IRQ vector.       */
+#define STATS_ID_END                0xFFFFFFFFU /**< @brief Export end.     */
+/** @} */
+
+/**
+ * @brief   Binary export magic number, "CHS1" in memory order.
+ */
+#define STATS_EXPORT_MAGIC          0x31534843U
+
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Per-vector IRQ statistics.
+ * @details If enabled the number of invocations, the duration and a
+ *          duration histogram are collected for each interrupt vector
+ *          served through @p CH_IRQ_PROLOGUE() and @p CH_IRQ_EPILOGUE().
+ * @note    The duration includes the time spent in nested interrupts.
+ * @note    Requires port support, the port must export the
+ *          @p PORT_IRQ_VECTORS_NUMBER constant and the
+ *          @p port_get_irq_vector() function.
+ */
+#if !defined(CH_DBG_IRQ_STATISTICS) || defined(__DOXYGEN__)
+#define CH_DBG_IRQ_STATISTICS               FALSE
+#endif
+
+/**
+ * @brief   Kernel durations histograms.
+ * @details If enabled then duration histograms are collected for the
+ *          threads and ISRs critical zones and for the reschedule latency,
+ *          the callers of the longest critical zones are also recorded.
+ * @note    The reschedule latency is the time between a waiting thread
+ *          being made ready and the thread being switched in.
+ */
+#if !defined(CH_DBG_STATS_HISTOGRAMS) || defined(__DOXYGEN__)
+#define CH_DBG_STATS_HISTOGRAMS             FALSE
+#endif
+
+/* Compatibility with the former per-vector IRQ histogram settings.*/
+#if !defined(CH_DBG_HISTOGRAM_BINS) && defined(CH_DBG_IRQ_HISTOGRAM_BINS)
+#define CH_DBG_HISTOGRAM_BINS               CH_DBG_IRQ_HISTOGRAM_BINS
+#endif
+#if !defined(CH_DBG_HISTOGRAM_SHIFT) && defined(CH_DBG_IRQ_HISTOGRAM_SHIFT)
+#define CH_DBG_HISTOGRAM_SHIFT              CH_DBG_IRQ_HISTOGRAM_SHIFT
+#endif
+
+/**
+ * @brief   Number of bins in the duration histograms.
+ * @note    The former @p CH_DBG_IRQ_HISTOGRAM_BINS setting is still
+ *          accepted as an alias.
+ */
+#if !defined(CH_DBG_HISTOGRAM_BINS) || defined(__DOXYGEN__)
+#define CH_DBG_HISTOGRAM_BINS               8
+#endif
+
+/**
+ * @brief   Scale of the duration histograms.
+ * @details The first bin counts durations below 2^N realtime counter
+ *          cycles, each following bin covers twice the range of the
+ *          previous one, the last bin counts all the longer durations.
+ */
+#if !defined(CH_DBG_HISTOGRAM_SHIFT) || defined(__DOXYGEN__)
+#define CH_DBG_HISTOGRAM_SHIFT              5
+#endif
+
+/**
+ * @name    Deprecated settings aliases
+ * @{
+ */
+#if !defined(CH_DBG_IRQ_HISTOGRAM_BINS) || defined(__DOXYGEN__)
+#define CH_DBG_IRQ_HISTOGRAM_BINS           CH_DBG_HISTOGRAM_BINS
+#endif
+#if !defined(CH_DBG_IRQ_HISTOGRAM_SHIFT) || defined(__DOXYGEN__)
+#define CH_DBG_IRQ_HISTOGRAM_SHIFT          CH_DBG_HISTOGRAM_SHIFT
+#endif
+/** @} */
+
 #if !CH_CFG_USE_TM
 #error "CH_DBG_STATISTICS requires CH_CFG_USE_TM"
 #endif
@@ -47,10 +128,51 @@
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if CH_DBG_IRQ_STATISTICS && !defined(PORT_IRQ_VECTORS_NUMBER)
+#error "CH_DBG_IRQ_STATISTICS not supported by this port"
+#endif
+
+#if CH_DBG_HISTOGRAM_BINS < 2
+#error "invalid CH_DBG_HISTOGRAM_BINS value"
+#endif
+
+#if (CH_DBG_IRQ_HISTOGRAM_BINS != CH_DBG_HISTOGRAM_BINS) ||                \
+    (CH_DBG_IRQ_HISTOGRAM_SHIFT != CH_DBG_HISTOGRAM_SHIFT)
+#error "conflicting CH_DBG_IRQ_HISTOGRAM_xxx and CH_DBG_HISTOGRAM_xxx"
+#endif
+
+/**
+ * @brief   Number of statistics records.
+ */
+#if CH_DBG_IRQ_STATISTICS || defined(__DOXYGEN__)
+#define STATS_RECORDS_NUMBER                                                \
+  (STATS_ID_IRQ_BASE + PORT_IRQ_VECTORS_NUMBER)
+#else
+#define STATS_RECORDS_NUMBER        STATS_ID_IRQ_BASE
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Type of a logarithmic duration histogram.
+ */
+typedef struct {
+  ucnt_t                bins[CH_DBG_HISTOGRAM_BINS];
+} stats_histogram_t;
+
+#if CH_DBG_IRQ_STATISTICS || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a per-vector IRQ statistics structure.
+ */
+typedef struct {
+  time_measurement_t    m_isr;      /**< @brief Measurement of the ISR
+                                                duration.                   */
+  stats_histogram_t     hist;       /**< @brief ISR duration histogram.     */
+} irq_stats_t;
+#endif
+
 /**
  * @brief   Type of a kernel statistics structure.
  */
@@ -61,12 +183,93 @@ typedef struct {
                                                 critical zones duration.    */
   time_measurement_t    m_crit_isr; /**< @brief Measurement of ISRs critical
                                                 zones duration.             */
+#if CH_DBG_STATS_HISTOGRAMS || defined(__DOXYGEN__)
+  time_measurement_t    m_resched;  /**< @brief Measurement of the
+                                                reschedule latency.         */
+  stats_histogram_t     h_crit_thd; /**< @brief Threads critical zones
+                                                histogram.                  */
+  stats_histogram_t     h_crit_isr; /**< @brief ISRs critical zones
+                                                histogram.                  */
+  stats_histogram_t     h_resched;  /**< @brief Reschedule latency
+                                                histogram.                  */
+  void                  *c_crit_thd;/**< @brief Caller of the longest
+                                                thread critical zone.       */
+  void                  *c_crit_isr;/**< @brief Caller of the longest ISR
+                                                critical zone.              */
+  void                  *c_thd;     /**< @brief Caller of the thread
+                                                critical zone in progress.  */
+  void                  *c_isr;     /**< @brief Caller of the ISR critical
+                                                zone in progress.           */
+#endif
+#if CH_DBG_IRQ_STATISTICS || defined(__DOXYGEN__)
+  irq_stats_t           irq[PORT_IRQ_VECTORS_NUMBER];
+                                    /**< @brief Per-vector IRQ statistics,
+                                                indexed by the port vector
+                                                number.                     */
+#endif
 } kernel_stats_t;
 
+/**
+ * @brief   Type of a statistics record.
+ * @details Consistent copy of one measurement, it is also the unit of the
+ *          binary export. The fields are in the target native byte order,
+ *          the layout is:
+ *          - offset 0, @p cumulative, 64 bits.
+ *          - offset 8, @p id, @p n, @p best, @p worst, @p last and
+ *            @p caller, 32 bits each.
+ *          - offset 32, @p hist, 32 bits for each of the
+ *            @p CH_DBG_HISTOGRAM_BINS bins.
+ *          .
+ *          The record size is padded to the alignment of the 64 bits
+ *          field, 8 bytes on most 32 bits targets, the bin
+ *          @p i counts the durations below 2^(shift + i) cycles, the last
+ *          bin counts all the longer durations.
+ */
+typedef struct {
+  uint64_t              cumulative; /**< @brief Cumulative duration.        */
+  uint32_t              id;         /**< @brief Record identifier.          */
+  uint32_t              n;          /**< @brief Number of measurements.     */
+  uint32_t              best;       /**< @brief Best duration.              */
+  uint32_t              worst;      /**< @brief Worst duration.             */
+  uint32_t              last;       /**< @brief Last duration.              */
+  uint32_t              caller;     /**< @brief Caller of the worst case or
+                                                zero if not recorded.       */
+  uint32_t              hist[CH_DBG_HISTOGRAM_BINS];
+                                    /**< @brief Duration histogram, all
+                                                zero if not collected.      */
+} stats_record_t;
+
+/**
+ * @brief   Type of the binary export header.
+ * @details The header is followed by the records with at least one
+ *          measurement and by a record with identifier @p STATS_ID_END.
+ *          The 8 bytes header layout is:
+ *          - offset 0, @p magic, 32 bits, it also identifies the byte
+ *            order of the export.
+ *          - offset 4, @p bins and @p shift, 16 bits each.
+ *          .
+ *          The decoder in @p tools/stats/stats.py prints an export.
+ */
+typedef struct {
+  uint32_t              magic;      /**< @brief @p STATS_EXPORT_MAGIC.      */
+  uint16_t              bins;       /**< @brief Histogram bins.             */
+  uint16_t              shift;      /**< @brief Histogram scale.            */
+} stats_export_header_t;
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
 
+/**
+ * @brief   Return address of the invoking function.
+ * @note    The functions using this macro must not be inlined.
+ */
+#if defined(__GNUC__) || defined(__DOXYGEN__)
+#define _stats_get_caller() __builtin_return_address(0)
+#else
+#define _stats_get_caller() NULL
+#endif
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -81,6 +284,13 @@ extern "C" {
   void _stats_stop_measure_crit_thd(void);
   void _stats_start_measure_crit_isr(void);
   void _stats_stop_measure_crit_isr(void);
+#if CH_DBG_IRQ_STATISTICS
+  void _stats_stop_measure_irq(void);
+#endif
+#if CH_DBG_STATS_HISTOGRAMS
+  void _stats_ready(thread_t *tp);
+#endif
+  bool chStatsGetRecord(uint32_t id, stats_record_t *srp);
 #ifdef __cplusplus
 }
 #endif
@@ -89,6 +299,14 @@ extern "C" {
 /* Module inline functions.                                                  */
 /*===========================================================================*/
 
+#if !CH_DBG_IRQ_STATISTICS
+#define _stats_stop_measure_irq()
+#endif
+
+#if !CH_DBG_STATS_HISTOGRAMS
+#define _stats_ready(tp)
+#endif
+
 #else /* !CH_DBG_STATISTICS */
 
 /* Stub functions for when the statistics module is disabled. */
@@ -98,6 +316,8 @@ extern "C" {
 #define _stats_stop_measure_crit_thd()
 #define _stats_start_measure_crit_isr()
 #define _stats_stop_measure_crit_isr()
+#define _stats_stop_measure_irq()
+#define _stats_ready(tp)
 
 #endif /* !CH_DBG_STATISTICS */
 
@@ -73,6 +73,7 @@
  * @special
  */
 #define CH_IRQ_EPILOGUE()                                                   \
+  _stats_stop_measure_irq();                                                \
   _dbg_check_leave_isr();                                                   \
   PORT_IRQ_EPILOGUE()
 
@@ -202,6 +203,19 @@
 #define chSysGetRealtimeCounterX() (rtcnt_t)port_rt_get_counter_value()
 #endif
 
+#if CH_CFG_SMP_MODE || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the identifier of the current core.
+ * @note    This function is only available in SMP mode.
+ *
+ * @return              The core identifier, from zero to
+ *                      @p PORT_CORES_NUMBER - 1.
+ *
+ * @xclass
+ */
+#define chSysGetCoreIdX() port_get_core_id()
+#endif
+
 /**
  * @brief   Performs a context switch.
  * @note    Not a user function, it is meant to be invoked by the scheduler
@@ -228,8 +242,14 @@
 extern "C" {
 #endif
   void chSysInit(void);
+#if CH_CFG_SMP_MODE
+  void chSysInitCore(void);
+#endif
   void chSysHalt(const char *reason);
   void chSysTimerHandlerI(void);
+#if CH_DBG_SIMULATED_TIME
+  systime_t chSysAdvanceTimeI(systime_t n);
+#endif
   syssts_t chSysGetStatusAndLockX(void);
   void chSysRestoreStatusX(syssts_t sts);
 #if PORT_SUPPORTS_RT
@@ -292,12 +312,17 @@ static inline void chSysEnable(void) {
 
 /**
  * @brief   Enters the kernel lock mode.
+ * @note    In SMP mode the lock also acquires the spinlock shared by all
+ *          the cores.
  *
  * @special
  */
 static inline void chSysLock(void)  {
 
   port_lock();
+#if CH_CFG_SMP_MODE
+  port_spin_lock();
+#endif
   _stats_start_measure_crit_thd();
   _dbg_check_lock();
 }
@@ -312,13 +337,19 @@ static inline void chSysUnlock(void) {
   _dbg_check_unlock();
   _stats_stop_measure_crit_thd();
 
+#if CH_CFG_SMP_MODE
+  /* The check is not performed in SMP mode, other cores can insert threads
+     in the ready list of this core, the inter-core notification performs
+     the reschedule after the lock is released.*/
+  port_spin_unlock();
+#else
   /* The following condition can be triggered by the use of i-class functions
      in a critical section not followed by a chSchResceduleS(), this means
      that the current thread has a lower priority than the next thread in
      the ready list.*/
-  chDbgAssert(ch.rlist.r_current->p_prio >= ch.rlist.r_queue.p_next->p_prio,
+  chDbgAssert(currp->p_prio >= firstprio(&currcore->rlist.r_queue),
               "priority violation, missing reschedule");
-
+#endif
   port_unlock();
 }
 
@@ -337,6 +368,9 @@ static inline void chSysUnlock(void) {
 static inline void chSysLockFromISR(void) {
 
   port_lock_from_isr();
+#if CH_CFG_SMP_MODE
+  port_spin_lock();
+#endif
   _stats_start_measure_crit_isr();
   _dbg_check_lock_from_isr();
 }
@@ -358,6 +392,9 @@ static inline void chSysUnlockFromISR(void) {
 
   _dbg_check_unlock_from_isr();
   _stats_stop_measure_crit_isr();
+#if CH_CFG_SMP_MODE
+  port_spin_unlock();
+#endif
   port_unlock_from_isr();
 }
 
@@ -273,7 +273,7 @@ extern "C" {
   */
 static inline thread_t *chThdGetSelfX(void) {
 
-  return ch.rlist.r_current;
+  return currcore->rlist.r_current;
 }
 
 /**
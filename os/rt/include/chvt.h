@@ -227,7 +227,7 @@ static inline void chVTObjectInit(virtual_timer_t *vtp) {
 static inline systime_t chVTGetSystemTimeX(void) {
 
 #if CH_CFG_ST_TIMEDELTA == 0
-  return ch.vtlist.vt_systime;
+  return currcore->vtlist.vt_systime;
 #else /* CH_CFG_ST_TIMEDELTA > 0 */
   return port_timer_get_time();
 #endif /* CH_CFG_ST_TIMEDELTA > 0 */
@@ -447,16 +447,16 @@ static inline void chVTDoTickI(void) {
   chDbgCheckClassI();
 
 #if CH_CFG_ST_TIMEDELTA == 0
-  ch.vtlist.vt_systime++;
-  if (&ch.vtlist != (virtual_timers_list_t *)ch.vtlist.vt_next) {
+  currcore->vtlist.vt_systime++;
+  if (&currcore->vtlist != (virtual_timers_list_t *)currcore->vtlist.vt_next) {
     virtual_timer_t *vtp;
 
-    --ch.vtlist.vt_next->vt_delta;
-    while (!(vtp = ch.vtlist.vt_next)->vt_delta) {
+    --currcore->vtlist.vt_next->vt_delta;
+    while (!(vtp = currcore->vtlist.vt_next)->vt_delta) {
       vtfunc_t fn = vtp->vt_func;
       vtp->vt_func = (vtfunc_t)NULL;
-      vtp->vt_next->vt_prev = (virtual_timer_t *)&ch.vtlist;
-      ch.vtlist.vt_next = vtp->vt_next;
+      vtp->vt_next->vt_prev = (virtual_timer_t *)&currcore->vtlist;
+      currcore->vtlist.vt_next = vtp->vt_next;
       chSysUnlockFromISR();
       fn(vtp->vt_par);
       chSysLockFromISR();
@@ -465,20 +465,20 @@ static inline void chVTDoTickI(void) {
 #else /* CH_CFG_ST_TIMEDELTA > 0 */
   virtual_timer_t *vtp;
   systime_t now = chVTGetSystemTimeX();
-  systime_t delta = now - ch.vtlist.vt_lasttime;
+  systime_t delta = now - currcore->vtlist.vt_lasttime;
 
-  while ((vtp = ch.vtlist.vt_next)->vt_delta <= delta) {
+  while ((vtp = currcore->vtlist.vt_next)->vt_delta <= delta) {
     delta -= vtp->vt_delta;
-    ch.vtlist.vt_lasttime += vtp->vt_delta;
+    currcore->vtlist.vt_lasttime += vtp->vt_delta;
     vtfunc_t fn = vtp->vt_func;
     vtp->vt_func = (vtfunc_t)NULL;
-    vtp->vt_next->vt_prev = (virtual_timer_t *)&ch.vtlist;
-    ch.vtlist.vt_next = vtp->vt_next;
+    vtp->vt_next->vt_prev = (virtual_timer_t *)&currcore->vtlist;
+    currcore->vtlist.vt_next = vtp->vt_next;
     chSysUnlockFromISR();
     fn(vtp->vt_par);
     chSysLockFromISR();
   }
-  if (&ch.vtlist == (virtual_timers_list_t *)ch.vtlist.vt_next) {
+  if (&currcore->vtlist == (virtual_timers_list_t *)currcore->vtlist.vt_next) {
     /* The list is empty, no tick event needed so the alarm timer
        is stopped.*/
     port_timer_stop_alarm();
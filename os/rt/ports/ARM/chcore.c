@@ -36,6 +36,13 @@
 /* Module exported variables.                                                */
 /*===========================================================================*/
 
+#if ARM_USE_FIQ_PEND || defined(__DOXYGEN__)
+/**
+ * @brief   FIQ deferred requests pending list.
+ */
+port_fiqreq_t * volatile _port_fiq_list;
+#endif
+
 /*===========================================================================*/
 /* Module local types.                                                       */
 /*===========================================================================*/
@@ -52,4 +59,40 @@
 /* Module exported functions.                                                */
 /*===========================================================================*/
 
+#if ARM_USE_FIQ_PEND || defined(__DOXYGEN__)
+/**
+ * @brief   FIQ deferred requests service.
+ * @details Software-triggered IRQ handler, the pending list is detached
+ *          atomically and the callbacks are invoked within the kernel lock.
+ *          Requests pended while serving are served by the next IRQ.
+ */
+CH_IRQ_HANDLER(_port_fiq_serve) {
+  port_fiqreq_t *rp;
+
+  CH_IRQ_PROLOGUE();
+
+  ARM_FIQ_PEND_CLEAR();
+#ifdef THUMB
+  rp = _port_fiq_fetch_thumb();
+#else
+  rp = _port_fiq_fetch_arm();
+#endif
+
+  chSysLockFromISR();
+  while (rp != NULL) {
+    port_fiqreq_t *next = rp->next;
+
+    /* After this point the request can be pended again by a FIQ.*/
+    rp->queued = false;
+    rp->cb(rp->p);
+    rp = next;
+  }
+  chSysUnlockFromISR();
+
+  ARM_IRQ_EOI();
+
+  CH_IRQ_EPILOGUE();
+}
+#endif /* ARM_USE_FIQ_PEND */
+
 /** @} */
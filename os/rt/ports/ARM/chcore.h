@@ -78,6 +78,24 @@
  */
 #define PORT_SUPPORTS_RT                FALSE
 
+/**
+ * @brief   Loading the PC from memory performs the ARM/THUMB state switch.
+ * @details This is true starting from ARMv5T, the architecture is taken
+ *          from the compiler predefined macros because the ARM9 family
+ *          includes ARMv4T cores (ARM920T, ARM922T) requiring a @p bx.
+ * @note    ARM7TDMI cores, LPC214x included, are ARMv4T so this setting
+ *          is always @p FALSE there and @p _port_switch_arm keeps the
+ *          @p bx return in THUMB builds, the leaner switch sequence does
+ *          not apply to those devices.
+ */
+#if defined(__ARM_ARCH_4T__) || defined(__ARM_ARCH_4__) ||                 \
+    (defined(__ARM_ARCH) && (__ARM_ARCH < 5)) ||                            \
+    (ARM_CORE == ARM_CORE_ARM7TDMI)
+#define ARM_LDM_PC_INTERWORKING         FALSE
+#else
+#define ARM_LDM_PC_INTERWORKING         TRUE
+#endif
+
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -121,10 +139,25 @@
 #define ARM_ENABLE_WFI_IDLE             FALSE
 #endif
 
+/**
+ * @brief   Enables the FIQ deferred requests.
+ * @details If enabled the FIQ handlers can defer work to IRQ level using
+ *          @p port_fiq_pend(), the deferred callbacks are invoked from a
+ *          software-triggered IRQ and can use I-class kernel APIs.
+ * @note    Requires device support, see @p ARM_SUPPORTS_FIQ_PEND.
+ */
+#if !defined(ARM_USE_FIQ_PEND) || defined(__DOXYGEN__)
+#define ARM_USE_FIQ_PEND                FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if ARM_USE_FIQ_PEND && !ARM_SUPPORTS_FIQ_PEND
+#error "FIQ deferred requests not supported by the selected device"
+#endif
+
 /* The following code is not processed when the file is included from an
    asm module.*/
 #if !defined(_FROM_ASM_)
@@ -137,7 +170,11 @@
 
 #elif ARM_CORE == ARM_CORE_ARM9
 #define PORT_ARCHITECTURE_ARM_ARM9
+#if ARM_LDM_PC_INTERWORKING
 #define PORT_ARCHITECTURE_NAME          "ARMv5T"
+#else
+#define PORT_ARCHITECTURE_NAME          "ARMv4T"
+#endif
 #define PORT_CORE_VARIANT_NAME          "ARM9"
 
 #elif ARM_CORE == ARM_CORE_CORTEX_A8
@@ -237,6 +274,32 @@ struct context {
   struct port_intctx    *r13;
 };
 
+#if ARM_USE_FIQ_PEND || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a FIQ deferred request.
+ */
+typedef struct port_fiqreq port_fiqreq_t;
+
+/**
+ * @brief   FIQ deferred callback type.
+ * @note    The callback is invoked from IRQ context within the kernel lock,
+ *          only I-class functions can be used.
+ *
+ * @param[in] p         the callback parameter
+ */
+typedef void (*port_fiqcb_t)(void *p);
+
+/**
+ * @brief   Structure representing a FIQ deferred request.
+ */
+struct port_fiqreq {
+  port_fiqreq_t         *next;      /**< @brief Next pending request.       */
+  port_fiqcb_t          cb;         /**< @brief Deferred callback.          */
+  void                  *p;         /**< @brief Callback parameter.         */
+  volatile bool         queued;     /**< @brief Request pending.            */
+};
+#endif
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
@@ -286,6 +349,17 @@ struct context {
 
 /**
  * @brief   Fast IRQ handler function declaration.
+ * @details Fast interrupts are served in FIQ mode, the sources are routed
+ *          to the FIQ line by the interrupt controller (@p VICIntSelect
+ *          on the LPC214x) and the handler is named @p FiqHandler in
+ *          order to override the weak vector. The FIQ is not masked by the
+ *          kernel lock so the latency is not affected by the kernel
+ *          critical zones, registers R8-R12 are banked and do not need to
+ *          be saved.
+ * @note    The handlers must be compiled in ARM mode, put the source in the
+ *          @p ACSRC list of a THUMB build.
+ * @note    Kernel APIs cannot be used, work requiring the kernel can be
+ *          deferred to IRQ level using @p port_fiq_pend().
  * @note    @p id can be a function name or a vector number depending on the
  *          port implementation.
  */
@@ -335,6 +409,10 @@ struct context {
 /* External declarations.                                                    */
 /*===========================================================================*/
 
+#if ARM_USE_FIQ_PEND && !defined(__DOXYGEN__)
+extern port_fiqreq_t * volatile _port_fiq_list;
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -347,6 +425,14 @@ extern "C" {
   void _port_switch_arm(thread_t *ntp, thread_t *otp);
 #endif
   void _port_thread_start(void);
+#if ARM_USE_FIQ_PEND
+#ifdef THUMB
+  port_fiqreq_t *_port_fiq_fetch_thumb(void);
+#else
+  port_fiqreq_t *_port_fiq_fetch_arm(void);
+#endif
+  void _port_fiq_serve(void);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -360,6 +446,9 @@ extern "C" {
  */
 static inline void port_init(void) {
 
+#if ARM_USE_FIQ_PEND
+  ARM_FIQ_PEND_SETUP(_port_fiq_serve);
+#endif
 }
 
 /**
@@ -516,6 +605,49 @@ static inline void port_wait_for_interrupt(void) {
 #endif
 }
 
+#if ARM_USE_FIQ_PEND || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes a FIQ deferred request.
+ *
+ * @param[out] rp       pointer to the @p port_fiqreq_t object
+ * @param[in] cb        the deferred callback
+ * @param[in] p         the callback parameter
+ *
+ * @init
+ */
+static inline void port_fiq_object_init(port_fiqreq_t *rp,
+                                        port_fiqcb_t cb, void *p) {
+
+  rp->next   = NULL;
+  rp->cb     = cb;
+  rp->p      = p;
+  rp->queued = false;
+}
+
+/**
+ * @brief   Pends a FIQ deferred request.
+ * @details The request callback is invoked from IRQ level as soon as the
+ *          IRQs are enabled. A request pended again before being served
+ *          is served once.
+ * @note    Must be invoked from FIQ handlers only, the pending list is
+ *          accessed without locks because the FIQ cannot be preempted.
+ * @note    The pending requests are not served in any particular order.
+ *
+ * @param[in] rp        pointer to the @p port_fiqreq_t object
+ *
+ * @special
+ */
+static inline void port_fiq_pend(port_fiqreq_t *rp) {
+
+  if (!rp->queued) {
+    rp->queued = true;
+    rp->next = _port_fiq_list;
+    _port_fiq_list = rp;
+  }
+  ARM_FIQ_PEND_TRIGGER();
+}
+#endif /* ARM_USE_FIQ_PEND */
+
 #if CH_CFG_ST_TIMEDELTA > 0
 #if !PORT_USE_ALT_TIMER
 #include "chcore_timer.h"
@@ -26,11 +26,16 @@
  * @{
  */
 
-#include "chconf.h"
-
 #define FALSE 0
 #define TRUE 1
 
+/*
+ * Imports the port configuration headers.
+ */
+#define _FROM_ASM_
+#include "chconf.h"
+#include "chcore.h"
+
 #if !defined(__DOXYGEN__)
 
                 .set    MODE_USR, 0x10
@@ -129,12 +134,40 @@ _port_switch_arm:
                 stmfd   sp!, {r4, r5, r6, r7, r8, r9, r10, r11, lr}
                 str     sp, [r1, #12]
                 ldr     sp, [r0, #12]
-#if defined(THUMB_PRESENT)
+#if defined(THUMB_PRESENT) && !ARM_LDM_PC_INTERWORKING
+                // ARMv4T, loading PC does not switch state.
                 ldmfd   sp!, {r4, r5, r6, r7, r8, r9, r10, r11, lr}
                 bx      lr
-#else /* !defined(THUMB_PRESENT)T */
+#else
+                // Pure ARM or ARMv5 and later, loading PC performs the
+                // state switch.
                 ldmfd   sp!, {r4, r5, r6, r7, r8, r9, r10, r11, pc}
-#endif /* !defined(THUMB_PRESENT) */
+#endif
+
+#if ARM_USE_FIQ_PEND
+/*
+ * Detaches the FIQ deferred requests list. SWP is atomic with respect to
+ * the FIQ so the FIQ does not need to be masked.
+ */
+                .balign 16
+#if defined(THUMB_PRESENT)
+                .code   16
+                .thumb_func
+                .global _port_fiq_fetch_thumb
+_port_fiq_fetch_thumb:
+                mov     r3, pc
+                bx      r3
+                // Goes into _port_fiq_fetch_arm in ARM mode
+#endif /* defined(THUMB_PRESENT) */
+
+                .code   32
+                .global _port_fiq_fetch_arm
+_port_fiq_fetch_arm:
+                ldr     r1, =_port_fiq_list
+                mov     r2, #0
+                swp     r0, r2, [r1]
+                bx      lr
+#endif /* ARM_USE_FIQ_PEND */
 
 /*
  * Common exit point for all IRQ routines, it performs the rescheduling if
@@ -95,6 +95,35 @@
 #define PORT_USE_ALT_TIMER              FALSE
 #endif
 
+/**
+ * @brief   Kernel hot paths in RAM.
+ * @details If enabled the scheduler, the system tick handler, the context
+ *          switch code and the port exception handlers are placed in the
+ *          @p .ramtext section, the startup code copies it in RAM together
+ *          with the DATA segment so the code runs without flash wait
+ *          states.
+ * @note    Calls between flash and RAM go through linker generated
+ *          veneers because the distance exceeds the @p BL range.
+ * @note    Only supported by the GCC compiler.
+ */
+#if !defined(PORT_HOT_CODE_IN_RAM) || defined(__DOXYGEN__)
+#define PORT_HOT_CODE_IN_RAM            FALSE
+#endif
+
+/**
+ * @brief   System data in core coupled memory.
+ * @details If enabled the @p ch_system_t structure is placed in the
+ *          @p .ccm section, it is not subject to contention with the DMA
+ *          on the bus matrix.
+ * @note    The @p .ccm output section is defined by the STM32F303,
+ *          STM32F405, STM32F407 and STM32F429 linker scripts, on the other
+ *          devices the section is placed in RAM.
+ * @note    Only supported by the GCC compiler.
+ */
+#if !defined(PORT_SYSTEM_IN_CCM) || defined(__DOXYGEN__)
+#define PORT_SYSTEM_IN_CCM              FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -103,6 +132,21 @@
    asm module.*/
 #if !defined(_FROM_ASM_)
 
+#if (PORT_HOT_CODE_IN_RAM || PORT_SYSTEM_IN_CCM) && !defined(__GNUC__)
+#error "PORT_HOT_CODE_IN_RAM and PORT_SYSTEM_IN_CCM require GCC"
+#endif
+
+/**
+ * @brief   Memory placement information.
+ */
+#if PORT_HOT_CODE_IN_RAM && PORT_SYSTEM_IN_CCM
+#define PORT_MEMORY_INFO                "Hot code in RAM, system data in CCM"
+#elif PORT_HOT_CODE_IN_RAM
+#define PORT_MEMORY_INFO                "Hot code in RAM"
+#elif PORT_SYSTEM_IN_CCM
+#define PORT_MEMORY_INFO                "System data in CCM"
+#endif
+
 /*
  * Inclusion of the appropriate CMSIS header for the selected device.
  */
@@ -222,6 +266,43 @@ struct context {
 #define CORTEX_PRIO_MASK(n)                                                 \
   ((n) << (8 - CORTEX_PRIORITY_BITS))
 
+/**
+ * @brief   Number of exception vectors including the system ones.
+ * @details The vectors are numbered as in the @p IPSR register, see
+ *          @p port_get_irq_vector().
+ */
+#define PORT_IRQ_VECTORS_NUMBER         (16 + CORTEX_NUM_VECTORS)
+
+#if defined(__GNUC__) || defined(__DOXYGEN__)
+/**
+ * @brief   Core coupled memory variable specifier.
+ * @details Places a variable, for example a thread working area, in the
+ *          @p .ccm section. The section is zeroed by the startup code.
+ * @note    The core coupled memory is not reachable by the DMA, buffers
+ *          used for DMA transfers cannot be placed there, this includes
+ *          buffers allocated on the stack of threads having their working
+ *          area in CCM.
+ */
+#define PORT_CCM_DATA __attribute__((section(".ccm")))
+#endif
+
+#if PORT_HOT_CODE_IN_RAM || defined(__DOXYGEN__)
+/**
+ * @brief   Hot code specifier.
+ * @details Places a function in the @p .ramtext section, functions are not
+ *          inlined in order to be sure that the code is really executed
+ *          from RAM.
+ */
+#define PORT_HOT_CODE __attribute__((section(".ramtext"), noinline))
+#endif
+
+#if PORT_SYSTEM_IN_CCM || defined(__DOXYGEN__)
+/**
+ * @brief   System data specifier.
+ */
+#define PORT_SYSTEM_DATA PORT_CCM_DATA
+#endif
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -240,6 +321,17 @@ struct context {
 
 #if !defined(_FROM_ASM_)
 
+/**
+ * @brief   Returns the number of the exception being served.
+ * @note    The value is meaningful only when invoked from an ISR.
+ *
+ * @return              The exception number, system exceptions included.
+ */
+static inline uint32_t port_get_irq_vector(void) {
+
+  return __get_IPSR() & 0x1FFU;
+}
+
 #if CH_CFG_ST_TIMEDELTA > 0
 #if !PORT_USE_ALT_TIMER
 #include "chcore_timer.h"
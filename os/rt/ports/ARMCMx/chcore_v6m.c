@@ -58,7 +58,7 @@
  * @details The NMI vector is used for exception mode re-entering after a
  *          context switch.
  */
-void NMI_Handler(void) {
+PORT_HOT_CODE void NMI_Handler(void) {
 
   /* The port_extctx structure is pointed by the PSP register.*/
   struct port_extctx *ctxp = (struct port_extctx *)__get_PSP();
@@ -81,7 +81,7 @@ void NMI_Handler(void) {
  * @details The PendSV vector is used for exception mode re-entering after a
  *          context switch.
  */
-void PendSV_Handler(void) {
+PORT_HOT_CODE void PendSV_Handler(void) {
 
   /* The port_extctx structure is pointed by the PSP register.*/
   struct port_extctx *ctxp = (struct port_extctx *)__get_PSP();
@@ -104,7 +104,7 @@ void PendSV_Handler(void) {
  *
  * @param[in] lr        value of the @p LR register on ISR entry
  */
-void _port_irq_epilogue(regarm_t lr) {
+PORT_HOT_CODE void _port_irq_epilogue(regarm_t lr) {
 
   if (lr != (regarm_t)0xFFFFFFF1) {
     struct port_extctx *ctxp;
@@ -237,6 +237,13 @@ struct port_intctx {
  */
 #define PORT_FAST_IRQ_HANDLER(id) void id(void)
 
+/**
+ * @brief   Memory barrier.
+ * @details All the memory accesses before the barrier are completed before
+ *          any memory access after the barrier.
+ */
+#define port_memory_barrier() __DMB()
+
 /**
  * @brief   Performs a context switch between two threads.
  * @details This is the most critical code in any port, this function
@@ -32,6 +32,24 @@
 /* Module local definitions.                                                 */
 /*===========================================================================*/
 
+#if CORTEX_USE_LAZY_FPU || defined(__DOXYGEN__)
+/**
+ * @brief   EXC_RETURN bit marking a basic exception frame.
+ */
+#define EXC_RETURN_BASIC_FRAME          0x00000010U
+
+/**
+ * @brief   Size of a basic exception frame.
+ */
+#define BASIC_FRAME_SIZE                (8 * sizeof (regarm_t))
+
+/**
+ * @brief   Checks if an EXC_RETURN value refers to an extended frame.
+ */
+#define IS_EXTENDED_FRAME(lr)                                               \
+  (((uint32_t)(lr) & EXC_RETURN_BASIC_FRAME) == 0U)
+#endif
+
 /*===========================================================================*/
 /* Module exported variables.                                                */
 /*===========================================================================*/
@@ -59,11 +77,20 @@
  *          context switch.
  * @note    The PendSV vector is only used in advanced kernel mode.
  */
-void SVC_Handler(void) {
+PORT_HOT_CODE void SVC_Handler(void) {
 
   /* The port_extctx structure is pointed by the PSP register.*/
   struct port_extctx *ctxp = (struct port_extctx *)__get_PSP();
 
+#if CORTEX_USE_LAZY_FPU
+  if (!IS_EXTENDED_FRAME(__builtin_return_address(0))) {
+    /* Basic frames, the thread has no FPU context.*/
+    __set_PSP((uint32_t)ctxp + BASIC_FRAME_SIZE);
+    port_unlock_from_isr();
+    return;
+  }
+#endif
+
   /* Discarding the current exception context and positioning the stack to
      point to the real one.*/
   ctxp++;
@@ -89,11 +116,19 @@ void SVC_Handler(void) {
  *          context switch.
  * @note    The PendSV vector is only used in compact kernel mode.
  */
-void PendSV_Handler(void) {
+PORT_HOT_CODE void PendSV_Handler(void) {
 
   /* The port_extctx structure is pointed by the PSP register.*/
   struct port_extctx *ctxp = (struct port_extctx *)__get_PSP();
 
+#if CORTEX_USE_LAZY_FPU
+  if (!IS_EXTENDED_FRAME(__builtin_return_address(0))) {
+    /* Basic frames, the thread has no FPU context.*/
+    __set_PSP((uint32_t)ctxp + BASIC_FRAME_SIZE);
+    return;
+  }
+#endif
+
   /* Discarding the current exception context and positioning the stack to
      point to the real one.*/
   ctxp++;
@@ -115,18 +150,61 @@ void PendSV_Handler(void) {
 
 /**
  * @brief   Exception exit redirection to _port_switch_from_isr().
+ * @note    In lazy FPU mode the function takes the value of the @p LR
+ *          register on ISR entry.
  */
-void _port_irq_epilogue(void) {
+#if !CORTEX_USE_LAZY_FPU || defined(__DOXYGEN__)
+PORT_HOT_CODE void _port_irq_epilogue(void) {
+#else
+PORT_HOT_CODE void _port_irq_epilogue(regarm_t lr) {
+#endif
+
+#if CORTEX_TAIL_CHAIN_DEFERRAL
+  {
+    /* An OS-aware interrupt not masked by the BASEPRI value of the
+       interrupted code is going to be tail-chained, its epilogue will
+       perform the check. System exceptions other than SysTick do not have
+       an epilogue so they are excluded.*/
+    uint32_t vect = (SCB->ICSR & SCB_ICSR_VECTPENDING_Msk) >>
+                    SCB_ICSR_VECTPENDING_Pos;
+    if (vect >= 15U) {
+      uint32_t prio = NVIC_GetPriority((IRQn_Type)((int32_t)vect - 16));
+      uint32_t basepri = __get_BASEPRI();
+
+      if ((prio >= CORTEX_MAX_KERNEL_PRIORITY) &&
+          ((basepri == 0U) || (CORTEX_PRIO_MASK(prio) < basepri)))
+        return;
+    }
+  }
+#endif
 
   port_lock_from_isr();
   if ((SCB->ICSR & SCB_ICSR_RETTOBASE_Msk) != 0) {
 
     /* The port_extctx structure is pointed by the PSP register.*/
     struct port_extctx *ctxp = (struct port_extctx *)__get_PSP();
+#if CORTEX_USE_LAZY_FPU
+    /* The artificial frame must be of the same type of the real one, the
+       exception return uses the same EXC_RETURN value.*/
+    bool fpuctx = IS_EXTENDED_FRAME(lr);
+
+    if (fpuctx)
+      ctxp--;
+    else
+      ctxp = (struct port_extctx *)((uint8_t *)ctxp - BASIC_FRAME_SIZE);
+
+    /* The frame type is passed in R0, the exit code re-enters exception
+       mode with a frame of the same type.*/
+    ctxp->r0 = (regarm_t)(fpuctx ? CORTEX_CONTROL_FPCA : 0);
+#else /* !CORTEX_USE_LAZY_FPU */
+#if CORTEX_USE_FPU
+    bool fpuctx = true;
+#endif
 
     /* Adding an artificial exception return context, there is no need to
        populate it fully.*/
     ctxp--;
+#endif /* !CORTEX_USE_LAZY_FPU */
 
     /* Writing back the modified PSP value.*/
     __set_PSP((uint32_t)ctxp);
@@ -141,7 +219,8 @@ void _port_irq_epilogue(void) {
       ctxp->pc = (regarm_t)_port_switch_from_isr;
 #if CORTEX_USE_FPU
       /* Enforcing a lazy FPU state save by accessing the FPCSR register.*/
-      (void) __get_FPSCR();
+      if (fpuctx)
+        (void) __get_FPSCR();
 #endif
     }
     else {
@@ -151,7 +230,7 @@ void _port_irq_epilogue(void) {
     }
 
 #if CORTEX_USE_FPU
-    {
+    if (fpuctx) {
       uint32_t fpccr;
 
       /* Saving the special register SCB_FPCCR into the reserved offset of
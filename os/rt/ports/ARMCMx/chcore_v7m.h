@@ -78,11 +78,24 @@
  */
 #define PORT_SUPPORTS_RT                TRUE
 
+/**
+ * @brief   This port supports atomic compare-and-swap.
+ * @details Implemented using the LDREX/STREX instructions.
+ */
+#define PORT_SUPPORTS_ATOMIC_CAS        TRUE
+
 /**
  * @brief   Disabled value for BASEPRI register.
  */
 #define CORTEX_BASEPRI_DISABLED         0
 
+/**
+ * @brief   FPCA bit of the CONTROL register.
+ * @details The bit is set by the core when a floating point instruction is
+ *          executed and marks an active FPU context.
+ */
+#define CORTEX_CONTROL_FPCA             4
+
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -132,6 +145,37 @@
 #error "the selected core does not have an FPU"
 #endif
 
+/**
+ * @brief   Per-thread FPU context switch.
+ * @details If enabled the FPU registers are saved and restored only for
+ *          the threads that executed floating point instructions, the
+ *          FPU usage is tracked using the @p CONTROL.FPCA bit. Threads
+ *          not using the FPU have smaller switch and exception frames.
+ * @note    In this mode the working area sizes do not include the FPU
+ *          context, threads using the FPU must add
+ *          @p PORT_FPU_STACK_SIZE to their stack size.
+ * @note    Requires @p CORTEX_USE_FPU and the automatic FPU state
+ *          preservation (@p FPCCR.ASPEN) enabled by the startup code.
+ */
+#if !defined(CORTEX_USE_LAZY_FPU) || defined(__DOXYGEN__)
+#define CORTEX_USE_LAZY_FPU             FALSE
+#endif
+
+/**
+ * @brief   Reschedule deferral on tail-chained interrupts.
+ * @details If enabled the IRQ epilogue skips the preemption check when
+ *          another OS-aware interrupt is pending, that interrupt is going
+ *          to be tail-chained and the check is performed by its own
+ *          epilogue, back to back interrupts then cause a single
+ *          reschedule.
+ * @note    Vectors are classified as OS-aware by their priority, the
+ *          OS-aware handlers must use the IRQ epilogue, see
+ *          @p nvicEnableVectors().
+ */
+#if !defined(CORTEX_TAIL_CHAIN_DEFERRAL) || defined(__DOXYGEN__)
+#define CORTEX_TAIL_CHAIN_DEFERRAL      FALSE
+#endif
+
 /**
  * @brief   Simplified priority handling flag.
  * @details Activating this option makes the Kernel work in compact mode.
@@ -200,6 +244,28 @@
  */
 #define CORTEX_PRIORITY_PENDSV          CORTEX_MAX_KERNEL_PRIORITY
 
+#if CORTEX_USE_LAZY_FPU && !CORTEX_USE_FPU
+#error "CORTEX_USE_LAZY_FPU requires CORTEX_USE_FPU"
+#endif
+
+/**
+ * @brief   The port switches an FPU context.
+ */
+#define PORT_USES_FPU                   CORTEX_USE_FPU
+
+/**
+ * @brief   Additional stack space required by threads using the FPU.
+ * @details In lazy FPU mode this is the space for the registers s16-s31
+ *          and for the FPU part of two exception frames, the real one and
+ *          the artificial one pushed by the IRQ epilogue. In the other
+ *          modes the space is already included in the working areas.
+ */
+#if CORTEX_USE_LAZY_FPU || defined(__DOXYGEN__)
+#define PORT_FPU_STACK_SIZE             (64 + 2 * 72)
+#else
+#define PORT_FPU_STACK_SIZE             0
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -243,7 +309,11 @@ struct port_extctx {
 };
 
 struct port_intctx {
-#if CORTEX_USE_FPU
+#if CORTEX_USE_LAZY_FPU
+  /* FPCA flag of the thread, when set the registers s16-s31 are stacked
+     between this field and r4.*/
+  regarm_t      fpca;
+#elif CORTEX_USE_FPU
   regarm_t      s16;
   regarm_t      s17;
   regarm_t      s18;
@@ -260,7 +330,7 @@ struct port_intctx {
   regarm_t      s29;
   regarm_t      s30;
   regarm_t      s31;
-#endif /* CORTEX_USE_FPU */
+#endif /* CORTEX_USE_FPU && !CORTEX_USE_LAZY_FPU */
   regarm_t      r4;
   regarm_t      r5;
   regarm_t      r6;
@@ -289,20 +359,39 @@ struct port_intctx {
   (tp)->p_ctx.r13->r4 = (regarm_t)(pf);                                     \
   (tp)->p_ctx.r13->r5 = (regarm_t)(arg);                                    \
   (tp)->p_ctx.r13->lr = (regarm_t)(_port_thread_start);                     \
+  PORT_SETUP_FPU_CONTEXT(tp);                                               \
 }
 
+#if CORTEX_USE_LAZY_FPU || defined(__DOXYGEN__)
+/**
+ * @brief   New threads start without an FPU context.
+ */
+#define PORT_SETUP_FPU_CONTEXT(tp) ((tp)->p_ctx.r13->fpca = (regarm_t)0)
+
 /**
  * @brief   Computes the thread working area global size.
+ * @details In lazy FPU mode only a basic exception frame is accounted,
+ *          see @p PORT_FPU_STACK_SIZE.
  * @note    There is no need to perform alignments in this macro.
  */
+#define PORT_WA_SIZE(n) (sizeof(struct port_intctx) +                       \
+                         (8 * sizeof(regarm_t)) +                           \
+                         (n) + (PORT_INT_REQUIRED_STACK))
+#else
+#define PORT_SETUP_FPU_CONTEXT(tp)
+
 #define PORT_WA_SIZE(n) (sizeof(struct port_intctx) +                       \
                          sizeof(struct port_extctx) +                       \
                          (n) + (PORT_INT_REQUIRED_STACK))
+#endif
 
+#if !CORTEX_USE_LAZY_FPU || defined(__DOXYGEN__)
 /**
  * @brief   IRQ prologue code.
  * @details This macro must be inserted at the start of all IRQ handlers
  *          enabled to invoke system APIs.
+ * @note    In lazy FPU mode the @p LR register is saved in order to know
+ *          the type of the exception frame.
  */
 #define PORT_IRQ_PROLOGUE()
 
@@ -312,6 +401,16 @@ struct port_intctx {
  *          enabled to invoke system APIs.
  */
 #define PORT_IRQ_EPILOGUE() _port_irq_epilogue()
+#else /* CORTEX_USE_LAZY_FPU */
+#if defined(__GNUC__)
+#define PORT_IRQ_PROLOGUE()                                                 \
+  regarm_t _saved_lr = (regarm_t)__builtin_return_address(0)
+#else
+#error "CORTEX_USE_LAZY_FPU is only supported by the GCC port"
+#endif
+
+#define PORT_IRQ_EPILOGUE() _port_irq_epilogue(_saved_lr)
+#endif /* CORTEX_USE_LAZY_FPU */
 
 /**
  * @brief   IRQ handler function declaration.
@@ -327,6 +426,13 @@ struct port_intctx {
  */
 #define PORT_FAST_IRQ_HANDLER(id) void id(void)
 
+/**
+ * @brief   Memory barrier.
+ * @details All the memory accesses before the barrier are completed before
+ *          any memory access after the barrier.
+ */
+#define port_memory_barrier() __DMB()
+
 /**
  * @brief   Performs a context switch between two threads.
  * @details This is the most critical code in any port, this function
@@ -339,13 +445,22 @@ struct port_intctx {
  */
 #if !CH_DBG_ENABLE_STACK_CHECK || defined(__DOXYGEN__)
 #define port_switch(ntp, otp) _port_switch(ntp, otp)
-#else
+#elif !CORTEX_USE_LAZY_FPU
 #define port_switch(ntp, otp) {                                             \
   struct port_intctx *r13 = (struct port_intctx *)__get_PSP();              \
   if ((stkalign_t *)(r13 - 1) < (otp)->p_stklimit)                          \
     chSysHalt("stack overflow");                                            \
   _port_switch(ntp, otp);                                                   \
 }
+#else
+#define port_switch(ntp, otp) {                                             \
+  uint8_t *r13 = (uint8_t *)__get_PSP() - sizeof (struct port_intctx);      \
+  if ((__get_CONTROL() & CORTEX_CONTROL_FPCA) != 0)                         \
+    r13 -= 64;                                                              \
+  if ((stkalign_t *)r13 < (otp)->p_stklimit)                                \
+    chSysHalt("stack overflow");                                            \
+  _port_switch(ntp, otp);                                                   \
+}
 #endif
 
 /*===========================================================================*/
@@ -355,7 +470,11 @@ struct port_intctx {
 #ifdef __cplusplus
 extern "C" {
 #endif
+#if !CORTEX_USE_LAZY_FPU
   void _port_irq_epilogue(void);
+#else
+  void _port_irq_epilogue(regarm_t lr);
+#endif
   void _port_switch(thread_t *ntp, thread_t *otp);
   void _port_thread_start(void);
   void _port_switch_from_isr(void);
@@ -538,6 +657,31 @@ static inline void port_wait_for_interrupt(void) {
 #endif
 }
 
+/**
+ * @brief   Atomic compare-and-swap.
+ * @details The variable is updated only if it still contains the expected
+ *          value, the operation is retried if the exclusive access is lost
+ *          because an interrupt or another bus master.
+ *
+ * @param[in] p         pointer to the variable to be updated
+ * @param[in] cmp       expected current value
+ * @param[in] val       new value
+ * @return              The operation result.
+ * @retval true         if the variable has been updated.
+ * @retval false        if the variable did not match @p cmp.
+ */
+static inline bool port_atomic_cas(volatile uint32_t *p,
+                                   uint32_t cmp, uint32_t val) {
+
+  do {
+    if (__LDREXW(p) != cmp) {
+      __CLREX();
+      return false;
+    }
+  } while (__STREXW(val, p) != 0);
+  return true;
+}
+
 /**
  * @brief   Returns the current value of the realtime counter.
  *
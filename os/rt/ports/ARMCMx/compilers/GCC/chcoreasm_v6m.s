@@ -49,7 +49,11 @@
                 .fpu    softvfp
 
                 .thumb
+#if PORT_HOT_CODE_IN_RAM
+                .section .ramtext, "ax", %progbits
+#else
                 .text
+#endif
 
 /*--------------------------------------------------------------------------*
  * Performs a context switch between two threads.
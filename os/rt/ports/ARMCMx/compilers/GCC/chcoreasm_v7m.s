@@ -43,6 +43,7 @@
                 .set    CONTEXT_OFFSET, 12
                 .set    SCB_ICSR, 0xE000ED04
                 .set    ICSR_PENDSVSET, 0x10000000
+                .set    CONTROL_FPCA, CORTEX_CONTROL_FPCA
 
                 .syntax unified
                 .cpu    cortex-m4
@@ -53,7 +54,11 @@
 #endif
 
                 .thumb
+#if PORT_HOT_CODE_IN_RAM
+                .section .ramtext, "ax", %progbits
+#else
                 .text
+#endif
 
 /*--------------------------------------------------------------------------*
  * Performs a context switch between two threads.
@@ -62,12 +67,31 @@
                 .globl  _port_switch
 _port_switch:
                 push    {r4, r5, r6, r7, r8, r9, r10, r11, lr}
-#if CORTEX_USE_FPU
+#if CORTEX_USE_LAZY_FPU
+                /* The FPU registers are saved only if the thread has an
+                   active FPU context, the FPCA flag is saved too.*/
+                mrs     r3, CONTROL
+                ands    r3, r3, #CONTROL_FPCA
+                beq     .L2
+                vpush   {s16-s31}
+.L2:            push    {r3}
+#elif CORTEX_USE_FPU
                 vpush   {s16-s31}
 #endif
                 str     sp, [r1, #CONTEXT_OFFSET]
                 ldr     sp, [r0, #CONTEXT_OFFSET]
-#if CORTEX_USE_FPU
+#if CORTEX_USE_LAZY_FPU
+                /* Restoring the FPU registers sets the FPCA bit again, for
+                   threads without an FPU context the bit is cleared.*/
+                pop     {r3}
+                cbz     r3, .L3
+                vpop    {s16-s31}
+                pop     {r4, r5, r6, r7, r8, r9, r10, r11, pc}
+.L3:            mrs     r3, CONTROL
+                bic     r3, r3, #CONTROL_FPCA
+                msr     CONTROL, r3
+                isb
+#elif CORTEX_USE_FPU
                 vpop    {s16-s31}
 #endif
                 pop     {r4, r5, r6, r7, r8, r9, r10, r11, pc}
@@ -107,6 +131,10 @@ _port_thread_start:
                 .thumb_func
                 .globl  _port_switch_from_isr
 _port_switch_from_isr:
+#if CORTEX_USE_LAZY_FPU
+                /* R0 contains the frame type of the interrupted context.*/
+                push    {r0, r1}
+#endif
 #if CH_DBG_STATISTICS
                 bl      _stats_start_measure_crit_thd
 #endif
@@ -119,9 +147,21 @@ _port_switch_from_isr:
 #endif
 #if CH_DBG_STATISTICS
                 bl      _stats_stop_measure_crit_thd
+#endif
+#if CORTEX_USE_LAZY_FPU
+                pop     {r0, r1}
 #endif
                 .globl  _port_exit_from_isr
 _port_exit_from_isr:
+#if CORTEX_USE_LAZY_FPU
+                /* The exception mode is re-entered with a frame of the same
+                   type of the real one, the FPCA bit is set accordingly.*/
+                mrs     r3, CONTROL
+                bic     r3, r3, #CONTROL_FPCA
+                orr     r3, r3, r0
+                msr     CONTROL, r3
+                isb
+#endif
 #if CORTEX_SIMPLIFIED_PRIORITY
                 movw    r3, #:lower16:SCB_ICSR
                 movt    r3, #:upper16:SCB_ICSR
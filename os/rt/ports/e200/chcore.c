@@ -72,10 +72,111 @@ void port_dummy1(void) {
   asm ("mfcr        %r0");
   asm ("stw         %r0, 0(%sp)");      /* CR.                              */
   asm ("stmw        %r14, 4(%sp)");     /* GPR14...GPR31.                   */
-  
+#if PPC_USE_SPE
+  /* The SPE context is saved only if the thread is marked as SPE user,
+     all the upper halves are saved because the thread could have been
+     preempted by an ISR.*/
+  asm ("lwz         %r0, 16(%r4)");     /* Swapped-out thread SPE flag.     */
+  asm ("cmplwi      %cr0, %r0, 0");
+  asm ("beq         %cr0, 1f");
+  asm ("mfmsr       %r5");
+  asm ("oris        %r5, %r5, 0x0200"); /* MSR[SPE] set, it could be called
+                                           from an ISR.                     */
+  asm ("mtmsr       %r5");
+  asm ("isync");
+  asm ("subi        %sp, %sp, 256");    /* Size of the spectx structure.    */
+  asm ("evstdd      %r0, 0(%sp)");      /* GPR0, GPR3...GPR31, 64 bits.     */
+  asm ("evstdd      %r3, 8(%sp)");
+  asm ("evstdd      %r4, 16(%sp)");
+  asm ("evstdd      %r5, 24(%sp)");
+  asm ("evstdd      %r6, 32(%sp)");
+  asm ("evstdd      %r7, 40(%sp)");
+  asm ("evstdd      %r8, 48(%sp)");
+  asm ("evstdd      %r9, 56(%sp)");
+  asm ("evstdd      %r10, 64(%sp)");
+  asm ("evstdd      %r11, 72(%sp)");
+  asm ("evstdd      %r12, 80(%sp)");
+  asm ("evstdd      %r13, 88(%sp)");
+  asm ("evstdd      %r14, 96(%sp)");
+  asm ("evstdd      %r15, 104(%sp)");
+  asm ("evstdd      %r16, 112(%sp)");
+  asm ("evstdd      %r17, 120(%sp)");
+  asm ("evstdd      %r18, 128(%sp)");
+  asm ("evstdd      %r19, 136(%sp)");
+  asm ("evstdd      %r20, 144(%sp)");
+  asm ("evstdd      %r21, 152(%sp)");
+  asm ("evstdd      %r22, 160(%sp)");
+  asm ("evstdd      %r23, 168(%sp)");
+  asm ("evstdd      %r24, 176(%sp)");
+  asm ("evstdd      %r25, 184(%sp)");
+  asm ("evstdd      %r26, 192(%sp)");
+  asm ("evstdd      %r27, 200(%sp)");
+  asm ("evstdd      %r28, 208(%sp)");
+  asm ("evstdd      %r29, 216(%sp)");
+  asm ("evstdd      %r30, 224(%sp)");
+  asm ("evstdd      %r31, 232(%sp)");
+  asm ("evxor       %r0, %r0, %r0");
+  asm ("evmwumiaa   %r0, %r0, %r0");    /* Accumulator into GPR0.           */
+  asm ("evstdd      %r0, 240(%sp)");
+  asm ("mfspr       %r0, 512");         /* SPEFSCR.                         */
+  asm ("stw         %r0, 248(%sp)");
+  asm ("1:");
+#endif
+
   asm ("stw         %sp, 12(%r4)");     /* Store swapped-out stack.         */
   asm ("lwz         %sp, 12(%r3)");     /* Load swapped-in stack.           */
-  
+
+#if PPC_USE_SPE
+  /* MSR[SPE] is set or cleared depending on the swapped-in thread, non-SPE
+     threads trap on the first SPE instruction.*/
+  asm ("mfmsr       %r5");
+  asm ("lwz         %r0, 16(%r3)");     /* Swapped-in thread SPE flag.      */
+  asm ("cmplwi      %cr0, %r0, 0");
+  asm ("rlwinm      %r5, %r5, 0, 7, 5");/* MSR[SPE] cleared.                */
+  asm ("beq         %cr0, 2f");
+  asm ("oris        %r5, %r5, 0x0200"); /* MSR[SPE] set.                    */
+  asm ("2:");
+  asm ("mtmsr       %r5");
+  asm ("isync");
+  asm ("beq         %cr0, 3f");
+  asm ("evldd       %r0, 240(%sp)");
+  asm ("evmra       %r0, %r0");         /* Accumulator.                     */
+  asm ("lwz         %r0, 248(%sp)");
+  asm ("mtspr       512, %r0");         /* SPEFSCR.                         */
+  asm ("evldd       %r0, 0(%sp)");      /* GPR0, GPR3...GPR31, 64 bits.     */
+  asm ("evldd       %r3, 8(%sp)");
+  asm ("evldd       %r4, 16(%sp)");
+  asm ("evldd       %r5, 24(%sp)");
+  asm ("evldd       %r6, 32(%sp)");
+  asm ("evldd       %r7, 40(%sp)");
+  asm ("evldd       %r8, 48(%sp)");
+  asm ("evldd       %r9, 56(%sp)");
+  asm ("evldd       %r10, 64(%sp)");
+  asm ("evldd       %r11, 72(%sp)");
+  asm ("evldd       %r12, 80(%sp)");
+  asm ("evldd       %r13, 88(%sp)");
+  asm ("evldd       %r14, 96(%sp)");
+  asm ("evldd       %r15, 104(%sp)");
+  asm ("evldd       %r16, 112(%sp)");
+  asm ("evldd       %r17, 120(%sp)");
+  asm ("evldd       %r18, 128(%sp)");
+  asm ("evldd       %r19, 136(%sp)");
+  asm ("evldd       %r20, 144(%sp)");
+  asm ("evldd       %r21, 152(%sp)");
+  asm ("evldd       %r22, 160(%sp)");
+  asm ("evldd       %r23, 168(%sp)");
+  asm ("evldd       %r24, 176(%sp)");
+  asm ("evldd       %r25, 184(%sp)");
+  asm ("evldd       %r26, 192(%sp)");
+  asm ("evldd       %r27, 200(%sp)");
+  asm ("evldd       %r28, 208(%sp)");
+  asm ("evldd       %r29, 216(%sp)");
+  asm ("evldd       %r30, 224(%sp)");
+  asm ("evldd       %r31, 232(%sp)");
+  asm ("addi        %sp, %sp, 256");    /* Size of the spectx structure.    */
+  asm ("3:");
+#endif
+
   asm ("lmw         %r14, 4(%sp)");     /* GPR14...GPR31.                   */
   asm ("lwz         %r0, 0(%sp)");      /* CR.                              */
   asm ("mtcr        %r0");
@@ -104,4 +205,58 @@ void port_dummy2(void) {
   asm ("bl          chThdExit");        /* Thread termination on exit.      */
 }
 
+#if PPC_USE_SPE || defined(__DOXYGEN__)
+/**
+ * @brief   SPE unavailable exception service.
+ * @details The current thread is marked as SPE user, from now on its SPE
+ *          context is saved and restored on context switch. The IVOR32
+ *          handler then re-executes the instruction with the SPE enabled.
+ * @note    SPE instructions are not allowed in ISRs, the system is halted.
+ *
+ * @param[in] nesting   ISR nesting level when the exception was raised
+ */
+void _port_spe_enable(uint32_t nesting) {
+
+  if (nesting > 0)
+    chSysHalt("SPE used in ISR");
+
+  currp->p_ctx.spe = 1;
+}
+#endif
+
+#if CH_CFG_SMP_MODE || defined(__DOXYGEN__)
+/**
+ * @brief   Kernel spinlock acquire from the IVOR handlers.
+ */
+void _port_spin_lock(void) {
+
+  port_spin_lock();
+}
+
+/**
+ * @brief   Kernel spinlock release from the IVOR handlers.
+ */
+void _port_spin_unlock(void) {
+
+  port_spin_unlock();
+}
+
+/**
+ * @brief   Inter-core notification handler.
+ * @details The software interrupt is just cleared, the threads made ready
+ *          by the other core are scheduled by the common IVOR epilogue.
+ *
+ * @isr
+ */
+CH_IRQ_HANDLER(PPC_SMP_IPI_HANDLER) {
+
+  CH_IRQ_PROLOGUE();
+
+  INTC_SSCIR_OF(PPC_INTC_BASE_OF(port_get_core_id()),
+                PPC_SMP_IPI_NUMBER) = INTC_SSCIR_CLR;
+
+  CH_IRQ_EPILOGUE();
+}
+#endif /* CH_CFG_SMP_MODE */
+
 /** @} */
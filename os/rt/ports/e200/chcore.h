@@ -77,6 +77,14 @@
 #include "ppcparams.h"
 #include "vectors.h"
 
+/**
+ * @brief   This port supports a realtime counter.
+ * @details The lower half of the Time Base is used as realtime counter, it
+ *          is available on the devices implementing the Book-E timer
+ *          facilities.
+ */
+#define PORT_SUPPORTS_RT                PPC_SUPPORTS_DECREMENTER
+
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -120,6 +128,70 @@
 #define PPC_ENABLE_WFI_IDLE             FALSE
 #endif
 
+/**
+ * @brief   Per-thread SPE context.
+ * @details If enabled the SPE is disabled for all threads, the first SPE
+ *          instruction executed by a thread raises an SPE unavailable
+ *          exception (IVOR32) which marks the thread as an SPE user and
+ *          re-enables the unit. The upper halves of the GPRs, the
+ *          accumulator and the SPEFSCR register are then saved and
+ *          restored on context switch for the marked threads only.
+ * @note    SPE instructions cannot be used in ISRs.
+ * @note    If disabled the SPE state is not part of the thread context,
+ *          the SPE must not be used by more than one thread.
+ */
+#if !defined(PPC_USE_SPE) || defined(__DOXYGEN__)
+#define PPC_USE_SPE                     FALSE
+#endif
+
+/**
+ * @brief   Use the INTC hardware vector mode.
+ * @details If enabled the INTC is switched in hardware vector mode and
+ *          IVOR4 points to a table of per-vector entry stubs, the vector
+ *          number is delivered directly by the core and the IACKR read
+ *          is avoided. If disabled the INTC is used in software vector
+ *          mode.
+ * @note    The table entries are 16 bytes wide and the table base is
+ *          16 bytes aligned, the same layout is expected by the core in
+ *          hardware vector mode.
+ */
+#if !defined(PPC_USE_INTC_HW_VECTORS) || defined(__DOXYGEN__)
+#define PPC_USE_INTC_HW_VECTORS         FALSE
+#endif
+
+/**
+ * @brief   SEMA4 gate used as kernel spinlock.
+ * @note    Only used in SMP mode.
+ */
+#if !defined(PPC_SMP_SPINLOCK_GATE) || defined(__DOXYGEN__)
+#define PPC_SMP_SPINLOCK_GATE           0
+#endif
+
+/**
+ * @brief   INTC software settable interrupt used for inter-core
+ *          notifications.
+ * @note    Only used in SMP mode, the software settable interrupts are
+ *          the INTC vectors from zero to seven.
+ */
+#if !defined(PPC_SMP_IPI_NUMBER) || defined(__DOXYGEN__)
+#define PPC_SMP_IPI_NUMBER              0
+#endif
+
+/**
+ * @brief   Inter-core notifications handler name.
+ * @note    Must match @p PPC_SMP_IPI_NUMBER.
+ */
+#if !defined(PPC_SMP_IPI_HANDLER) || defined(__DOXYGEN__)
+#define PPC_SMP_IPI_HANDLER             vector0
+#endif
+
+/**
+ * @brief   Inter-core notifications INTC priority.
+ */
+#if !defined(PPC_SMP_IPI_PRIORITY) || defined(__DOXYGEN__)
+#define PPC_SMP_IPI_PRIORITY            1
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -132,6 +204,49 @@
 #error "the selected MCU does not support BookE instructions set"
 #endif
 
+#if PPC_USE_SPE && (PPC_VARIANT != PPC_VARIANT_e200z3) &&                   \
+                   (PPC_VARIANT != PPC_VARIANT_e200z4)
+#error "the selected MCU does not support the SPE"
+#endif
+
+#if PPC_USE_INTC_HW_VECTORS && !PPC_SUPPORTS_IVORS
+#error "INTC hardware vector mode requires IVOR registers"
+#endif
+
+#if !defined(PPC_CORES_NUMBER) || defined(__DOXYGEN__)
+/**
+ * @brief   Number of cores, single core devices do not specify it.
+ */
+#define PPC_CORES_NUMBER                1
+#endif
+
+/**
+ * @brief   SMP mode support.
+ */
+#define PORT_SUPPORTS_SMP               (PPC_CORES_NUMBER > 1)
+
+/**
+ * @brief   Number of cores.
+ */
+#define PORT_CORES_NUMBER               PPC_CORES_NUMBER
+
+#if CH_CFG_SMP_MODE && !PORT_SUPPORTS_SMP
+#error "CH_CFG_SMP_MODE requires a multi-core device"
+#endif
+
+#if CH_CFG_SMP_MODE && PPC_USE_IRQ_PREEMPTION
+#error "SMP mode is not compatible with PPC_USE_IRQ_PREEMPTION"
+#endif
+
+#if CH_CFG_SMP_MODE && (PPC_SMP_IPI_NUMBER > 7)
+#error "invalid PPC_SMP_IPI_NUMBER value specified"
+#endif
+
+#if CH_CFG_SMP_MODE && ((PPC_SMP_IPI_PRIORITY < 1) ||                      \
+                        (PPC_SMP_IPI_PRIORITY > 15))
+#error "invalid PPC_SMP_IPI_PRIORITY value specified"
+#endif
+
 /**
  * @brief   Name of the architecture variant.
  */
@@ -256,13 +371,39 @@ struct port_intctx {
   regppc_t      padding;
 };
 
+#if PPC_USE_SPE || defined(__DOXYGEN__)
+/**
+ * @brief   SPE saved context.
+ * @details This structure is pushed below the @p port_intctx structure
+ *          when switching out a thread using the SPE.
+ * @note    The GPRs are saved as 64 bits values, only the upper halves are
+ *          meaningful, the lower halves are also present in the
+ *          @p port_intctx and @p port_extctx structures.
+ */
+struct port_spectx {
+  uint64_t      r0;
+  uint64_t      r3_r31[29];
+  uint64_t      acc;
+  uint32_t      spefscr;
+  uint32_t      padding;
+};
+#endif
+
 /**
  * @brief   Platform dependent part of the @p Thread structure.
  * @details This structure usually contains just the saved stack pointer
  *          defined as a pointer to a @p port_intctx structure.
+ * @note    The @p sp field is at offset 12 in the @p thread_t structure
+ *          and @p spe at offset 16, the offsets are hard-coded in the
+ *          context switch code.
  */
 struct context {
   struct port_intctx *sp;
+#if PPC_USE_SPE || defined(__DOXYGEN__)
+  uint32_t      spe;                /**< @brief Thread is an SPE user, the
+                                         @p sp field points to a
+                                         @p port_spectx structure.          */
+#endif
 };
 
 #endif /* !defined(_FROM_ASM_) */
@@ -285,15 +426,31 @@ struct context {
   (tp)->p_ctx.sp = (struct port_intctx *)(sp - sizeof(struct port_intctx)); \
   (tp)->p_ctx.sp->r31 = (regppc_t)(arg);                                    \
   (tp)->p_ctx.sp->r30 = (regppc_t)(pf);                                     \
+  PORT_SETUP_SPE_CONTEXT(tp);                                               \
 }
 
+#if PPC_USE_SPE || defined(__DOXYGEN__)
+/**
+ * @brief   SPE part of the @p PORT_SETUP_CONTEXT() macro.
+ * @details Threads start as non-SPE users.
+ */
+#define PORT_SETUP_SPE_CONTEXT(tp) ((tp)->p_ctx.spe = 0)
+
 /**
  * @brief   Computes the thread working area global size.
  * @note    There is no need to perform alignments in this macro.
  */
 #define PORT_WA_SIZE(n) (sizeof(struct port_intctx) +                       \
                          sizeof(struct port_extctx) +                       \
+                         sizeof(struct port_spectx) +                       \
                          (n) + (PORT_INT_REQUIRED_STACK))
+#else
+#define PORT_SETUP_SPE_CONTEXT(tp)
+
+#define PORT_WA_SIZE(n) (sizeof(struct port_intctx) +                       \
+                         sizeof(struct port_extctx) +                       \
+                         (n) + (PORT_INT_REQUIRED_STACK))
+#endif
 
 /**
  * @brief   IRQ prologue code.
@@ -362,6 +519,29 @@ struct context {
 #define port_read_spr(spr, val)                                             \
   asm volatile ("mfspr   %[p0], %[p1]" : [p0] "=r" (val) : [p1] "n" (spr))
 
+/**
+ * @brief   Memory barrier.
+ * @details Orders the memory accesses as seen by the other bus masters,
+ *          required when publishing objects to another core.
+ */
+#define port_memory_barrier() asm volatile ("msync" : : : "memory")
+
+#if CH_CFG_SMP_MODE || defined(__DOXYGEN__)
+/**
+ * @brief   INTC base address of the specified core.
+ *
+ * @param[in] core      the core identifier
+ */
+#define PPC_INTC_BASE_OF(core) ((core) == 0U ? INTC_BASE : PPC_INTC1_BASE)
+
+/**
+ * @brief   SEMA4 gate register.
+ *
+ * @param[in] n         the gate number
+ */
+#define PPC_SEMA4_GATE(n) *((volatile uint8_t *)(PPC_SEMA4_BASE + (n)))
+#endif
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -375,6 +555,13 @@ extern "C" {
 #endif
   void _port_switch(thread_t *ntp, thread_t *otp);
   void _port_thread_start(void);
+#if PPC_USE_SPE
+  void _port_spe_enable(uint32_t nesting);
+#endif
+#if CH_CFG_SMP_MODE
+  void _port_spin_lock(void);
+  void _port_spin_unlock(void);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -389,9 +576,61 @@ extern "C" {
    asm module.*/
 #if !defined(_FROM_ASM_)
 
+#if CH_CFG_SMP_MODE || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the identifier of the current core.
+ *
+ * @return              The value of the PIR register.
+ */
+static inline unsigned port_get_core_id(void) {
+  unsigned pir;
+
+  port_read_spr(286, pir);
+  return pir;
+}
+
+/**
+ * @brief   Acquires the kernel spinlock.
+ * @details The SEMA4 gate is written with the core identifier plus one,
+ *          the write is ignored if the gate is owned by the other core.
+ * @note    Interrupts must be already disabled.
+ */
+static inline void port_spin_lock(void) {
+  uint8_t tag = (uint8_t)(port_get_core_id() + 1U);
+
+  do {
+    PPC_SEMA4_GATE(PPC_SMP_SPINLOCK_GATE) = tag;
+  } while (PPC_SEMA4_GATE(PPC_SMP_SPINLOCK_GATE) != tag);
+  asm volatile ("mbar    0" : : : "memory");
+}
+
+/**
+ * @brief   Releases the kernel spinlock.
+ */
+static inline void port_spin_unlock(void) {
+
+  asm volatile ("mbar    0" : : : "memory");
+  PPC_SEMA4_GATE(PPC_SMP_SPINLOCK_GATE) = 0;
+}
+
+/**
+ * @brief   Notifies another core.
+ * @details The inter-core software interrupt is triggered on the INTC of
+ *          the target core, the reschedule is performed on exit.
+ *
+ * @param[in] core      the target core identifier
+ */
+static inline void port_notify_core(unsigned core) {
+
+  INTC_SSCIR_OF(PPC_INTC_BASE_OF(core), PPC_SMP_IPI_NUMBER) = INTC_SSCIR_SET;
+}
+#endif /* CH_CFG_SMP_MODE */
+
 /**
  * @brief   Kernel port layer initialization.
- * @details IVOR4 and IVOR10 initialization.
+ * @details IVOR4 and IVOR10 initialization, Time Base activation.
+ * @note    In SMP mode the function is invoked by each core, the INTC of
+ *          the current core is initialized.
  */
 static inline void port_init(void) {
   uint32_t n;
@@ -401,17 +640,52 @@ static inline void port_init(void) {
   n = 0;
   port_write_spr(272, n);
 
+#if PORT_SUPPORTS_RT
+  /* Enabling the Time Base, HID0[TBEN], it is the realtime counter.*/
+  port_read_spr(1008, n);
+  n |= 0x00004000U;
+  port_write_spr(1008, n);
+#endif
+
 #if PPC_SUPPORTS_IVORS
   /* The CPU supports IVOR registers, the kernel requires IVOR4 and IVOR10
      and the initialization is performed here.*/
+#if PPC_USE_INTC_HW_VECTORS
+  asm volatile ("li          %%r3, _hwvectors@l   \t\n"
+                "mtIVOR4     %%r3                 \t\n"
+#else
   asm volatile ("li          %%r3, _IVOR4@l       \t\n"
                 "mtIVOR4     %%r3                 \t\n"
+#endif
                 "li          %%r3, _IVOR10@l      \t\n"
                 "mtIVOR10    %%r3" : : : "r3", "memory");
 #endif
 
+#if PPC_USE_SPE
+  /* SPE unavailable exception handler, the SPE is disabled until the first
+     SPE instruction is executed by a thread.*/
+  asm volatile ("li          %%r3, _IVOR32@l      \t\n"
+                "mtspr       528, %%r3            \t\n"
+                "mfmsr       %%r3                 \t\n"
+                "rlwinm      %%r3, %%r3, 0, 7, 5  \t\n"
+                "mtmsr       %%r3                 \t\n"
+                "isync" : : : "r3", "memory");
+#endif
+
   /* Interrupt controller initialization.*/
+#if CH_CFG_SMP_MODE
+  n = PPC_INTC_BASE_OF(port_get_core_id());
+  intc_init_at(n);
+  INTC_PSR_OF(n, PPC_SMP_IPI_NUMBER) = PPC_SMP_IPI_PRIORITY;
+#if PPC_USE_INTC_HW_VECTORS
+  INTC_MCR_OF(n) = INTC_MCR_HVEN;
+#endif
+#else /* !CH_CFG_SMP_MODE */
   intc_init();
+#if PPC_USE_INTC_HW_VECTORS
+  INTC_MCR = INTC_MCR_HVEN;
+#endif
+#endif /* !CH_CFG_SMP_MODE */
 }
 
 /**
@@ -539,8 +813,15 @@ static inline void port_wait_for_interrupt(void) {
  * @return              The realtime counter value.
  */
 static inline rtcnt_t port_rt_get_counter_value(void) {
+#if PORT_SUPPORTS_RT
+  rtcnt_t tbl;
 
+  /* Lower half of the Time Base, enabled in port_init().*/
+  port_read_spr(268, tbl);
+  return tbl;
+#else
   return 0;
+#endif
 }
 
 #endif /* !defined(_FROM_ASM_) */
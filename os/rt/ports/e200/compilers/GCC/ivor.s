@@ -47,19 +47,18 @@
          */
         .equ  INTC_IACKR, 0xfff48010
         .equ  INTC_EOIR,  0xfff48018
+#if CH_CFG_SMP_MODE
+        .equ  INTC1_IACKR, PPC_INTC1_BASE + 0x10
+        .equ  INTC1_EOIR,  PPC_INTC1_BASE + 0x18
+#endif
 
         .section    .handlers, "ax"
 
-#if PPC_SUPPORTS_DECREMENTER
         /*
-         * _IVOR10 handler (Book-E decrementer).
+         * Saves the external context (port_extctx structure) except the
+         * stack back link, the frame must be already allocated.
          */
-        .align      4
-        .globl      _IVOR10
-        .type       _IVOR10, @function
-_IVOR10:
-        /* Saving the external context (port_extctx structure).*/
-        stwu        %sp, -80(%sp)
+        .macro      IVOR_SAVE_CONTEXT
 #if PPC_USE_VLE && PPC_SUPPORTS_VLE_MULTI
         e_stmvsrrw  8(%sp)                  /* Saves PC, MSR.               */
         e_stmvsprw  16(%sp)                 /* Saves CR, LR, CTR, XER.      */
@@ -89,6 +88,39 @@ _IVOR10:
         stw         %r11, 68(%sp)
         stw         %r12, 72(%sp)
 #endif /* !(PPC_USE_VLE && PPC_SUPPORTS_VLE_MULTI) */
+        .endm
+
+        /*
+         * Loads the address of an INTC register of the current core, in
+         * SMP mode the PIR register selects the INTC and CR0 is modified.
+         */
+        .macro      INTC_LOAD_ADDR rd, addr0, addr1
+#if CH_CFG_SMP_MODE
+        mfspr       \rd, 286                /* PIR register.                */
+        cmpli       cr0, \rd, 0
+        lis         \rd, \addr0@h
+        ori         \rd, \rd, \addr0@l
+        beq         cr0, 1f
+        lis         \rd, \addr1@h
+        ori         \rd, \rd, \addr1@l
+1:
+#else
+        lis         \rd, \addr0@h
+        ori         \rd, \rd, \addr0@l
+#endif
+        .endm
+
+#if PPC_SUPPORTS_DECREMENTER
+        /*
+         * _IVOR10 handler (Book-E decrementer).
+         */
+        .align      4
+        .globl      _IVOR10
+        .type       _IVOR10, @function
+_IVOR10:
+        /* Saving the external context (port_extctx structure).*/
+        stwu        %sp, -80(%sp)
+        IVOR_SAVE_CONTEXT
 
         /* Increasing the SPGR0 register.*/
         mfspr       %r0, 272
@@ -104,6 +136,9 @@ _IVOR10:
         wrteei      1
 #endif
 
+#if CH_CFG_SMP_MODE
+        bl          _port_spin_lock
+#endif
 #if CH_DBG_SYSTEM_STATE_CHECK
         bl          _dbg_check_enter_isr
         bl          _dbg_check_lock_from_isr
@@ -114,6 +149,9 @@ _IVOR10:
         bl          _dbg_check_unlock_from_isr
         bl          _dbg_check_leave_isr
 #endif
+#if CH_CFG_SMP_MODE
+        bl          _port_spin_unlock
+#endif
 
 #if PPC_USE_IRQ_PREEMPTION
         /* Prevents preemption again.*/
@@ -133,35 +171,7 @@ _IVOR10:
 _IVOR4:
         /* Saving the external context (port_extctx structure).*/
         stwu        %sp, -80(%sp)
-#if PPC_USE_VLE && PPC_SUPPORTS_VLE_MULTI
-        e_stmvsrrw  8(%sp)                  /* Saves PC, MSR.               */
-        e_stmvsprw  16(%sp)                 /* Saves CR, LR, CTR, XER.      */
-        e_stmvgprw  32(%sp)                 /* Saves GPR0, GPR3...GPR12.    */
-#else /* !(PPC_USE_VLE && PPC_SUPPORTS_VLE_MULTI) */
-        stw         %r0, 32(%sp)            /* Saves GPR0.                  */
-        mfSRR0      %r0
-        stw         %r0, 8(%sp)             /* Saves PC.                    */
-        mfSRR1      %r0
-        stw         %r0, 12(%sp)            /* Saves MSR.                   */
-        mfCR        %r0
-        stw         %r0, 16(%sp)            /* Saves CR.                    */
-        mfLR        %r0
-        stw         %r0, 20(%sp)            /* Saves LR.                    */
-        mfCTR       %r0
-        stw         %r0, 24(%sp)            /* Saves CTR.                   */
-        mfXER       %r0
-        stw         %r0, 28(%sp)            /* Saves XER.                   */
-        stw         %r3, 36(%sp)            /* Saves GPR3...GPR12.          */
-        stw         %r4, 40(%sp)
-        stw         %r5, 44(%sp)
-        stw         %r6, 48(%sp)
-        stw         %r7, 52(%sp)
-        stw         %r8, 56(%sp)
-        stw         %r9, 60(%sp)
-        stw         %r10, 64(%sp)
-        stw         %r11, 68(%sp)
-        stw         %r12, 72(%sp)
-#endif /* !(PPC_USE_VLE && PPC_SUPPORTS_VLE_MULTI) */
+        IVOR_SAVE_CONTEXT
 
         /* Increasing the SPGR0 register.*/
         mfspr       %r0, 272
@@ -169,12 +179,13 @@ _IVOR4:
         mtspr       272, %r0
 
         /* Software vector address from the INTC register.*/
-        lis         %r3, INTC_IACKR@h
-        ori         %r3, %r3, INTC_IACKR@l  /* IACKR register address.      */
+        INTC_LOAD_ADDR %r3, INTC_IACKR, INTC1_IACKR
         lwz         %r3, 0(%r3)             /* IACKR register value.        */
         lwz         %r3, 0(%r3)
         mtCTR       %r3                     /* Software handler address.    */
 
+        /* Common IVOR4 code, the software handler address is in CTR.*/
+.ivor4_serve:
 #if PPC_USE_IRQ_PREEMPTION
         /* Allows preemption while executing the software handler.*/
         wrteei      1
@@ -190,8 +201,7 @@ _IVOR4:
 
         /* Informs the INTC that the interrupt has been served.*/
         mbar        0
-        lis         %r3, INTC_EOIR@h
-        ori         %r3, %r3, INTC_EOIR@l
+        INTC_LOAD_ADDR %r3, INTC_EOIR, INTC1_EOIR
         stw         %r3, 0(%r3)             /* Writing any value should do. */
 
         /* Common IVOR epilogue code, context restore.*/
@@ -202,6 +212,17 @@ _ivor_exit:
         eaddi       %r0, %r0, -1
         mtspr       272, %r0
 
+#if PPC_USE_IRQ_PREEMPTION
+        /* Returning to another ISR, the reschedule check is performed by
+           the outermost ISR only.*/
+        cmpli       cr0, %r0, 0
+        bne         cr0, .ivor_restore
+#endif
+
+#if CH_CFG_SMP_MODE
+        /* The ready list can also be modified by the other cores.*/
+        bl          _port_spin_lock
+#endif
 #if CH_DBG_STATISTICS
         bl          _stats_start_measure_crit_thd
 #endif
@@ -219,8 +240,12 @@ _ivor_exit:
 #if CH_DBG_STATISTICS
         bl          _stats_stop_measure_crit_thd
 #endif
+#if CH_CFG_SMP_MODE
+        bl          _port_spin_unlock
+#endif
 
         /* Restoring the external context.*/
+.ivor_restore:
 #if PPC_USE_VLE && PPC_SUPPORTS_VLE_MULTI
         e_lmvgprw   32(%sp)                 /* Restores GPR0, GPR3...GPR12. */
         e_lmvsprw   16(%sp)                 /* Restores CR, LR, CTR, XER.   */
@@ -253,6 +278,80 @@ _ivor_exit:
         addi        %sp, %sp, 80            /* Back to the previous frame.  */
         rfi
 
+#if PPC_USE_INTC_HW_VECTORS
+        /*
+         * Hardware vectors table, IVOR4 points here when the INTC is in
+         * hardware vector mode. Each 16 bytes entry allocates the frame,
+         * saves GPR3 in the padding slot and loads the vector number.
+         */
+        .align      4
+        .globl      _hwvectors
+_hwvectors:
+        .set        vnum, 0
+        .rept       PPC_NUM_VECTORS
+        .align      4
+        stwu        %sp, -80(%sp)
+        stw         %r3, 76(%sp)            /* GPR3 into the padding slot.  */
+        li          %r3, vnum               /* Vector number.               */
+        b           _ivor4_hw
+        .set        vnum, vnum + 1
+        .endr
+
+        /*
+         * Common hardware vectors code, the vector number is in GPR3.
+         */
+        .align      4
+        .type       _ivor4_hw, @function
+_ivor4_hw:
+        IVOR_SAVE_CONTEXT
+        lwz         %r4, 76(%sp)
+        stw         %r4, 36(%sp)            /* Saves the interrupted GPR3.  */
+
+        /* Increasing the SPGR0 register.*/
+        mfspr       %r0, 272
+        eaddi       %r0, %r0, 1
+        mtspr       272, %r0
+
+        /* Software handler address from the vectors table.*/
+        lis         %r4, _vectors@h
+        ori         %r4, %r4, _vectors@l
+        slwi        %r3, %r3, 2
+        lwzx        %r3, %r4, %r3
+        mtCTR       %r3                     /* Software handler address.    */
+        b           .ivor4_serve
+#endif /* PPC_USE_INTC_HW_VECTORS */
+
+#if PPC_USE_SPE
+        /*
+         * _IVOR32 handler (SPE unavailable).
+         */
+        .align      4
+        .globl      _IVOR32
+        .type       _IVOR32, @function
+_IVOR32:
+        /* Saving the external context (port_extctx structure).*/
+        stwu        %sp, -80(%sp)
+        IVOR_SAVE_CONTEXT
+
+        /* Increasing the SPGR0 register, the previous value is passed to
+           the service function.*/
+        mfspr       %r0, 272
+        mr          %r3, %r0
+        eaddi       %r0, %r0, 1
+        mtspr       272, %r0
+
+        /* Marks the current thread as SPE user.*/
+        bl          _port_spe_enable
+
+        /* The faulting instruction is re-executed with the SPE enabled.*/
+        lwz         %r0, 12(%sp)
+        oris        %r0, %r0, 0x0200        /* MSR[SPE] set.                */
+        stw         %r0, 12(%sp)
+
+        /* Jumps to the common IVOR epilogue code.*/
+        b           _ivor_exit
+#endif /* PPC_USE_SPE */
+
 #endif /* !defined(__DOXYGEN__) */
 
 /** @} */
@@ -15,6 +15,7 @@ KERNSRC = ${CHIBIOS}/os/rt/src/chsys.c \
           ${CHIBIOS}/os/rt/src/chevents.c \
           ${CHIBIOS}/os/rt/src/chmsg.c \
           ${CHIBIOS}/os/rt/src/chmboxes.c \
+          ${CHIBIOS}/os/rt/src/chrings.c \
           ${CHIBIOS}/os/rt/src/chqueues.c \
           ${CHIBIOS}/os/rt/src/chmemcore.c \
           ${CHIBIOS}/os/rt/src/chheap.c \
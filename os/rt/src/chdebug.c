@@ -82,7 +82,7 @@
  */
 void _dbg_check_disable(void) {
 
-  if ((ch.dbg_isr_cnt != 0) || (ch.dbg_lock_cnt != 0))
+  if ((currcore->dbg_isr_cnt != 0) || (currcore->dbg_lock_cnt != 0))
     chSysHalt("SV#1");
 }
 
@@ -93,7 +93,7 @@ void _dbg_check_disable(void) {
  */
 void _dbg_check_suspend(void) {
 
-  if ((ch.dbg_isr_cnt != 0) || (ch.dbg_lock_cnt != 0))
+  if ((currcore->dbg_isr_cnt != 0) || (currcore->dbg_lock_cnt != 0))
     chSysHalt("SV#2");
 }
 
@@ -104,7 +104,7 @@ void _dbg_check_suspend(void) {
  */
 void _dbg_check_enable(void) {
 
-  if ((ch.dbg_isr_cnt != 0) || (ch.dbg_lock_cnt != 0))
+  if ((currcore->dbg_isr_cnt != 0) || (currcore->dbg_lock_cnt != 0))
     chSysHalt("SV#3");
 }
 
@@ -115,7 +115,7 @@ void _dbg_check_enable(void) {
  */
 void _dbg_check_lock(void) {
 
-  if ((ch.dbg_isr_cnt != 0) || (ch.dbg_lock_cnt != 0))
+  if ((currcore->dbg_isr_cnt != 0) || (currcore->dbg_lock_cnt != 0))
     chSysHalt("SV#4");
   _dbg_enter_lock();
 }
@@ -127,7 +127,7 @@ void _dbg_check_lock(void) {
  */
 void _dbg_check_unlock(void) {
 
-  if ((ch.dbg_isr_cnt != 0) || (ch.dbg_lock_cnt <= 0))
+  if ((currcore->dbg_isr_cnt != 0) || (currcore->dbg_lock_cnt <= 0))
     chSysHalt("SV#5");
   _dbg_leave_lock();
 }
@@ -139,7 +139,7 @@ void _dbg_check_unlock(void) {
  */
 void _dbg_check_lock_from_isr(void) {
 
-  if ((ch.dbg_isr_cnt <= 0) || (ch.dbg_lock_cnt != 0))
+  if ((currcore->dbg_isr_cnt <= 0) || (currcore->dbg_lock_cnt != 0))
     chSysHalt("SV#6");
   _dbg_enter_lock();
 }
@@ -151,7 +151,7 @@ void _dbg_check_lock_from_isr(void) {
  */
 void _dbg_check_unlock_from_isr(void) {
 
-  if ((ch.dbg_isr_cnt <= 0) || (ch.dbg_lock_cnt <= 0))
+  if ((currcore->dbg_isr_cnt <= 0) || (currcore->dbg_lock_cnt <= 0))
     chSysHalt("SV#7");
   _dbg_leave_lock();
 }
@@ -164,9 +164,9 @@ void _dbg_check_unlock_from_isr(void) {
 void _dbg_check_enter_isr(void) {
 
   port_lock_from_isr();
-  if ((ch.dbg_isr_cnt < 0) || (ch.dbg_lock_cnt != 0))
+  if ((currcore->dbg_isr_cnt < 0) || (currcore->dbg_lock_cnt != 0))
     chSysHalt("SV#8");
-  ch.dbg_isr_cnt++;
+  currcore->dbg_isr_cnt++;
   port_unlock_from_isr();
 }
 
@@ -178,9 +178,9 @@ void _dbg_check_enter_isr(void) {
 void _dbg_check_leave_isr(void) {
 
   port_lock_from_isr();
-  if ((ch.dbg_isr_cnt <= 0) || (ch.dbg_lock_cnt != 0))
+  if ((currcore->dbg_isr_cnt <= 0) || (currcore->dbg_lock_cnt != 0))
     chSysHalt("SV#9");
-  ch.dbg_isr_cnt--;
+  currcore->dbg_isr_cnt--;
   port_unlock_from_isr();
 }
 
@@ -194,7 +194,7 @@ void _dbg_check_leave_isr(void) {
  */
 void chDbgCheckClassI(void) {
 
-  if ((ch.dbg_isr_cnt < 0) || (ch.dbg_lock_cnt <= 0))
+  if ((currcore->dbg_isr_cnt < 0) || (currcore->dbg_lock_cnt <= 0))
     chSysHalt("SV#10");
 }
 
@@ -208,7 +208,7 @@ void chDbgCheckClassI(void) {
  */
 void chDbgCheckClassS(void) {
 
-  if ((ch.dbg_isr_cnt != 0) || (ch.dbg_lock_cnt <= 0))
+  if ((currcore->dbg_isr_cnt != 0) || (currcore->dbg_lock_cnt <= 0))
     chSysHalt("SV#11");
 }
 
@@ -221,8 +221,8 @@ void chDbgCheckClassS(void) {
  */
 void _trace_init(void) {
 
-  ch.dbg_trace_buffer.tb_size = CH_DBG_TRACE_BUFFER_SIZE;
-  ch.dbg_trace_buffer.tb_ptr = &ch.dbg_trace_buffer.tb_buffer[0];
+  currcore->dbg_trace_buffer.tb_size = CH_DBG_TRACE_BUFFER_SIZE;
+  currcore->dbg_trace_buffer.tb_ptr = &currcore->dbg_trace_buffer.tb_buffer[0];
 }
 
 /**
@@ -234,13 +234,14 @@ void _trace_init(void) {
  */
 void _dbg_trace(thread_t *otp) {
 
-  ch.dbg_trace_buffer.tb_ptr->se_time   = chVTGetSystemTimeX();
-  ch.dbg_trace_buffer.tb_ptr->se_tp     = currp;
-  ch.dbg_trace_buffer.tb_ptr->se_wtobjp = otp->p_u.wtobjp;
-  ch.dbg_trace_buffer.tb_ptr->se_state  = (uint8_t)otp->p_state;
-  if (++ch.dbg_trace_buffer.tb_ptr >=
-      &ch.dbg_trace_buffer.tb_buffer[CH_DBG_TRACE_BUFFER_SIZE])
-    ch.dbg_trace_buffer.tb_ptr = &ch.dbg_trace_buffer.tb_buffer[0];
+  currcore->dbg_trace_buffer.tb_ptr->se_time   = chVTGetSystemTimeX();
+  currcore->dbg_trace_buffer.tb_ptr->se_tp     = currp;
+  currcore->dbg_trace_buffer.tb_ptr->se_wtobjp = otp->p_u.wtobjp;
+  currcore->dbg_trace_buffer.tb_ptr->se_state  = (uint8_t)otp->p_state;
+  if (++currcore->dbg_trace_buffer.tb_ptr >=
+      &currcore->dbg_trace_buffer.tb_buffer[CH_DBG_TRACE_BUFFER_SIZE])
+    currcore->dbg_trace_buffer.tb_ptr =
+      &currcore->dbg_trace_buffer.tb_buffer[0];
 }
 #endif /* CH_DBG_ENABLE_TRACE */
 
@@ -74,6 +74,17 @@
 /* Module local types.                                                       */
 /*===========================================================================*/
 
+/**
+ * @brief   Threads to be made ready by a broadcast.
+ * @details The list is @p NULL terminated and kept in insertion order.
+ */
+typedef struct {
+  thread_t              *head;      /**< @brief First thread or @p NULL.    */
+  thread_t              *tail;      /**< @brief Last thread.                */
+  bool                  ordered;    /**< @brief The list is already in
+                                                decreasing priority order.  */
+} evt_batch_t;
+
 /*===========================================================================*/
 /* Module local variables.                                                   */
 /*===========================================================================*/
@@ -82,6 +93,107 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Verifies if a thread waiting for events must be awakened.
+ *
+ * @param[in] tp        the thread to be checked
+ * @return              The wakeup condition.
+ *
+ * @notapi
+ */
+static inline bool evt_wakeup_required(thread_t *tp) {
+
+  /* Test on the AND/OR conditions wait states.*/
+  return (bool)(((tp->p_state == CH_STATE_WTOREVT) &&
+                 ((tp->p_epending & tp->p_u.ewmask) != 0)) ||
+                ((tp->p_state == CH_STATE_WTANDEVT) &&
+                 ((tp->p_epending & tp->p_u.ewmask) == tp->p_u.ewmask)));
+}
+
+/**
+ * @brief   Appends a thread to a list of threads to be made ready.
+ * @note    The thread is marked as ready immediately so that further
+ *          listeners owned by the same thread cannot queue it twice.
+ *
+ * @param[in] tp        the thread to be added
+ * @param[in] bp        pointer to the @p evt_batch_t structure
+ *
+ * @notapi
+ */
+static void evt_batch_append(thread_t *tp, evt_batch_t *bp) {
+
+  tp->p_u.rdymsg = MSG_OK;
+  tp->p_state = CH_STATE_READY;
+  tp->p_next = NULL;
+  if (bp->head == NULL)
+    bp->head = tp;
+  else {
+    if (bp->tail->p_prio < tp->p_prio)
+      bp->ordered = false;
+    bp->tail->p_next = tp;
+  }
+  bp->tail = tp;
+}
+
+/**
+ * @brief   Orders a list of threads to be made ready.
+ * @details Bottom-up merge sort, the list is ordered by decreasing priority
+ *          and threads with equal priority are kept in insertion order. The
+ *          time is O(n log n) and no extra memory is used.
+ *
+ * @param[in] bp        pointer to the @p evt_batch_t structure
+ *
+ * @notapi
+ */
+static void evt_batch_sort(evt_batch_t *bp) {
+  thread_t *list = bp->head;
+  unsigned width, merges;
+
+  width = 1;
+  do {
+    thread_t *p = list, *tail = NULL;
+
+    list = NULL;
+    merges = 0;
+    while (p != NULL) {
+      thread_t *q = p;
+      unsigned psize = 0, qsize = width;
+
+      /* Merging the run starting at p with the following one at q.*/
+      merges++;
+      while ((psize < width) && (q != NULL)) {
+        psize++;
+        q = q->p_next;
+      }
+      while ((psize > 0) || ((qsize > 0) && (q != NULL))) {
+        thread_t *e;
+
+        if ((psize > 0) &&
+            ((qsize == 0) || (q == NULL) || (p->p_prio >= q->p_prio))) {
+          e = p;
+          p = p->p_next;
+          psize--;
+        }
+        else {
+          e = q;
+          q = q->p_next;
+          qsize--;
+        }
+        if (tail == NULL)
+          list = e;
+        else
+          tail->p_next = e;
+        tail = e;
+      }
+      p = q;
+    }
+    tail->p_next = NULL;
+    bp->tail = tail;
+    width <<= 1;
+  } while (merges > 1);
+  bp->head = list;
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -89,20 +201,27 @@
 /**
  * @brief   Registers an Event Listener on an Event Source.
  * @details Once a thread has registered as listener on an event source it
- *          will be notified of all events broadcasted there.
+ *          will be notified of the events broadcasted there, a broadcast
+ *          specifying flags only signals the listener if at least one of
+ *          the flags is also present in @p wflags.
  * @note    Multiple Event Listeners can specify the same bits to be ORed to
  *          different threads.
+ * @note    Filtered out broadcasts still add their flags to the listener,
+ *          the filter only prevents the thread from being signaled.
  *
  * @param[in] esp       pointer to the  @p event_source_t structure
  * @param[in] elp       pointer to the @p event_listener_t structure
  * @param[in] mask      the mask of event flags to be ORed to the thread when
  *                      the event source is broadcasted
+ * @param[in] wflags    mask of flags the listening thread is interested in,
+ *                      broadcasts without flags are always signaled
  *
  * @api
  */
-void chEvtRegisterMask(event_source_t *esp,
-                       event_listener_t *elp,
-                       eventmask_t mask) {
+void chEvtRegisterMaskWithFlags(event_source_t *esp,
+                                event_listener_t *elp,
+                                eventmask_t mask,
+                                eventflags_t wflags) {
 
   chDbgCheck((esp != NULL) && (elp != NULL));
 
@@ -112,6 +231,7 @@ void chEvtRegisterMask(event_source_t *esp,
   elp->el_listener = currp;
   elp->el_mask     = mask;
   elp->el_flags    = 0;
+  elp->el_wflags   = wflags;
   chSysUnlock();
 }
 
@@ -191,6 +311,11 @@ eventmask_t chEvtAddEvents(eventmask_t mask) {
  *          threads registered on the @p event_source_t in addition to the
  *          event flags specified by the threads themselves in the
  *          @p event_listener_t objects.
+ * @note    Listeners registered with a flags filter are only signaled if
+ *          @p flags is zero or has at least one flag in common with the
+ *          filter.
+ * @note    The awakened threads are inserted in the ready list at once
+ *          after all the listeners have been processed.
  * @post    This function does not reschedule so a call to a rescheduling
  *          function must be performed before unlocking the kernel. Note that
  *          interrupt handlers always reschedule on exit so an explicit
@@ -203,16 +328,38 @@ eventmask_t chEvtAddEvents(eventmask_t mask) {
  */
 void chEvtBroadcastFlagsI(event_source_t *esp, eventflags_t flags) {
   event_listener_t *elp;
+  evt_batch_t batch;
 
   chDbgCheckClassI();
   chDbgCheck(esp != NULL);
 
+  /* The threads to be awakened are collected, ordered by priority and
+     then inserted in the ready list in a single pass.*/
+  batch.head    = NULL;
+  batch.ordered = true;
   elp = esp->es_next;
   while (elp != (event_listener_t *)esp) {
     elp->el_flags |= flags;
-    chEvtSignalI(elp->el_listener, elp->el_mask);
+    /* Listeners not interested in any of the broadcasted flags are
+       skipped.*/
+    if ((flags == 0) || ((elp->el_wflags & flags) != 0)) {
+      thread_t *tp = elp->el_listener;
+
+      tp->p_epending |= elp->el_mask;
+      if (evt_wakeup_required(tp))
+        evt_batch_append(tp, &batch);
+    }
     elp = elp->el_next;
   }
+  if (batch.head != NULL) {
+    threads_list_t tl;
+
+    if (!batch.ordered)
+      evt_batch_sort(&batch);
+    tl.p_next = batch.head;
+    batch.tail->p_next = (thread_t *)&tl;
+    chSchReadyListI(&tl);
+  }
 }
 
 /**
@@ -274,11 +421,7 @@ void chEvtSignalI(thread_t *tp, eventmask_t mask) {
   chDbgCheck(tp != NULL);
 
   tp->p_epending |= mask;
-  /* Test on the AND/OR conditions wait states.*/
-  if (((tp->p_state == CH_STATE_WTOREVT) &&
-       ((tp->p_epending & tp->p_u.ewmask) != 0)) ||
-      ((tp->p_state == CH_STATE_WTANDEVT) &&
-       ((tp->p_epending & tp->p_u.ewmask) == tp->p_u.ewmask))) {
+  if (evt_wakeup_required(tp)) {
     tp->p_u.rdymsg = MSG_OK;
     chSchReadyI(tp);
   }
@@ -31,6 +31,13 @@
  *          Memory Pools do not enforce any alignment constraint on the
  *          contained object however the objects must be properly aligned
  *          to contain a pointer to void.
+ *          <h2>Pool caches</h2>
+ *          Threads allocating and releasing objects frequently can place
+ *          a private cache in front of a pool, objects are served from the
+ *          cache without entering the kernel and the pool is accessed in
+ *          batches only when the cache is found empty or full. Cached
+ *          objects are returned to the pool when the owner thread exits.
+ *          Caches require the @p CH_CFG_USE_POOLCACHES option.
  * @pre     In order to use the memory pools APIs the @p CH_CFG_USE_MEMPOOLS option
  *          must be enabled in @p chconf.h.
  * @{
@@ -56,6 +63,30 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if CH_CFG_USE_POOLCACHES || defined(__DOXYGEN__)
+/**
+ * @brief   Unlinks objects from the top of a pool cache.
+ *
+ * @param[in] pcp       pointer to a @p pool_cache_t structure
+ * @param[in] n         number of objects to be unlinked, must be greater
+ *                      than zero and not greater than the cached objects
+ * @param[out] lastp    pointer to the last unlinked object
+ * @return              The pointer to the first unlinked object.
+ */
+static struct pool_header *cache_unlink(pool_cache_t *pcp, cnt_t n,
+                                        struct pool_header **lastp) {
+  struct pool_header *first, *last;
+
+  first = last = pcp->pc_objs;
+  pcp->pc_cnt -= n;
+  while (--n > 0)
+    last = last->ph_next;
+  pcp->pc_objs = last->ph_next;
+  *lastp = last;
+  return first;
+}
+#endif /* CH_CFG_USE_POOLCACHES */
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -189,6 +220,195 @@ void chPoolFree(memory_pool_t *mp, void *objp) {
   chSysUnlock();
 }
 
+#if CH_CFG_USE_POOLCACHES || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes an empty pool cache.
+ * @details The cache is bound to the calling thread, only the owner thread
+ *          can allocate and release objects through the cache.
+ * @note    The cached objects are returned to the pool when the owner
+ *          thread exits, this requires the cache structure to outlive the
+ *          thread, for example a static structure. A cache declared in a
+ *          function stack frame must be disposed using
+ *          @p chPoolCacheDispose() before the function returns.
+ *
+ * @param[out] pcp      pointer to a @p pool_cache_t structure
+ * @param[in] mp        pointer to the underlying @p memory_pool_t structure
+ * @param[in] size      maximum number of cached objects, zero selects the
+ *                      default @p CH_CFG_POOLCACHE_SIZE value
+ *
+ * @api
+ */
+void chPoolCacheObjectInit(pool_cache_t *pcp, memory_pool_t *mp,
+                           cnt_t size) {
+
+  chDbgCheck((pcp != NULL) && (mp != NULL) && (size != 1));
+
+  pcp->pc_pool   = mp;
+  pcp->pc_objs   = NULL;
+  pcp->pc_cnt    = 0;
+  pcp->pc_size   = size > 0 ? size : CH_CFG_POOLCACHE_SIZE;
+  pcp->pc_hits   = 0;
+  pcp->pc_misses = 0;
+
+  /* The list is only accessed by the owner thread, no critical zone.*/
+  pcp->pc_next   = currp->p_pcaches;
+  currp->p_pcaches = pcp;
+}
+
+/**
+ * @brief   Allocates an object through a pool cache.
+ * @details If the cache is empty then it is refilled with half of its
+ *          capacity in a single critical zone.
+ * @note    This function must be invoked by the owner thread only.
+ *
+ * @param[in] pcp       pointer to a @p pool_cache_t structure
+ * @return              The pointer to the allocated object.
+ * @retval NULL         if both the cache and the pool are empty.
+ *
+ * @api
+ */
+void *chPoolCacheAlloc(pool_cache_t *pcp) {
+  struct pool_header *php, *last;
+  memory_pool_t *mp;
+  cnt_t n;
+
+  chDbgCheck(pcp != NULL);
+
+  if ((php = pcp->pc_objs) != NULL) {
+    pcp->pc_objs = php->ph_next;
+    pcp->pc_cnt--;
+    pcp->pc_hits++;
+    return php;
+  }
+
+  /* Cache miss, the returned object can come from the pool provider, the
+     refill only takes the objects already in the pool.*/
+  pcp->pc_misses++;
+  mp = pcp->pc_pool;
+  chSysLock();
+  php = chPoolAllocI(mp);
+  if ((php != NULL) && ((last = mp->mp_next) != NULL)) {
+    pcp->pc_objs = last;
+    n = 1;
+    while ((n < pcp->pc_size / 2) && (last->ph_next != NULL)) {
+      last = last->ph_next;
+      n++;
+    }
+    mp->mp_next = last->ph_next;
+    last->ph_next = NULL;
+    pcp->pc_cnt = n;
+  }
+  chSysUnlock();
+  return php;
+}
+
+/**
+ * @brief   Releases an object through a pool cache.
+ * @details If the cache is full then half of its objects are returned to
+ *          the pool in a single, constant time, critical zone.
+ * @pre     The freed object must be of the right size for the underlying
+ *          memory pool.
+ * @note    This function must be invoked by the owner thread only.
+ *
+ * @param[in] pcp       pointer to a @p pool_cache_t structure
+ * @param[in] objp      the pointer to the object to be released
+ *
+ * @api
+ */
+void chPoolCacheFree(pool_cache_t *pcp, void *objp) {
+  struct pool_header *php = objp, *first, *last;
+
+  chDbgCheck((pcp != NULL) && (objp != NULL));
+
+  if (pcp->pc_cnt >= pcp->pc_size) {
+    pcp->pc_misses++;
+    first = cache_unlink(pcp, pcp->pc_size / 2, &last);
+    chSysLock();
+    last->ph_next = pcp->pc_pool->mp_next;
+    pcp->pc_pool->mp_next = first;
+    chSysUnlock();
+  }
+  else
+    pcp->pc_hits++;
+  php->ph_next = pcp->pc_objs;
+  pcp->pc_objs = php;
+  pcp->pc_cnt++;
+}
+
+/**
+ * @brief   Returns all the cached objects to the underlying pool.
+ * @note    This function must be invoked by the owner thread only.
+ *
+ * @param[in] pcp       pointer to a @p pool_cache_t structure
+ *
+ * @api
+ */
+void chPoolCacheFlush(pool_cache_t *pcp) {
+  struct pool_header *first, *last;
+
+  chDbgCheck(pcp != NULL);
+
+  if (pcp->pc_cnt > 0) {
+    first = cache_unlink(pcp, pcp->pc_cnt, &last);
+    chSysLock();
+    last->ph_next = pcp->pc_pool->mp_next;
+    pcp->pc_pool->mp_next = first;
+    chSysUnlock();
+  }
+}
+
+/**
+ * @brief   Disposes a pool cache.
+ * @details The cached objects are returned to the pool and the cache is
+ *          unbound from the owner thread, after this the structure can be
+ *          deallocated.
+ * @note    This function must be invoked by the owner thread only.
+ *
+ * @param[in] pcp       pointer to a @p pool_cache_t structure
+ *
+ * @api
+ */
+void chPoolCacheDispose(pool_cache_t *pcp) {
+  pool_cache_t **pcpp = &currp->p_pcaches;
+
+  chPoolCacheFlush(pcp);
+  while (*pcpp != NULL) {
+    if (*pcpp == pcp) {
+      *pcpp = pcp->pc_next;
+      return;
+    }
+    pcpp = &(*pcpp)->pc_next;
+  }
+  chDbgAssert(false, "not owned");
+}
+
+/**
+ * @brief   Returns the objects cached by a thread to their pools.
+ * @details All the caches owned by the thread are emptied and unbound.
+ * @note    This function is invoked by @p chThdExitS() in the context of
+ *          the exiting thread.
+ *
+ * @param[in] tp        pointer to the exiting thread
+ *
+ * @notapi
+ */
+void _pool_caches_release(thread_t *tp) {
+  pool_cache_t *pcp;
+  struct pool_header *first, *last;
+
+  chDbgCheckClassS();
+
+  for (pcp = tp->p_pcaches; pcp != NULL; pcp = pcp->pc_next) {
+    if (pcp->pc_cnt > 0) {
+      first = cache_unlink(pcp, pcp->pc_cnt, &last);
+      last->ph_next = pcp->pc_pool->mp_next;
+      pcp->pc_pool->mp_next = first;
+    }
+  }
+  tp->p_pcaches = NULL;
+}
+#endif /* CH_CFG_USE_POOLCACHES */
+
 #endif /* CH_CFG_USE_MEMPOOLS */
 
 /** @} */
@@ -33,6 +33,9 @@
  *            in the system.
  *          - <b>Next</b>, returns the next, in creation order, active thread
  *            in the system.
+ *          - <b>Stack Unused</b>, returns the amount of stack never used by
+ *            a thread since its creation, this is the high water mark of the
+ *            thread stack and can be used in order to size the working areas.
  *          .
  *          The registry is meant to be mainly a debug feature, for example,
  *          using the registry a debugger can enumerate the active threads
@@ -131,7 +134,7 @@ thread_t *chRegFirstThread(void) {
   thread_t *tp;
 
   chSysLock();
-  tp = ch.rlist.r_newer;
+  tp = currcore->rlist.r_newer;
 #if CH_CFG_USE_DYNAMIC
   tp->p_refs++;
 #endif
@@ -155,7 +158,7 @@ thread_t *chRegNextThread(thread_t *tp) {
 
   chSysLock();
   ntp = tp->p_newer;
-  if (ntp == (thread_t *)&ch.rlist)
+  if (ntp == (thread_t *)&currcore->rlist)
     ntp = NULL;
 #if CH_CFG_USE_DYNAMIC
   else {
@@ -170,6 +173,62 @@ thread_t *chRegNextThread(thread_t *tp) {
   return ntp;
 }
 
+#if (CH_DBG_FILL_THREADS && CH_DBG_ENABLE_STACK_CHECK) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the unused stack space of a thread.
+ * @details The stack area is scanned, starting from the stack limit, until
+ *          the first byte not matching @p CH_DBG_STACK_FILL_VALUE is found.
+ *          The scan is performed using stack words after the initial
+ *          unaligned part so its cost is modest even on large stacks.
+ * @pre     The options @p CH_DBG_FILL_THREADS and
+ *          @p CH_DBG_ENABLE_STACK_CHECK must be enabled in @p chconf.h, the
+ *          stack check is required because it provides the stack limit of
+ *          the main thread.
+ * @note    Threads created using @p chThdCreateI() do not have the stack
+ *          filled, the returned value is meaningless for those threads.
+ * @note    The main thread stack is filled by the startup code, the fill
+ *          value must match @p CH_DBG_STACK_FILL_VALUE.
+ * @note    The value can only decrease during the thread lifetime, it can
+ *          be read from any context but the thread must be kept alive
+ *          using a reference or by other means.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The number of stack bytes never used by the thread.
+ *
+ * @xclass
+ */
+size_t chRegGetStackUnusedX(thread_t *tp) {
+  const stkalign_t pattern = ((stkalign_t)-1 / (stkalign_t)0xFF) *
+                             (stkalign_t)CH_DBG_STACK_FILL_VALUE;
+  uint8_t *startp, *p;
+  stkalign_t *wp;
+
+  chDbgCheck(tp != NULL);
+
+  startp = (uint8_t *)tp->p_stklimit;
+
+  /* Leading bytes up to the first stack word boundary.*/
+  p = startp;
+  while (((size_t)p & (sizeof (stkalign_t) - 1)) != 0) {
+    if (*p != CH_DBG_STACK_FILL_VALUE)
+      return (size_t)(p - startp);
+    p++;
+  }
+
+  /* Word-wide scan, the stack top is always in use so the loop is bounded
+     by the thread context.*/
+  wp = (stkalign_t *)p;
+  while (*wp == pattern)
+    wp++;
+
+  /* Locating the first used byte inside the mismatching word.*/
+  p = (uint8_t *)wp;
+  while (*p == CH_DBG_STACK_FILL_VALUE)
+    p++;
+  return (size_t)(p - startp);
+}
+#endif /* CH_DBG_FILL_THREADS && CH_DBG_ENABLE_STACK_CHECK */
+
 #endif /* CH_CFG_USE_REGISTRY */
 
 /** @} */
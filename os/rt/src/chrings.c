@@ -0,0 +1,627 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    chrings.c
+ * @brief   Lock-free ring buffers code.
+ *
+ * @addtogroup ring_buffers
+ * @details Lock-free ring buffers of fixed size objects.
+ *          <h2>Operation mode</h2>
+ *          A ring buffer is a circular buffer of fixed size objects meant
+ *          to transport data between interrupt handlers and threads without
+ *          entering critical zones. Two variants are available:
+ *          - <b>Single producer, single consumer</b>, @p ring_buffer_t,
+ *            the producer only writes the write counter and the consumer
+ *            only writes the read counter, no atomic operations are
+ *            required.
+ *          - <b>Multiple producers, single consumer</b>,
+ *            @p mp_ring_buffer_t, producers reserve slots using an atomic
+ *            compare-and-swap (LDREX/STREX on ARMv7-M) and publish them
+ *            through per-slot sequence counters.
+ *          .
+ *          Operations defined for ring buffers:
+ *          - <b>Reserve</b>, the producer obtains a pointer to one or more
+ *            contiguous free slots where objects can be built in place.
+ *          - <b>Commit</b>, the reserved slots are made visible to the
+ *            consumer, a waiting consumer is awakened.
+ *          - <b>Fetch</b>, the consumer obtains a pointer to one or more
+ *            contiguous objects.
+ *          - <b>Release</b>, the fetched slots are returned to the
+ *            producers.
+ *          - <b>Put/Get</b>, single object copy variants of the above.
+ *          - <b>Wait</b>, the consumer thread waits for an object to become
+ *            available.
+ *          .
+ *          The number of objects in a ring buffer must be a power of two.
+ * @note    The wakeup of a waiting consumer requires a critical zone so
+ *          the commit functions can only be invoked from contexts allowed
+ *          to enter the kernel. Fast interrupts above the kernel priority
+ *          can produce objects only if the consumer polls the buffer.
+ * @pre     In order to use the ring buffers APIs the
+ *          @p CH_CFG_USE_RINGBUFFERS option must be enabled in
+ *          @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if CH_CFG_USE_RINGBUFFERS || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Copies an object.
+ * @note    Ring buffer objects are usually small, a simple loop is used
+ *          in order to not depend on the C library.
+ */
+static void rb_copy(uint8_t *dp, const uint8_t *sp, size_t n) {
+
+  while (n > 0) {
+    *dp++ = *sp++;
+    n--;
+  }
+}
+
+/**
+ * @brief   Awakens the consumer thread if it is waiting.
+ *
+ * @param[in] trp       pointer to the consumer thread reference
+ */
+static void rb_wakeup(thread_reference_t *trp) {
+
+  /* The reference is checked out of the critical zone, this is safe because
+     the consumer sets it atomically after checking for an empty buffer.*/
+  if (*trp != NULL) {
+    syssts_t sts = chSysGetStatusAndLockX();
+    chThdResumeI(trp, MSG_OK);
+    chSysRestoreStatusX(sts);
+  }
+}
+
+/**
+ * @brief   Atomic compare-and-swap.
+ *
+ * @param[in] p         pointer to the variable to be updated
+ * @param[in] cmp       expected current value
+ * @param[in] val       new value
+ * @return              The operation result.
+ * @retval true         if the variable has been updated.
+ * @retval false        if the variable did not match @p cmp.
+ */
+static inline bool rb_cas(volatile uint32_t *p, uint32_t cmp, uint32_t val) {
+#if PORT_SUPPORTS_ATOMIC_CAS
+
+  return port_atomic_cas(p, cmp, val);
+#else /* !PORT_SUPPORTS_ATOMIC_CAS */
+  syssts_t sts;
+  bool b = false;
+
+  sts = chSysGetStatusAndLockX();
+  if (*p == cmp) {
+    *p = val;
+    b = true;
+  }
+  chSysRestoreStatusX(sts);
+  return b;
+#endif /* !PORT_SUPPORTS_ATOMIC_CAS */
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p ring_buffer_t object.
+ *
+ * @param[out] rbp      pointer to the @p ring_buffer_t structure to be
+ *                      initialized
+ * @param[in] buffer    pointer to the objects buffer, the buffer must be
+ *                      large enough to contain @p n objects
+ * @param[in] objsize   size of a single object
+ * @param[in] n         number of objects in the buffer, must be a power of
+ *                      two greater than one
+ *
+ * @init
+ */
+void chRBObjectInit(ring_buffer_t *rbp, void *buffer,
+                    size_t objsize, size_t n) {
+
+  chDbgCheck((rbp != NULL) && (buffer != NULL) && (objsize > 0) &&
+             (n > 1) && ((n & (n - 1)) == 0));
+
+  rbp->rb_buffer  = (uint8_t *)buffer;
+  rbp->rb_objsize = objsize;
+  rbp->rb_mask    = (uint32_t)n - 1;
+  rbp->rb_wrcnt   = 0;
+  rbp->rb_rdcnt   = 0;
+  rbp->rb_thread  = NULL;
+}
+
+/**
+ * @brief   Reserves contiguous free slots in a ring buffer.
+ * @details The producer can build the objects in place then make them
+ *          visible to the consumer using @p chRBCommitX().
+ * @note    Less than @p n slots are returned if the buffer does not have
+ *          enough free space or if the free space wraps around the end
+ *          of the buffer.
+ * @note    This function must be invoked by the producer only.
+ *
+ * @param[in] rbp       pointer to the @p ring_buffer_t structure
+ * @param[out] objpp    pointer to a pointer to the first reserved slot
+ * @param[in] n         number of slots requested
+ * @return              The number of reserved slots.
+ * @retval 0            if the buffer is full.
+ *
+ * @xclass
+ */
+size_t chRBReserveX(ring_buffer_t *rbp, void **objpp, size_t n) {
+  uint32_t wrcnt, idx;
+  size_t free;
+
+  chDbgCheck((rbp != NULL) && (objpp != NULL));
+
+  wrcnt = rbp->rb_wrcnt;
+  idx   = wrcnt & rbp->rb_mask;
+  free  = (size_t)(rbp->rb_mask + 1) - (size_t)(wrcnt - rbp->rb_rdcnt);
+  if (n > free)
+    n = free;
+  if (n > (size_t)(rbp->rb_mask + 1 - idx))
+    n = (size_t)(rbp->rb_mask + 1 - idx);
+  *objpp = rbp->rb_buffer + idx * rbp->rb_objsize;
+  return n;
+}
+
+/**
+ * @brief   Commits slots previously reserved using @p chRBReserveX().
+ * @details The objects become visible to the consumer, if the consumer is
+ *          waiting then it is awakened.
+ * @note    This function must be invoked by the producer only.
+ *
+ * @param[in] rbp       pointer to the @p ring_buffer_t structure
+ * @param[in] n         number of slots to be committed, it cannot exceed
+ *                      the number of reserved slots
+ *
+ * @xclass
+ */
+void chRBCommitX(ring_buffer_t *rbp, size_t n) {
+
+  chDbgCheck(rbp != NULL);
+
+  /* The objects must be in memory before the counter is updated.*/
+  port_memory_barrier();
+  rbp->rb_wrcnt += (uint32_t)n;
+  rb_wakeup(&rbp->rb_thread);
+}
+
+/**
+ * @brief   Copies an object into a ring buffer.
+ * @note    This function must be invoked by the producer only.
+ *
+ * @param[in] rbp       pointer to the @p ring_buffer_t structure
+ * @param[in] objp      pointer to the object to be copied
+ * @return              The operation status.
+ * @retval MSG_OK       if the object has been inserted.
+ * @retval MSG_TIMEOUT  if the ring buffer is full.
+ *
+ * @xclass
+ */
+msg_t chRBPutX(ring_buffer_t *rbp, const void *objp) {
+  void *p;
+
+  if (chRBReserveX(rbp, &p, 1) == 0)
+    return MSG_TIMEOUT;
+  rb_copy((uint8_t *)p, (const uint8_t *)objp, rbp->rb_objsize);
+  chRBCommitX(rbp, 1);
+  return MSG_OK;
+}
+
+/**
+ * @brief   Fetches contiguous objects from a ring buffer.
+ * @details The objects can be accessed in place then the slots must be
+ *          returned to the producer using @p chRBReleaseX().
+ * @note    Less than @p n objects are returned if the buffer does not
+ *          contain enough objects or if the objects wrap around the end
+ *          of the buffer.
+ * @note    This function must be invoked by the consumer only.
+ *
+ * @param[in] rbp       pointer to the @p ring_buffer_t structure
+ * @param[out] objpp    pointer to a pointer to the first object
+ * @param[in] n         number of objects requested
+ * @return              The number of available objects.
+ * @retval 0            if the buffer is empty.
+ *
+ * @xclass
+ */
+size_t chRBFetchX(ring_buffer_t *rbp, void **objpp, size_t n) {
+  uint32_t rdcnt, idx;
+  size_t used;
+
+  chDbgCheck((rbp != NULL) && (objpp != NULL));
+
+  rdcnt = rbp->rb_rdcnt;
+  idx   = rdcnt & rbp->rb_mask;
+  used  = (size_t)(rbp->rb_wrcnt - rdcnt);
+  if (n > used)
+    n = used;
+  if (n > (size_t)(rbp->rb_mask + 1 - idx))
+    n = (size_t)(rbp->rb_mask + 1 - idx);
+  /* The objects must not be accessed before the counter is read.*/
+  port_memory_barrier();
+  *objpp = rbp->rb_buffer + idx * rbp->rb_objsize;
+  return n;
+}
+
+/**
+ * @brief   Releases slots previously fetched using @p chRBFetchX().
+ * @note    This function must be invoked by the consumer only.
+ *
+ * @param[in] rbp       pointer to the @p ring_buffer_t structure
+ * @param[in] n         number of slots to be released, it cannot exceed
+ *                      the number of fetched objects
+ *
+ * @xclass
+ */
+void chRBReleaseX(ring_buffer_t *rbp, size_t n) {
+
+  chDbgCheck(rbp != NULL);
+
+  /* The objects must have been consumed before the counter is updated.*/
+  port_memory_barrier();
+  rbp->rb_rdcnt += (uint32_t)n;
+}
+
+/**
+ * @brief   Copies an object out of a ring buffer.
+ * @note    This function must be invoked by the consumer only.
+ *
+ * @param[in] rbp       pointer to the @p ring_buffer_t structure
+ * @param[out] objp     pointer to the object to be filled
+ * @return              The operation status.
+ * @retval MSG_OK       if an object has been retrieved.
+ * @retval MSG_TIMEOUT  if the ring buffer is empty.
+ *
+ * @xclass
+ */
+msg_t chRBGetX(ring_buffer_t *rbp, void *objp) {
+  void *p;
+
+  if (chRBFetchX(rbp, &p, 1) == 0)
+    return MSG_TIMEOUT;
+  rb_copy((uint8_t *)objp, (const uint8_t *)p, rbp->rb_objsize);
+  chRBReleaseX(rbp, 1);
+  return MSG_OK;
+}
+
+/**
+ * @brief   Waits for an object to become available in a ring buffer.
+ * @details The consumer thread is suspended until the producer commits
+ *          an object, if the buffer is not empty the function returns
+ *          immediately.
+ * @note    Only the consumer thread can wait on a ring buffer.
+ *
+ * @param[in] rbp       pointer to the @p ring_buffer_t structure
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if an object is available.
+ * @retval MSG_TIMEOUT  if the buffer is still empty after the specified
+ *                      time.
+ *
+ * @api
+ */
+msg_t chRBWaitTimeout(ring_buffer_t *rbp, systime_t time) {
+  msg_t msg = MSG_OK;
+
+  chDbgCheck(rbp != NULL);
+
+  chSysLock();
+  if (chRBIsEmptyX(rbp))
+    msg = chThdSuspendTimeoutS(&rbp->rb_thread, time);
+  chSysUnlock();
+  return msg;
+}
+
+/**
+ * @brief   Initializes a @p mp_ring_buffer_t object.
+ *
+ * @param[out] mprbp    pointer to the @p mp_ring_buffer_t structure to be
+ *                      initialized
+ * @param[in] buffer    pointer to the objects buffer, the buffer must be
+ *                      large enough to contain @p n objects
+ * @param[in] seq       pointer to an array of @p n sequence counters
+ * @param[in] objsize   size of a single object
+ * @param[in] n         number of objects in the buffer, must be a power of
+ *                      two greater than one
+ *
+ * @init
+ */
+void chMPRBObjectInit(mp_ring_buffer_t *mprbp, void *buffer,
+                      uint32_t *seq, size_t objsize, size_t n) {
+  size_t i;
+
+  chDbgCheck((mprbp != NULL) && (buffer != NULL) && (seq != NULL) &&
+             (objsize > 0) && (n > 1) && ((n & (n - 1)) == 0));
+
+  mprbp->mprb_buffer  = (uint8_t *)buffer;
+  mprbp->mprb_seq     = seq;
+  mprbp->mprb_objsize = objsize;
+  mprbp->mprb_mask    = (uint32_t)n - 1;
+  mprbp->mprb_wrcnt   = 0;
+  mprbp->mprb_rdcnt   = 0;
+  mprbp->mprb_thread  = NULL;
+  for (i = 0; i < n; i++)
+    seq[i] = 0;
+}
+
+/**
+ * @brief   Reserves contiguous free slots in a multiple producers ring
+ *          buffer.
+ * @details The producer can build the objects in place then make them
+ *          visible to the consumer using @p chMPRBCommitX().
+ * @note    Less than @p n slots are returned if the buffer does not have
+ *          enough free space or if the free space wraps around the end
+ *          of the buffer.
+ *
+ * @param[in] mprbp     pointer to the @p mp_ring_buffer_t structure
+ * @param[out] objpp    pointer to a pointer to the first reserved slot
+ * @param[in] n         number of slots requested
+ * @return              The number of reserved slots.
+ * @retval 0            if the buffer is full.
+ *
+ * @xclass
+ */
+size_t chMPRBReserveX(mp_ring_buffer_t *mprbp, void **objpp, size_t n) {
+  uint32_t cnt, idx, base;
+  size_t k, max;
+
+  chDbgCheck((mprbp != NULL) && (objpp != NULL));
+
+  while (true) {
+    cnt  = mprbp->mprb_wrcnt;
+    idx  = cnt & mprbp->mprb_mask;
+    base = cnt & ~mprbp->mprb_mask;
+    max  = (size_t)(mprbp->mprb_mask + 1 - idx);
+    if (max > n)
+      max = n;
+
+    /* Counting the free slots, the consumer releases the slots in order so
+       the free slots are always a contiguous sequence.*/
+    k = 0;
+    while ((k < max) && (mprbp->mprb_seq[idx + k] == base))
+      k++;
+    if (k == 0) {
+      /* If the first slot still belongs to the previous lap then the buffer
+         is full, else another producer reserved it and the counter value
+         is stale.*/
+      if ((int32_t)(mprbp->mprb_seq[idx] - base) < 0)
+        return 0;
+      continue;
+    }
+    if (rb_cas(&mprbp->mprb_wrcnt, cnt, cnt + (uint32_t)k))
+      break;
+  }
+  *objpp = mprbp->mprb_buffer + idx * mprbp->mprb_objsize;
+  return k;
+}
+
+/**
+ * @brief   Commits slots previously reserved using @p chMPRBReserveX().
+ * @details The objects become visible to the consumer, if the consumer is
+ *          waiting then it is awakened.
+ *
+ * @param[in] mprbp     pointer to the @p mp_ring_buffer_t structure
+ * @param[in] objp      pointer to the first slot to be committed as returned
+ *                      by @p chMPRBReserveX()
+ * @param[in] n         number of slots to be committed, it cannot exceed
+ *                      the number of reserved slots
+ *
+ * @xclass
+ */
+void chMPRBCommitX(mp_ring_buffer_t *mprbp, void *objp, size_t n) {
+  uint32_t idx;
+
+  chDbgCheck((mprbp != NULL) && (objp != NULL));
+
+  idx = (uint32_t)(((uint8_t *)objp - mprbp->mprb_buffer) /
+                   mprbp->mprb_objsize);
+
+  /* The objects must be in memory before the sequence counters are
+     updated.*/
+  port_memory_barrier();
+  while (n > 0) {
+    /* The reserved slots are owned by this producer, no atomic operations
+       are required.*/
+    mprbp->mprb_seq[idx]++;
+    idx++;
+    n--;
+  }
+  rb_wakeup(&mprbp->mprb_thread);
+}
+
+/**
+ * @brief   Copies an object into a multiple producers ring buffer.
+ *
+ * @param[in] mprbp     pointer to the @p mp_ring_buffer_t structure
+ * @param[in] objp      pointer to the object to be copied
+ * @return              The operation status.
+ * @retval MSG_OK       if the object has been inserted.
+ * @retval MSG_TIMEOUT  if the ring buffer is full.
+ *
+ * @xclass
+ */
+msg_t chMPRBPutX(mp_ring_buffer_t *mprbp, const void *objp) {
+  void *p;
+
+  if (chMPRBReserveX(mprbp, &p, 1) == 0)
+    return MSG_TIMEOUT;
+  rb_copy((uint8_t *)p, (const uint8_t *)objp, mprbp->mprb_objsize);
+  chMPRBCommitX(mprbp, p, 1);
+  return MSG_OK;
+}
+
+/**
+ * @brief   Fetches contiguous objects from a multiple producers ring
+ *          buffer.
+ * @details The objects can be accessed in place then the slots must be
+ *          returned to the producers using @p chMPRBReleaseX().
+ * @note    Only committed objects are returned, the sequence stops at the
+ *          first slot reserved but not yet committed.
+ * @note    This function must be invoked by the consumer only.
+ *
+ * @param[in] mprbp     pointer to the @p mp_ring_buffer_t structure
+ * @param[out] objpp    pointer to a pointer to the first object
+ * @param[in] n         number of objects requested
+ * @return              The number of available objects.
+ * @retval 0            if the buffer is empty.
+ *
+ * @xclass
+ */
+size_t chMPRBFetchX(mp_ring_buffer_t *mprbp, void **objpp, size_t n) {
+  uint32_t cnt, idx, base;
+  size_t k, max;
+
+  chDbgCheck((mprbp != NULL) && (objpp != NULL));
+
+  cnt  = mprbp->mprb_rdcnt;
+  idx  = cnt & mprbp->mprb_mask;
+  base = cnt & ~mprbp->mprb_mask;
+  max  = (size_t)(mprbp->mprb_mask + 1 - idx);
+  if (max > n)
+    max = n;
+  k = 0;
+  while ((k < max) && (mprbp->mprb_seq[idx + k] == base + 1))
+    k++;
+  /* The objects must not be accessed before the counters are read.*/
+  port_memory_barrier();
+  *objpp = mprbp->mprb_buffer + idx * mprbp->mprb_objsize;
+  return k;
+}
+
+/**
+ * @brief   Releases slots previously fetched using @p chMPRBFetchX().
+ * @note    This function must be invoked by the consumer only.
+ *
+ * @param[in] mprbp     pointer to the @p mp_ring_buffer_t structure
+ * @param[in] n         number of slots to be released, it cannot exceed
+ *                      the number of fetched objects
+ *
+ * @xclass
+ */
+void chMPRBReleaseX(mp_ring_buffer_t *mprbp, size_t n) {
+  uint32_t cnt, idx, base;
+
+  chDbgCheck(mprbp != NULL);
+
+  cnt  = mprbp->mprb_rdcnt;
+  idx  = cnt & mprbp->mprb_mask;
+  base = cnt & ~mprbp->mprb_mask;
+
+  /* The objects must have been consumed before the slots are returned.*/
+  port_memory_barrier();
+  mprbp->mprb_rdcnt = cnt + (uint32_t)n;
+  while (n > 0) {
+    /* The slot becomes free for the next lap.*/
+    mprbp->mprb_seq[idx] = base + mprbp->mprb_mask + 1;
+    idx++;
+    n--;
+  }
+}
+
+/**
+ * @brief   Copies an object out of a multiple producers ring buffer.
+ * @note    This function must be invoked by the consumer only.
+ *
+ * @param[in] mprbp     pointer to the @p mp_ring_buffer_t structure
+ * @param[out] objp     pointer to the object to be filled
+ * @return              The operation status.
+ * @retval MSG_OK       if an object has been retrieved.
+ * @retval MSG_TIMEOUT  if the ring buffer is empty.
+ *
+ * @xclass
+ */
+msg_t chMPRBGetX(mp_ring_buffer_t *mprbp, void *objp) {
+  void *p;
+
+  if (chMPRBFetchX(mprbp, &p, 1) == 0)
+    return MSG_TIMEOUT;
+  rb_copy((uint8_t *)objp, (const uint8_t *)p, mprbp->mprb_objsize);
+  chMPRBReleaseX(mprbp, 1);
+  return MSG_OK;
+}
+
+/**
+ * @brief   Waits for an object to become available in a multiple producers
+ *          ring buffer.
+ * @details The consumer thread is suspended until a producer commits an
+ *          object, if an object is available the function returns
+ *          immediately.
+ * @note    Only the consumer thread can wait on a ring buffer.
+ * @note    The thread can be awakened by a producer committing an object
+ *          behind a slot still reserved by another producer, in this case
+ *          @p chMPRBFetchX() can still return zero and the wait must be
+ *          repeated.
+ *
+ * @param[in] mprbp     pointer to the @p mp_ring_buffer_t structure
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if an object is available or a producer committed
+ *                      an object.
+ * @retval MSG_TIMEOUT  if the buffer is still empty after the specified
+ *                      time.
+ *
+ * @api
+ */
+msg_t chMPRBWaitTimeout(mp_ring_buffer_t *mprbp, systime_t time) {
+  msg_t msg = MSG_OK;
+
+  chDbgCheck(mprbp != NULL);
+
+  chSysLock();
+  if (chMPRBIsEmptyX(mprbp))
+    msg = chThdSuspendTimeoutS(&mprbp->mprb_thread, time);
+  chSysUnlock();
+  return msg;
+}
+
+#endif /* CH_CFG_USE_RINGBUFFERS */
+
+/** @} */
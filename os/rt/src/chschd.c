@@ -37,10 +37,17 @@
 /* Module exported variables.                                                */
 /*===========================================================================*/
 
+#if CH_CFG_SMP_MODE || defined(__DOXYGEN__)
+/**
+ * @brief   System data structures, one instance for each core.
+ */
+PORT_SYSTEM_DATA ch_system_t ch_cores[PORT_CORES_NUMBER];
+#else
 /**
  * @brief   System data structures.
  */
-ch_system_t ch;
+PORT_SYSTEM_DATA ch_system_t ch;
+#endif
 
 /*===========================================================================*/
 /* Module local types.                                                       */
@@ -65,10 +72,11 @@ ch_system_t ch;
  */
 void _scheduler_init(void) {
 
-  queue_init(&ch.rlist.r_queue);
-  ch.rlist.r_prio = NOPRIO;
+  queue_init(&currcore->rlist.r_queue);
+  currcore->rlist.r_prio = NOPRIO;
 #if CH_CFG_USE_REGISTRY
-  ch.rlist.r_newer = ch.rlist.r_older = (thread_t *)&ch.rlist;
+  currcore->rlist.r_newer = (thread_t *)&currcore->rlist;
+  currcore->rlist.r_older = (thread_t *)&currcore->rlist;
 #endif
 }
 
@@ -220,8 +228,13 @@ thread_t *chSchReadyI(thread_t *tp) {
               (tp->p_state != CH_STATE_FINAL),
               "invalid state");
 
+  _stats_ready(tp);
   tp->p_state = CH_STATE_READY;
-  cp = (thread_t *)&ch.rlist.r_queue;
+#if CH_CFG_SMP_MODE
+  cp = (thread_t *)&tp->p_core->rlist.r_queue;
+#else
+  cp = (thread_t *)&currcore->rlist.r_queue;
+#endif
   do {
     cp = cp->p_next;
   } while (cp->p_prio >= tp->p_prio);
@@ -229,9 +242,94 @@ thread_t *chSchReadyI(thread_t *tp) {
   tp->p_next = cp;
   tp->p_prev = cp->p_prev;
   tp->p_prev->p_next = cp->p_prev = tp;
+#if CH_CFG_SMP_MODE
+  /* A thread made ready by another core, the owner core is notified and
+     performs the reschedule on the interrupt exit.*/
+  if (!_sch_is_local(tp))
+    port_notify_core((unsigned)(tp->p_core - ch_cores));
+#endif
   return tp;
 }
 
+/**
+ * @brief   Inserts a list of threads in the Ready List.
+ * @details The threads are moved from the list into the ready list in a
+ *          single pass, each thread is positioned behind all threads with
+ *          higher or equal priority. This is much faster than invoking
+ *          @p chSchReadyI() on each thread when several threads become
+ *          ready at once, the ready list is only scanned once.
+ * @pre     The threads in the list must be ordered by decreasing priority,
+ *          threads with equal priority are made ready in list order.
+ * @pre     The threads must not be already inserted in any other list
+ *          through their @p p_next and @p p_prev or list corruption would
+ *          occur.
+ * @post    The list is left empty.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note that
+ *          interrupt handlers always reschedule on exit so an explicit
+ *          reschedule must not be performed in ISRs.
+ * @note    In SMP mode the threads can be owned by different cores, each
+ *          thread is inserted in the ready list of its owner core and the
+ *          core is notified if it is not the current one. The scan restarts
+ *          only when the owner core changes between consecutive threads.
+ *
+ * @param[in] tlp       pointer to the threads list header
+ *
+ * @iclass
+ */
+void chSchReadyListI(threads_list_t *tlp) {
+  thread_t *tp;
+#if CH_CFG_SMP_MODE
+  thread_t *cp = NULL;
+  ch_system_t *corep = NULL;
+#else
+  thread_t *cp = (thread_t *)&currcore->rlist.r_queue;
+#endif
+
+  chDbgCheckClassI();
+  chDbgCheck(tlp != NULL);
+
+  tp = tlp->p_next;
+  while (tp != (thread_t *)tlp) {
+    thread_t *ntp = tp->p_next;
+
+    chDbgAssert(tp->p_state != CH_STATE_FINAL, "invalid state");
+    chDbgAssert((ntp == (thread_t *)tlp) || (ntp->p_prio <= tp->p_prio),
+                "not ordered");
+
+    /* Note, the caller may already have marked the thread as ready while
+       building the list, chSchReadyI() would reject it.*/
+    _stats_ready(tp);
+    tp->p_state = CH_STATE_READY;
+#if CH_CFG_SMP_MODE
+    /* Each core has its own ready list, the search restarts from the head
+       of the owner's list when the owner changes.*/
+    if (tp->p_core != corep) {
+      corep = tp->p_core;
+      cp = (thread_t *)&corep->rlist.r_queue;
+    }
+#endif
+    /* The search restarts from the previous insertion point because the
+       list is ordered, the ready list is scanned only once.*/
+    do {
+      cp = cp->p_next;
+    } while (cp->p_prio >= tp->p_prio);
+    /* Insertion on p_prev.*/
+    tp->p_next = cp;
+    tp->p_prev = cp->p_prev;
+    tp->p_prev->p_next = cp->p_prev = tp;
+    cp = tp;
+#if CH_CFG_SMP_MODE
+    /* A thread made ready by another core, the owner core is notified and
+       performs the reschedule on the interrupt exit.*/
+    if (!_sch_is_local(tp))
+      port_notify_core((unsigned)(corep - ch_cores));
+#endif
+    tp = ntp;
+  }
+  tlp->p_next = (thread_t *)tlp;
+}
+
 /**
  * @brief   Puts the current thread to sleep into the specified state.
  * @details The thread goes into a sleeping state. The possible
@@ -252,7 +350,7 @@ void chSchGoSleepS(tstate_t newstate) {
      time quantum when it will wakeup.*/
   otp->p_preempt = CH_CFG_TIME_QUANTUM;
 #endif
-  setcurrp(queue_fifo_remove(&ch.rlist.r_queue));
+  setcurrp(queue_fifo_remove(&currcore->rlist.r_queue));
 #if defined(CH_CFG_IDLE_ENTER_HOOK)
   if (currp->p_prio == IDLEPRIO) {
     CH_CFG_IDLE_ENTER_HOOK();
@@ -344,6 +442,8 @@ msg_t chSchGoSleepTimeoutS(tstate_t newstate, systime_t time) {
  *          @p chSchRescheduleS() but much more efficient.
  * @note    The function assumes that the current thread has the highest
  *          priority.
+ * @note    In SMP mode a thread owned by another core is just made ready,
+ *          the owner core performs the reschedule.
  *
  * @param[in] ntp       the thread to be made ready
  * @param[in] msg       the wakeup message
@@ -362,11 +462,12 @@ void chSchWakeupS(thread_t *ntp, msg_t msg) {
      one then it is just inserted in the ready list else it made
      running immediately and the invoking thread goes in the ready
      list instead.*/
-  if (ntp->p_prio <= currp->p_prio) {
+  if ((ntp->p_prio <= currp->p_prio) || !_sch_is_local(ntp)) {
     chSchReadyI(ntp);
   }
   else {
     thread_t *otp = chSchReadyI(currp);
+    _stats_ready(ntp);
     setcurrp(ntp);
 #if defined(CH_CFG_IDLE_LEAVE_HOOK)
   if (otp->p_prio == IDLEPRIO) {
@@ -407,7 +508,7 @@ void chSchRescheduleS(void) {
  * @special
  */
 bool chSchIsPreemptionRequired(void) {
-  tprio_t p1 = firstprio(&ch.rlist.r_queue);
+  tprio_t p1 = firstprio(&currcore->rlist.r_queue);
   tprio_t p2 = currp->p_prio;
 #if CH_CFG_TIME_QUANTUM > 0
   /* If the running thread has not reached its time quantum, reschedule only
@@ -432,12 +533,12 @@ bool chSchIsPreemptionRequired(void) {
  *
  * @special
  */
-void chSchDoRescheduleBehind(void) {
+PORT_HOT_CODE void chSchDoRescheduleBehind(void) {
   thread_t *otp;
 
   otp = currp;
   /* Picks the first thread from the ready queue and makes it current.*/
-  setcurrp(queue_fifo_remove(&ch.rlist.r_queue));
+  setcurrp(queue_fifo_remove(&currcore->rlist.r_queue));
 #if defined(CH_CFG_IDLE_LEAVE_HOOK)
   if (otp->p_prio == IDLEPRIO) {
     CH_CFG_IDLE_LEAVE_HOOK();
@@ -460,12 +561,12 @@ void chSchDoRescheduleBehind(void) {
  *
  * @special
  */
-void chSchDoRescheduleAhead(void) {
+PORT_HOT_CODE void chSchDoRescheduleAhead(void) {
   thread_t *otp, *cp;
 
   otp = currp;
   /* Picks the first thread from the ready queue and makes it current.*/
-  setcurrp(queue_fifo_remove(&ch.rlist.r_queue));
+  setcurrp(queue_fifo_remove(&currcore->rlist.r_queue));
 #if defined(CH_CFG_IDLE_LEAVE_HOOK)
   if (otp->p_prio == IDLEPRIO) {
     CH_CFG_IDLE_LEAVE_HOOK();
@@ -474,7 +575,7 @@ void chSchDoRescheduleAhead(void) {
   currp->p_state = CH_STATE_CURRENT;
 
   otp->p_state = CH_STATE_READY;
-  cp = (thread_t *)&ch.rlist.r_queue;
+  cp = (thread_t *)&currcore->rlist.r_queue;
   do {
     cp = cp->p_next;
   } while (cp->p_prio > otp->p_prio);
@@ -496,7 +597,7 @@ void chSchDoRescheduleAhead(void) {
  *
  * @special
  */
-void chSchDoReschedule(void) {
+PORT_HOT_CODE void chSchDoReschedule(void) {
 
 #if CH_CFG_TIME_QUANTUM > 0
   /* If CH_CFG_TIME_QUANTUM is enabled then there are two different scenarios
@@ -51,6 +51,83 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if CH_DBG_STATS_HISTOGRAMS || CH_DBG_IRQ_STATISTICS || defined(__DOXYGEN__)
+/**
+ * @brief   Clears a duration histogram.
+ *
+ * @param[out] hp       pointer to the @p stats_histogram_t structure
+ */
+static void stats_hist_init(stats_histogram_t *hp) {
+  unsigned i;
+
+  for (i = 0; i < CH_DBG_HISTOGRAM_BINS; i++)
+    hp->bins[i] = 0;
+}
+
+/**
+ * @brief   Accounts a duration in an histogram.
+ *
+ * @param[in] hp        pointer to the @p stats_histogram_t structure
+ * @param[in] d         the duration in realtime counter cycles
+ */
+static void stats_hist_update(stats_histogram_t *hp, rtcnt_t d) {
+  unsigned i;
+
+  /* Logarithmic histogram bin.*/
+  d >>= CH_DBG_HISTOGRAM_SHIFT;
+  i = 0;
+  while ((d > 0) && (i < CH_DBG_HISTOGRAM_BINS - 1)) {
+    d >>= 1;
+    i++;
+  }
+  hp->bins[i]++;
+}
+#endif
+
+#if CH_DBG_STATS_HISTOGRAMS || defined(__DOXYGEN__)
+/**
+ * @brief   Stops the measurement of a critical zone.
+ * @details The histogram is updated and, if the zone is the longest one,
+ *          its caller is recorded.
+ *
+ * @param[in] tmp       pointer to the zone measurement
+ * @param[in] hp        pointer to the zone histogram
+ * @param[out] worstp   pointer to the caller of the longest zone
+ * @param[in] caller    caller of the zone being closed
+ */
+static void stats_stop_crit(time_measurement_t *tmp, stats_histogram_t *hp,
+                            void **worstp, void *caller) {
+  rtcnt_t worst = tmp->worst;
+
+  chTMStopMeasurementX(tmp);
+  stats_hist_update(hp, tmp->last);
+  if (tmp->worst > worst)
+    *worstp = caller;
+}
+#endif
+
+/**
+ * @brief   Copies a measurement into a statistics record.
+ *
+ * @param[out] srp      pointer to the @p stats_record_t structure
+ * @param[in] tmp       pointer to the measurement
+ * @param[in] hp        pointer to the histogram or @p NULL
+ * @param[in] caller    caller of the worst case or @p NULL
+ */
+static void stats_fill_record(stats_record_t *srp, time_measurement_t *tmp,
+                              stats_histogram_t *hp, void *caller) {
+  unsigned i;
+
+  srp->cumulative = (uint64_t)tmp->cumulative;
+  srp->n          = (uint32_t)tmp->n;
+  srp->best       = (uint32_t)tmp->best;
+  srp->worst      = (uint32_t)tmp->worst;
+  srp->last       = (uint32_t)tmp->last;
+  srp->caller     = (uint32_t)(size_t)caller;
+  for (i = 0; i < CH_DBG_HISTOGRAM_BINS; i++)
+    srp->hist[i] = hp != NULL ? (uint32_t)hp->bins[i] : 0U;
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -62,35 +139,97 @@
  */
 void _stats_init(void) {
 
-  ch.kernel_stats.n_irq = 0;
-  ch.kernel_stats.n_ctxswc = 0;
-  chTMObjectInit(&ch.kernel_stats.m_crit_thd);
-  chTMObjectInit(&ch.kernel_stats.m_crit_isr);
+  currcore->kernel_stats.n_irq = 0;
+  currcore->kernel_stats.n_ctxswc = 0;
+  chTMObjectInit(&currcore->kernel_stats.m_crit_thd);
+  chTMObjectInit(&currcore->kernel_stats.m_crit_isr);
+#if CH_DBG_STATS_HISTOGRAMS
+  chTMObjectInit(&currcore->kernel_stats.m_resched);
+  stats_hist_init(&currcore->kernel_stats.h_crit_thd);
+  stats_hist_init(&currcore->kernel_stats.h_crit_isr);
+  stats_hist_init(&currcore->kernel_stats.h_resched);
+  currcore->kernel_stats.c_crit_thd = NULL;
+  currcore->kernel_stats.c_crit_isr = NULL;
+  currcore->kernel_stats.c_thd = NULL;
+  currcore->kernel_stats.c_isr = NULL;
+#endif
+#if CH_DBG_IRQ_STATISTICS
+  {
+    unsigned i;
+
+    for (i = 0; i < PORT_IRQ_VECTORS_NUMBER; i++) {
+      chTMObjectInit(&currcore->kernel_stats.irq[i].m_isr);
+      stats_hist_init(&currcore->kernel_stats.irq[i].hist);
+    }
+  }
+#endif
 }
 
 /**
  * @brief   Increases the IRQ counter.
+ * @details If @p CH_DBG_IRQ_STATISTICS is enabled then the measurement of
+ *          the ISR duration is also started.
  */
 void _stats_increase_irq(void) {
 
-  ch.kernel_stats.n_irq++;
+  currcore->kernel_stats.n_irq++;
+#if CH_DBG_IRQ_STATISTICS
+  chTMStartMeasurementX(
+    &currcore->kernel_stats.irq[port_get_irq_vector()].m_isr);
+#endif
 }
 
 /**
  * @brief   Updates context switch related statistics.
+ * @details If @p CH_DBG_STATS_HISTOGRAMS is enabled and the thread being
+ *          switched in has been woken then the reschedule latency is
+ *          also measured.
  */
 void _stats_ctxswc(thread_t *ntp, thread_t *otp) {
 
-  ch.kernel_stats.n_ctxswc++;
+  currcore->kernel_stats.n_ctxswc++;
   chTMChainMeasurementToX(&otp->p_stats, &ntp->p_stats);
+#if CH_DBG_STATS_HISTOGRAMS
+  if (ntp->p_readymark) {
+    ntp->p_readymark = false;
+
+    /* The ready time stamp is the start of the measurement.*/
+    currcore->kernel_stats.m_resched.last = ntp->p_readyts;
+    chTMStopMeasurementX(&currcore->kernel_stats.m_resched);
+    stats_hist_update(&currcore->kernel_stats.h_resched,
+                      currcore->kernel_stats.m_resched.last);
+  }
+#endif
+}
+
+#if CH_DBG_STATS_HISTOGRAMS || defined(__DOXYGEN__)
+/**
+ * @brief   Marks the time a thread is made ready.
+ * @details Threads re-inserted in the ready list because preempted are
+ *          not marked, only threads leaving a wait state are.
+ *
+ * @param[in] tp        the thread being made ready
+ */
+void _stats_ready(thread_t *tp) {
+
+  if (tp->p_state != CH_STATE_CURRENT) {
+    tp->p_readyts   = chSysGetRealtimeCounterX();
+    tp->p_readymark = true;
+  }
 }
+#endif
 
 /**
  * @brief   Starts the measurement of a thread critical zone.
+ * @note    The function is not inlined so the caller of the critical zone
+ *          can be recorded.
  */
-void _stats_start_measure_crit_thd(void) {
+NOINLINE void _stats_start_measure_crit_thd(void) {
 
-  chTMStartMeasurementX(&ch.kernel_stats.m_crit_thd);
+#if CH_DBG_STATS_HISTOGRAMS
+  currcore->kernel_stats.c_thd = _stats_get_caller();
+#endif
+  chTMStartMeasurementX(&currcore->kernel_stats.m_crit_thd);
 }
 
 /**
@@ -98,15 +237,27 @@ void _stats_start_measure_crit_thd(void) {
  */
 void _stats_stop_measure_crit_thd(void) {
 
-  chTMStopMeasurementX(&ch.kernel_stats.m_crit_thd);
+#if CH_DBG_STATS_HISTOGRAMS
+  kernel_stats_t *ksp = &currcore->kernel_stats;
+
+  stats_stop_crit(&ksp->m_crit_thd, &ksp->h_crit_thd,
+                  &ksp->c_crit_thd, ksp->c_thd);
+#else
+  chTMStopMeasurementX(&currcore->kernel_stats.m_crit_thd);
+#endif
 }
 
 /**
  * @brief   Starts the measurement of an ISR critical zone.
+ * @note    The function is not inlined so the caller of the critical zone
+ *          can be recorded.
  */
-void _stats_start_measure_crit_isr(void) {
+NOINLINE void _stats_start_measure_crit_isr(void) {
 
-  chTMStartMeasurementX(&ch.kernel_stats.m_crit_isr);
+#if CH_DBG_STATS_HISTOGRAMS
+  currcore->kernel_stats.c_isr = _stats_get_caller();
+#endif
+  chTMStartMeasurementX(&currcore->kernel_stats.m_crit_isr);
 }
 
 /**
@@ -114,7 +265,101 @@ void _stats_start_measure_crit_isr(void) {
  */
 void _stats_stop_measure_crit_isr(void) {
 
-  chTMStopMeasurementX(&ch.kernel_stats.m_crit_isr);
+#if CH_DBG_STATS_HISTOGRAMS
+  kernel_stats_t *ksp = &currcore->kernel_stats;
+
+  stats_stop_crit(&ksp->m_crit_isr, &ksp->h_crit_isr,
+                  &ksp->c_crit_isr, ksp->c_isr);
+#else
+  chTMStopMeasurementX(&currcore->kernel_stats.m_crit_isr);
+#endif
+}
+
+#if CH_DBG_IRQ_STATISTICS || defined(__DOXYGEN__)
+/**
+ * @brief   Stops the measurement of an ISR duration.
+ * @details The measurement is accounted to the vector being served and its
+ *          duration histogram is updated.
+ * @note    A vector cannot preempt itself so the measurement objects are
+ *          not shared between nested ISRs.
+ */
+void _stats_stop_measure_irq(void) {
+  irq_stats_t *isp = &currcore->kernel_stats.irq[port_get_irq_vector()];
+
+  chTMStopMeasurementX(&isp->m_isr);
+  stats_hist_update(&isp->hist, isp->m_isr.last);
+}
+#endif
+
+/**
+ * @brief   Returns a consistent copy of a statistics record.
+ * @details The identifiers are @p STATS_ID_CRIT_THD, @p STATS_ID_CRIT_ISR,
+ *          @p STATS_ID_RESCHED and, if @p CH_DBG_IRQ_STATISTICS is enabled,
+ *          @p STATS_ID_IRQ_BASE plus the port vector number. The records
+ *          not collected in the current configuration have no
+ *          measurements.
+ *
+ * @param[in] id        the record identifier
+ * @param[out] srp      pointer to the @p stats_record_t structure
+ * @return              The operation status.
+ * @retval false        if the identifier is not valid.
+ * @retval true         if the record has been copied.
+ *
+ * @api
+ */
+bool chStatsGetRecord(uint32_t id, stats_record_t *srp) {
+#if !CH_DBG_STATS_HISTOGRAMS
+  time_measurement_t none;
+#endif
+
+  chDbgCheck(srp != NULL);
+
+  if (id >= STATS_RECORDS_NUMBER)
+    return false;
+
+#if !CH_DBG_STATS_HISTOGRAMS
+  chTMObjectInit(&none);
+#endif
+  srp->id = id;
+  chSysLock();
+  switch (id) {
+  case STATS_ID_CRIT_THD:
+#if CH_DBG_STATS_HISTOGRAMS
+    stats_fill_record(srp, &currcore->kernel_stats.m_crit_thd,
+                      &currcore->kernel_stats.h_crit_thd,
+                      currcore->kernel_stats.c_crit_thd);
+#else
+    stats_fill_record(srp, &currcore->kernel_stats.m_crit_thd, NULL, NULL);
+#endif
+    break;
+  case STATS_ID_CRIT_ISR:
+#if CH_DBG_STATS_HISTOGRAMS
+    stats_fill_record(srp, &currcore->kernel_stats.m_crit_isr,
+                      &currcore->kernel_stats.h_crit_isr,
+                      currcore->kernel_stats.c_crit_isr);
+#else
+    stats_fill_record(srp, &currcore->kernel_stats.m_crit_isr, NULL, NULL);
+#endif
+    break;
+  case STATS_ID_RESCHED:
+#if CH_DBG_STATS_HISTOGRAMS
+    stats_fill_record(srp, &currcore->kernel_stats.m_resched,
+                      &currcore->kernel_stats.h_resched, NULL);
+#else
+    stats_fill_record(srp, &none, NULL, NULL);
+#endif
+    break;
+  default:
+#if CH_DBG_IRQ_STATISTICS
+    stats_fill_record(srp,
+                      &currcore->kernel_stats.irq[id - STATS_ID_IRQ_BASE].m_isr,
+                      &currcore->kernel_stats.irq[id - STATS_ID_IRQ_BASE].hist,
+                      NULL);
+#endif
+    break;
+  }
+  chSysUnlock();
+  return true;
 }
 
 #endif /* CH_DBG_STATISTICS */
@@ -49,10 +49,19 @@
 /*===========================================================================*/
 
 #if !CH_CFG_NO_IDLE_THREAD || defined(__DOXYGEN__)
+#if CH_CFG_SMP_MODE || defined(__DOXYGEN__)
+/**
+ * @brief   Idle threads working areas, one for each core.
+ */
+static stkalign_t _idle_thread_wa[PORT_CORES_NUMBER]
+                                 [THD_WORKING_AREA_SIZE(PORT_IDLE_THREAD_STACK_SIZE) /
+                                  sizeof(stkalign_t)];
+#else
 /**
  * @brief   Idle thread working area.
  */
 static THD_WORKING_AREA(_idle_thread_wa, PORT_IDLE_THREAD_STACK_SIZE);
+#endif
 #endif /* CH_CFG_NO_IDLE_THREAD */
 
 /*===========================================================================*/
@@ -75,12 +84,73 @@ static void _idle_thread(void *p) {
   (void)p;
   chRegSetThreadName("idle");
   while (true) {
+#if CH_DBG_SIMULATED_TIME
+    /* No other thread is ready, the system time jumps straight to the next
+       timer deadline. Waiting for an interrupt only makes sense when there
+       are no timers armed.*/
+    chSysLock();
+    if ((virtual_timers_list_t *)currcore->vtlist.vt_next !=
+        &currcore->vtlist) {
+      (void) chSysAdvanceTimeI(currcore->vtlist.vt_next->vt_delta);
+      chSchRescheduleS();
+      chSysUnlock();
+      continue;
+    }
+    chSysUnlock();
+#endif
     port_wait_for_interrupt();
     CH_CFG_IDLE_LOOP_HOOK();
   }
 }
 #endif /* CH_CFG_NO_IDLE_THREAD */
 
+/**
+ * @brief   Starts the kernel on the current core.
+ * @details The current instructions stream becomes the main thread and the
+ *          idle thread is created.
+ *
+ * @param[in] mtp       pointer to the main thread structure
+ * @param[in] stklimit  stack boundary of the main thread
+ */
+static void _sys_start(thread_t *mtp, stkalign_t *stklimit) {
+
+#if !CH_CFG_NO_IDLE_THREAD
+  /* Now this instructions flow becomes the main thread.*/
+  setcurrp(_thread_init(mtp, NORMALPRIO));
+#else
+  /* Now this instructions flow becomes the main thread.*/
+  setcurrp(_thread_init(mtp, IDLEPRIO));
+#endif
+
+  currp->p_state = CH_STATE_CURRENT;
+#if CH_DBG_ENABLE_STACK_CHECK
+  /* This is a special case because the main thread thread_t structure is not
+     adjacent to its stack area.*/
+  currp->p_stklimit = stklimit;
+#else
+  (void)stklimit;
+#endif
+  chSysEnable();
+
+  /* Note, &ch_debug points to the string "main" if the registry is
+     active, else the parameter is ignored.*/
+  chRegSetThreadName((const char *)&ch_debug);
+
+#if !CH_CFG_NO_IDLE_THREAD
+  /* This thread has the lowest priority in the system, its role is just to
+     serve interrupts in its context while keeping the lowest energy saving
+     mode compatible with the system status.*/
+#if CH_CFG_SMP_MODE
+  chThdCreateStatic(_idle_thread_wa[port_get_core_id()],
+                    sizeof(_idle_thread_wa[0]), IDLEPRIO,
+                    (tfunc_t)_idle_thread, NULL);
+#else
+  chThdCreateStatic(_idle_thread_wa, sizeof(_idle_thread_wa), IDLEPRIO,
+                    (tfunc_t)_idle_thread, NULL);
+#endif
+#endif
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -94,6 +164,8 @@ static void _idle_thread(void *p) {
  * @post    The main thread is created with priority @p NORMALPRIO.
  * @note    This function has special, architecture-dependent, requirements,
  *          see the notes into the various port reference manuals.
+ * @note    In SMP mode this function must be invoked by the core zero, the
+ *          other cores use @p chSysInitCore().
  *
  * @special
  */
@@ -122,34 +194,49 @@ void chSysInit(void) {
   _trace_init();
 #endif
 
-#if !CH_CFG_NO_IDLE_THREAD
-  /* Now this instructions flow becomes the main thread.*/
-  setcurrp(_thread_init(&mainthread, NORMALPRIO));
-#else
-  /* Now this instructions flow becomes the main thread.*/
-  setcurrp(_thread_init(&mainthread, IDLEPRIO));
-#endif
-
-  currp->p_state = CH_STATE_CURRENT;
 #if CH_DBG_ENABLE_STACK_CHECK
-  /* This is a special case because the main thread thread_t structure is not
-     adjacent to its stack area.*/
-  currp->p_stklimit = &__main_thread_stack_base__;
+  _sys_start(&mainthread, &__main_thread_stack_base__);
+#else
+  _sys_start(&mainthread, NULL);
 #endif
-  chSysEnable();
+}
 
-  /* Note, &ch_debug points to the string "main" if the registry is
-     active, else the parameter is ignored.*/
-  chRegSetThreadName((const char *)&ch_debug);
+#if CH_CFG_SMP_MODE || defined(__DOXYGEN__)
+/**
+ * @brief   ChibiOS/RT secondary core initialization.
+ * @details Initializes the kernel instance of the current core, after
+ *          executing this function the current instructions stream becomes
+ *          the main thread of the core. The memory allocators and the
+ *          other global services are initialized once by @p chSysInit().
+ * @pre     The core zero must have already completed @p chSysInit().
+ * @pre     Interrupts must be still disabled when @p chSysInitCore() is
+ *          invoked and are internally enabled.
+ * @post    The core main thread is created with priority @p NORMALPRIO.
+ * @note    The stack of the core main thread is not checked when the
+ *          option @p CH_DBG_ENABLE_STACK_CHECK is enabled, the boundary
+ *          is not known to the kernel.
+ *
+ * @special
+ */
+void chSysInitCore(void) {
+  static thread_t mainthreads[PORT_CORES_NUMBER];
 
-#if !CH_CFG_NO_IDLE_THREAD
-  /* This thread has the lowest priority in the system, its role is just to
-     serve interrupts in its context while keeping the lowest energy saving
-     mode compatible with the system status.*/
-  chThdCreateStatic(_idle_thread_wa, sizeof(_idle_thread_wa), IDLEPRIO,
-                    (tfunc_t)_idle_thread, NULL);
+  port_init();
+  _scheduler_init();
+  _vt_init();
+#if CH_CFG_USE_TM
+  _tm_init();
 #endif
+#if CH_DBG_STATISTICS
+  _stats_init();
+#endif
+#if CH_DBG_ENABLE_TRACE
+  _trace_init();
+#endif
+
+  _sys_start(&mainthreads[port_get_core_id()], NULL);
 }
+#endif /* CH_CFG_SMP_MODE */
 
 /**
  * @brief   Halts the system.
@@ -166,7 +253,7 @@ void chSysHalt(const char *reason) {
   port_disable();
 
 #if CH_DBG_ENABLED
-  ch.dbg_panic_msg = reason;
+  currcore->dbg_panic_msg = reason;
 #else
   (void)reason;
 #endif
@@ -191,7 +278,7 @@ void chSysHalt(const char *reason) {
  *
  * @iclass
  */
-void chSysTimerHandlerI(void) {
+PORT_HOT_CODE void chSysTimerHandlerI(void) {
 
   chDbgCheckClassI();
 
@@ -210,6 +297,60 @@ void chSysTimerHandlerI(void) {
 #endif
 }
 
+#if CH_DBG_SIMULATED_TIME || defined(__DOXYGEN__)
+/**
+ * @brief   Advances the simulated system time.
+ * @details Processes up to @p n system ticks as @p chSysTimerHandlerI()
+ *          would do. Ticks not triggering any event are processed in a
+ *          single step, the function returns after the first tick that
+ *          triggers timers or uses up the time quantum of the running thread
+ *          so that the caller can reschedule at the exact tick.
+ * @note    The @p CH_CFG_SYSTEM_TICK_HOOK is not invoked for the skipped
+ *          ticks.
+ *
+ * @param[in] n         maximum number of ticks to be processed, must be
+ *                      greater than zero
+ * @return              The number of ticks actually processed.
+ *
+ * @iclass
+ */
+systime_t chSysAdvanceTimeI(systime_t n) {
+  systime_t k;
+
+  chDbgCheckClassI();
+  chDbgCheck(n > 0);
+
+  /* Number of ticks that can be skipped because nothing would happen.*/
+  k = n - 1;
+  if (((virtual_timers_list_t *)currcore->vtlist.vt_next !=
+       &currcore->vtlist) &&
+      (currcore->vtlist.vt_next->vt_delta <= k))
+    k = currcore->vtlist.vt_next->vt_delta - 1;
+#if CH_CFG_TIME_QUANTUM > 0
+  if ((currp->p_preempt > 0) && (currp->p_preempt <= k))
+    k = currp->p_preempt - 1;
+#endif
+
+  if (k > 0) {
+    currcore->vtlist.vt_systime += k;
+    if (&currcore->vtlist != (virtual_timers_list_t *)currcore->vtlist.vt_next)
+      currcore->vtlist.vt_next->vt_delta -= k;
+#if CH_CFG_TIME_QUANTUM > 0
+    if (currp->p_preempt > 0)
+      currp->p_preempt -= k;
+#endif
+#if CH_DBG_THREADS_PROFILING
+    currp->p_time += k;
+#endif
+  }
+
+  /* The last tick is a regular one.*/
+  chSysTimerHandlerI();
+
+  return k + 1;
+}
+#endif /* CH_DBG_SIMULATED_TIME */
+
 /**
  * @brief   Returns the execution status and enters a critical zone.
  * @details This functions enters into a critical zone and can be called
@@ -95,6 +95,9 @@ thread_t *_thread_init(thread_t *tp, tprio_t prio) {
   tp->p_prio = prio;
   tp->p_state = CH_STATE_WTSTART;
   tp->p_flags = CH_FLAG_MODE_STATIC;
+#if CH_CFG_SMP_MODE
+  tp->p_core = currcore;
+#endif
 #if CH_CFG_TIME_QUANTUM > 0
   tp->p_preempt = CH_CFG_TIME_QUANTUM;
 #endif
@@ -105,6 +108,9 @@ thread_t *_thread_init(thread_t *tp, tprio_t prio) {
 #if CH_CFG_USE_EVENTS
   tp->p_epending = 0;
 #endif
+#if CH_CFG_USE_POOLCACHES
+  tp->p_pcaches = NULL;
+#endif
 #if CH_DBG_THREADS_PROFILING
   tp->p_time = 0;
 #endif
@@ -127,6 +133,9 @@ thread_t *_thread_init(thread_t *tp, tprio_t prio) {
 #if CH_DBG_STATISTICS || defined(__DOXYGEN__)
   chTMObjectInit(&tp->p_stats);
   chTMStartMeasurementX(&tp->p_stats);
+#if CH_DBG_STATS_HISTOGRAMS
+  tp->p_readymark = false;
+#endif
 #endif
 #if defined(CH_CFG_THREAD_INIT_HOOK)
   CH_CFG_THREAD_INIT_HOOK(tp);
@@ -380,6 +389,11 @@ void chThdExitS(msg_t msg) {
 #if defined(CH_CFG_THREAD_EXIT_HOOK)
   CH_CFG_THREAD_EXIT_HOOK(tp);
 #endif
+#if CH_CFG_USE_POOLCACHES
+  /* Objects cached by the thread are returned to their pools now, the
+     caches themselves can be allocated in the thread working area.*/
+  _pool_caches_release(tp);
+#endif
 #if CH_CFG_USE_WAITEXIT
   while (list_notempty(&tp->p_waiting))
     chSchReadyI(list_remove(&tp->p_waiting));
@@ -466,7 +480,7 @@ msg_t chThdSuspendS(thread_reference_t *trp) {
   chDbgAssert(*trp == NULL, "not NULL");
 
   *trp = tp;
-  tp->p_u.wtobjp = &trp;
+  tp->p_u.wtobjp = trp;
   chSchGoSleepS(CH_STATE_SUSPENDED);
   return chThdGetSelfX()->p_msg;
 }
@@ -499,7 +513,7 @@ msg_t chThdSuspendTimeoutS(thread_reference_t *trp, systime_t timeout) {
     return MSG_TIMEOUT;
 
   *trp = tp;
-  tp->p_u.wtobjp = &trp;
+  tp->p_u.wtobjp = trp;
   return chSchGoSleepTimeoutS(CH_STATE_SUSPENDED, timeout);
 }
 
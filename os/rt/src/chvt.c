@@ -61,12 +61,13 @@
  */
 void _vt_init(void) {
 
-  ch.vtlist.vt_next = ch.vtlist.vt_prev = (void *)&ch.vtlist;
-  ch.vtlist.vt_delta = (systime_t)-1;
+  currcore->vtlist.vt_next = (void *)&currcore->vtlist;
+  currcore->vtlist.vt_prev = (void *)&currcore->vtlist;
+  currcore->vtlist.vt_delta = (systime_t)-1;
 #if CH_CFG_ST_TIMEDELTA == 0
-  ch.vtlist.vt_systime = 0;
+  currcore->vtlist.vt_systime = 0;
 #else /* CH_CFG_ST_TIMEDELTA > 0 */
-  ch.vtlist.vt_lasttime = 0;
+  currcore->vtlist.vt_lasttime = 0;
 #endif /* CH_CFG_ST_TIMEDELTA > 0 */
 }
 
@@ -101,7 +102,7 @@ void chVTDoSetI(virtual_timer_t *vtp, systime_t delay,
 
   vtp->vt_par = par;
   vtp->vt_func = vtfunc;
-  p = ch.vtlist.vt_next;
+  p = currcore->vtlist.vt_next;
 
 #if CH_CFG_ST_TIMEDELTA > 0 || defined(__DOXYGEN__)
   {
@@ -112,21 +113,21 @@ void chVTDoSetI(virtual_timer_t *vtp, systime_t delay,
     if (delay < CH_CFG_ST_TIMEDELTA)
       delay = CH_CFG_ST_TIMEDELTA;
 
-    if (&ch.vtlist == (virtual_timers_list_t *)p) {
+    if (&currcore->vtlist == (virtual_timers_list_t *)p) {
       /* The delta list is empty, the current time becomes the new
          delta list base time.*/
-      ch.vtlist.vt_lasttime = now;
-      port_timer_start_alarm(ch.vtlist.vt_lasttime + delay);
+      currcore->vtlist.vt_lasttime = now;
+      port_timer_start_alarm(currcore->vtlist.vt_lasttime + delay);
     }
     else {
       /* Now the delay is calculated as delta from the last tick interrupt
          time.*/
-      delay += now - ch.vtlist.vt_lasttime;
+      delay += now - currcore->vtlist.vt_lasttime;
 
       /* If the specified delay is closer in time than the first element
          in the delta list then it becomes the next alarm event in time.*/
       if (delay < p->vt_delta)
-        port_timer_set_alarm(ch.vtlist.vt_lasttime + delay);
+        port_timer_set_alarm(currcore->vtlist.vt_lasttime + delay);
     }
   }
 #endif /* CH_CFG_ST_TIMEDELTA > 0 */
@@ -146,7 +147,7 @@ void chVTDoSetI(virtual_timer_t *vtp, systime_t delay,
   /* Special case when the timer is in last position in the list, the
      value in the header must be restored.*/;
   p->vt_delta -= delay;
-  ch.vtlist.vt_delta = (systime_t)-1;
+  currcore->vtlist.vt_delta = (systime_t)-1;
 }
 
 /**
@@ -171,18 +172,19 @@ void chVTDoResetI(virtual_timer_t *vtp) {
 
   /* The above code changes the value in the header when the removed element
      is the last of the list, restoring it.*/
-  ch.vtlist.vt_delta = (systime_t)-1;
+  currcore->vtlist.vt_delta = (systime_t)-1;
 
 #if CH_CFG_ST_TIMEDELTA > 0 || defined(__DOXYGEN__)
   {
-    if (&ch.vtlist == (virtual_timers_list_t *)ch.vtlist.vt_next) {
+    if ((virtual_timers_list_t *)currcore->vtlist.vt_next ==
+        &currcore->vtlist) {
       /* Just removed the last element in the list, alarm timer stopped.*/
       port_timer_stop_alarm();
     }
     else {
       /* The alarm is set to the next element in the delta list.*/
-      port_timer_set_alarm(ch.vtlist.vt_lasttime +
-                           ch.vtlist.vt_next->vt_delta);
+      port_timer_set_alarm(currcore->vtlist.vt_lasttime +
+                           currcore->vtlist.vt_next->vt_delta);
     }
   }
 #endif /* CH_CFG_ST_TIMEDELTA > 0 */
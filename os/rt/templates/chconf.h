@@ -260,6 +260,15 @@
  */
 #define CH_CFG_USE_MAILBOXES                TRUE
 
+/**
+ * @brief   Ring buffers APIs.
+ * @details If enabled then the lock-free ring buffers APIs are included
+ *          in the kernel.
+ *
+ * @note    The default is @p TRUE.
+ */
+#define CH_CFG_USE_RINGBUFFERS              TRUE
+
 /**
  * @brief   I/O Queues APIs.
  * @details If enabled then the I/O queues APIs are included in the kernel.
@@ -298,6 +307,27 @@
  */
 #define CH_CFG_USE_MEMPOOLS                 TRUE
 
+/**
+ * @brief   Memory Pools per-thread caches.
+ * @details If enabled then threads can place private object caches in
+ *          front of memory pools, the caches are emptied on thread exit.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS.
+ */
+#define CH_CFG_USE_POOLCACHES               FALSE
+
+/**
+ * @brief   Default number of objects held by a pool cache.
+ * @details When a cache is found full on release half of its objects are
+ *          returned to the pool, when it is found empty on allocation it
+ *          is refilled with half of its capacity.
+ *
+ * @note    The default is 8.
+ * @note    Requires @p CH_CFG_USE_POOLCACHES.
+ */
+#define CH_CFG_POOLCACHE_SIZE               8
+
 /**
  * @brief   Dynamic Threads APIs.
  * @details If enabled then the dynamic threads creation APIs are included
@@ -395,6 +425,18 @@
  */
 #define CH_DBG_THREADS_PROFILING            FALSE
 
+/**
+ * @brief   Debug option, simulated time.
+ * @details If enabled then the system tick is not generated by the port
+ *          timer, the system time is advanced by the idle thread straight to
+ *          the next virtual timer deadline and by the test code using
+ *          @p chSysAdvanceTimeI().
+ *
+ * @note    The default is @p FALSE.
+ * @note    This debug option is not compatible with the tickless mode.
+ */
+#define CH_DBG_SIMULATED_TIME               FALSE
+
 /** @} */
 
 /*===========================================================================*/
@@ -27,6 +27,62 @@
 #ifndef _CH_HPP_
 #define _CH_HPP_
 
+/**
+ * @name    Statically initialized objects declarations
+ * @{
+ */
+/**
+ * @brief   Declares a statically initialized counter semaphore.
+ *
+ * @param[in] name      the name of the semaphore variable
+ * @param[in] n         the counter initial value, this value must be
+ *                      non-negative
+ */
+#define STATIC_SEMAPHORE_DECL(name, n)                                      \
+  chibios_rt::StaticCounterSemaphore name = {_SEMAPHORE_DATA(name.sem, n)}
+
+/**
+ * @brief   Declares a statically initialized binary semaphore.
+ *
+ * @param[in] name      the name of the semaphore variable
+ * @param[in] taken     the semaphore initial state
+ */
+#define STATIC_BSEMAPHORE_DECL(name, taken)                                 \
+  chibios_rt::StaticBinarySemaphore name = {_BSEMAPHORE_DATA(name.bsem,     \
+                                                             taken)}
+
+/**
+ * @brief   Declares a statically initialized mutex.
+ *
+ * @param[in] name      the name of the mutex variable
+ */
+#define STATIC_MUTEX_DECL(name)                                             \
+  chibios_rt::StaticMutex name = {_MUTEX_DATA(name.mutex)}
+
+/**
+ * @brief   Declares a statically initialized event source.
+ *
+ * @param[in] name      the name of the event source variable
+ */
+#define STATIC_EVENTSOURCE_DECL(name)                                       \
+  chibios_rt::StaticEvtSource name = {                                     \
+    {(event_listener_t *)&name.ev_source}                                   \
+  }
+
+/**
+ * @brief   Declares a statically initialized mailbox.
+ *
+ * @param[in] name      the name of the mailbox variable
+ * @param[in] type      type of the messages
+ * @param[in] n         size of the mailbox
+ */
+#define STATIC_MAILBOX_DECL(name, type, n)                                  \
+  chibios_rt::StaticMailbox<type, n> name = {                               \
+    _MAILBOX_DATA(name.mb, name.mb_buf, n),                                 \
+    {0}                                                                     \
+  }
+/** @} */
+
 /**
  * @brief   ChibiOS kernel-related classes and interfaces.
  */
@@ -753,12 +809,19 @@ namespace chibios_rt {
    * @brief   Static threads template class.
    * @details This class introduces static working area allocation.
    *
-   * @param N               the working area size for the thread class
+   * @param N               the stack size for the thread class, the working
+   *                        area size is rounded up to the port alignment
    */
   template <int N>
   class BaseStaticThread : public BaseThread {
+#if (__cplusplus >= 201103L) || defined(__DOXYGEN__)
+    static_assert(N > 0, "invalid stack size");
+    static_assert((size_t)N >= PORT_IDLE_THREAD_STACK_SIZE,
+                  "stack size below the port minimum");
+#endif
+
   protected:
-    WORKING_AREA(wa, N);
+    THD_WORKING_AREA(wa, N);
 
   public:
     /**
@@ -2209,6 +2272,817 @@ namespace chibios_rt {
   };
 #endif /* CH_USE_MEMPOOLS */
 
+#if CH_CFG_USE_RINGBUFFERS || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::RingBuffer                                                 *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Template class encapsulating a single producer, single consumer,
+   *          lock-free ring buffer and its objects buffer.
+   * @note    The objects are copied as raw memory, @p T must be a plain
+   *          data type.
+   *
+   * @param T                   type of the objects
+   * @param N                   number of objects, must be a power of two
+   */
+  template<class T, size_t N>
+  class RingBuffer {
+  private:
+    ::ring_buffer_t rb;
+    T               rb_buf[N];
+
+  public:
+    /**
+     * @brief   RingBuffer constructor.
+     *
+     * @init
+     */
+    RingBuffer(void) {
+
+      chRBObjectInit(&rb, rb_buf, sizeof (T), N);
+    }
+
+    /**
+     * @brief   Reserves contiguous free slots.
+     * @note    This function must be invoked by the producer only.
+     *
+     * @param[out] objpp    pointer to a pointer to the first reserved slot
+     * @param[in] n         number of slots requested
+     * @return              The number of reserved slots.
+     *
+     * @xclass
+     */
+    size_t reserve(T **objpp, size_t n) {
+
+      return chRBReserveX(&rb, (void **)objpp, n);
+    }
+
+    /**
+     * @brief   Commits reserved slots.
+     * @note    This function must be invoked by the producer only.
+     *
+     * @param[in] n         number of slots to be committed
+     *
+     * @xclass
+     */
+    void commit(size_t n) {
+
+      chRBCommitX(&rb, n);
+    }
+
+    /**
+     * @brief   Copies an object into the ring buffer.
+     * @note    This function must be invoked by the producer only.
+     *
+     * @param[in] obj       the object to be copied
+     * @return              The operation status.
+     * @retval MSG_OK       if the object has been inserted.
+     * @retval MSG_TIMEOUT  if the ring buffer is full.
+     *
+     * @xclass
+     */
+    msg_t put(const T &obj) {
+
+      return chRBPutX(&rb, &obj);
+    }
+
+    /**
+     * @brief   Fetches contiguous objects.
+     * @note    This function must be invoked by the consumer only.
+     *
+     * @param[out] objpp    pointer to a pointer to the first object
+     * @param[in] n         number of objects requested
+     * @return              The number of available objects.
+     *
+     * @xclass
+     */
+    size_t fetch(T **objpp, size_t n) {
+
+      return chRBFetchX(&rb, (void **)objpp, n);
+    }
+
+    /**
+     * @brief   Releases fetched slots.
+     * @note    This function must be invoked by the consumer only.
+     *
+     * @param[in] n         number of slots to be released
+     *
+     * @xclass
+     */
+    void release(size_t n) {
+
+      chRBReleaseX(&rb, n);
+    }
+
+    /**
+     * @brief   Copies an object out of the ring buffer.
+     * @note    This function must be invoked by the consumer only.
+     *
+     * @param[out] obj      the object to be filled
+     * @return              The operation status.
+     * @retval MSG_OK       if an object has been retrieved.
+     * @retval MSG_TIMEOUT  if the ring buffer is empty.
+     *
+     * @xclass
+     */
+    msg_t get(T &obj) {
+
+      return chRBGetX(&rb, &obj);
+    }
+
+    /**
+     * @brief   Waits for an object to become available.
+     * @note    Only the consumer thread can wait on a ring buffer.
+     *
+     * @param[in] time      the number of ticks before the operation timeouts
+     * @return              The operation status.
+     * @retval MSG_OK       if an object is available.
+     * @retval MSG_TIMEOUT  if the buffer is still empty after the specified
+     *                      time.
+     *
+     * @api
+     */
+    msg_t wait(systime_t time) {
+
+      return chRBWaitTimeout(&rb, time);
+    }
+
+    /**
+     * @brief   Returns the number of objects in the ring buffer.
+     *
+     * @xclass
+     */
+    size_t getUsedCount(void) {
+
+      return chRBGetUsedCountX(&rb);
+    }
+
+    /**
+     * @brief   Returns the number of free slots in the ring buffer.
+     *
+     * @xclass
+     */
+    size_t getFreeCount(void) {
+
+      return chRBGetFreeCountX(&rb);
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::MPRingBuffer                                               *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Template class encapsulating a multiple producers, single
+   *          consumer, lock-free ring buffer and its objects buffer.
+   * @note    The objects are copied as raw memory, @p T must be a plain
+   *          data type.
+   *
+   * @param T                   type of the objects
+   * @param N                   number of objects, must be a power of two
+   */
+  template<class T, size_t N>
+  class MPRingBuffer {
+  private:
+    ::mp_ring_buffer_t  mprb;
+    T                   mprb_buf[N];
+    uint32_t            mprb_seq[N];
+
+  public:
+    /**
+     * @brief   MPRingBuffer constructor.
+     *
+     * @init
+     */
+    MPRingBuffer(void) {
+
+      chMPRBObjectInit(&mprb, mprb_buf, mprb_seq, sizeof (T), N);
+    }
+
+    /**
+     * @brief   Reserves contiguous free slots.
+     *
+     * @param[out] objpp    pointer to a pointer to the first reserved slot
+     * @param[in] n         number of slots requested
+     * @return              The number of reserved slots.
+     *
+     * @xclass
+     */
+    size_t reserve(T **objpp, size_t n) {
+
+      return chMPRBReserveX(&mprb, (void **)objpp, n);
+    }
+
+    /**
+     * @brief   Commits reserved slots.
+     *
+     * @param[in] objp      pointer to the first reserved slot
+     * @param[in] n         number of slots to be committed
+     *
+     * @xclass
+     */
+    void commit(T *objp, size_t n) {
+
+      chMPRBCommitX(&mprb, objp, n);
+    }
+
+    /**
+     * @brief   Copies an object into the ring buffer.
+     *
+     * @param[in] obj       the object to be copied
+     * @return              The operation status.
+     * @retval MSG_OK       if the object has been inserted.
+     * @retval MSG_TIMEOUT  if the ring buffer is full.
+     *
+     * @xclass
+     */
+    msg_t put(const T &obj) {
+
+      return chMPRBPutX(&mprb, &obj);
+    }
+
+    /**
+     * @brief   Fetches contiguous committed objects.
+     * @note    This function must be invoked by the consumer only.
+     *
+     * @param[out] objpp    pointer to a pointer to the first object
+     * @param[in] n         number of objects requested
+     * @return              The number of available objects.
+     *
+     * @xclass
+     */
+    size_t fetch(T **objpp, size_t n) {
+
+      return chMPRBFetchX(&mprb, (void **)objpp, n);
+    }
+
+    /**
+     * @brief   Releases fetched slots.
+     * @note    This function must be invoked by the consumer only.
+     *
+     * @param[in] n         number of slots to be released
+     *
+     * @xclass
+     */
+    void release(size_t n) {
+
+      chMPRBReleaseX(&mprb, n);
+    }
+
+    /**
+     * @brief   Copies an object out of the ring buffer.
+     * @note    This function must be invoked by the consumer only.
+     *
+     * @param[out] obj      the object to be filled
+     * @return              The operation status.
+     * @retval MSG_OK       if an object has been retrieved.
+     * @retval MSG_TIMEOUT  if the ring buffer is empty.
+     *
+     * @xclass
+     */
+    msg_t get(T &obj) {
+
+      return chMPRBGetX(&mprb, &obj);
+    }
+
+    /**
+     * @brief   Waits for an object to become available.
+     * @note    Only the consumer thread can wait on a ring buffer.
+     *
+     * @param[in] time      the number of ticks before the operation timeouts
+     * @return              The operation status.
+     * @retval MSG_OK       if an object is available or has been committed.
+     * @retval MSG_TIMEOUT  if the buffer is still empty after the specified
+     *                      time.
+     *
+     * @api
+     */
+    msg_t wait(systime_t time) {
+
+      return chMPRBWaitTimeout(&mprb, time);
+    }
+  };
+#endif /* CH_CFG_USE_RINGBUFFERS */
+
+#if (__cplusplus >= 201103L) || defined(__DOXYGEN__)
+  /*
+   * Statically initialized objects.
+   *
+   * The following classes have no run-time constructor, objects declared
+   * at file scope are constant-initialized by the compiler and placed in
+   * the initialized data section so no static constructor is executed at
+   * startup.
+   * Objects containing threads queues are self-referencing through casts
+   * that are not allowed in constant expressions, those classes are
+   * aggregates and must be declared using the provided *_DECL() macros,
+   * the memory pools classes have constexpr constructors instead.
+   */
+
+#if CH_CFG_USE_SEMAPHORES || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::StaticCounterSemaphore                                     *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Class encapsulating a statically initialized semaphore.
+   * @note    Objects of this class must be declared using
+   *          @p STATIC_SEMAPHORE_DECL().
+   */
+  class StaticCounterSemaphore {
+  public:
+    /**
+     * @brief   Embedded @p ::semaphore_t structure.
+     */
+    ::semaphore_t sem;
+
+    /**
+     * @brief   Performs a wait operation on the semaphore.
+     *
+     * @return              A message specifying how the invoking thread has
+     *                      been released from the semaphore.
+     *
+     * @api
+     */
+    msg_t wait(void) {
+
+      return chSemWait(&sem);
+    }
+
+    /**
+     * @brief   Performs a wait operation on the semaphore with timeout.
+     *
+     * @param[in] time      the number of ticks before the operation timeouts
+     * @return              A message specifying how the invoking thread has
+     *                      been released from the semaphore.
+     *
+     * @api
+     */
+    msg_t waitTimeout(systime_t time) {
+
+      return chSemWaitTimeout(&sem, time);
+    }
+
+    /**
+     * @brief   Performs a signal operation on the semaphore.
+     *
+     * @api
+     */
+    void signal(void) {
+
+      chSemSignal(&sem);
+    }
+
+    /**
+     * @brief   Performs a signal operation on the semaphore.
+     *
+     * @iclass
+     */
+    void signalI(void) {
+
+      chSemSignalI(&sem);
+    }
+
+    /**
+     * @brief   Returns the semaphore counter current value.
+     *
+     * @iclass
+     */
+    cnt_t getCounterI(void) {
+
+      return chSemGetCounterI(&sem);
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::StaticBinarySemaphore                                      *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Class encapsulating a statically initialized binary semaphore.
+   * @note    Objects of this class must be declared using
+   *          @p STATIC_BSEMAPHORE_DECL().
+   */
+  class StaticBinarySemaphore {
+  public:
+    /**
+     * @brief   Embedded @p ::binary_semaphore_t structure.
+     */
+    ::binary_semaphore_t bsem;
+
+    /**
+     * @brief   Performs a wait operation on the binary semaphore.
+     *
+     * @return              A message specifying how the invoking thread has
+     *                      been released from the semaphore.
+     *
+     * @api
+     */
+    msg_t wait(void) {
+
+      return chBSemWait(&bsem);
+    }
+
+    /**
+     * @brief   Performs a wait operation on the binary semaphore with
+     *          timeout.
+     *
+     * @param[in] time      the number of ticks before the operation timeouts
+     * @return              A message specifying how the invoking thread has
+     *                      been released from the semaphore.
+     *
+     * @api
+     */
+    msg_t waitTimeout(systime_t time) {
+
+      return chBSemWaitTimeout(&bsem, time);
+    }
+
+    /**
+     * @brief   Performs a signal operation on the binary semaphore.
+     *
+     * @api
+     */
+    void signal(void) {
+
+      chBSemSignal(&bsem);
+    }
+
+    /**
+     * @brief   Performs a signal operation on the binary semaphore.
+     *
+     * @iclass
+     */
+    void signalI(void) {
+
+      chBSemSignalI(&bsem);
+    }
+
+    /**
+     * @brief   Returns the binary semaphore current state.
+     *
+     * @iclass
+     */
+    bool getStateI(void) {
+
+      return chBSemGetStateI(&bsem);
+    }
+  };
+#endif /* CH_CFG_USE_SEMAPHORES */
+
+#if CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::StaticMutex                                                *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Class encapsulating a statically initialized mutex.
+   * @note    Objects of this class must be declared using
+   *          @p STATIC_MUTEX_DECL().
+   */
+  class StaticMutex {
+  public:
+    /**
+     * @brief   Embedded @p ::mutex_t structure.
+     */
+    ::mutex_t mutex;
+
+    /**
+     * @brief   Locks the mutex.
+     *
+     * @api
+     */
+    void lock(void) {
+
+      chMtxLock(&mutex);
+    }
+
+    /**
+     * @brief   Tries to lock the mutex.
+     *
+     * @return              The operation status.
+     * @retval true         if the mutex has been successfully acquired.
+     * @retval false        if the lock attempt failed.
+     *
+     * @api
+     */
+    bool tryLock(void) {
+
+      return chMtxTryLock(&mutex);
+    }
+
+    /**
+     * @brief   Unlocks the mutex.
+     *
+     * @api
+     */
+    void unlock(void) {
+
+      chMtxUnlock(&mutex);
+    }
+  };
+#endif /* CH_CFG_USE_MUTEXES */
+
+#if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::StaticEvtSource                                            *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Class encapsulating a statically initialized event source.
+   * @note    Objects of this class must be declared using
+   *          @p STATIC_EVENTSOURCE_DECL().
+   */
+  class StaticEvtSource {
+  public:
+    /**
+     * @brief   Embedded @p ::event_source_t structure.
+     */
+    ::event_source_t ev_source;
+
+    /**
+     * @brief   Registers a listener on the event source.
+     *
+     * @param[in] elp       pointer to the @p ::event_listener_t structure
+     * @param[in] emask     the mask of event flags to be added to the
+     *                      thread when the event source is broadcasted
+     *
+     * @api
+     */
+    void registerMask(::event_listener_t *elp, eventmask_t emask) {
+
+      chEvtRegisterMask(&ev_source, elp, emask);
+    }
+
+    /**
+     * @brief   Unregisters a listener.
+     *
+     * @param[in] elp       pointer to the @p ::event_listener_t structure
+     *
+     * @api
+     */
+    void unregister(::event_listener_t *elp) {
+
+      chEvtUnregister(&ev_source, elp);
+    }
+
+    /**
+     * @brief   Broadcasts on the event source.
+     *
+     * @param[in] flags     the flags set to be added to the listener flags
+     *                      mask
+     *
+     * @api
+     */
+    void broadcastFlags(eventflags_t flags) {
+
+      chEvtBroadcastFlags(&ev_source, flags);
+    }
+
+    /**
+     * @brief   Broadcasts on the event source.
+     *
+     * @param[in] flags     the flags set to be added to the listener flags
+     *                      mask
+     *
+     * @iclass
+     */
+    void broadcastFlagsI(eventflags_t flags) {
+
+      chEvtBroadcastFlagsI(&ev_source, flags);
+    }
+  };
+#endif /* CH_CFG_USE_EVENTS */
+
+#if CH_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::StaticMailbox                                              *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Template class encapsulating a statically initialized mailbox
+   *          and its messages buffer.
+   * @note    Objects of this class must be declared using
+   *          @p STATIC_MAILBOX_DECL().
+   *
+   * @param T                   type of the messages, a pointer or an
+   *                            integral type not larger than @p msg_t
+   * @param N                   size of the mailbox
+   */
+  template<class T, cnt_t N>
+  class StaticMailbox {
+    static_assert(sizeof (T) <= sizeof (msg_t),
+                  "message type larger than msg_t");
+    static_assert(N > 0, "invalid mailbox size");
+
+  public:
+    /**
+     * @brief   Embedded @p ::mailbox_t structure.
+     */
+    ::mailbox_t mb;
+    /**
+     * @brief   Messages buffer.
+     */
+    msg_t       mb_buf[N];
+
+    /**
+     * @brief   Posts a message into the mailbox.
+     *
+     * @param[in] msg       the message to be posted
+     * @param[in] time      the number of ticks before the operation timeouts
+     * @return              The operation status.
+     *
+     * @api
+     */
+    msg_t post(T msg, systime_t time) {
+
+      return chMBPost(&mb, (msg_t)msg, time);
+    }
+
+    /**
+     * @brief   Posts a message into the mailbox.
+     *
+     * @param[in] msg       the message to be posted
+     * @return              The operation status.
+     *
+     * @iclass
+     */
+    msg_t postI(T msg) {
+
+      return chMBPostI(&mb, (msg_t)msg);
+    }
+
+    /**
+     * @brief   Retrieves a message from the mailbox.
+     *
+     * @param[out] msgp     pointer to the message variable
+     * @param[in] time      the number of ticks before the operation timeouts
+     * @return              The operation status.
+     *
+     * @api
+     */
+    msg_t fetch(T *msgp, systime_t time) {
+      msg_t msg, rdymsg;
+
+      rdymsg = chMBFetch(&mb, &msg, time);
+      if (rdymsg == MSG_OK)
+        *msgp = (T)msg;
+      return rdymsg;
+    }
+
+    /**
+     * @brief   Retrieves a message from the mailbox.
+     *
+     * @param[out] msgp     pointer to the message variable
+     * @return              The operation status.
+     *
+     * @iclass
+     */
+    msg_t fetchI(T *msgp) {
+      msg_t msg, rdymsg;
+
+      rdymsg = chMBFetchI(&mb, &msg);
+      if (rdymsg == MSG_OK)
+        *msgp = (T)msg;
+      return rdymsg;
+    }
+
+    /**
+     * @brief   Returns the number of messages in the mailbox.
+     *
+     * @iclass
+     */
+    cnt_t getUsedCountI(void) {
+
+      return chMBGetUsedCountI(&mb);
+    }
+
+    /**
+     * @brief   Returns the mailbox capacity.
+     */
+    static constexpr cnt_t getSize(void) {
+
+      return N;
+    }
+  };
+#endif /* CH_CFG_USE_MAILBOXES */
+
+#if CH_CFG_USE_MEMPOOLS || defined(__DOXYGEN__)
+  /**
+   * @brief   Compile-time sequence of indexes.
+   * @note    Internal helper, the C++ library is not used.
+   */
+  template<size_t... I> struct _IndexSequence {};
+
+  /**
+   * @brief   Generator of a @p _IndexSequence from 0 to @p N - 1.
+   */
+  template<size_t N, size_t... I>
+  struct _MakeIndexSequence : _MakeIndexSequence<N - 1, N - 1, I...> {};
+
+  template<size_t... I>
+  struct _MakeIndexSequence<0, I...> {
+    typedef _IndexSequence<I...> type;
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::StaticObjectsPool                                          *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Template class encapsulating a statically initialized memory
+   *          pool and its objects.
+   * @details The free objects list is built by the constexpr constructor,
+   *          a file scope pool is placed in the initialized data section
+   *          already containing all its objects.
+   * @note    Objects are not constructed when allocated, use placement
+   *          new on the returned memory if @p T has a constructor.
+   *
+   * @param T                   type of the objects
+   * @param N                   number of objects in the pool
+   */
+  template<class T, size_t N>
+  class StaticObjectsPool {
+    static_assert(N > 0, "invalid pool size");
+
+  private:
+    /**
+     * @brief   Storage for a single object, when free the object is
+     *          overlaid by the pool header.
+     */
+    union alignas(T) pool_slot {
+      struct pool_header    ph;
+      uint8_t               obj[sizeof (T)];
+    };
+
+    pool_slot       slots[N];
+
+    template<size_t... I>
+    constexpr StaticObjectsPool(_IndexSequence<I...>) :
+      slots{{{I + 1 < N ? &slots[I + 1].ph : NULL}}...},
+      pool{&slots[0].ph, sizeof (pool_slot), NULL} {
+    }
+
+  public:
+    /**
+     * @brief   Embedded @p ::memory_pool_t structure.
+     */
+    ::memory_pool_t pool;
+
+    /**
+     * @brief   StaticObjectsPool constructor.
+     *
+     * @init
+     */
+    constexpr StaticObjectsPool(void) :
+      StaticObjectsPool(typename _MakeIndexSequence<N>::type()) {
+    }
+
+    /**
+     * @brief   Allocates an object from the pool.
+     *
+     * @return              The pointer to the allocated object.
+     * @retval NULL         if pool is empty.
+     *
+     * @api
+     */
+    T *alloc(void) {
+
+      return (T *)chPoolAlloc(&pool);
+    }
+
+    /**
+     * @brief   Allocates an object from the pool.
+     *
+     * @return              The pointer to the allocated object.
+     * @retval NULL         if pool is empty.
+     *
+     * @iclass
+     */
+    T *allocI(void) {
+
+      return (T *)chPoolAllocI(&pool);
+    }
+
+    /**
+     * @brief   Releases an object into the pool.
+     *
+     * @param[in] objp      the pointer to the object to be released
+     *
+     * @api
+     */
+    void free(T *objp) {
+
+      chPoolFree(&pool, objp);
+    }
+
+    /**
+     * @brief   Releases an object into the pool.
+     *
+     * @param[in] objp      the pointer to the object to be released
+     *
+     * @iclass
+     */
+    void freeI(T *objp) {
+
+      chPoolFreeI(&pool, objp);
+    }
+  };
+#endif /* CH_CFG_USE_MEMPOOLS */
+#endif /* __cplusplus >= 201103L */
+
   /*------------------------------------------------------------------------*
    * chibios_rt::BaseSequentialStreamInterface                              *
    *------------------------------------------------------------------------*/
@@ -0,0 +1,504 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    dmacopy.c
+ * @brief   Asynchronous memory copy service code.
+ *
+ * @addtogroup dmacopy
+ * @{
+ */
+
+#include <string.h>
+
+#include "ch.h"
+#include "dmacopy.h"
+
+#if DMACOPY_USE_DMA
+#include "hal.h"
+
+#if !defined(STM32_DMA_REQUIRED) || !STM32_DMA_USE_ARBITER
+#error "DMACOPY_USE_DMA requires STM32_DMA_USE_ARBITER"
+#endif
+#endif
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Head of the requests queue, it is the active request.
+ */
+static dmacopy_request_t *dc_head;
+
+/**
+ * @brief   Tail of the requests queue.
+ */
+static dmacopy_request_t *dc_tail;
+
+#if DMACOPY_USE_DMA || defined(__DOXYGEN__)
+/**
+ * @brief   DMA stream request.
+ */
+static stm32_dma_request_t dc_dmarq;
+
+/**
+ * @brief   Owned DMA stream or @p NULL.
+ */
+static const stm32_dma_stream_t *dc_dmastp;
+
+/**
+ * @brief   Size in bytes of the DMA transfer in progress.
+ */
+static size_t dc_chunk;
+#endif
+
+#if !DMACOPY_USE_DMA || defined(__DOXYGEN__)
+/**
+ * @brief   Worker thread working area.
+ */
+static THD_WORKING_AREA(dc_wa, DMACOPY_WORKER_STACK_SIZE);
+
+/**
+ * @brief   Worker thread reference while sleeping.
+ */
+static thread_reference_t dc_worker;
+#endif
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Completes the active request and removes it from the queue.
+ *
+ * @param[in] msg       completion result
+ *
+ * @notapi
+ */
+static void dc_complete_i(msg_t msg) {
+  dmacopy_request_t *rqp = dc_head;
+
+  dc_head = rqp->next;
+  if (dc_head == NULL)
+    dc_tail = NULL;
+
+  rqp->state  = DMACOPY_IDLE;
+  rqp->result = msg;
+  if (rqp->callback != NULL)
+    rqp->callback(rqp);
+#if CH_CFG_USE_EVENTS
+  if (rqp->esp != NULL)
+    chEvtBroadcastFlagsI(rqp->esp, rqp->flags);
+#endif
+  chThdResumeI(&rqp->thread, msg);
+}
+
+#if DMACOPY_USE_DMA || defined(__DOXYGEN__)
+/**
+ * @brief   Starts the next DMA transfer of the active request.
+ * @details The widest data unit allowed by the alignment is used, the
+ *          transfer is limited by the 16 bits transfer counter.
+ *
+ * @notapi
+ */
+static void dc_dma_next_i(void) {
+  dmacopy_request_t *rqp = dc_head;
+  uint32_t mode, align;
+  size_t unit, cnt;
+
+  rqp->state = DMACOPY_ACTIVE;
+
+  align = (uint32_t)rqp->dst | (uint32_t)rqp->n;
+  if (rqp->src != NULL)
+    align |= (uint32_t)rqp->src;
+  if ((align & 3) == 0) {
+    mode = STM32_DMA_CR_PSIZE_WORD | STM32_DMA_CR_MSIZE_WORD;
+    unit = 4;
+  }
+  else if ((align & 1) == 0) {
+    mode = STM32_DMA_CR_PSIZE_HWORD | STM32_DMA_CR_MSIZE_HWORD;
+    unit = 2;
+  }
+  else {
+    mode = STM32_DMA_CR_PSIZE_BYTE | STM32_DMA_CR_MSIZE_BYTE;
+    unit = 1;
+  }
+  cnt = rqp->n / unit;
+  if (cnt > 0xFFFF)
+    cnt = 0xFFFF;
+  dc_chunk = cnt * unit;
+
+  /* Fills use the pattern as a non incremented source.*/
+  if (rqp->src != NULL) {
+    dmaStreamSetPeripheral(dc_dmastp, rqp->src);
+    mode |= STM32_DMA_CR_PINC;
+  }
+  else {
+    dmaStreamSetPeripheral(dc_dmastp, &rqp->pattern);
+  }
+  dmaStreamSetMemory0(dc_dmastp, rqp->dst);
+  dmaStreamSetTransactionSize(dc_dmastp, cnt);
+  dmaStreamSetMode(dc_dmastp, mode | STM32_DMA_CR_MINC |
+                              STM32_DMA_CR_DIR_M2M |
+                              STM32_DMA_CR_PL(STM32_DMA_M2M_DMA_PRIORITY) |
+                              STM32_DMA_CR_TCIE | STM32_DMA_CR_TEIE |
+                              STM32_DMA_CR_EN);
+}
+
+/**
+ * @brief   DMA stream granted by the arbiter.
+ *
+ * @param[in] p         not used
+ * @param[in] dmastp    the granted stream
+ *
+ * @notapi
+ */
+static void dc_dma_grant(void *p, const stm32_dma_stream_t *dmastp) {
+
+  (void)p;
+
+  dc_dmastp = dmastp;
+  dmaStreamSetFIFO(dc_dmastp, STM32_DMA_FCR_DMDIS | STM32_DMA_FCR_FTH_FULL);
+  dc_dma_next_i();
+}
+
+/**
+ * @brief   DMA stream ISR callback.
+ * @details Continues the active request or chains the next one, the stream
+ *          is released as soon as the queue is empty.
+ *
+ * @param[in] p         not used
+ * @param[in] flags     pre-shifted content of the ISR register
+ *
+ * @notapi
+ */
+static void dc_dma_serve_interrupt(void *p, uint32_t flags) {
+  dmacopy_request_t *rqp = dc_head;
+
+  (void)p;
+
+  chSysLockFromISR();
+  if ((flags & STM32_DMA_ISR_TEIF) != 0)
+    dc_complete_i(MSG_RESET);
+  else {
+    rqp->dst += dc_chunk;
+    if (rqp->src != NULL)
+      rqp->src += dc_chunk;
+    rqp->n -= dc_chunk;
+    if (rqp->n == 0)
+      dc_complete_i(MSG_OK);
+  }
+
+  if (dc_head != NULL)
+    dc_dma_next_i();
+  else {
+    dmaStreamDisable(dc_dmastp);
+    dmaStreamRelease(dc_dmastp);
+    dc_dmastp = NULL;
+  }
+  chSysUnlockFromISR();
+}
+
+/**
+ * @brief   Starts processing a non empty queue.
+ *
+ * @notapi
+ */
+static void dc_kick_i(void) {
+  const stm32_dma_stream_t *dmastp;
+
+  /* If the stream is not available immediately then the processing
+     starts from the grant callback.*/
+  dmastp = dmaStreamRequestI(&dc_dmarq);
+  if (dmastp != NULL)
+    dc_dma_grant(NULL, dmastp);
+}
+#endif /* DMACOPY_USE_DMA */
+
+#if !DMACOPY_USE_DMA || defined(__DOXYGEN__)
+/**
+ * @brief   Worker thread of the software back-end.
+ *
+ * @param[in] arg       not used
+ * @return              The function never returns.
+ *
+ * @notapi
+ */
+static msg_t dc_worker_thread(void *arg) {
+
+  (void)arg;
+
+  chRegSetThreadName("dmacopy");
+  chSysLock();
+  while (true) {
+    dmacopy_request_t *rqp = dc_head;
+
+    if (rqp == NULL) {
+      chThdSuspendS(&dc_worker);
+      continue;
+    }
+    rqp->state = DMACOPY_ACTIVE;
+    chSysUnlock();
+
+    if (rqp->src != NULL)
+      memcpy(rqp->dst, rqp->src, rqp->n);
+    else
+      memset(rqp->dst, (int)(rqp->pattern & 0xFF), rqp->n);
+
+    chSysLock();
+    dc_complete_i(MSG_OK);
+    chSchRescheduleS();
+  }
+  return 0;
+}
+
+/**
+ * @brief   Starts processing a non empty queue.
+ *
+ * @notapi
+ */
+static void dc_kick_i(void) {
+
+  chThdResumeI(&dc_worker, MSG_OK);
+}
+#endif /* !DMACOPY_USE_DMA */
+
+/**
+ * @brief   Appends a request to the queue.
+ *
+ * @param[in] rqp       pointer to the @p dmacopy_request_t object
+ *
+ * @notapi
+ */
+static void dc_enqueue_i(dmacopy_request_t *rqp) {
+
+  rqp->next  = NULL;
+  rqp->state = DMACOPY_QUEUED;
+  if (dc_tail == NULL) {
+    dc_head = dc_tail = rqp;
+    dc_kick_i();
+  }
+  else {
+    dc_tail->next = rqp;
+    dc_tail = rqp;
+  }
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes the copy service.
+ * @note    With the software back-end this function creates the worker
+ *          thread so it must be invoked after @p chSysInit().
+ *
+ * @init
+ */
+void dmacopyInit(void) {
+
+  dc_head = dc_tail = NULL;
+#if DMACOPY_USE_DMA
+  dc_dmastp = NULL;
+  dmaStreamRequestObjectInit(&dc_dmarq, STM32_DMA_M2M_STREAMS_MSK,
+                             STM32_DMA_M2M_IRQ_PRIORITY,
+                             dc_dma_serve_interrupt, dc_dma_grant, NULL);
+#else
+  dc_worker = NULL;
+  chThdCreateStatic(dc_wa, sizeof dc_wa, DMACOPY_WORKER_PRIORITY,
+                    dc_worker_thread, NULL);
+#endif
+}
+
+/**
+ * @brief   Initializes a @p dmacopy_request_t object.
+ *
+ * @param[out] rqp      pointer to the @p dmacopy_request_t object
+ * @param[in] callback  completion callback or @p NULL
+ *
+ * @init
+ */
+void dmacopyObjectInit(dmacopy_request_t *rqp, dmacopycb_t callback) {
+
+  chDbgCheck(rqp != NULL);
+
+  rqp->next     = NULL;
+  rqp->callback = callback;
+#if CH_CFG_USE_EVENTS
+  rqp->esp      = NULL;
+  rqp->flags    = 0;
+#endif
+  rqp->thread   = NULL;
+  rqp->result   = MSG_OK;
+  rqp->state    = DMACOPY_IDLE;
+}
+
+/**
+ * @brief   Queues a memory copy.
+ * @details Requests are processed in order, the completion is notified
+ *          using the callback, the event source or @p dmacopyWaitS().
+ * @note    With the DMA back-end the buffers must be reachable by the DMA,
+ *          the CCM RAM is not.
+ *
+ * @param[in] rqp       pointer to an idle @p dmacopy_request_t object
+ * @param[out] dst      destination address
+ * @param[in] src       source address
+ * @param[in] n         number of bytes to copy, must be greater than zero
+ *
+ * @iclass
+ */
+void dmacopyStartCopyI(dmacopy_request_t *rqp,
+                       void *dst, const void *src, size_t n) {
+
+  chDbgCheckClassI();
+  chDbgCheck((rqp != NULL) && (dst != NULL) && (src != NULL) && (n > 0));
+  chDbgAssert(rqp->state == DMACOPY_IDLE, "not idle");
+
+  rqp->dst = dst;
+  rqp->src = src;
+  rqp->n   = n;
+  dc_enqueue_i(rqp);
+}
+
+/**
+ * @brief   Queues a memory fill.
+ * @details Requests are processed in order, the completion is notified
+ *          using the callback, the event source or @p dmacopyWaitS().
+ * @note    With the DMA back-end the buffer and the request object must be
+ *          reachable by the DMA, the CCM RAM is not.
+ *
+ * @param[in] rqp       pointer to an idle @p dmacopy_request_t object
+ * @param[out] dst      destination address
+ * @param[in] value     fill value
+ * @param[in] n         number of bytes to fill, must be greater than zero
+ *
+ * @iclass
+ */
+void dmacopyStartSetI(dmacopy_request_t *rqp,
+                      void *dst, uint8_t value, size_t n) {
+
+  chDbgCheckClassI();
+  chDbgCheck((rqp != NULL) && (dst != NULL) && (n > 0));
+  chDbgAssert(rqp->state == DMACOPY_IDLE, "not idle");
+
+  rqp->dst     = dst;
+  rqp->src     = NULL;
+  rqp->n       = n;
+  rqp->pattern = (uint32_t)value * 0x01010101U;
+  dc_enqueue_i(rqp);
+}
+
+/**
+ * @brief   Waits for a request completion.
+ * @note    Only one thread can wait on a request.
+ *
+ * @param[in] rqp       pointer to the @p dmacopy_request_t object
+ * @return              The completion result.
+ * @retval MSG_OK       if the operation has been performed.
+ * @retval MSG_RESET    if a transfer error occurred.
+ *
+ * @sclass
+ */
+msg_t dmacopyWaitS(dmacopy_request_t *rqp) {
+
+  chDbgCheckClassS();
+  chDbgCheck(rqp != NULL);
+
+  if (rqp->state == DMACOPY_IDLE)
+    return rqp->result;
+  return chThdSuspendS(&rqp->thread);
+}
+
+/**
+ * @brief   Copies a memory block.
+ * @details Blocks smaller than @p DMACOPY_THRESHOLD are copied by the CPU,
+ *          larger blocks are queued and the calling thread sleeps until
+ *          the copy is complete.
+ *
+ * @param[out] dst      destination address
+ * @param[in] src       source address
+ * @param[in] n         number of bytes to copy
+ * @return              The operation result.
+ * @retval MSG_OK       if the operation has been performed.
+ * @retval MSG_RESET    if a transfer error occurred.
+ *
+ * @api
+ */
+msg_t dmacopyMemcpy(void *dst, const void *src, size_t n) {
+  dmacopy_request_t rq;
+  msg_t msg;
+
+  if (n < DMACOPY_THRESHOLD) {
+    memcpy(dst, src, n);
+    return MSG_OK;
+  }
+
+  dmacopyObjectInit(&rq, NULL);
+  chSysLock();
+  dmacopyStartCopyI(&rq, dst, src, n);
+  msg = dmacopyWaitS(&rq);
+  chSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Fills a memory block.
+ * @details Blocks smaller than @p DMACOPY_THRESHOLD are filled by the CPU,
+ *          larger blocks are queued and the calling thread sleeps until
+ *          the fill is complete.
+ *
+ * @param[out] dst      destination address
+ * @param[in] value     fill value
+ * @param[in] n         number of bytes to fill
+ * @return              The operation result.
+ * @retval MSG_OK       if the operation has been performed.
+ * @retval MSG_RESET    if a transfer error occurred.
+ *
+ * @api
+ */
+msg_t dmacopyMemset(void *dst, uint8_t value, size_t n) {
+  dmacopy_request_t rq;
+  msg_t msg;
+
+  if (n < DMACOPY_THRESHOLD) {
+    memset(dst, value, n);
+    return MSG_OK;
+  }
+
+  dmacopyObjectInit(&rq, NULL);
+  chSysLock();
+  dmacopyStartSetI(&rq, dst, value, n);
+  msg = dmacopyWaitS(&rq);
+  chSysUnlock();
+
+  return msg;
+}
+
+/** @} */
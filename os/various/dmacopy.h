@@ -0,0 +1,200 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    dmacopy.h
+ * @brief   Asynchronous memory copy service macros and structures.
+ *
+ * @addtogroup dmacopy
+ * @{
+ */
+
+#ifndef _DMACOPY_H_
+#define _DMACOPY_H_
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Request states
+ * @{
+ */
+#define DMACOPY_IDLE            0   /**< @brief Not queued or completed.    */
+#define DMACOPY_QUEUED          1   /**< @brief Waiting in the queue.       */
+#define DMACOPY_ACTIVE          2   /**< @brief Being processed.            */
+/** @} */
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Enables the DMA back-end.
+ * @details If @p TRUE the copies are performed by the STM32 DMA in memory
+ *          to memory mode, the streams are obtained through the DMA
+ *          arbiter (@p STM32_DMA_USE_ARBITER). If @p FALSE the copies are
+ *          performed by a dedicated worker thread, this back-end runs on
+ *          any port and is meant for testing and benchmarking.
+ */
+#if !defined(DMACOPY_USE_DMA) || defined(__DOXYGEN__)
+#define DMACOPY_USE_DMA                 FALSE
+#endif
+
+/**
+ * @brief   Size threshold for the blocking functions.
+ * @details Blocks smaller than this size are copied by the CPU in the
+ *          calling thread because the setup and the context switches would
+ *          cost more than the copy.
+ */
+#if !defined(DMACOPY_THRESHOLD) || defined(__DOXYGEN__)
+#define DMACOPY_THRESHOLD               256
+#endif
+
+/**
+ * @brief   Worker thread priority.
+ * @note    Only used by the software back-end.
+ */
+#if !defined(DMACOPY_WORKER_PRIORITY) || defined(__DOXYGEN__)
+#define DMACOPY_WORKER_PRIORITY         NORMALPRIO
+#endif
+
+/**
+ * @brief   Worker thread stack size.
+ * @note    Only used by the software back-end.
+ */
+#if !defined(DMACOPY_WORKER_STACK_SIZE) || defined(__DOXYGEN__)
+#define DMACOPY_WORKER_STACK_SIZE       256
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a copy request.
+ */
+typedef struct dmacopy_request dmacopy_request_t;
+
+/**
+ * @brief   Copy completion callback type.
+ * @note    The callback is invoked from within the system lock, either from
+ *          the DMA ISR or from the worker thread, only I-class functions
+ *          can be used.
+ *
+ * @param[in] rqp       pointer to the completed @p dmacopy_request_t object
+ */
+typedef void (*dmacopycb_t)(dmacopy_request_t *rqp);
+
+/**
+ * @brief   Structure representing a copy request.
+ * @note    The buffer fields are advanced while the request is processed.
+ */
+struct dmacopy_request {
+  dmacopy_request_t     *next;          /**< @brief Next queued request.    */
+  uint8_t               *dst;           /**< @brief Destination pointer.    */
+  const uint8_t         *src;           /**< @brief Source pointer or
+                                             @p NULL for fills.             */
+  size_t                n;              /**< @brief Bytes to be moved.      */
+  uint32_t              pattern;        /**< @brief Fill pattern, the fill
+                                             value replicated in each byte. */
+  dmacopycb_t           callback;       /**< @brief Completion callback or
+                                             @p NULL.                       */
+#if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
+  event_source_t        *esp;           /**< @brief Event source broadcast
+                                             on completion or @p NULL.      */
+  eventflags_t          flags;          /**< @brief Flags to be broadcast.  */
+#endif
+  thread_reference_t    thread;         /**< @brief Waiting thread.         */
+  msg_t                 result;         /**< @brief Completion result.      */
+  uint8_t               state;          /**< @brief Request state.          */
+};
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns @p true if a request is neither queued nor active.
+ *
+ * @param[in] rqp       pointer to the @p dmacopy_request_t object
+ * @return              The request state.
+ *
+ * @iclass
+ */
+#define dmacopyIsIdleI(rqp) ((rqp)->state == DMACOPY_IDLE)
+
+/**
+ * @brief   Returns the result of a completed request.
+ * @details The result is @p MSG_OK or @p MSG_RESET if a transfer error
+ *          occurred.
+ *
+ * @param[in] rqp       pointer to the @p dmacopy_request_t object
+ * @return              The completion result.
+ *
+ * @iclass
+ */
+#define dmacopyGetResultI(rqp) ((rqp)->result)
+
+#if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
+/**
+ * @brief   Associates an event source to a request.
+ * @details The event source is broadcast with the specified flags when the
+ *          request completes.
+ *
+ * @param[in] rqp       pointer to the @p dmacopy_request_t object
+ * @param[in] e         pointer to the @p event_source_t object or @p NULL
+ * @param[in] f         flags to be broadcast
+ *
+ * @api
+ */
+#define dmacopySetEvent(rqp, e, f) {                                        \
+  (rqp)->esp   = (e);                                                       \
+  (rqp)->flags = (f);                                                       \
+}
+#endif
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void dmacopyInit(void);
+  void dmacopyObjectInit(dmacopy_request_t *rqp, dmacopycb_t callback);
+  void dmacopyStartCopyI(dmacopy_request_t *rqp,
+                         void *dst, const void *src, size_t n);
+  void dmacopyStartSetI(dmacopy_request_t *rqp,
+                        void *dst, uint8_t value, size_t n);
+  msg_t dmacopyWaitS(dmacopy_request_t *rqp);
+  msg_t dmacopyMemcpy(void *dst, const void *src, size_t n);
+  msg_t dmacopyMemset(void *dst, uint8_t value, size_t n);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+#endif /* _DMACOPY_H_ */
+
+/** @} */
@@ -0,0 +1,560 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    icchannel.c
+ * @brief   Inter-core channels code.
+ *
+ * @addtogroup icchannel
+ * @{
+ */
+
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "icchannel.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Copies data into the transmit ring.
+ * @details The data is copied first, then the write counter is published
+ *          after a memory barrier so the remote side never sees a counter
+ *          covering data not yet written.
+ *
+ * @param[in] icp       pointer to the @p InterCoreChannel object
+ * @param[in] bp        pointer to the data buffer
+ * @param[in] n         maximum number of bytes to be written
+ * @return              The number of bytes effectively written.
+ *
+ * @notapi
+ */
+static size_t icc_tx_copy(InterCoreChannel *icp, const uint8_t *bp, size_t n) {
+  icc_ring_t *rp = icp->tx;
+  uint32_t wr = rp->wrcnt;
+  size_t space, offset, s1;
+
+  space = (size_t)ICC_BUFFER_SIZE - (size_t)(wr - rp->rdcnt);
+  if (n > space)
+    n = space;
+  if (n == 0)
+    return 0;
+
+  /* The copy can wrap around the end of the buffer.*/
+  offset = (size_t)(wr & (ICC_BUFFER_SIZE - 1));
+  s1 = (size_t)ICC_BUFFER_SIZE - offset;
+  if (s1 >= n)
+    memcpy(&rp->buffer[offset], bp, n);
+  else {
+    memcpy(&rp->buffer[offset], bp, s1);
+    memcpy(&rp->buffer[0], bp + s1, n - s1);
+  }
+
+  port_memory_barrier();
+  rp->wrcnt = wr + (uint32_t)n;
+  return n;
+}
+
+/**
+ * @brief   Copies data out of the receive ring.
+ * @details The data is copied first, then the read counter is published
+ *          after a memory barrier so the remote side never overwrites data
+ *          not yet read.
+ *
+ * @param[in] icp       pointer to the @p InterCoreChannel object
+ * @param[out] bp       pointer to the data buffer
+ * @param[in] n         maximum number of bytes to be read
+ * @return              The number of bytes effectively read.
+ *
+ * @notapi
+ */
+static size_t icc_rx_copy(InterCoreChannel *icp, uint8_t *bp, size_t n) {
+  icc_ring_t *rp = icp->rx;
+  uint32_t rd = rp->rdcnt;
+  size_t full, offset, s1;
+
+  full = (size_t)(rp->wrcnt - rd);
+  if (n > full)
+    n = full;
+  if (n == 0)
+    return 0;
+
+  /* Data must not be read before the write counter has been read.*/
+  port_memory_barrier();
+  offset = (size_t)(rd & (ICC_BUFFER_SIZE - 1));
+  s1 = (size_t)ICC_BUFFER_SIZE - offset;
+  if (s1 >= n)
+    memcpy(bp, &rp->buffer[offset], n);
+  else {
+    memcpy(bp, &rp->buffer[offset], s1);
+    memcpy(bp + s1, &rp->buffer[0], n - s1);
+  }
+
+  port_memory_barrier();
+  rp->rdcnt = rd + (uint32_t)n;
+  return n;
+}
+
+/**
+ * @brief   Notifies the remote consumer.
+ * @details The doorbell is rung only if the remote consumer requested a
+ *          wait after the previous notification, redundant doorbells are
+ *          suppressed.
+ *
+ * @param[in] icp       pointer to the @p InterCoreChannel object
+ *
+ * @notapi
+ */
+static void icc_notify_consumer(InterCoreChannel *icp) {
+  uint32_t w;
+
+  port_memory_barrier();
+  w = icp->tx->rdwait;
+  if (w != icp->txnotified) {
+    icp->txnotified = w;
+    icp->config->doorbell(icp);
+  }
+}
+
+/**
+ * @brief   Notifies the remote producer.
+ * @details The doorbell is rung only if the remote producer requested a
+ *          wait after the previous notification, redundant doorbells are
+ *          suppressed.
+ *
+ * @param[in] icp       pointer to the @p InterCoreChannel object
+ *
+ * @notapi
+ */
+static void icc_notify_producer(InterCoreChannel *icp) {
+  uint32_t w;
+
+  port_memory_barrier();
+  w = icp->rx->wrwait;
+  if (w != icp->rxnotified) {
+    icp->rxnotified = w;
+    icp->config->doorbell(icp);
+  }
+}
+
+/**
+ * @brief   Waits for free space in the transmit ring.
+ * @details The wait request is published before checking the ring again,
+ *          the remote consumer checks the wait requests after publishing
+ *          its read counter so a wakeup cannot be lost.
+ *
+ * @param[in] icp       pointer to the @p InterCoreChannel object
+ * @param[in] n         required number of free bytes
+ * @param[in] time      the number of ticks before the operation timeouts
+ * @return              The wait result.
+ * @retval MSG_OK       if the space could be available.
+ * @retval MSG_TIMEOUT  if the operation timed out.
+ *
+ * @notapi
+ */
+static msg_t icc_wait_space_s(InterCoreChannel *icp, size_t n,
+                              systime_t time) {
+  icc_ring_t *rp = icp->tx;
+
+  rp->wrwait = rp->wrwait + 1U;
+  port_memory_barrier();
+  if ((size_t)ICC_BUFFER_SIZE - (size_t)(rp->wrcnt - rp->rdcnt) >= n)
+    return MSG_OK;
+  return chThdSuspendTimeoutS(&icp->wrthread, time);
+}
+
+/**
+ * @brief   Waits for data in the receive ring.
+ * @details The wait request is published before checking the ring again,
+ *          the remote producer checks the wait requests after publishing
+ *          its write counter so a wakeup cannot be lost.
+ *
+ * @param[in] icp       pointer to the @p InterCoreChannel object
+ * @param[in] n         required number of bytes
+ * @param[in] time      the number of ticks before the operation timeouts
+ * @return              The wait result.
+ * @retval MSG_OK       if the data could be available.
+ * @retval MSG_TIMEOUT  if the operation timed out.
+ *
+ * @notapi
+ */
+static msg_t icc_wait_data_s(InterCoreChannel *icp, size_t n,
+                             systime_t time) {
+  icc_ring_t *rp = icp->rx;
+
+  rp->rdwait = rp->rdwait + 1U;
+  port_memory_barrier();
+  if ((size_t)(rp->wrcnt - rp->rdcnt) >= n)
+    return MSG_OK;
+  return chThdSuspendTimeoutS(&icp->rdthread, time);
+}
+
+static size_t writes(void *ip, const uint8_t *bp, size_t n) {
+
+  return iccWriteTimeout(ip, bp, n, TIME_INFINITE);
+}
+
+static size_t reads(void *ip, uint8_t *bp, size_t n) {
+
+  return iccReadTimeout(ip, bp, n, TIME_INFINITE);
+}
+
+static size_t writet(void *ip, const uint8_t *bp, size_t n,
+                     systime_t time) {
+
+  return iccWriteTimeout(ip, bp, n, time);
+}
+
+static size_t readt(void *ip, uint8_t *bp, size_t n, systime_t time) {
+
+  return iccReadTimeout(ip, bp, n, time);
+}
+
+static msg_t putt(void *ip, uint8_t b, systime_t time) {
+
+  if (iccWriteTimeout(ip, &b, 1, time) == 0)
+    return MSG_TIMEOUT;
+  return MSG_OK;
+}
+
+static msg_t put(void *ip, uint8_t b) {
+
+  return putt(ip, b, TIME_INFINITE);
+}
+
+static msg_t gett(void *ip, systime_t time) {
+  uint8_t b;
+
+  if (iccReadTimeout(ip, &b, 1, time) == 0)
+    return MSG_TIMEOUT;
+  return (msg_t)b;
+}
+
+static msg_t get(void *ip) {
+
+  return gett(ip, TIME_INFINITE);
+}
+
+static const struct InterCoreChannelVMT vmt = {
+  writes, reads, put, get,
+  putt, gett, writet, readt
+};
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a shared memory area.
+ * @note    The area must be initialized by one of the two cores before
+ *          the channel is started on either core.
+ *
+ * @param[out] shp      pointer to the @p icc_shared_t structure
+ *
+ * @init
+ */
+void iccSharedInit(icc_shared_t *shp) {
+
+  chDbgCheck(shp != NULL);
+  chDbgAssert(((size_t)shp & (ICC_CACHE_LINE_SIZE - 1)) == 0,
+              "not aligned");
+
+  memset(shp, 0, sizeof (icc_shared_t));
+  port_memory_barrier();
+}
+
+/**
+ * @brief   Initializes an inter-core channel object.
+ * @note    The object is bound to one side of the shared memory area, the
+ *          remote core must use the other side.
+ *
+ * @param[out] icp      pointer to the @p InterCoreChannel object
+ * @param[in] config    pointer to the @p ICCConfig object
+ *
+ * @init
+ */
+void iccObjectInit(InterCoreChannel *icp, const ICCConfig *config) {
+
+  chDbgCheck((icp != NULL) && (config != NULL) &&
+             (config->shared != NULL) && (config->side <= 1U) &&
+             (config->doorbell != NULL));
+
+  icp->vmt        = &vmt;
+  icp->config     = config;
+  icp->tx         = &config->shared->ring[config->side];
+  icp->rx         = &config->shared->ring[config->side ^ 1U];
+  icp->txnotified = icp->tx->rdwait;
+  icp->rxnotified = icp->rx->wrwait;
+  icp->wrthread   = NULL;
+  icp->rdthread   = NULL;
+}
+
+/**
+ * @brief   Inter-core channel write with timeout.
+ * @details The function writes data from a buffer to the channel, the
+ *          remote core is notified once when the data has been written or
+ *          before waiting for free space.
+ * @note    The copies are performed within the kernel lock, the lock time
+ *          is bounded by @p ICC_BUFFER_SIZE.
+ *
+ * @param[in] icp       pointer to the @p InterCoreChannel object
+ * @param[in] bp        pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of bytes effectively transferred.
+ *
+ * @api
+ */
+size_t iccWriteTimeout(InterCoreChannel *icp, const uint8_t *bp,
+                       size_t n, systime_t time) {
+  size_t w = 0;
+  bool pending = false;
+
+  chDbgCheck((icp != NULL) && (bp != NULL));
+
+  chSysLock();
+  while (w < n) {
+    size_t done = icc_tx_copy(icp, bp + w, n - w);
+
+    w += done;
+    pending = pending || (done > 0);
+    if (w < n) {
+      /* Ring full, the consumer must be notified before waiting or the
+         two sides could wait for each other.*/
+      if (pending) {
+        icc_notify_consumer(icp);
+        pending = false;
+      }
+      if (icc_wait_space_s(icp, 1, time) != MSG_OK)
+        break;
+    }
+  }
+  if (pending)
+    icc_notify_consumer(icp);
+  chSysUnlock();
+  return w;
+}
+
+/**
+ * @brief   Inter-core channel read with timeout.
+ * @details The function reads data from the channel into a buffer, the
+ *          remote core is notified once when the data has been read or
+ *          before waiting for more data.
+ * @note    The copies are performed within the kernel lock, the lock time
+ *          is bounded by @p ICC_BUFFER_SIZE.
+ *
+ * @param[in] icp       pointer to the @p InterCoreChannel object
+ * @param[out] bp       pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of bytes effectively transferred.
+ *
+ * @api
+ */
+size_t iccReadTimeout(InterCoreChannel *icp, uint8_t *bp,
+                      size_t n, systime_t time) {
+  size_t r = 0;
+  bool pending = false;
+
+  chDbgCheck((icp != NULL) && (bp != NULL));
+
+  chSysLock();
+  while (r < n) {
+    size_t done = icc_rx_copy(icp, bp + r, n - r);
+
+    r += done;
+    pending = pending || (done > 0);
+    if (r < n) {
+      /* Ring empty, the producer must be notified before waiting or the
+         two sides could wait for each other.*/
+      if (pending) {
+        icc_notify_producer(icp);
+        pending = false;
+      }
+      if (icc_wait_data_s(icp, 1, time) != MSG_OK)
+        break;
+    }
+  }
+  if (pending)
+    icc_notify_producer(icp);
+  chSysUnlock();
+  return r;
+}
+
+/**
+ * @brief   Posts a message into an inter-core channel.
+ * @details The message is written as a single unit, the remote side never
+ *          sees a partial message.
+ * @note    Messages and byte streams should not be mixed on the same
+ *          channel direction.
+ *
+ * @param[in] icp       pointer to the @p InterCoreChannel object
+ * @param[in] msg       the message to be posted
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t iccPost(InterCoreChannel *icp, msg_t msg, systime_t time) {
+  msg_t rdymsg;
+
+  chDbgCheck(icp != NULL);
+
+  chSysLock();
+  while ((rdymsg = iccPostI(icp, msg)) != MSG_OK) {
+    if (icc_wait_space_s(icp, sizeof (msg_t), time) != MSG_OK)
+      break;
+  }
+  chSysUnlock();
+  return rdymsg;
+}
+
+/**
+ * @brief   Posts a message into an inter-core channel.
+ * @details This variant is non-blocking, the function returns a timeout
+ *          condition if there is no space for the message.
+ *
+ * @param[in] icp       pointer to the @p InterCoreChannel object
+ * @param[in] msg       the message to be posted
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_TIMEOUT  if the channel is full and the message cannot be
+ *                      posted.
+ *
+ * @iclass
+ */
+msg_t iccPostI(InterCoreChannel *icp, msg_t msg) {
+
+  chDbgCheckClassI();
+  chDbgCheck(icp != NULL);
+
+  if (iccGetWritableX(icp) < sizeof (msg_t))
+    return MSG_TIMEOUT;
+  (void)icc_tx_copy(icp, (const uint8_t *)&msg, sizeof (msg_t));
+  icc_notify_consumer(icp);
+  return MSG_OK;
+}
+
+/**
+ * @brief   Retrieves a message from an inter-core channel.
+ * @details The message is read as a single unit.
+ *
+ * @param[in] icp       pointer to the @p InterCoreChannel object
+ * @param[out] msgp     pointer to a message variable for the received
+ *                      message
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t iccFetch(InterCoreChannel *icp, msg_t *msgp, systime_t time) {
+  msg_t rdymsg;
+
+  chDbgCheck((icp != NULL) && (msgp != NULL));
+
+  chSysLock();
+  while ((rdymsg = iccFetchI(icp, msgp)) != MSG_OK) {
+    if (icc_wait_data_s(icp, sizeof (msg_t), time) != MSG_OK)
+      break;
+  }
+  chSysUnlock();
+  return rdymsg;
+}
+
+/**
+ * @brief   Retrieves a message from an inter-core channel.
+ * @details This variant is non-blocking, the function returns a timeout
+ *          condition if no message is available.
+ *
+ * @param[in] icp       pointer to the @p InterCoreChannel object
+ * @param[out] msgp     pointer to a message variable for the received
+ *                      message
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_TIMEOUT  if the channel is empty and a message cannot be
+ *                      fetched.
+ *
+ * @iclass
+ */
+msg_t iccFetchI(InterCoreChannel *icp, msg_t *msgp) {
+
+  chDbgCheckClassI();
+  chDbgCheck((icp != NULL) && (msgp != NULL));
+
+  if (iccGetReadableX(icp) < sizeof (msg_t))
+    return MSG_TIMEOUT;
+  (void)icc_rx_copy(icp, (uint8_t *)msgp, sizeof (msg_t));
+  icc_notify_producer(icp);
+  return MSG_OK;
+}
+
+/**
+ * @brief   Handles a doorbell interrupt.
+ * @details The threads waiting on the channel are resumed, they check the
+ *          rings again and go back waiting if the doorbell was not meant
+ *          for them.
+ * @note    This function must be called from the doorbell ISR of the
+ *          channel.
+ *
+ * @param[in] icp       pointer to the @p InterCoreChannel object
+ *
+ * @iclass
+ */
+void iccServeDoorbellI(InterCoreChannel *icp) {
+
+  chDbgCheckClassI();
+  chDbgCheck(icp != NULL);
+
+  chThdResumeI(&icp->rdthread, MSG_OK);
+  chThdResumeI(&icp->wrthread, MSG_OK);
+}
+
+/** @} */
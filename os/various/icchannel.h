@@ -0,0 +1,254 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    icchannel.h
+ * @brief   Inter-core channels macros and structures.
+ *
+ * @addtogroup icchannel
+ * @{
+ */
+
+#ifndef _ICCHANNEL_H_
+#define _ICCHANNEL_H_
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of the ring buffer of each channel direction.
+ * @note    Must be a power of two, the value must be the same in the
+ *          images running on both cores.
+ */
+#if !defined(ICC_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define ICC_BUFFER_SIZE                 256
+#endif
+
+/**
+ * @brief   Cache line size.
+ * @details The counters written by the producer and the counters written
+ *          by the consumer are placed in separate lines of this size.
+ * @note    The value must be the same in the images running on both cores.
+ */
+#if !defined(ICC_CACHE_LINE_SIZE) || defined(__DOXYGEN__)
+#define ICC_CACHE_LINE_SIZE             32
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (ICC_BUFFER_SIZE < 8) || ((ICC_BUFFER_SIZE & (ICC_BUFFER_SIZE - 1)) != 0)
+#error "ICC_BUFFER_SIZE must be a power of two not lower than 8"
+#endif
+
+#if (ICC_CACHE_LINE_SIZE < 8) ||                                            \
+    ((ICC_CACHE_LINE_SIZE & (ICC_CACHE_LINE_SIZE - 1)) != 0)
+#error "ICC_CACHE_LINE_SIZE must be a power of two not lower than 8"
+#endif
+
+#if !defined(port_memory_barrier)
+#error "inter-core channels require port_memory_barrier()"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Structure representing one direction of an inter-core channel.
+ * @details Single producer, single consumer, ring buffer. Each field is
+ *          written by one side only and the fields of each side are placed
+ *          in a separate cache line.
+ */
+typedef struct {
+  /* Fields written by the producer.*/
+  volatile uint32_t     wrcnt;          /**< @brief Free running write
+                                                    counter.                */
+  volatile uint32_t     wrwait;         /**< @brief Producer wait requests
+                                                    counter.                */
+  uint8_t               wrpad[ICC_CACHE_LINE_SIZE - 8];
+  /* Fields written by the consumer.*/
+  volatile uint32_t     rdcnt;          /**< @brief Free running read
+                                                    counter.                */
+  volatile uint32_t     rdwait;         /**< @brief Consumer wait requests
+                                                    counter.                */
+  uint8_t               rdpad[ICC_CACHE_LINE_SIZE - 8];
+  uint8_t               buffer[ICC_BUFFER_SIZE];
+} icc_ring_t;
+
+/**
+ * @brief   Shared memory area of an inter-core channel.
+ * @note    The area must be aligned to @p ICC_CACHE_LINE_SIZE and must be
+ *          initialized using @p iccSharedInit() before starting the
+ *          channel on either core.
+ * @note    If the cores have data caches then the area must be placed
+ *          in a non-cacheable or coherent memory region.
+ */
+typedef struct {
+  icc_ring_t            ring[2];        /**< @brief Rings, the ring zero is
+                                                    written by the side
+                                                    zero.                   */
+} icc_shared_t;
+
+/**
+ * @brief   Type of an inter-core channel object.
+ */
+typedef struct InterCoreChannel InterCoreChannel;
+
+/**
+ * @brief   Doorbell callback type.
+ * @details The callback raises the doorbell interrupt on the remote core,
+ *          the remote interrupt handler must call @p iccServeDoorbellI().
+ * @note    The callback is invoked from within the kernel lock, it is
+ *          invoked once for each wait request of the remote side.
+ *
+ * @param[in] icp       pointer to the @p InterCoreChannel object
+ */
+typedef void (*iccdoorbell_t)(InterCoreChannel *icp);
+
+/**
+ * @brief   Inter-core channel configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief   Shared memory area.
+   */
+  icc_shared_t          *shared;
+  /**
+   * @brief   Channel side, zero or one.
+   * @note    The two cores must use different sides of the same area.
+   */
+  uint32_t              side;
+  /**
+   * @brief   Remote doorbell callback.
+   */
+  iccdoorbell_t         doorbell;
+} ICCConfig;
+
+/**
+ * @brief   @p InterCoreChannel specific data.
+ */
+#define _inter_core_channel_data                                            \
+  _base_channel_data                                                        \
+  /* Current configuration data.*/                                          \
+  const ICCConfig       *config;                                            \
+  /* Transmit ring, written by this side.*/                                 \
+  icc_ring_t            *tx;                                                \
+  /* Receive ring, written by the remote side.*/                            \
+  icc_ring_t            *rx;                                                \
+  /* Last remote consumer wait request notified.*/                          \
+  uint32_t              txnotified;                                         \
+  /* Last remote producer wait request notified.*/                          \
+  uint32_t              rxnotified;                                         \
+  /* Thread waiting for free space or NULL.*/                               \
+  thread_reference_t    wrthread;                                           \
+  /* Thread waiting for data or NULL.*/                                     \
+  thread_reference_t    rdthread;
+
+/**
+ * @brief   @p InterCoreChannel virtual methods table.
+ */
+struct InterCoreChannelVMT {
+  _base_channel_methods
+};
+
+/**
+ * @extends BaseChannel
+ *
+ * @brief   Inter-core channel object.
+ * @details The object represents one side of a channel between two cores
+ *          running independent kernel instances. The data is exchanged
+ *          through a shared memory area, the remote threads are woken
+ *          using a doorbell interrupt.
+ * @note    One thread at a time can write and one thread at a time can
+ *          read on each side.
+ */
+struct InterCoreChannel {
+  /** @brief Virtual Methods Table.*/
+  const struct InterCoreChannelVMT *vmt;
+  _inter_core_channel_data
+};
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void iccSharedInit(icc_shared_t *shp);
+  void iccObjectInit(InterCoreChannel *icp, const ICCConfig *config);
+  size_t iccWriteTimeout(InterCoreChannel *icp, const uint8_t *bp,
+                         size_t n, systime_t time);
+  size_t iccReadTimeout(InterCoreChannel *icp, uint8_t *bp,
+                        size_t n, systime_t time);
+  msg_t iccPost(InterCoreChannel *icp, msg_t msg, systime_t time);
+  msg_t iccPostI(InterCoreChannel *icp, msg_t msg);
+  msg_t iccFetch(InterCoreChannel *icp, msg_t *msgp, systime_t time);
+  msg_t iccFetchI(InterCoreChannel *icp, msg_t *msgp);
+  void iccServeDoorbellI(InterCoreChannel *icp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the number of bytes that can be read.
+ * @note    The value can change after reading because the remote side is
+ *          not affected by the kernel lock.
+ *
+ * @param[in] icp       pointer to the @p InterCoreChannel object
+ * @return              The number of bytes in the receive ring.
+ *
+ * @xclass
+ */
+static inline size_t iccGetReadableX(InterCoreChannel *icp) {
+
+  return (size_t)(icp->rx->wrcnt - icp->rx->rdcnt);
+}
+
+/**
+ * @brief   Returns the number of bytes that can be written.
+ * @note    The value can change after reading because the remote side is
+ *          not affected by the kernel lock.
+ *
+ * @param[in] icp       pointer to the @p InterCoreChannel object
+ * @return              The number of free bytes in the transmit ring.
+ *
+ * @xclass
+ */
+static inline size_t iccGetWritableX(InterCoreChannel *icp) {
+
+  return (size_t)ICC_BUFFER_SIZE -
+         (size_t)(icp->tx->wrcnt - icp->tx->rdcnt);
+}
+
+#endif /* _ICCHANNEL_H_ */
+
+/** @} */
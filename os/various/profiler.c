@@ -0,0 +1,234 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    profiler.c
+ * @brief   Sampling profiler code.
+ *
+ * @addtogroup profiler
+ * @{
+ */
+
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "chprintf.h"
+#include "profiler.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Samples histogram.
+ * @details The sampling callback is the only writer, entries are never
+ *          removed while the profiler is running.
+ */
+static prof_entry_t prof_hist[PROF_HISTOGRAM_SIZE];
+
+/**
+ * @brief   Total samples counter.
+ */
+static volatile uint32_t prof_samples;
+
+/**
+ * @brief   Samples without a known PC.
+ */
+static volatile uint32_t prof_nopc;
+
+/**
+ * @brief   Samples lost because the histogram was full.
+ */
+static volatile uint32_t prof_lost;
+
+/**
+ * @brief   Current configuration or @p NULL.
+ */
+static const ProfilerConfig *prof_config;
+
+/**
+ * @brief   Sampling timer configuration.
+ */
+static GPTConfig prof_gptcfg;
+
+/**
+ * @brief   Profiler running flag.
+ */
+static bool prof_running;
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Sampling timer callback.
+ * @details The interrupted PC and the current thread name are accumulated
+ *          in the histogram using open addressing.
+ * @note    The sample is taken from a kernel-aware ISR so code running
+ *          within critical zones is attributed to the first instruction
+ *          after the zone.
+ *
+ * @param[in] gptp      pointer to the @p GPTDriver object
+ *
+ * @notapi
+ */
+static void prof_sample(GPTDriver *gptp) {
+  uint32_t pc, h, i;
+  const char *name;
+
+  (void)gptp;
+
+  pc = PROF_GET_INTERRUPTED_PC();
+#if CH_CFG_USE_REGISTRY
+  name = chThdGetSelfX()->p_name;
+#else
+  name = NULL;
+#endif
+
+  prof_samples++;
+  if (pc == 0U)
+    prof_nopc++;
+
+  h = ((pc ^ (uint32_t)name) * 2654435761U) >> 16;
+  for (i = 0; i < PROF_MAX_PROBES; i++) {
+    prof_entry_t *ep = &prof_hist[(h + i) & (PROF_HISTOGRAM_SIZE - 1)];
+
+    if (ep->count == 0U) {
+      /* Free entry, the counter is written last.*/
+      ep->pc    = pc;
+      ep->name  = name;
+      ep->count = 1U;
+      return;
+    }
+    if ((ep->pc == pc) && (ep->name == name)) {
+      ep->count++;
+      return;
+    }
+  }
+  prof_lost++;
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Starts the profiler.
+ * @details The GPT driver is started and the sampling begins, the samples
+ *          are accumulated over previous runs until @p profReset() is
+ *          invoked.
+ *
+ * @param[in] config    pointer to the @p ProfilerConfig object
+ *
+ * @api
+ */
+void profStart(const ProfilerConfig *config) {
+
+  chDbgCheck((config != NULL) && (config->gptp != NULL) &&
+             (config->interval > 0));
+  chDbgAssert(!prof_running, "already running");
+
+  prof_config            = config;
+  prof_gptcfg.frequency  = config->frequency;
+  prof_gptcfg.callback   = prof_sample;
+  prof_running           = true;
+  gptStart(config->gptp, &prof_gptcfg);
+  gptStartContinuous(config->gptp, config->interval);
+}
+
+/**
+ * @brief   Stops the profiler.
+ * @details The GPT driver is stopped, the samples are retained.
+ *
+ * @api
+ */
+void profStop(void) {
+
+  chDbgAssert(prof_running, "not running");
+
+  gptStopTimer(prof_config->gptp);
+  gptStop(prof_config->gptp);
+  prof_running = false;
+}
+
+/**
+ * @brief   Clears the samples.
+ * @note    The profiler must be stopped.
+ *
+ * @api
+ */
+void profReset(void) {
+
+  chDbgAssert(!prof_running, "running");
+
+  memset(prof_hist, 0, sizeof prof_hist);
+  prof_samples = 0;
+  prof_nopc    = 0;
+  prof_lost    = 0;
+}
+
+/**
+ * @brief   Dumps the samples on a stream.
+ * @details The output is meant to be processed by the @p profiler.py host
+ *          script which resolves the addresses against the ELF file. The
+ *          format is:
+ *          - <tt>prof begin <samples> <nopc> <lost> <rate></tt>
+ *          - <tt>prof <pc> <count> <thread></tt>, once for each entry.
+ *          - <tt>prof end</tt>
+ *          .
+ *          Addresses are hexadecimal, a zero PC means unknown, a thread
+ *          named "-" has no name.
+ * @note    The dump can be performed while the profiler is running, in
+ *          that case the counters are not an atomic snapshot.
+ *
+ * @param[in] chp       pointer to a @p BaseSequentialStream object
+ *
+ * @api
+ */
+void profDump(BaseSequentialStream *chp) {
+  uint32_t rate = 0, i;
+
+  chDbgCheck(chp != NULL);
+
+  if (prof_config != NULL)
+    rate = (uint32_t)prof_config->frequency / (uint32_t)prof_config->interval;
+  chprintf(chp, "prof begin %u %u %u %u\r\n",
+           prof_samples, prof_nopc, prof_lost, rate);
+  for (i = 0; i < PROF_HISTOGRAM_SIZE; i++) {
+    prof_entry_t *ep = &prof_hist[i];
+    uint32_t count = ep->count;
+
+    if (count > 0U)
+      chprintf(chp, "prof %08x %u %s\r\n",
+               ep->pc, count, ep->name != NULL ? ep->name : "-");
+  }
+  chprintf(chp, "prof end\r\n");
+}
+
+/** @} */
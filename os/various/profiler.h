@@ -0,0 +1,154 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    profiler.h
+ * @brief   Sampling profiler macros and structures.
+ *
+ * @addtogroup profiler
+ * @{
+ */
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Number of entries in the samples histogram.
+ * @details Each entry counts the samples of a (PC, thread name) pair.
+ * @note    Must be a power of two.
+ */
+#if !defined(PROF_HISTOGRAM_SIZE) || defined(__DOXYGEN__)
+#define PROF_HISTOGRAM_SIZE             256
+#endif
+
+/**
+ * @brief   Maximum number of histogram entries probed for a sample.
+ * @details Samples not finding a matching or free entry within this number
+ *          of probes are counted as lost.
+ */
+#if !defined(PROF_MAX_PROBES) || defined(__DOXYGEN__)
+#define PROF_MAX_PROBES                 8
+#endif
+
+/**
+ * @brief   Interrupted PC retrieval.
+ * @details The macro is invoked from the sampling timer callback and must
+ *          return the PC of the interrupted thread or zero if it is not
+ *          known or if the timer interrupted another ISR.
+ * @note    The default implementation reads the exception frame on the
+ *          process stack of the Cortex-M ports, on ARMv6-M nested
+ *          interrupts cannot be detected and are attributed to the thread
+ *          below them. The other ports only collect per-thread samples
+ *          unless they define this macro.
+ */
+#if !defined(PROF_GET_INTERRUPTED_PC) || defined(__DOXYGEN__)
+#if defined(PORT_ARCHITECTURE_ARM_v7M) || defined(PORT_ARCHITECTURE_ARM_v7ME)
+#define PROF_GET_INTERRUPTED_PC()                                           \
+  ((SCB->ICSR & SCB_ICSR_RETTOBASE_Msk) != 0U ?                             \
+   ((uint32_t *)__get_PSP())[6] : 0U)
+#elif defined(PORT_ARCHITECTURE_ARM_v6M)
+#define PROF_GET_INTERRUPTED_PC() (((uint32_t *)__get_PSP())[6])
+#else
+#define PROF_GET_INTERRUPTED_PC() 0U
+#endif
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !HAL_USE_GPT
+#error "the profiler requires HAL_USE_GPT"
+#endif
+
+#if (PROF_HISTOGRAM_SIZE < 2) ||                                            \
+    ((PROF_HISTOGRAM_SIZE & (PROF_HISTOGRAM_SIZE - 1)) != 0)
+#error "PROF_HISTOGRAM_SIZE must be a power of two"
+#endif
+
+#if (PROF_MAX_PROBES < 1) || (PROF_MAX_PROBES > PROF_HISTOGRAM_SIZE)
+#error "invalid PROF_MAX_PROBES value"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Profiler configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief   GPT driver used as sampling timer.
+   * @note    The driver is started and stopped by the profiler.
+   */
+  GPTDriver             *gptp;
+  /**
+   * @brief   Timer clock in Hz.
+   */
+  gptfreq_t             frequency;
+  /**
+   * @brief   Timer ticks between samples.
+   */
+  gptcnt_t              interval;
+} ProfilerConfig;
+
+/**
+ * @brief   Structure representing an histogram entry.
+ * @note    The counter is written last so entries with a non-zero counter
+ *          are always complete.
+ */
+typedef struct {
+  volatile uint32_t     pc;             /**< @brief Sampled PC or zero.     */
+  const char * volatile name;           /**< @brief Thread name or
+                                             @p NULL.                       */
+  volatile uint32_t     count;          /**< @brief Samples counter.        */
+} prof_entry_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void profStart(const ProfilerConfig *config);
+  void profStop(void);
+  void profReset(void);
+  void profDump(BaseSequentialStream *chp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+#endif /* _PROFILER_H_ */
+
+/** @} */
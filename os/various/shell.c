@@ -34,6 +34,204 @@
  */
 event_source_t shell_terminated;
 
+#if SHELL_USE_BUFFERED_IO || defined(__DOXYGEN__)
+/**
+ * @brief   @p ShellStream virtual methods table.
+ */
+struct ShellStreamVMT {
+  _base_channel_methods
+};
+
+/**
+ * @extends BaseChannel
+ *
+ * @brief   Buffered stream wrapping the shell channel.
+ * @details The stream is a full @p BaseChannel so that commands can use
+ *          the channel API on the shell stream, the methods with timeout
+ *          flush the output buffer and then access the wrapped channel.
+ */
+typedef struct {
+  /** @brief Virtual Methods Table.*/
+  const struct ShellStreamVMT *vmt;
+  /** @brief Wrapped channel.*/
+  BaseChannel           *chp;
+  /** @brief Number of bytes in the output buffer.*/
+  size_t                on;
+  /** @brief Read index into the input buffer.*/
+  size_t                ip;
+  /** @brief Number of bytes in the input buffer.*/
+  size_t                in;
+  /** @brief Output buffer.*/
+  uint8_t               obuf[SHELL_OUTPUT_BUFFER_SIZE];
+  /** @brief Input buffer.*/
+  uint8_t               ibuf[SHELL_INPUT_BUFFER_SIZE];
+} ShellStream;
+
+static void ss_flush(ShellStream *ssp) {
+
+  if (ssp->on > 0) {
+    chnWrite(ssp->chp, ssp->obuf, ssp->on);
+    ssp->on = 0;
+  }
+}
+
+static size_t ss_writes(void *ip, const uint8_t *bp, size_t n) {
+  ShellStream *ssp = ip;
+
+  if (n > SHELL_OUTPUT_BUFFER_SIZE - ssp->on) {
+    ss_flush(ssp);
+    if (n >= SHELL_OUTPUT_BUFFER_SIZE)
+      return chnWrite(ssp->chp, bp, n);
+  }
+  memcpy(ssp->obuf + ssp->on, bp, n);
+  ssp->on += n;
+  return n;
+}
+
+static size_t ss_reads(void *ip, uint8_t *bp, size_t n) {
+  ShellStream *ssp = ip;
+  size_t i = 0;
+
+  ss_flush(ssp);
+  while ((i < n) && (ssp->ip < ssp->in))
+    bp[i++] = ssp->ibuf[ssp->ip++];
+  if (i < n)
+    i += chnRead(ssp->chp, bp + i, n - i);
+  return i;
+}
+
+static msg_t ss_put(void *ip, uint8_t b) {
+  ShellStream *ssp = ip;
+
+  if (ssp->on >= SHELL_OUTPUT_BUFFER_SIZE)
+    ss_flush(ssp);
+  ssp->obuf[ssp->on++] = b;
+  return MSG_OK;
+}
+
+static msg_t ss_get(void *ip) {
+  ShellStream *ssp = ip;
+
+  ss_flush(ssp);
+  if (ssp->ip < ssp->in)
+    return ssp->ibuf[ssp->ip++];
+  return streamGet(ssp->chp);
+}
+
+static msg_t ss_putt(void *ip, uint8_t b, systime_t time) {
+  ShellStream *ssp = ip;
+
+  ss_flush(ssp);
+  return chnPutTimeout(ssp->chp, b, time);
+}
+
+static msg_t ss_gett(void *ip, systime_t time) {
+  ShellStream *ssp = ip;
+
+  ss_flush(ssp);
+  if (ssp->ip < ssp->in)
+    return ssp->ibuf[ssp->ip++];
+  return chnGetTimeout(ssp->chp, time);
+}
+
+static size_t ss_writet(void *ip, const uint8_t *bp, size_t n,
+                        systime_t time) {
+  ShellStream *ssp = ip;
+
+  ss_flush(ssp);
+  return chnWriteTimeout(ssp->chp, bp, n, time);
+}
+
+static size_t ss_readt(void *ip, uint8_t *bp, size_t n, systime_t time) {
+  ShellStream *ssp = ip;
+  size_t i = 0;
+
+  ss_flush(ssp);
+  while ((i < n) && (ssp->ip < ssp->in))
+    bp[i++] = ssp->ibuf[ssp->ip++];
+  if (i < n)
+    i += chnReadTimeout(ssp->chp, bp + i, n - i, time);
+  return i;
+}
+
+static const struct ShellStreamVMT ss_vmt = {ss_writes, ss_reads,
+                                             ss_put, ss_get,
+                                             ss_putt, ss_gett,
+                                             ss_writet, ss_readt};
+
+static void ss_object_init(ShellStream *ssp, BaseSequentialStream *chp) {
+
+  ssp->vmt = &ss_vmt;
+  ssp->chp = (BaseChannel *)chp;
+  ssp->on  = 0;
+  ssp->ip  = 0;
+  ssp->in  = 0;
+}
+
+/**
+ * @brief   Reads a whole line from the buffered stream.
+ * @details The input is fetched in blocks, all the bytes already received
+ *          by the channel are moved with a single read operation, the
+ *          bytes following the end of line are kept for the next line.
+ *          The echo is collected in the output buffer.
+ *
+ * @param[in] ssp       pointer to a @p ShellStream object
+ * @param[in] line      pointer to the line buffer
+ * @param[in] size      buffer maximum length
+ * @return              The operation status.
+ * @retval TRUE         the channel was reset or CTRL-D pressed.
+ * @retval FALSE        operation successful.
+ */
+static bool ss_get_line(ShellStream *ssp, char *line, unsigned size) {
+  char *p = line;
+
+  while (TRUE) {
+    char c;
+
+    if (ssp->ip >= ssp->in) {
+      msg_t msg;
+
+      /* The pending output is sent before waiting for new input.*/
+      ss_flush(ssp);
+      msg = chnGetTimeout(ssp->chp, TIME_INFINITE);
+      if (msg < Q_OK)
+        return TRUE;
+      ssp->ibuf[0] = (uint8_t)msg;
+      ssp->in = 1 + chnReadTimeout(ssp->chp, &ssp->ibuf[1],
+                                   SHELL_INPUT_BUFFER_SIZE - 1,
+                                   TIME_IMMEDIATE);
+      ssp->ip = 0;
+    }
+    c = (char)ssp->ibuf[ssp->ip++];
+    if (c == 4) {
+      chprintf((BaseSequentialStream *)ssp, "^D");
+      return TRUE;
+    }
+    if (c == 8) {
+      if (p != line) {
+        ss_put(ssp, c);
+        ss_put(ssp, 0x20);
+        ss_put(ssp, c);
+        p--;
+      }
+      continue;
+    }
+    if (c == '\r') {
+      ss_put(ssp, '\r');
+      ss_put(ssp, '\n');
+      *p = 0;
+      return FALSE;
+    }
+    if (c < 0x20)
+      continue;
+    if (p < line + size - 1) {
+      ss_put(ssp, c);
+      *p++ = (char)c;
+    }
+  }
+}
+#endif /* SHELL_USE_BUFFERED_IO */
+
 static char *_strtok(char *str, const char *delim, char **saveptr) {
   char *token;
   if (str)
@@ -106,15 +304,121 @@ static void cmd_systime(BaseSequentialStream *chp, int argc, char *argv[]) {
   chprintf(chp, "%lu\r\n", (unsigned long)chVTGetSystemTime());
 }
 
+#if CH_DBG_STATISTICS || defined(__DOXYGEN__)
+static void print_record(BaseSequentialStream *chp, stats_record_t *srp) {
+  unsigned i;
+
+  if (srp->id == STATS_ID_CRIT_THD)
+    chprintf(chp, "crit_thd");
+  else if (srp->id == STATS_ID_CRIT_ISR)
+    chprintf(chp, "crit_isr");
+  else if (srp->id == STATS_ID_RESCHED)
+    chprintf(chp, "resched ");
+  else
+    chprintf(chp, "irq%-5u", (unsigned)(srp->id - STATS_ID_IRQ_BASE));
+  chprintf(chp, " n=%u best=%u worst=%u last=%u",
+           srp->n, srp->best, srp->worst, srp->last);
+  if (srp->caller != 0U)
+    chprintf(chp, " caller=%08x", srp->caller);
+  chprintf(chp, "\r\n        ");
+  for (i = 0; i < CH_DBG_HISTOGRAM_BINS - 1; i++)
+    chprintf(chp, " <%u:%u", 1U << (CH_DBG_HISTOGRAM_SHIFT + i),
+             srp->hist[i]);
+  chprintf(chp, " >=%u:%u\r\n", 1U << (CH_DBG_HISTOGRAM_SHIFT + i),
+           srp->hist[i]);
+}
+
+static void cmd_stats(BaseSequentialStream *chp, int argc, char *argv[]) {
+  stats_record_t sr;
+  uint32_t id;
+  bool binary;
+
+  if ((argc > 1) || ((argc == 1) && (strcmp(argv[0], "bin") != 0))) {
+    usage(chp, "stats [bin]");
+    return;
+  }
+
+  /* The binary export is the header, the records with measurements and
+     an end record.*/
+  binary = argc == 1;
+  if (binary) {
+    stats_export_header_t h;
+
+    h.magic = STATS_EXPORT_MAGIC;
+    h.bins  = CH_DBG_HISTOGRAM_BINS;
+    h.shift = CH_DBG_HISTOGRAM_SHIFT;
+    chSequentialStreamWrite(chp, (const uint8_t *)&h, sizeof h);
+  }
+  for (id = 0; chStatsGetRecord(id, &sr); id++) {
+    if (sr.n == 0)
+      continue;
+    if (binary)
+      chSequentialStreamWrite(chp, (const uint8_t *)&sr, sizeof sr);
+    else
+      print_record(chp, &sr);
+  }
+  if (binary) {
+    memset(&sr, 0, sizeof sr);
+    sr.id = STATS_ID_END;
+    chSequentialStreamWrite(chp, (const uint8_t *)&sr, sizeof sr);
+  }
+}
+#endif
+
 /**
  * @brief   Array of the default commands.
  */
 static ShellCommand local_commands[] = {
   {"info", cmd_info},
+#if CH_DBG_STATISTICS
+  {"stats", cmd_stats},
+#endif
   {"systime", cmd_systime},
   {NULL, NULL}
 };
 
+#if SHELL_USE_SORTED_COMMANDS || defined(__DOXYGEN__)
+/**
+ * @brief   Number of the default commands.
+ */
+#define LOCAL_COMMANDS_NUM                                                  \
+  (sizeof (local_commands) / sizeof (local_commands[0]) - 1)
+
+static size_t cmdcount(const ShellCommand *scp) {
+  size_t n = 0;
+
+  if (scp != NULL) {
+    while (scp[n].sc_name != NULL) {
+      chDbgAssert((n == 0) ||
+                  (strcasecmp(scp[n - 1].sc_name, scp[n].sc_name) < 0),
+                  "commands table not sorted");
+      n++;
+    }
+  }
+  return n;
+}
+
+static bool cmdexec(const ShellCommand *scp, size_t n,
+                    BaseSequentialStream *chp,
+                    char *name, int argc, char *argv[]) {
+  size_t lo = 0, hi = n;
+
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    int r = strcasecmp(name, scp[mid].sc_name);
+
+    if (r == 0) {
+      scp[mid].sc_function(chp, argc, argv);
+      return FALSE;
+    }
+    if (r < 0)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  return TRUE;
+}
+#else /* !SHELL_USE_SORTED_COMMANDS */
 static bool cmdexec(const ShellCommand *scp, BaseSequentialStream *chp,
                       char *name, int argc, char *argv[]) {
 
@@ -127,6 +431,7 @@ static bool cmdexec(const ShellCommand *scp, BaseSequentialStream *chp,
   }
   return TRUE;
 }
+#endif /* !SHELL_USE_SORTED_COMMANDS */
 
 /**
  * @brief   Shell thread function.
@@ -142,12 +447,25 @@ static msg_t shell_thread(void *p) {
   const ShellCommand *scp = ((ShellConfig *)p)->sc_commands;
   char *lp, *cmd, *tokp, line[SHELL_MAX_LINE_LENGTH];
   char *args[SHELL_MAX_ARGUMENTS + 1];
+#if SHELL_USE_SORTED_COMMANDS
+  size_t nscp = cmdcount(scp);
+#endif
+#if SHELL_USE_BUFFERED_IO
+  ShellStream ss;
+
+  ss_object_init(&ss, chp);
+  chp = (BaseSequentialStream *)&ss;
+#endif
 
   chRegSetThreadName("shell");
   chprintf(chp, "\r\nChibiOS/RT Shell\r\n");
   while (TRUE) {
     chprintf(chp, "ch> ");
+#if SHELL_USE_BUFFERED_IO
+    if (ss_get_line(&ss, line, sizeof(line))) {
+#else
     if (shellGetLine(chp, line, sizeof(line))) {
+#endif
       chprintf(chp, "\r\nlogout");
       break;
     }
@@ -182,13 +500,22 @@ static msg_t shell_thread(void *p) {
           list_commands(chp, scp);
         chprintf(chp, "\r\n");
       }
+#if SHELL_USE_SORTED_COMMANDS
+      else if (cmdexec(local_commands, LOCAL_COMMANDS_NUM,
+                       chp, cmd, n, args) &&
+               cmdexec(scp, nscp, chp, cmd, n, args)) {
+#else
       else if (cmdexec(local_commands, chp, cmd, n, args) &&
           ((scp == NULL) || cmdexec(scp, chp, cmd, n, args))) {
+#endif
         chprintf(chp, "%s", cmd);
         chprintf(chp, " ?\r\n");
       }
     }
   }
+#if SHELL_USE_BUFFERED_IO
+  ss_flush(&ss);
+#endif
   shellExit(MSG_OK);
   /* Never executed, silencing a warning.*/
   return 0;
@@ -208,6 +535,8 @@ void shellInit(void) {
  * @brief   Terminates the shell.
  * @note    Must be invoked from the command handlers.
  * @note    Does not return.
+ * @note    If @p SHELL_USE_BUFFERED_IO is enabled then the output of the
+ *          invoking command still in the buffer is discarded.
  *
  * @param[in] msg       shell exit code
  *
@@ -39,6 +39,51 @@
 #define SHELL_MAX_ARGUMENTS         4
 #endif
 
+/**
+ * @brief   Sorted commands tables.
+ * @details If enabled the commands are searched using a binary search
+ *          instead of a linear scan, the user commands table must be sorted
+ *          by name in ascending order as defined by @p strcasecmp().
+ * @note    The order is verified when the shell starts if the
+ *          @p CH_DBG_ENABLE_ASSERTS option is enabled.
+ */
+#if !defined(SHELL_USE_SORTED_COMMANDS) || defined(__DOXYGEN__)
+#define SHELL_USE_SORTED_COMMANDS   FALSE
+#endif
+
+/**
+ * @brief   Buffered I/O.
+ * @details If enabled the input is read from the channel in blocks and
+ *          the echo and the commands output are collected in a buffer
+ *          written using a single stream @p write() call.
+ * @note    The shell channel must be a @p BaseChannel.
+ * @note    The commands receive a buffered stream, not the channel
+ *          specified in the configuration, the stream is flushed when
+ *          the command returns or before any read operation.
+ * @note    The buffered stream is itself a @p BaseChannel, the channel
+ *          functions with timeout flush the output and then operate on
+ *          the configured channel.
+ */
+#if !defined(SHELL_USE_BUFFERED_IO) || defined(__DOXYGEN__)
+#define SHELL_USE_BUFFERED_IO       FALSE
+#endif
+
+/**
+ * @brief   Input buffer size.
+ * @note    Only used if @p SHELL_USE_BUFFERED_IO is enabled.
+ */
+#if !defined(SHELL_INPUT_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define SHELL_INPUT_BUFFER_SIZE     32
+#endif
+
+/**
+ * @brief   Output buffer size.
+ * @note    Only used if @p SHELL_USE_BUFFERED_IO is enabled.
+ */
+#if !defined(SHELL_OUTPUT_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define SHELL_OUTPUT_BUFFER_SIZE    64
+#endif
+
 /**
  * @brief   Command handler function type.
  */
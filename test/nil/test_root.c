@@ -36,6 +36,12 @@
 const testcase_t * const *test_suite[] = {
   test_sequence_001,
   test_sequence_002,
+#if NIL_CFG_USE_TASKS
+  test_sequence_003,
+#endif
+#if NIL_CFG_USE_MAILBOXES || NIL_CFG_USE_QUEUES
+  test_sequence_004,
+#endif
   NULL
 };
 
@@ -45,6 +51,10 @@ const testcase_t * const *test_suite[] = {
 
 semaphore_t gsem1, gsem2;
 thread_reference_t gtr1;
+#if NIL_CFG_USE_MAILBOXES
+static msg_t gmb1_buffer[1];
+MAILBOX_DECL(gmb1, gmb1_buffer, 1);
+#endif
 
 /*
  * Support thread.
@@ -65,6 +75,10 @@ THD_FUNCTION(test_support, arg) {
     chSemResetI(&gsem2, 0);
     chThdResumeI(&gtr1, MSG_OK);
     chEvtSignalI(tp, 0x55);
+#if NIL_CFG_USE_MAILBOXES
+    if (chMBGetUsedCountI(&gmb1) < 0)
+      (void) chMBPostI(&gmb1, 0x55);
+#endif
     chSchRescheduleS();
     chSysUnlock();
 
@@ -72,4 +86,34 @@ THD_FUNCTION(test_support, arg) {
   }
 }
 
+#if NIL_CFG_USE_MAILBOXES
+/**
+ * @brief   Reference to the consumer thread while waiting for a job.
+ */
+thread_reference_t gtr_consumer;
+
+/**
+ * @brief   Job to be executed by the consumer thread.
+ */
+void (*gconsumer)(void);
+
+/*
+ * Consumer thread, it executes the job in @p gconsumer each time it is
+ * resumed, it must have a priority higher than the tester thread.
+ */
+THD_WORKING_AREA(wa_test_consumer, 128);
+THD_FUNCTION(test_consumer, arg) {
+
+  (void)arg;
+
+  while (true) {
+    chSysLock();
+    (void) chThdSuspendTimeoutS(&gtr_consumer, TIME_INFINITE);
+    chSysUnlock();
+
+    gconsumer();
+  }
+}
+#endif
+
 /** @} */
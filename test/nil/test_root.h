@@ -29,6 +29,8 @@
 
 #include "test_sequence_001.h"
 #include "test_sequence_002.h"
+#include "test_sequence_003.h"
+#include "test_sequence_004.h"
 
 /*===========================================================================*/
 /* Default definitions.                                                      */
@@ -49,8 +51,17 @@ extern "C" {
 #endif
   extern semaphore_t gsem1, gsem2;
   extern thread_reference_t gtr1;
+#if NIL_CFG_USE_MAILBOXES
+  extern mailbox_t gmb1;
+#endif
   extern THD_WORKING_AREA(wa_test_support, 128);
   THD_FUNCTION(test_support, arg);
+#if NIL_CFG_USE_MAILBOXES
+  extern thread_reference_t gtr_consumer;
+  extern void (*gconsumer)(void);
+  extern THD_WORKING_AREA(wa_test_consumer, 128);
+  THD_FUNCTION(test_consumer, arg);
+#endif
 #ifdef __cplusplus
 }
 #endif
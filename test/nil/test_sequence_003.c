@@ -0,0 +1,256 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_003 Run-to-completion tasks
+ *
+ * File: @ref test_sequence_003.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the ChibiOS/NIL functionalities related to
+ * run-to-completion tasks and task resources.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_003_001
+ * - @subpage test_003_002
+ * .
+ */
+
+#if NIL_CFG_USE_TASKS || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+static task_resource_t res1;
+static bool ceiling_test;
+static uint32_t task_count;
+#if PORT_SUPPORTS_RT
+static rtcnt_t task_t0, task_t1;
+#endif
+
+void test_task_high(void *arg) {
+
+  (void)arg;
+  test_emit_token('A');
+}
+
+void test_task_mid(void *arg) {
+
+  (void)arg;
+  test_emit_token('B');
+}
+
+void test_task_low(void *arg) {
+
+  (void)arg;
+  test_emit_token('C');
+  if (ceiling_test) {
+    chTaskResourceLock(&res1);
+    chTaskActivate(TEST_TASK_MID);
+    chTaskActivate(TEST_TASK_HIGH);
+    test_emit_token('D');
+    chTaskResourceUnlock(&res1);
+    test_emit_token('E');
+  }
+}
+
+void test_task_counter(void *arg) {
+
+  (void)arg;
+#if PORT_SUPPORTS_RT
+  task_t1 = port_rt_get_counter_value();
+#endif
+  task_count++;
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page test_003_001 Tasks preemption and ceiling
+ *
+ * <h2>Description</h2>
+ * Tasks are activated in various orders and with a resource locked, the
+ * execution order is verified.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - NIL_CFG_USE_TASKS
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - A task is activated by the tester thread, it must run before the
+ *   activation function returns because the tasks server has an higher
+ *   priority.
+ * - Three tasks are activated from within a critical zone in reverse
+ *   priority order, they must run in priority order.
+ * - The low priority task locks a resource whose ceiling is the medium
+ *   task priority then activates the medium and high priority tasks. The
+ *   high priority task must preempt immediately, the medium one only
+ *   after the resource has been released.
+ * .
+ */
+
+static void test_003_001_setup(void) {
+
+  chTaskResourceObjectInit(&res1, TEST_TASK_MID);
+  ceiling_test = false;
+}
+
+static void test_003_001_execute(void) {
+
+  /* A task is activated by the tester thread, it must run before the
+     activation function returns because the tasks server has an higher
+     priority.*/
+  test_set_step(1);
+  {
+    chTaskActivate(TEST_TASK_LOW);
+    test_assert_sequence("C", "not executed");
+  }
+
+  /* Three tasks are activated from within a critical zone in reverse
+     priority order, they must run in priority order.*/
+  test_set_step(2);
+  {
+    chSysLock();
+    chTaskActivateI(TEST_TASK_LOW);
+    chTaskActivateI(TEST_TASK_MID);
+    chTaskActivateI(TEST_TASK_HIGH);
+    chSchRescheduleS();
+    chSysUnlock();
+    test_assert_sequence("ABC", "invalid sequence");
+  }
+
+  /* The low priority task locks a resource whose ceiling is the medium
+     task priority then activates the medium and high priority tasks. The
+     high priority task must preempt immediately, the medium one only
+     after the resource has been released.*/
+  test_set_step(3);
+  {
+    ceiling_test = true;
+    chTaskActivate(TEST_TASK_LOW);
+    test_assert_sequence("CADBE", "invalid sequence");
+  }
+}
+
+static const testcase_t test_003_001 = {
+  "tasks preemption and ceiling",
+  test_003_001_setup,
+  NULL,
+  test_003_001_execute
+};
+
+/**
+ * @page test_003_002 Tasks footprint and latency
+ *
+ * <h2>Description</h2>
+ * The RAM footprint of a task is compared with the footprint of a thread
+ * having a minimal stack, then the activation performance is measured.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - NIL_CFG_USE_TASKS
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - The RAM and ROM sizes of a thread and of a task are printed.
+ * - A task is activated repeatedly for one second, the number of
+ *   activations per second is printed and, if the port supports a realtime
+ *   counter, the activation to execution latency in clock cycles.
+ * .
+ */
+
+static void test_003_002_setup(void) {
+
+  task_count = 0;
+}
+
+static void test_003_002_execute(void) {
+
+  /* The RAM and ROM sizes of a thread and of a task are printed.*/
+  test_set_step(1);
+  {
+    test_print("--- Thread: ");
+    test_printn(sizeof (thread_t) + THD_WORKING_AREA_SIZE(128));
+    test_print(" RAM bytes (128 bytes stack), ");
+    test_printn(sizeof (thread_config_t));
+    test_println(" ROM bytes");
+    test_print("--- Task  : 0 RAM bytes (shared stack), ");
+    test_printn(sizeof (task_config_t));
+    test_println(" ROM bytes");
+  }
+
+  /* A task is activated repeatedly for one second, the number of
+     activations per second is printed and, if the port supports a realtime
+     counter, the activation to execution latency in clock cycles.*/
+  test_set_step(2);
+  {
+    systime_t start;
+    uint32_t n = 0;
+
+    start = chVTGetSystemTimeX();
+    do {
+#if PORT_SUPPORTS_RT
+      task_t0 = port_rt_get_counter_value();
+#endif
+      chTaskActivate(TEST_TASK_COUNTER);
+      n++;
+    } while (chVTIsTimeWithinX(chVTGetSystemTimeX(),
+                               start, start + S2ST(1)));
+    test_assert(task_count == n, "activations lost");
+
+    test_print("--- Score : ");
+    test_printn(n);
+    test_println(" activations/S");
+#if PORT_SUPPORTS_RT
+    test_print("--- Latency: ");
+    test_printn((uint32_t)(rtcnt_t)(task_t1 - task_t0));
+    test_println(" cycles");
+#endif
+  }
+}
+
+static const testcase_t test_003_002 = {
+  "tasks footprint and latency",
+  test_003_002_setup,
+  NULL,
+  test_003_002_execute
+};
+
+#endif /* NIL_CFG_USE_TASKS */
+
+ /****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Sequence brief description.
+ */
+const testcase_t * const test_sequence_003[] = {
+#if NIL_CFG_USE_TASKS || defined(__DOXYGEN__)
+  &test_003_001,
+  &test_003_002,
+#endif
+  NULL
+};
@@ -0,0 +1,44 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef _TEST_SEQUENCE_003_H_
+#define _TEST_SEQUENCE_003_H_
+
+/*
+ * Identifiers of the test tasks, the application tasks table must declare
+ * the tasks in this order.
+ */
+#define TEST_TASK_HIGH      0
+#define TEST_TASK_MID       1
+#define TEST_TASK_LOW       2
+#define TEST_TASK_COUNTER   3
+
+extern const testcase_t * const test_sequence_003[];
+
+#if NIL_CFG_USE_TASKS
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void test_task_high(void *arg);
+  void test_task_mid(void *arg);
+  void test_task_low(void *arg);
+  void test_task_counter(void *arg);
+#ifdef __cplusplus
+}
+#endif
+#endif
+
+#endif /* _TEST_SEQUENCE_003_H_ */
@@ -0,0 +1,549 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_004 Mailboxes and byte queues
+ *
+ * File: @ref test_sequence_004.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the ChibiOS/NIL functionalities related to
+ * mailboxes and byte queues.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_004_001
+ * - @subpage test_004_002
+ * - @subpage test_004_003
+ * - @subpage test_004_004
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define MB_SIZE             4
+#define BQ_SIZE             4
+
+#if NIL_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
+static msg_t mb_buffer[MB_SIZE];
+static MAILBOX_DECL(mb1, mb_buffer, MB_SIZE);
+
+/*
+ * Mailbox emulated using a semaphores pair, used as benchmark reference.
+ */
+static msg_t sp_buffer[MB_SIZE];
+static semaphore_t sp_full, sp_empty;
+static unsigned sp_wr, sp_rd;
+
+static void sp_post(msg_t msg) {
+
+  chSemWait(&sp_empty);
+  chSysLock();
+  sp_buffer[sp_wr] = msg;
+  sp_wr = (sp_wr + 1) % MB_SIZE;
+  chSysUnlock();
+  chSemSignal(&sp_full);
+}
+
+static msg_t sp_fetch(void) {
+  msg_t msg;
+
+  chSemWait(&sp_full);
+  chSysLock();
+  msg = sp_buffer[sp_rd];
+  sp_rd = (sp_rd + 1) % MB_SIZE;
+  chSysUnlock();
+  chSemSignal(&sp_empty);
+  return msg;
+}
+
+/*
+ * Message terminating the consumer jobs, never posted as a sequence number.
+ */
+#define CONS_STOP           ((msg_t)-1)
+
+static volatile uint32_t cons_n;
+static volatile bool cons_ok;
+
+/*
+ * Consumer job for the native mailbox, messages are fetched and checked
+ * against the expected sequence until CONS_STOP is received.
+ */
+static void mb_consumer(void) {
+  msg_t msg;
+
+  cons_n = 0;
+  cons_ok = true;
+  while (true) {
+    (void) chMBFetch(&mb1, &msg);
+    if (msg == CONS_STOP)
+      return;
+    if (msg != (msg_t)cons_n)
+      cons_ok = false;
+    cons_n++;
+  }
+}
+
+/*
+ * Consumer job for the semaphores pair.
+ */
+static void sp_consumer(void) {
+  msg_t msg;
+
+  cons_n = 0;
+  cons_ok = true;
+  while (true) {
+    msg = sp_fetch();
+    if (msg == CONS_STOP)
+      return;
+    if (msg != (msg_t)cons_n)
+      cons_ok = false;
+    cons_n++;
+  }
+}
+
+/*
+ * Starts a job on the consumer thread, the consumer has higher priority so
+ * it is immediately waiting on the mailbox when this function returns.
+ */
+static void cons_start(void (*job)(void)) {
+
+  gconsumer = job;
+  chSysLock();
+  chThdResumeI(&gtr_consumer, MSG_OK);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+#endif
+
+#if NIL_CFG_USE_QUEUES || defined(__DOXYGEN__)
+static uint8_t bq_buffer[BQ_SIZE];
+static BYTE_QUEUE_DECL(bq1, bq_buffer, BQ_SIZE);
+#endif
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if NIL_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
+/**
+ * @page test_004_001 Mailbox primitives, no state change
+ *
+ * <h2>Description</h2>
+ * Post and Fetch primitives are tested. The testing thread does not
+ * trigger a state change.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - NIL_CFG_USE_MAILBOXES
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - The mailbox is filled using chMBPost(), after return the counters
+ *   are tested, a further chMBPostI() must fail.
+ * - The mailbox is emptied using chMBFetch(), the messages order and
+ *   the counters are tested, a further chMBFetchI() must fail.
+ * - Messages are posted using chMBPostI() and then the mailbox is reset
+ *   using chMBReset(), after return the counters are tested.
+ * .
+ */
+
+static void test_004_001_setup(void) {
+
+  chMBObjectInit(&mb1, mb_buffer, MB_SIZE);
+}
+
+static void test_004_001_teardown(void) {
+
+  chMBReset(&mb1);
+}
+
+static void test_004_001_execute(void) {
+
+  /* The mailbox is filled using chMBPost(), after return the counters
+     are tested, a further chMBPostI() must fail.*/
+  test_set_step(1);
+  {
+    msg_t i, msg;
+
+    for (i = 0; i < MB_SIZE; i++) {
+      msg = chMBPost(&mb1, 'A' + i);
+      test_assert(MSG_OK == msg, "wrong returned message");
+    }
+    test_assert_lock(chMBGetFreeCountI(&mb1) == 0, "not full");
+    test_assert_lock(chMBGetUsedCountI(&mb1) == MB_SIZE, "wrong count");
+    chSysLock();
+    msg = chMBPostI(&mb1, 'X');
+    chSysUnlock();
+    test_assert(MSG_TIMEOUT == msg, "post on full mailbox");
+  }
+
+  /* The mailbox is emptied using chMBFetch(), the messages order and
+     the counters are tested, a further chMBFetchI() must fail.*/
+  test_set_step(2);
+  {
+    msg_t i, msg, msg2;
+
+    for (i = 0; i < MB_SIZE; i++) {
+      msg = chMBFetch(&mb1, &msg2);
+      test_assert(MSG_OK == msg, "wrong returned message");
+      test_emit_token((char)msg2);
+    }
+    test_assert_sequence("ABCD", "wrong get sequence");
+    test_assert_lock(chMBGetFreeCountI(&mb1) == MB_SIZE, "not empty");
+    test_assert_lock(chMBGetUsedCountI(&mb1) == 0, "wrong count");
+    chSysLock();
+    msg = chMBFetchI(&mb1, &msg2);
+    chSysUnlock();
+    test_assert(MSG_TIMEOUT == msg, "fetch on empty mailbox");
+  }
+
+  /* Messages are posted using chMBPostI() and then the mailbox is reset
+     using chMBReset(), after return the counters are tested.*/
+  test_set_step(3);
+  {
+    chSysLock();
+    (void) chMBPostI(&mb1, 'A');
+    (void) chMBPostI(&mb1, 'B');
+    chSysUnlock();
+    test_assert_lock(chMBGetUsedCountI(&mb1) == 2, "wrong count");
+    chMBReset(&mb1);
+    test_assert_lock(chMBGetFreeCountI(&mb1) == MB_SIZE, "not empty");
+    test_assert_lock(chMBGetUsedCountI(&mb1) == 0, "wrong count");
+    test_assert(mb1.rdptr == mb1.buffer, "wrong read pointer");
+    test_assert(mb1.wrptr == mb1.buffer, "wrong write pointer");
+  }
+}
+
+static const testcase_t test_004_001 = {
+  "mailbox primitives, no state change",
+  test_004_001_setup,
+  test_004_001_teardown,
+  test_004_001_execute
+};
+#endif /* NIL_CFG_USE_MAILBOXES */
+
+#if NIL_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
+/**
+ * @page test_004_002 Mailbox primitives, with state change
+ *
+ * <h2>Description</h2>
+ * Fetch with state change and timeouts are tested.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - NIL_CFG_USE_MAILBOXES
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - The function chMBFetch() is invoked on an empty mailbox, a message
+ *   is posted by another thread. After return the message and the
+ *   counters are tested.
+ * - The function chMBFetchTimeout() is invoked on an empty mailbox,
+ *   after return the system time, the counters and the returned message
+ *   are tested.
+ * - The function chMBPostTimeout() is invoked on a full mailbox,
+ *   after return the system time, the counters and the returned message
+ *   are tested.
+ * .
+ */
+
+static void test_004_002_setup(void) {
+
+  chMBObjectInit(&mb1, mb_buffer, MB_SIZE);
+}
+
+static void test_004_002_teardown(void) {
+
+  chMBReset(&mb1);
+}
+
+static void test_004_002_execute(void) {
+  systime_t time;
+  msg_t msg, msg2;
+
+  /* The function chMBFetch() is invoked on an empty mailbox, a message
+     is posted by another thread. After return the message and the
+     counters are tested.*/
+  test_set_step(1);
+  {
+    msg = chMBFetch(&gmb1, &msg2);
+    test_assert(MSG_OK == msg, "wrong returned message");
+    test_assert(0x55 == msg2, "wrong message");
+    test_assert_lock(chMBGetUsedCountI(&gmb1) == 0, "wrong count");
+  }
+
+  /* The function chMBFetchTimeout() is invoked on an empty mailbox,
+     after return the system time, the counters and the returned message
+     are tested.*/
+  test_set_step(2);
+  {
+    time = chVTGetSystemTimeX();
+    msg = chMBFetchTimeout(&mb1, &msg2, MS2ST(1000));
+    test_assert_time_window(time + MS2ST(1000),
+                            time + MS2ST(1000) + 1,
+                            "out of time window");
+    test_assert(MSG_TIMEOUT == msg, "wrong timeout message");
+    test_assert_lock(chMBGetUsedCountI(&mb1) == 0, "wrong count");
+  }
+
+  /* The function chMBPostTimeout() is invoked on a full mailbox,
+     after return the system time, the counters and the returned message
+     are tested.*/
+  test_set_step(3);
+  {
+    msg_t i;
+
+    for (i = 0; i < MB_SIZE; i++)
+      (void) chMBPost(&mb1, i);
+    time = chVTGetSystemTimeX();
+    msg = chMBPostTimeout(&mb1, 'X', MS2ST(1000));
+    test_assert_time_window(time + MS2ST(1000),
+                            time + MS2ST(1000) + 1,
+                            "out of time window");
+    test_assert(MSG_TIMEOUT == msg, "wrong timeout message");
+    test_assert_lock(chMBGetFreeCountI(&mb1) == 0, "wrong count");
+  }
+}
+
+static const testcase_t test_004_002 = {
+  "mailbox primitives, with state change",
+  test_004_002_setup,
+  test_004_002_teardown,
+  test_004_002_execute
+};
+#endif /* NIL_CFG_USE_MAILBOXES */
+
+#if NIL_CFG_USE_QUEUES || defined(__DOXYGEN__)
+/**
+ * @page test_004_003 Byte queues primitives
+ *
+ * <h2>Description</h2>
+ * Put, Get and Reset primitives are tested, including timeouts.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - NIL_CFG_USE_QUEUES
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - The queue is filled using chBQPutI(), a further chBQPutI() must fail,
+ *   then the queue is emptied using chBQGet() and the bytes order is
+ *   tested.
+ * - The function chBQGetTimeout() is invoked on an empty queue, after
+ *   return the system time and the returned message are tested.
+ * - The function chBQPutTimeout() is invoked on a full queue, after
+ *   return the system time and the returned message are tested, then
+ *   the queue is reset and the counters are tested.
+ * .
+ */
+
+static void test_004_003_setup(void) {
+
+  chBQObjectInit(&bq1, bq_buffer, BQ_SIZE);
+}
+
+static void test_004_003_teardown(void) {
+
+  chBQReset(&bq1);
+}
+
+static void test_004_003_execute(void) {
+  systime_t time;
+  msg_t msg;
+  unsigned i;
+
+  /* The queue is filled using chBQPutI(), a further chBQPutI() must fail,
+     then the queue is emptied using chBQGet() and the bytes order is
+     tested.*/
+  test_set_step(1);
+  {
+    chSysLock();
+    for (i = 0; i < BQ_SIZE; i++)
+      (void) chBQPutI(&bq1, 'A' + i);
+    msg = chBQPutI(&bq1, 'X');
+    chSysUnlock();
+    test_assert(MSG_TIMEOUT == msg, "put on full queue");
+    test_assert_lock(chBQGetUsedCountI(&bq1) == BQ_SIZE, "wrong count");
+    for (i = 0; i < BQ_SIZE; i++)
+      test_emit_token((char)chBQGet(&bq1));
+    test_assert_sequence("ABCD", "wrong get sequence");
+    test_assert_lock(chBQGetFreeCountI(&bq1) == BQ_SIZE, "not empty");
+  }
+
+  /* The function chBQGetTimeout() is invoked on an empty queue, after
+     return the system time and the returned message are tested.*/
+  test_set_step(2);
+  {
+    time = chVTGetSystemTimeX();
+    msg = chBQGetTimeout(&bq1, MS2ST(1000));
+    test_assert_time_window(time + MS2ST(1000),
+                            time + MS2ST(1000) + 1,
+                            "out of time window");
+    test_assert(MSG_TIMEOUT == msg, "wrong timeout message");
+    test_assert_lock(chBQGetUsedCountI(&bq1) == 0, "wrong count");
+  }
+
+  /* The function chBQPutTimeout() is invoked on a full queue, after
+     return the system time and the returned message are tested, then
+     the queue is reset and the counters are tested.*/
+  test_set_step(3);
+  {
+    for (i = 0; i < BQ_SIZE; i++)
+      (void) chBQPut(&bq1, 'A' + i);
+    time = chVTGetSystemTimeX();
+    msg = chBQPutTimeout(&bq1, 'X', MS2ST(1000));
+    test_assert_time_window(time + MS2ST(1000),
+                            time + MS2ST(1000) + 1,
+                            "out of time window");
+    test_assert(MSG_TIMEOUT == msg, "wrong timeout message");
+    chBQReset(&bq1);
+    test_assert_lock(chBQGetFreeCountI(&bq1) == BQ_SIZE, "not empty");
+    test_assert_lock(chBQGetUsedCountI(&bq1) == 0, "wrong count");
+  }
+}
+
+static const testcase_t test_004_003 = {
+  "byte queues primitives",
+  test_004_003_setup,
+  test_004_003_teardown,
+  test_004_003_execute
+};
+#endif /* NIL_CFG_USE_QUEUES */
+
+#if NIL_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
+/**
+ * @page test_004_004 Mailbox benchmark
+ *
+ * <h2>Description</h2>
+ * The native mailbox is compared with a mailbox emulated using a pair
+ * of semaphores and a critical zone, the usual pattern on kernels without
+ * a mailbox primitive.<br>
+ * The tester thread is the producer, the messages are fetched by the
+ * higher priority consumer thread so each message wakes up the consumer
+ * and each fetch blocks it again.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - NIL_CFG_USE_MAILBOXES
+ * .
+ * The @p test_consumer thread must be in the threads table with a
+ * priority higher than the tester thread.
+ *
+ * <h2>Test Steps</h2>
+ * - Messages are posted to the consumer thread using the native mailbox
+ *   for one second, the number of messages per second is printed.
+ * - Messages are posted to the consumer thread using the semaphores pair
+ *   for one second, the number of messages per second is printed.
+ * .
+ */
+
+static void test_004_004_setup(void) {
+
+  chMBObjectInit(&mb1, mb_buffer, MB_SIZE);
+  chSemObjectInit(&sp_full, 0);
+  chSemObjectInit(&sp_empty, MB_SIZE);
+  sp_wr = sp_rd = 0;
+}
+
+static void test_004_004_execute(void) {
+  systime_t start;
+  uint32_t n;
+
+  /* Messages are posted to the consumer thread using the native mailbox
+     for one second, the number of messages per second is printed.*/
+  test_set_step(1);
+  {
+    test_assert_lock(gtr_consumer != NULL, "consumer not available");
+    cons_start(mb_consumer);
+    n = 0;
+    start = chVTGetSystemTimeX();
+    do {
+      (void) chMBPost(&mb1, (msg_t)n);
+      n++;
+    } while (chVTIsTimeWithinX(chVTGetSystemTimeX(),
+                               start, start + S2ST(1)));
+    (void) chMBPost(&mb1, CONS_STOP);
+    test_assert_lock(gtr_consumer != NULL, "consumer not waiting");
+    test_assert(cons_n == n, "messages lost");
+    test_assert(cons_ok, "wrong message");
+
+    test_print("--- Mailbox : ");
+    test_printn(n);
+    test_println(" msgs/S");
+  }
+
+  /* Messages are posted to the consumer thread using the semaphores pair
+     for one second, the number of messages per second is printed.*/
+  test_set_step(2);
+  {
+    test_assert_lock(gtr_consumer != NULL, "consumer not available");
+    cons_start(sp_consumer);
+    n = 0;
+    start = chVTGetSystemTimeX();
+    do {
+      sp_post((msg_t)n);
+      n++;
+    } while (chVTIsTimeWithinX(chVTGetSystemTimeX(),
+                               start, start + S2ST(1)));
+    sp_post(CONS_STOP);
+    test_assert_lock(gtr_consumer != NULL, "consumer not waiting");
+    test_assert(cons_n == n, "messages lost");
+    test_assert(cons_ok, "wrong message");
+
+    test_print("--- Sem pair: ");
+    test_printn(n);
+    test_println(" msgs/S");
+  }
+}
+
+static const testcase_t test_004_004 = {
+  "mailbox benchmark",
+  test_004_004_setup,
+  NULL,
+  test_004_004_execute
+};
+#endif /* NIL_CFG_USE_MAILBOXES */
+
+ /****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Sequence brief description.
+ */
+const testcase_t * const test_sequence_004[] = {
+#if NIL_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
+  &test_004_001,
+  &test_004_002,
+#endif
+#if NIL_CFG_USE_QUEUES || defined(__DOXYGEN__)
+  &test_004_003,
+#endif
+#if NIL_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
+  &test_004_004,
+#endif
+  NULL
+};
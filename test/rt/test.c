@@ -31,12 +31,26 @@
 #include "testmtx.h"
 #include "testmsg.h"
 #include "testmbox.h"
+#include "testrings.h"
 #include "testevt.h"
 #include "testheap.h"
 #include "testpools.h"
 #include "testdyn.h"
 #include "testqueues.h"
+#include "testsmp.h"
 #include "testbmk.h"
+#if TEST_USE_GPT_LATENCY
+#include "testlat.h"
+#endif
+#if TEST_USE_CPP_WRAPPERS
+#include "testcpp.h"
+#endif
+#if TEST_USE_DMACOPY
+#include "testdmacopy.h"
+#endif
+#if TEST_USE_ICCHANNEL
+#include "testicc.h"
+#endif
 
 /*
  * Array of all the test patterns.
@@ -47,12 +61,26 @@ static ROMCONST struct testcase * ROMCONST *patterns[] = {
   patternmtx,
   patternmsg,
   patternmbox,
+  patternrings,
   patternevt,
   patternheap,
   patternpools,
   patterndyn,
   patternqueues,
+  patternsmp,
   patternbmk,
+#if TEST_USE_GPT_LATENCY
+  patternlat,
+#endif
+#if TEST_USE_CPP_WRAPPERS
+  patterncpp,
+#endif
+#if TEST_USE_DMACOPY
+  patterndmacopy,
+#endif
+#if TEST_USE_ICCHANNEL
+  patternicc,
+#endif
   NULL
 };
 
@@ -83,6 +111,31 @@ void * ROMCONST wa[5] = {test.wa.T0, test.wa.T1, test.wa.T2,
  */
 static BaseSequentialStream *chp;
 
+#if TEST_BMK_MODE
+/*
+ * Benchmark mode, the test cases output is suppressed while the benchmarks
+ * are running.
+ */
+static bool quiet;
+
+static struct {
+  const char    *unit;
+  unsigned      run;
+  bool          failed;
+  uint32_t      scores[TEST_BMK_RUNS];
+#if TEST_BMK_LATENCY
+  test_histogram_t hist;
+#endif
+} bmk;
+
+#if TEST_BMK_LATENCY
+/*
+ * Start time of the current latency sample.
+ */
+rtcnt_t test_bmk_t0;
+#endif
+#endif /* TEST_BMK_MODE */
+
 /**
  * @brief   Prints a decimal unsigned number.
  *
@@ -91,6 +144,10 @@ static BaseSequentialStream *chp;
 void test_printn(uint32_t n) {
   char buf[16], *p;
 
+#if TEST_BMK_MODE
+  if (quiet)
+    return;
+#endif
   if (!n)
     chSequentialStreamPut(chp, '0');
   else {
@@ -109,6 +166,10 @@ void test_printn(uint32_t n) {
  */
 void test_print(const char *msgp) {
 
+#if TEST_BMK_MODE
+  if (quiet)
+    return;
+#endif
   while (*msgp)
     chSequentialStreamPut(chp, *msgp++);
 }
@@ -120,6 +181,10 @@ void test_print(const char *msgp) {
  */
 void test_println(const char *msgp) {
 
+#if TEST_BMK_MODE
+  if (quiet)
+    return;
+#endif
   test_print(msgp);
   chSequentialStreamWrite(chp, (const uint8_t *)"\r\n", 2);
 }
@@ -169,7 +234,7 @@ bool _test_assert(unsigned point, bool condition) {
   return FALSE;
 }
 
-bool _test_assert_sequence(unsigned point, char *expected) {
+bool _test_assert_sequence(unsigned point, const char *expected) {
   char *cp = tokens_buffer;
   while (cp < tokp) {
     if (*cp++ != *expected++)
@@ -183,7 +248,14 @@ bool _test_assert_sequence(unsigned point, char *expected) {
 
 bool _test_assert_time_window(unsigned point, systime_t start, systime_t end) {
 
+#if CH_DBG_SIMULATED_TIME
+  /* Code execution takes no time in simulated time mode, deadlines are
+     met exactly.*/
+  (void)end;
+  return _test_assert(point, chVTGetSystemTime() == start);
+#else
   return _test_assert(point, chVTIsSystemTimeWithin(start, end));
+#endif
 }
 
 /*
@@ -214,26 +286,51 @@ void test_wait_threads(void) {
     }
 }
 
-#if CH_DBG_THREADS_PROFILING
+#if CH_DBG_SIMULATED_TIME
+/**
+ * @brief   Consumes simulated time.
+ * @details The calling thread behaves as if it was executing code for
+ *          @p n system ticks, threads awakened meanwhile preempt it exactly
+ *          at their deadline tick.
+ *
+ * @param[in] n             number of system ticks
+ */
+void test_advance_time(systime_t n) {
+
+  chSysLock();
+  while (n > 0) {
+    n -= chSysAdvanceTimeI(n);
+    if (chSchIsPreemptionRequired())
+      chSchDoReschedule();
+  }
+  chSysUnlock();
+}
+#endif
+
+#if TEST_USE_CPU_PULSE
 /**
  * @brief   CPU pulse.
- * @note    The current implementation is not totally reliable.
+ * @note    The current implementation is not totally reliable, the
+ *          simulated time implementation is exact.
  *
  * @param[in] duration      CPU pulse duration in milliseconds
  */
 void test_cpu_pulse(unsigned duration) {
+#if CH_DBG_SIMULATED_TIME
+
+  test_advance_time(MS2ST(duration));
+#else
   systime_t start, end, now;
 
   start = chThdGetTicksX(chThdGetSelfX());
   end = start + MS2ST(duration);
   do {
     now = chThdGetTicksX(chThdGetSelfX());
-#if defined(SIMULATOR)
-    ChkIntSources();
-#endif
+    test_poll();
   }
   while (end > start ? (now >= start) && (now < end) :
                        (now >= start) || (now < end));
+#endif
 }
 #endif
 
@@ -276,6 +373,293 @@ void test_start_timer(unsigned ms) {
   chVTSet(&vt, duration, tmr, NULL);
 }
 
+#if TEST_USE_HISTOGRAMS || defined(__DOXYGEN__)
+/*
+ * Latency histograms utils.
+ */
+
+static unsigned hist_msb(uint32_t x) {
+#if defined(__GNUC__)
+  return 31U - (unsigned)__builtin_clz((unsigned)x);
+#else
+  unsigned n = 0;
+
+  while (x >>= 1)
+    n++;
+  return n;
+#endif
+}
+
+/**
+ * @brief   Resets a latency histogram.
+ *
+ * @param[out] hp       pointer to the @p test_histogram_t structure
+ */
+void test_hist_reset(test_histogram_t *hp) {
+  unsigned i;
+
+  hp->samples = 0;
+  hp->min = 0xFFFFFFFFU;
+  hp->max = 0;
+  for (i = 0; i < TEST_HIST_BUCKETS; i++)
+    hp->buckets[i] = 0;
+}
+
+/**
+ * @brief   Accounts a sample in a latency histogram.
+ *
+ * @param[in] hp        pointer to the @p test_histogram_t structure
+ * @param[in] x         the sample
+ */
+void test_hist_add(test_histogram_t *hp, uint32_t x) {
+  unsigned i, msb;
+
+  if (x < hp->min)
+    hp->min = x;
+  if (x > hp->max)
+    hp->max = x;
+  hp->samples++;
+  if (x < (2U << TEST_BMK_HIST_SUBBITS))
+    i = (unsigned)x;
+  else {
+    msb = hist_msb(x);
+    if (msb >= TEST_BMK_HIST_MAXBIT)
+      i = TEST_HIST_BUCKETS - 1U;
+    else
+      i = (2U << TEST_BMK_HIST_SUBBITS) +
+          (msb - TEST_BMK_HIST_SUBBITS - 1U) * (1U << TEST_BMK_HIST_SUBBITS) +
+          ((unsigned)(x >> (msb - TEST_BMK_HIST_SUBBITS)) &
+           ((1U << TEST_BMK_HIST_SUBBITS) - 1U));
+  }
+  hp->buckets[i]++;
+}
+
+/**
+ * @brief   Returns the upper bound of the values accounted in a bucket.
+ *
+ * @param[in] i         the bucket index
+ * @return              The upper bound, included.
+ */
+uint32_t test_hist_upper(unsigned i) {
+  unsigned k, msb;
+
+  if (i < (2U << TEST_BMK_HIST_SUBBITS))
+    return i;
+  k = i - (2U << TEST_BMK_HIST_SUBBITS);
+  msb = (k >> TEST_BMK_HIST_SUBBITS) + TEST_BMK_HIST_SUBBITS + 1U;
+  return (((1U << TEST_BMK_HIST_SUBBITS) +
+           (k & ((1U << TEST_BMK_HIST_SUBBITS) - 1U)) + 1U) <<
+          (msb - TEST_BMK_HIST_SUBBITS)) - 1U;
+}
+
+/**
+ * @brief   Returns a percentile of a latency histogram.
+ * @details The upper bound of the bucket containing the percentile is
+ *          returned, the value is clamped to the exact maximum.
+ *
+ * @param[in] hp        pointer to the @p test_histogram_t structure
+ * @param[in] pct       the percentile
+ * @return              The percentile value.
+ */
+uint32_t test_hist_percentile(const test_histogram_t *hp, unsigned pct) {
+  uint32_t target, cnt, upper;
+  unsigned i;
+
+  target = (hp->samples / 100U) * pct +
+           ((hp->samples % 100U) * pct + 99U) / 100U;
+  cnt = 0;
+  for (i = 0; i < TEST_HIST_BUCKETS - 1U; i++) {
+    cnt += hp->buckets[i];
+    if (cnt >= target)
+      break;
+  }
+  upper = test_hist_upper(i);
+  return upper < hp->max ? upper : hp->max;
+}
+#endif /* TEST_USE_HISTOGRAMS */
+
+#if TEST_BMK_MODE || defined(__DOXYGEN__)
+/*
+ * Benchmark mode utils.
+ */
+
+/**
+ * @brief   Records the score of the current benchmark run.
+ * @note    Only available in benchmark mode, otherwise the call is
+ *          removed.
+ *
+ * @param[in] score     the benchmark score
+ * @param[in] unit      the score unit as a string
+ */
+void test_bmk_score(uint32_t score, const char *unit) {
+
+  bmk.scores[bmk.run] = score;
+  bmk.unit = unit;
+}
+
+#if TEST_BMK_LATENCY || defined(__DOXYGEN__)
+/**
+ * @brief   Accounts a latency sample in the benchmark histogram.
+ *
+ * @param[in] dt        the sample in realtime counter ticks
+ */
+void test_bmk_sample(rtcnt_t dt) {
+
+  test_hist_add(&bmk.hist, (uint32_t)dt);
+}
+#endif /* TEST_BMK_LATENCY */
+
+static void bmk_reset(void) {
+  unsigned i;
+
+  bmk.unit = NULL;
+  bmk.failed = FALSE;
+  for (i = 0; i < TEST_BMK_RUNS; i++)
+    bmk.scores[i] = 0;
+#if TEST_BMK_LATENCY
+  test_hist_reset(&bmk.hist);
+#endif
+}
+
+/*
+ * Prints a quoted string, quotes are escaped as required by the output
+ * format.
+ */
+static void bmk_print_string(const char *s) {
+
+  chSequentialStreamPut(chp, '"');
+  while (*s) {
+#if TEST_BMK_FORMAT == TEST_BMK_FORMAT_JSON
+    if ((*s == '"') || (*s == '\\'))
+      chSequentialStreamPut(chp, '\\');
+#else
+    if (*s == '"')
+      chSequentialStreamPut(chp, '"');
+#endif
+    chSequentialStreamPut(chp, *s++);
+  }
+  chSequentialStreamPut(chp, '"');
+}
+
+static void bmk_print_info(const char *name, const char *value) {
+
+#if TEST_BMK_FORMAT == TEST_BMK_FORMAT_JSON
+  test_print("  ");
+  bmk_print_string(name);
+  test_print(": ");
+  bmk_print_string(value);
+  test_println(",");
+#else
+  test_print("# ");
+  test_print(name);
+  test_print(": ");
+  test_println(value);
+#endif
+}
+
+static void bmk_print_header(void) {
+
+#if TEST_BMK_FORMAT == TEST_BMK_FORMAT_JSON
+  test_println("{");
+#endif
+  bmk_print_info("kernel", CH_KERNEL_VERSION);
+  bmk_print_info("compiled", __DATE__ " - " __TIME__);
+#ifdef PORT_COMPILER_NAME
+  bmk_print_info("compiler", PORT_COMPILER_NAME);
+#endif
+  bmk_print_info("architecture", PORT_ARCHITECTURE_NAME);
+#ifdef PORT_CORE_VARIANT_NAME
+  bmk_print_info("core_variant", PORT_CORE_VARIANT_NAME);
+#endif
+#ifdef PORT_MEMORY_INFO
+  bmk_print_info("memory", PORT_MEMORY_INFO);
+#endif
+#ifdef PLATFORM_NAME
+  bmk_print_info("platform", PLATFORM_NAME);
+#endif
+#ifdef BOARD_NAME
+  bmk_print_info("board", BOARD_NAME);
+#endif
+#if TEST_BMK_FORMAT == TEST_BMK_FORMAT_JSON
+  test_print("  \"runs\": ");
+  test_printn(TEST_BMK_RUNS);
+  test_println(",");
+  test_println("  \"benchmarks\": [");
+#else
+  test_println("name,unit,failed,scores,samples,p50,p99,max");
+#endif
+}
+
+static void bmk_print_record(const char *name, bool first) {
+  unsigned i;
+
+#if TEST_BMK_FORMAT == TEST_BMK_FORMAT_JSON
+  if (!first)
+    test_println(",");
+  test_print("    {\"name\": ");
+  bmk_print_string(name);
+  test_print(", \"unit\": ");
+  bmk_print_string(bmk.unit);
+  test_print(bmk.failed ? ", \"failed\": true" : ", \"failed\": false");
+  test_print(", \"scores\": [");
+  for (i = 0; i < TEST_BMK_RUNS; i++) {
+    if (i > 0)
+      test_print(", ");
+    test_printn(bmk.scores[i]);
+  }
+  test_print("]");
+#if TEST_BMK_LATENCY
+  if (bmk.hist.samples > 0) {
+    test_print(", \"samples\": ");
+    test_printn(bmk.hist.samples);
+    test_print(", \"p50\": ");
+    test_printn(test_hist_percentile(&bmk.hist, 50));
+    test_print(", \"p99\": ");
+    test_printn(test_hist_percentile(&bmk.hist, 99));
+    test_print(", \"max\": ");
+    test_printn(bmk.hist.max);
+  }
+#endif
+  test_print("}");
+#else /* TEST_BMK_FORMAT == TEST_BMK_FORMAT_CSV */
+  (void)first;
+  bmk_print_string(name);
+  test_print(",");
+  bmk_print_string(bmk.unit);
+  test_print(bmk.failed ? ",1," : ",0,");
+  for (i = 0; i < TEST_BMK_RUNS; i++) {
+    if (i > 0)
+      test_print(";");
+    test_printn(bmk.scores[i]);
+  }
+#if TEST_BMK_LATENCY
+  if (bmk.hist.samples > 0) {
+    test_print(",");
+    test_printn(bmk.hist.samples);
+    test_print(",");
+    test_printn(test_hist_percentile(&bmk.hist, 50));
+    test_print(",");
+    test_printn(test_hist_percentile(&bmk.hist, 99));
+    test_print(",");
+    test_printn(bmk.hist.max);
+    test_println("");
+    return;
+  }
+#endif
+  test_println(",,,,");
+#endif /* TEST_BMK_FORMAT == TEST_BMK_FORMAT_CSV */
+}
+
+static void bmk_print_footer(void) {
+
+#if TEST_BMK_FORMAT == TEST_BMK_FORMAT_JSON
+  test_println("");
+  test_println("  ]");
+  test_println("}");
+#endif
+}
+#endif /* TEST_BMK_MODE */
+
 /*
  * Test suite execution.
  */
@@ -305,16 +689,58 @@ static void print_line(void) {
   chSequentialStreamWrite(chp, (const uint8_t *)"\r\n", 2);
 }
 
-/**
- * @brief   Test execution thread function.
- *
- * @param[in] p         pointer to a @p BaseChannel object for test output
- * @return              A failure boolean value.
+#if TEST_BMK_MODE || defined(__DOXYGEN__)
+/*
+ * Benchmark mode execution, each benchmark is executed TEST_BMK_RUNS times
+ * and then its record is emitted.
  */
-msg_t TestThread(void *p) {
+static msg_t execute_benchmarks(void) {
+  static ROMCONST struct testcase * ROMCONST *bmkpatterns[] = {
+    patternbmk,
+#if TEST_USE_GPT_LATENCY
+    patternlat,
+#endif
+    NULL
+  };
+  unsigned i, j;
+  bool first = TRUE;
+
+  global_fail = FALSE;
+  bmk_print_header();
+  for (i = 0; bmkpatterns[i] != NULL; i++) {
+    for (j = 0; bmkpatterns[i][j] != NULL; j++) {
+      bmk_reset();
+      for (bmk.run = 0; bmk.run < TEST_BMK_RUNS; bmk.run++) {
+#if DELAY_BETWEEN_TESTS > 0
+        chThdSleepMilliseconds(DELAY_BETWEEN_TESTS);
+#endif
+        quiet = TRUE;
+        execute_test(bmkpatterns[i][j]);
+        quiet = FALSE;
+        if (local_fail)
+          bmk.failed = TRUE;
+      }
+
+      /* Test cases not reporting a score are not benchmarks.*/
+      if (bmk.unit != NULL) {
+        bmk_print_record(bmkpatterns[i][j]->name, first);
+        first = FALSE;
+      }
+    }
+  }
+  bmk_print_footer();
+
+  return (msg_t)global_fail;
+}
+#endif /* TEST_BMK_MODE */
+
+#if !TEST_BMK_MODE || defined(__DOXYGEN__)
+/*
+ * Normal execution, all the test cases are executed once.
+ */
+static msg_t execute_tests(void) {
   int i, j;
 
-  chp = p;
   test_println("");
   test_println("*** ChibiOS/RT test suite");
   test_println("***");
@@ -336,6 +762,10 @@ msg_t TestThread(void *p) {
   test_print("*** Port Info:    ");
   test_println(PORT_INFO);
 #endif
+#ifdef PORT_MEMORY_INFO
+  test_print("*** Memory:       ");
+  test_println(PORT_MEMORY_INFO);
+#endif
 #ifdef PLATFORM_NAME
   test_print("*** Platform:     ");
   test_println(PLATFORM_NAME);
@@ -386,5 +816,24 @@ msg_t TestThread(void *p) {
 
   return (msg_t)global_fail;
 }
+#endif /* !TEST_BMK_MODE */
+
+/**
+ * @brief   Test execution thread function.
+ * @note    If @p TEST_BMK_MODE is enabled then only the benchmarks are
+ *          executed and the results are emitted in machine readable format.
+ *
+ * @param[in] p         pointer to a @p BaseChannel object for test output
+ * @return              A failure boolean value.
+ */
+msg_t TestThread(void *p) {
+
+  chp = p;
+#if TEST_BMK_MODE
+  return execute_benchmarks();
+#else
+  return execute_tests();
+#endif
+}
 
 /** @} */
@@ -39,6 +39,120 @@
 #define TEST_NO_BENCHMARKS      FALSE
 #endif
 
+/**
+ * @brief   Interrupt latency test sequence switch.
+ * @details If @p TRUE then the GPT based interrupt to thread latency test
+ *          sequence is included, the application must build @p testlat.c
+ *          and the HAL must be enabled.
+ */
+#if !defined(TEST_USE_GPT_LATENCY) || defined(__DOXYGEN__)
+#define TEST_USE_GPT_LATENCY    FALSE
+#endif
+
+/**
+ * @brief   C++ wrappers test sequence switch.
+ * @details If @p TRUE then the C++ wrappers test sequence is included, the
+ *          application must build @p testcpp.cpp using a C++11 compiler.
+ */
+#if !defined(TEST_USE_CPP_WRAPPERS) || defined(__DOXYGEN__)
+#define TEST_USE_CPP_WRAPPERS   FALSE
+#endif
+
+/**
+ * @brief   Asynchronous memory copy test sequence switch.
+ * @details If @p TRUE then the @p dmacopy test sequence is included, the
+ *          application must build @p testdmacopy.c and
+ *          @p os/various/dmacopy.c and must invoke @p dmacopyInit().
+ */
+#if !defined(TEST_USE_DMACOPY) || defined(__DOXYGEN__)
+#define TEST_USE_DMACOPY        FALSE
+#endif
+
+/**
+ * @brief   Inter-core channels test sequence switch.
+ * @details If @p TRUE then the inter-core channels test sequence is
+ *          included, the application must build @p testicc.c and
+ *          @p os/various/icchannel.c and the HAL must be enabled.
+ */
+#if !defined(TEST_USE_ICCHANNEL) || defined(__DOXYGEN__)
+#define TEST_USE_ICCHANNEL      FALSE
+#endif
+
+/**
+ * @brief   Benchmark mode.
+ * @details If @p TRUE then only the benchmarks are executed, each one
+ *          @p TEST_BMK_RUNS times, and the results are emitted in the
+ *          machine readable format selected by @p TEST_BMK_FORMAT instead
+ *          of the normal test log.
+ */
+#if !defined(TEST_BMK_MODE) || defined(__DOXYGEN__)
+#define TEST_BMK_MODE           FALSE
+#endif
+
+/**
+ * @brief   Number of runs of each benchmark in benchmark mode.
+ */
+#if !defined(TEST_BMK_RUNS) || defined(__DOXYGEN__)
+#define TEST_BMK_RUNS           5
+#endif
+
+/**
+ * @name    Benchmark mode output formats
+ * @{
+ */
+#define TEST_BMK_FORMAT_JSON    0
+#define TEST_BMK_FORMAT_CSV     1
+/** @} */
+
+/**
+ * @brief   Benchmark mode output format.
+ */
+#if !defined(TEST_BMK_FORMAT) || defined(__DOXYGEN__)
+#define TEST_BMK_FORMAT         TEST_BMK_FORMAT_JSON
+#endif
+
+/**
+ * @brief   Latency sampling enable switch.
+ * @details Latency samples are taken using the realtime counter so the
+ *          feature is only available on ports supporting it.
+ */
+#define TEST_BMK_LATENCY        (TEST_BMK_MODE && PORT_SUPPORTS_RT)
+
+/**
+ * @brief   Number of sub-buckets per power of two in latency histograms.
+ * @details The value is expressed as a power of two exponent, the relative
+ *          error of the reported percentiles is within 1/2^N.
+ */
+#define TEST_BMK_HIST_SUBBITS   3
+
+/**
+ * @brief   CPU pulses support switch.
+ * @details CPU pulses are measured using the threads profiling or, in
+ *          simulated time mode, by advancing the system time.
+ */
+#define TEST_USE_CPU_PULSE      (CH_DBG_THREADS_PROFILING ||                \
+                                 CH_DBG_SIMULATED_TIME)
+
+/**
+ * @brief   Highest power of two covered by latency histograms.
+ * @details Bigger samples are accounted in the last bucket, the maximum is
+ *          always tracked exactly.
+ */
+#define TEST_BMK_HIST_MAXBIT    24
+
+/**
+ * @brief   Latency histograms support switch.
+ */
+#define TEST_USE_HISTOGRAMS     (TEST_BMK_LATENCY || TEST_USE_GPT_LATENCY)
+
+/**
+ * @brief   Number of buckets in a latency histogram.
+ */
+#define TEST_HIST_BUCKETS                                                   \
+  ((2U << TEST_BMK_HIST_SUBBITS) +                                          \
+   (TEST_BMK_HIST_MAXBIT - TEST_BMK_HIST_SUBBITS - 1U) *                    \
+   (1U << TEST_BMK_HIST_SUBBITS))
+
 #define MAX_THREADS             5
 #define MAX_TOKENS              16
 
@@ -63,6 +177,21 @@ struct testcase {
   void (*execute)(void);        /**< @brief Test case execution function.   */
 };
 
+/**
+ * @brief   Structure representing a latency histogram.
+ * @details The histogram is log-linear, values below 2^(N+1) have their own
+ *          bucket then each power of two is split in 2^N buckets, N is
+ *          @p TEST_BMK_HIST_SUBBITS. The minimum and the maximum are
+ *          tracked exactly.
+ */
+typedef struct {
+  uint32_t      samples;        /**< @brief Number of samples.              */
+  uint32_t      min;            /**< @brief Minimum sample.                 */
+  uint32_t      max;            /**< @brief Maximum sample.                 */
+  uint32_t      buckets[TEST_HIST_BUCKETS];
+                                /**< @brief Samples counters.               */
+} test_histogram_t;
+
 #ifndef __DOXYGEN__
 union test_buffers {
   struct {
@@ -86,18 +215,33 @@ extern "C" {
   void test_emit_token(char token);
   bool _test_fail(unsigned point);
   bool _test_assert(unsigned point, bool condition);
-  bool _test_assert_sequence(unsigned point, char *expected);
+  bool _test_assert_sequence(unsigned point, const char *expected);
   bool _test_assert_time_window(unsigned point, systime_t start, systime_t end);
   void test_terminate_threads(void);
   void test_wait_threads(void);
   systime_t test_wait_tick(void);
   void test_start_timer(unsigned ms);
-#if CH_DBG_THREADS_PROFILING
+#if TEST_USE_CPU_PULSE
   void test_cpu_pulse(unsigned duration);
 #endif
+#if CH_DBG_SIMULATED_TIME
+  void test_advance_time(systime_t n);
+#endif
 #if defined(WIN32)
   void ChkIntSources(void);
 #endif
+#if TEST_USE_HISTOGRAMS
+  void test_hist_reset(test_histogram_t *hp);
+  void test_hist_add(test_histogram_t *hp, uint32_t x);
+  uint32_t test_hist_upper(unsigned i);
+  uint32_t test_hist_percentile(const test_histogram_t *hp, unsigned pct);
+#endif
+#if TEST_BMK_MODE
+  void test_bmk_score(uint32_t score, const char *unit);
+#endif
+#if TEST_BMK_LATENCY
+  void test_bmk_sample(rtcnt_t dt);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -161,11 +305,59 @@ extern "C" {
     return;                                                                 \
 }
 
+/**
+ * @brief   Polling point inside busy loops.
+ * @details Gives the simulator the chance to serve its interrupt sources,
+ *          in simulated time mode each polling point consumes a system tick
+ *          so that loops waiting for a time event terminate.
+ * @note    The simulated time mode is checked first because the simulator
+ *          does not advance the system time by itself in that mode, its
+ *          interrupt sources are still served.
+ */
+#if CH_DBG_SIMULATED_TIME || defined(__DOXYGEN__)
+#if defined(SIMULATOR)
+#define test_poll() {                                                       \
+  ChkIntSources();                                                          \
+  test_advance_time(1);                                                     \
+}
+#else
+#define test_poll() test_advance_time(1)
+#endif
+#elif defined(SIMULATOR)
+#define test_poll() ChkIntSources()
+#else
+#define test_poll()
+#endif
+
+#if !TEST_BMK_MODE && !defined(__DOXYGEN__)
+#define test_bmk_score(score, unit)
+#endif
+
+#if TEST_BMK_LATENCY || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a latency sample.
+ * @note    Only the tester thread can take samples.
+ */
+#define test_bmk_sample_start() (test_bmk_t0 = chSysGetRealtimeCounterX())
+
+/**
+ * @brief   Ends a latency sample and accounts it in the histogram.
+ */
+#define test_bmk_sample_end()                                               \
+  test_bmk_sample((rtcnt_t)(chSysGetRealtimeCounterX() - test_bmk_t0))
+#else
+#define test_bmk_sample_start()
+#define test_bmk_sample_end()
+#endif
+
 #if !defined(__DOXYGEN__)
 extern thread_t *threads[MAX_THREADS];
 extern union test_buffers test;
 extern void * ROMCONST wa[];
 extern bool test_timer_done;
+#if TEST_BMK_LATENCY
+extern rtcnt_t test_bmk_t0;
+#endif
 #endif
 
 #endif /* _TEST_H_ */
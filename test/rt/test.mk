@@ -5,12 +5,28 @@ TESTSRC = ${CHIBIOS}/test/rt/test.c \
           ${CHIBIOS}/test/rt/testmtx.c \
           ${CHIBIOS}/test/rt/testmsg.c \
           ${CHIBIOS}/test/rt/testmbox.c \
+          ${CHIBIOS}/test/rt/testrings.c \
           ${CHIBIOS}/test/rt/testevt.c \
           ${CHIBIOS}/test/rt/testheap.c \
           ${CHIBIOS}/test/rt/testpools.c \
           ${CHIBIOS}/test/rt/testdyn.c \
           ${CHIBIOS}/test/rt/testqueues.c \
+          ${CHIBIOS}/test/rt/testsmp.c \
           ${CHIBIOS}/test/rt/testbmk.c
 
+# Interrupt latency test files, requires TEST_USE_GPT_LATENCY and the HAL.
+TESTLATSRC = ${CHIBIOS}/test/rt/testlat.c
+
+# C++ test files, requires TEST_USE_CPP_WRAPPERS.
+TESTCPPSRC = ${CHIBIOS}/test/rt/testcpp.cpp
+
+# Asynchronous memory copy test files, requires TEST_USE_DMACOPY and
+# os/various/dmacopy.c.
+TESTDMACOPYSRC = ${CHIBIOS}/test/rt/testdmacopy.c
+
+# Inter-core channels test files, requires TEST_USE_ICCHANNEL, the HAL
+# and os/various/icchannel.c.
+TESTICCSRC = ${CHIBIOS}/test/rt/testicc.c
+
 # Required include directories
 TESTINC = ${CHIBIOS}/test/rt
@@ -30,7 +30,12 @@
  * <h2>Objective</h2>
  * Objective of the test module is to provide a performance index for the
  * most critical system subsystems. The performance numbers allow to
- * discover performance regressions between successive ChibiOS/RT releases.
+ * discover performance regressions between successive ChibiOS/RT releases.<br>
+ * If @p TEST_BMK_MODE is enabled then each benchmark is executed
+ * @p TEST_BMK_RUNS times, the latency of each loop iteration is sampled
+ * using the realtime counter and the results are emitted as JSON or CSV
+ * records, the @p tools/bmkcompare/bmkcompare.py script compares two result
+ * files and reports the statistically significant regressions.
  *
  * <h2>Preconditions</h2>
  * None.
@@ -49,6 +54,13 @@
  * - @subpage test_benchmarks_011
  * - @subpage test_benchmarks_012
  * - @subpage test_benchmarks_013
+ * - @subpage test_benchmarks_014
+ * - @subpage test_benchmarks_015
+ * - @subpage test_benchmarks_016
+ * - @subpage test_benchmarks_017
+ * - @subpage test_benchmarks_018
+ * - @subpage test_benchmarks_019
+ * - @subpage test_benchmarks_020
  * .
  * @file testbmk.c Kernel Benchmarks
  * @brief Kernel Benchmarks source file
@@ -83,11 +95,11 @@ static unsigned int msg_loop_test(thread_t *tp) {
   test_wait_tick();
   test_start_timer(1000);
   do {
+    test_bmk_sample_start();
     (void)chMsgSend(tp, 1);
+    test_bmk_sample_end();
     n++;
-#if defined(SIMULATOR)
-    ChkIntSources();
-#endif
+    test_poll();
   } while (!test_timer_done);
   (void)chMsgSend(tp, 0);
   return n;
@@ -108,6 +120,7 @@ static void bmk1_execute(void) {
   threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()-1, thread1, NULL);
   n = msg_loop_test(threads[0]);
   test_wait_threads();
+  test_bmk_score(n, "msgs/S");
   test_print("--- Score : ");
   test_printn(n);
   test_print(" msgs/S, ");
@@ -137,6 +150,7 @@ static void bmk2_execute(void) {
   threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()+1, thread1, NULL);
   n = msg_loop_test(threads[0]);
   test_wait_threads();
+  test_bmk_score(n, "msgs/S");
   test_print("--- Score : ");
   test_printn(n);
   test_print(" msgs/S, ");
@@ -176,6 +190,7 @@ static void bmk3_execute(void) {
   threads[4] = chThdCreateStatic(wa[4], WA_SIZE, chThdGetPriorityX()-5, thread2, NULL);
   n = msg_loop_test(threads[0]);
   test_wait_threads();
+  test_bmk_score(n, "msgs/S");
   test_print("--- Score : ");
   test_printn(n);
   test_print(" msgs/S, ");
@@ -224,22 +239,23 @@ static void bmk4_execute(void) {
   test_wait_tick();
   test_start_timer(1000);
   do {
+    test_bmk_sample_start();
     chSysLock();
     chSchWakeupS(tp, MSG_OK);
     chSchWakeupS(tp, MSG_OK);
     chSchWakeupS(tp, MSG_OK);
     chSchWakeupS(tp, MSG_OK);
     chSysUnlock();
+    test_bmk_sample_end();
     n += 4;
-#if defined(SIMULATOR)
-    ChkIntSources();
-#endif
+    test_poll();
   } while (!test_timer_done);
   chSysLock();
   chSchWakeupS(tp, MSG_TIMEOUT);
   chSysUnlock();
 
   test_wait_threads();
+  test_bmk_score(n * 2, "ctxswc/S");
   test_print("--- Score : ");
   test_printn(n * 2);
   test_println(" ctxswc/S");
@@ -271,12 +287,13 @@ static void bmk5_execute(void) {
   test_wait_tick();
   test_start_timer(1000);
   do {
+    test_bmk_sample_start();
     chThdWait(chThdCreateStatic(wap, WA_SIZE, prio, thread2, NULL));
+    test_bmk_sample_end();
     n++;
-#if defined(SIMULATOR)
-    ChkIntSources();
-#endif
+    test_poll();
   } while (!test_timer_done);
+  test_bmk_score(n, "threads/S");
   test_print("--- Score : ");
   test_printn(n);
   test_println(" threads/S");
@@ -310,12 +327,13 @@ static void bmk6_execute(void) {
   test_wait_tick();
   test_start_timer(1000);
   do {
+    test_bmk_sample_start();
     chThdCreateStatic(wap, WA_SIZE, prio, thread2, NULL);
+    test_bmk_sample_end();
     n++;
-#if defined(SIMULATOR)
-    ChkIntSources();
-#endif
+    test_poll();
   } while (!test_timer_done);
+  test_bmk_score(n, "threads/S");
   test_print("--- Score : ");
   test_printn(n);
   test_println(" threads/S");
@@ -365,16 +383,17 @@ static void bmk7_execute(void) {
   test_wait_tick();
   test_start_timer(1000);
   do {
+    test_bmk_sample_start();
     chSemReset(&sem1, 0);
+    test_bmk_sample_end();
     n++;
-#if defined(SIMULATOR)
-    ChkIntSources();
-#endif
+    test_poll();
   } while (!test_timer_done);
   test_terminate_threads();
   chSemReset(&sem1, 0);
   test_wait_threads();
 
+  test_bmk_score(n, "reschedules/S");
   test_print("--- Score : ");
   test_printn(n);
   test_print(" reschedules/S, ");
@@ -407,9 +426,7 @@ static msg_t thread8(void *p) {
     chThdYield();
     chThdYield();
     (*(uint32_t *)p) += 4;
-#if defined(SIMULATOR)
-    ChkIntSources();
-#endif
+    test_poll();
   } while(!chThdShouldTerminateX());
   return 0;
 }
@@ -430,6 +447,7 @@ static void bmk8_execute(void) {
   test_terminate_threads();
   test_wait_threads();
 
+  test_bmk_score(n, "ctxswc/S");
   test_print("--- Score : ");
   test_printn(n);
   test_println(" ctxswc/S");
@@ -463,6 +481,7 @@ static void bmk9_execute(void) {
   test_wait_tick();
   test_start_timer(1000);
   do {
+    test_bmk_sample_start();
     chSysLock();
     chIQPutI(&iq, 0);
     chIQPutI(&iq, 1);
@@ -473,11 +492,11 @@ static void bmk9_execute(void) {
     (void)chIQGet(&iq);
     (void)chIQGet(&iq);
     (void)chIQGet(&iq);
+    test_bmk_sample_end();
     n++;
-#if defined(SIMULATOR)
-    ChkIntSources();
-#endif
+    test_poll();
   } while (!test_timer_done);
+  test_bmk_score(n * 4, "bytes/S");
   test_print("--- Score : ");
   test_printn(n * 4);
   test_println(" bytes/S");
@@ -509,17 +528,18 @@ static void bmk10_execute(void) {
   test_wait_tick();
   test_start_timer(1000);
   do {
+    test_bmk_sample_start();
     chSysLock();
     chVTDoSetI(&vt1, 1, tmo, NULL);
     chVTDoSetI(&vt2, 10000, tmo, NULL);
     chVTDoResetI(&vt1);
     chVTDoResetI(&vt2);
     chSysUnlock();
+    test_bmk_sample_end();
     n++;
-#if defined(SIMULATOR)
-    ChkIntSources();
-#endif
+    test_poll();
   } while (!test_timer_done);
+  test_bmk_score(n * 2, "timers/S");
   test_print("--- Score : ");
   test_printn(n * 2);
   test_println(" timers/S");
@@ -553,6 +573,7 @@ static void bmk11_execute(void) {
   test_wait_tick();
   test_start_timer(1000);
   do {
+    test_bmk_sample_start();
     chSemWait(&sem1);
     chSemSignal(&sem1);
     chSemWait(&sem1);
@@ -561,11 +582,11 @@ static void bmk11_execute(void) {
     chSemSignal(&sem1);
     chSemWait(&sem1);
     chSemSignal(&sem1);
+    test_bmk_sample_end();
     n++;
-#if defined(SIMULATOR)
-    ChkIntSources();
-#endif
+    test_poll();
   } while (!test_timer_done);
+  test_bmk_score(n * 4, "wait+signal/S");
   test_print("--- Score : ");
   test_printn(n * 4);
   test_println(" wait+signal/S");
@@ -600,6 +621,7 @@ static void bmk12_execute(void) {
   test_wait_tick();
   test_start_timer(1000);
   do {
+    test_bmk_sample_start();
     chMtxLock(&mtx1);
     chMtxUnlock(&mtx1);
     chMtxLock(&mtx1);
@@ -608,11 +630,11 @@ static void bmk12_execute(void) {
     chMtxUnlock(&mtx1);
     chMtxLock(&mtx1);
     chMtxUnlock(&mtx1);
+    test_bmk_sample_end();
     n++;
-#if defined(SIMULATOR)
-    ChkIntSources();
-#endif
+    test_poll();
   } while (!test_timer_done);
+  test_bmk_score(n * 4, "lock+unlock/S");
   test_print("--- Score : ");
   test_printn(n * 4);
   test_println(" lock+unlock/S");
@@ -679,6 +701,14 @@ static void bmk13_execute(void) {
   test_printn(sizeof(mailbox_t));
   test_println(" bytes");
 #endif
+#if CH_CFG_USE_RINGBUFFERS || defined(__DOXYGEN__)
+  test_print("--- RingB.: ");
+  test_printn(sizeof(ring_buffer_t));
+  test_println(" bytes");
+  test_print("--- MPRing: ");
+  test_printn(sizeof(mp_ring_buffer_t));
+  test_println(" bytes");
+#endif
 }
 
 ROMCONST struct testcase testbmk13 = {
@@ -688,6 +718,429 @@ ROMCONST struct testcase testbmk13 = {
   bmk13_execute
 };
 
+#if CH_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_014 Mailboxes throughput
+ *
+ * <h2>Description</h2>
+ * Four messages are posted and then fetched from a @p mailbox_t using the
+ * I-Class APIs into a continuous loop, this is the reference for the ring
+ * buffers benchmarks.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations.
+ */
+
+static void bmk14_execute(void) {
+  uint32_t n;
+  msg_t msg;
+  static msg_t mb[16];
+  static mailbox_t mbx;
+
+  chMBObjectInit(&mbx, mb, sizeof (mb) / sizeof (msg_t));
+  n = 0;
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    test_bmk_sample_start();
+    chSysLock();
+    (void)chMBPostI(&mbx, 0);
+    (void)chMBPostI(&mbx, 1);
+    (void)chMBPostI(&mbx, 2);
+    (void)chMBPostI(&mbx, 3);
+    chSysUnlock();
+    chSysLock();
+    (void)chMBFetchI(&mbx, &msg);
+    (void)chMBFetchI(&mbx, &msg);
+    (void)chMBFetchI(&mbx, &msg);
+    (void)chMBFetchI(&mbx, &msg);
+    chSysUnlock();
+    test_bmk_sample_end();
+    n++;
+    test_poll();
+  } while (!test_timer_done);
+  test_bmk_score(n * 4, "msgs/S");
+  test_print("--- Score : ");
+  test_printn(n * 4);
+  test_println(" msgs/S");
+}
+
+ROMCONST struct testcase testbmk14 = {
+  "Benchmark, mailboxes throughput",
+  NULL,
+  NULL,
+  bmk14_execute
+};
+#endif /* CH_CFG_USE_MAILBOXES */
+
+#if CH_CFG_USE_RINGBUFFERS || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_015 Ring buffers throughput
+ *
+ * <h2>Description</h2>
+ * Four @p msg_t objects are put and then got from a single producer
+ * @p ring_buffer_t into a continuous loop, the same operations performed
+ * by @ref test_benchmarks_014 without critical zones.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations.
+ */
+
+static void bmk15_execute(void) {
+  uint32_t n;
+  msg_t msg;
+  static msg_t rbb[16];
+  static ring_buffer_t rb;
+
+  chRBObjectInit(&rb, rbb, sizeof (msg_t), sizeof (rbb) / sizeof (msg_t));
+  n = 0;
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    test_bmk_sample_start();
+    msg = 0;
+    (void)chRBPutX(&rb, &msg);
+    (void)chRBPutX(&rb, &msg);
+    (void)chRBPutX(&rb, &msg);
+    (void)chRBPutX(&rb, &msg);
+    (void)chRBGetX(&rb, &msg);
+    (void)chRBGetX(&rb, &msg);
+    (void)chRBGetX(&rb, &msg);
+    (void)chRBGetX(&rb, &msg);
+    test_bmk_sample_end();
+    n++;
+    test_poll();
+  } while (!test_timer_done);
+  test_bmk_score(n * 4, "msgs/S");
+  test_print("--- Score : ");
+  test_printn(n * 4);
+  test_println(" msgs/S");
+}
+
+ROMCONST struct testcase testbmk15 = {
+  "Benchmark, ring buffers throughput",
+  NULL,
+  NULL,
+  bmk15_execute
+};
+
+/**
+ * @page test_benchmarks_016 Multiple producers ring buffers throughput
+ *
+ * <h2>Description</h2>
+ * Four @p msg_t objects are put and then got from a multiple producers
+ * @p mp_ring_buffer_t into a continuous loop.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations.
+ */
+
+static void bmk16_execute(void) {
+  uint32_t n;
+  msg_t msg;
+  static msg_t mprbb[16];
+  static uint32_t mprbs[16];
+  static mp_ring_buffer_t mprb;
+
+  chMPRBObjectInit(&mprb, mprbb, mprbs, sizeof (msg_t),
+                   sizeof (mprbb) / sizeof (msg_t));
+  n = 0;
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    test_bmk_sample_start();
+    msg = 0;
+    (void)chMPRBPutX(&mprb, &msg);
+    (void)chMPRBPutX(&mprb, &msg);
+    (void)chMPRBPutX(&mprb, &msg);
+    (void)chMPRBPutX(&mprb, &msg);
+    (void)chMPRBGetX(&mprb, &msg);
+    (void)chMPRBGetX(&mprb, &msg);
+    (void)chMPRBGetX(&mprb, &msg);
+    (void)chMPRBGetX(&mprb, &msg);
+    test_bmk_sample_end();
+    n++;
+    test_poll();
+  } while (!test_timer_done);
+  test_bmk_score(n * 4, "msgs/S");
+  test_print("--- Score : ");
+  test_printn(n * 4);
+  test_println(" msgs/S");
+}
+
+ROMCONST struct testcase testbmk16 = {
+  "Benchmark, MP ring buffers throughput",
+  NULL,
+  NULL,
+  bmk16_execute
+};
+#endif /* CH_CFG_USE_RINGBUFFERS */
+
+#if CH_CFG_USE_MEMPOOLS || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_017 Memory pools, four threads
+ *
+ * <h2>Description</h2>
+ * Four threads with the same priority allocate and release two objects
+ * from a shared memory pool into a continuous loop, the threads yield
+ * after each iteration so that the pool is accessed in turn.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations.
+ */
+
+#define BMK_POOL_OBJECTS 32
+
+static memory_pool_t bmkmp;
+static void *bmkobjs[BMK_POOL_OBJECTS][2];
+static uint32_t bmkcnt[4];
+
+static msg_t thread5(void *p) {
+  uint32_t *np = (uint32_t *)p;
+  void *o1, *o2;
+
+  do {
+    o1 = chPoolAlloc(&bmkmp);
+    o2 = chPoolAlloc(&bmkmp);
+    chPoolFree(&bmkmp, o2);
+    chPoolFree(&bmkmp, o1);
+    (*np)++;
+    chThdYield();
+    test_poll();
+  } while (!test_timer_done);
+  return 0;
+}
+
+static void bmkpools_setup(void) {
+  unsigned i;
+
+  chPoolObjectInit(&bmkmp, sizeof (bmkobjs[0]), NULL);
+  chPoolLoadArray(&bmkmp, bmkobjs, BMK_POOL_OBJECTS);
+  for (i = 0; i < 4; i++)
+    bmkcnt[i] = 0;
+}
+
+static uint32_t bmkpools_run(tfunc_t pf) {
+  tprio_t prio = chThdGetPriorityX() - 1;
+  unsigned i;
+
+  test_wait_tick();
+  test_start_timer(1000);
+  for (i = 0; i < 4; i++)
+    threads[i] = chThdCreateStatic(wa[i], WA_SIZE, prio, pf,
+                                   (void *)&bmkcnt[i]);
+  test_wait_threads();
+  return bmkcnt[0] + bmkcnt[1] + bmkcnt[2] + bmkcnt[3];
+}
+
+static void bmk17_execute(void) {
+  uint32_t n;
+
+  n = bmkpools_run(thread5) * 2;
+  test_bmk_score(n, "allocs/S");
+  test_print("--- Score : ");
+  test_printn(n);
+  test_println(" allocs/S");
+}
+
+ROMCONST struct testcase testbmk17 = {
+  "Benchmark, memory pools, 4 threads",
+  bmkpools_setup,
+  NULL,
+  bmk17_execute
+};
+
+#if CH_CFG_USE_POOLCACHES || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_018 Memory pools with thread caches, four threads
+ *
+ * <h2>Description</h2>
+ * Same as @ref test_benchmarks_017 but the objects are allocated and
+ * released through per-thread pool caches, the cache hit rate of each
+ * thread is also reported.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations.
+ */
+
+/*
+ * The caches are static, they are still linked to the threads when the
+ * threads exit and their counters are read after that.
+ */
+static pool_cache_t bmkpc[4];
+
+static msg_t thread6(void *p) {
+  uint32_t *np = (uint32_t *)p;
+  pool_cache_t *pcp = &bmkpc[np - bmkcnt];
+  void *o1, *o2;
+
+  chPoolCacheObjectInit(pcp, &bmkmp, 4);
+  do {
+    o1 = chPoolCacheAlloc(pcp);
+    o2 = chPoolCacheAlloc(pcp);
+    chPoolCacheFree(pcp, o2);
+    chPoolCacheFree(pcp, o1);
+    (*np)++;
+    chThdYield();
+    test_poll();
+  } while (!test_timer_done);
+  return 0;
+}
+
+static void bmk18_execute(void) {
+  uint32_t n;
+  unsigned i;
+
+  n = bmkpools_run(thread6) * 2;
+  test_bmk_score(n, "allocs/S");
+  test_print("--- Score : ");
+  test_printn(n);
+  test_println(" allocs/S");
+  test_print("--- Hits  :");
+  for (i = 0; i < 4; i++) {
+    test_print(" ");
+    test_printn(chPoolCacheGetHitRateX(&bmkpc[i]));
+    test_print("%");
+  }
+  test_println("");
+}
+
+ROMCONST struct testcase testbmk18 = {
+  "Benchmark, pool caches, 4 threads",
+  bmkpools_setup,
+  NULL,
+  bmk18_execute
+};
+#endif /* CH_CFG_USE_POOLCACHES */
+#endif /* CH_CFG_USE_MEMPOOLS */
+
+/**
+ * @page test_benchmarks_019 Run-time objects initialization
+ *
+ * <h2>Description</h2>
+ * A set of kernel objects, one for each enabled object type, is initialized
+ * at run-time into a continuous loop, this is the startup cost paid by each
+ * object initialized by code, for example by a C++ constructor, instead of
+ * a static initializer.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations.
+ */
+
+static void bmk19_execute(void) {
+  uint32_t n = 0;
+  static semaphore_t sem;
+#if CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
+  static mutex_t mtx;
+#endif
+#if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
+  static event_source_t es;
+#endif
+#if CH_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
+  static msg_t mbb[4];
+  static mailbox_t mb;
+#endif
+#if CH_CFG_USE_MEMPOOLS || defined(__DOXYGEN__)
+  static void *objs[4][2];
+  static memory_pool_t mp;
+#endif
+
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    test_bmk_sample_start();
+    chSemObjectInit(&sem, 0);
+#if CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
+    chMtxObjectInit(&mtx);
+#endif
+#if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
+    chEvtObjectInit(&es);
+#endif
+#if CH_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
+    chMBObjectInit(&mb, mbb, 4);
+#endif
+#if CH_CFG_USE_MEMPOOLS || defined(__DOXYGEN__)
+    chPoolObjectInit(&mp, sizeof (objs[0]), NULL);
+    chPoolLoadArray(&mp, objs, 4);
+#endif
+    test_bmk_sample_end();
+    n++;
+    test_poll();
+  } while (!test_timer_done);
+  test_bmk_score(n, "sets/S");
+  test_print("--- Score : ");
+  test_printn(n);
+  test_println(" sets/S");
+}
+
+ROMCONST struct testcase testbmk19 = {
+  "Benchmark, run-time objects init",
+  NULL,
+  NULL,
+  bmk19_execute
+};
+
+#if (defined(PORT_USES_FPU) && PORT_USES_FPU) || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_020 Context Switch performance, FPU threads
+ *
+ * <h2>Description</h2>
+ * Same as @ref test_benchmarks_004 but both threads execute a floating
+ * point instruction before the measurement, the FPU context is switched
+ * too. On ports saving the FPU context only for the threads using it the
+ * difference with @ref test_benchmarks_004 is the FPU switch cost.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the port switches an FPU context
+ * (@p PORT_USES_FPU).
+ */
+
+static volatile float fpu_dummy = 1.0f;
+static THD_WORKING_AREA(wa_fpu, THREADS_STACK_SIZE + PORT_FPU_STACK_SIZE);
+
+static msg_t thread20(void *p) {
+
+  /* Floating point operation, the thread gains an FPU context.*/
+  fpu_dummy = fpu_dummy * 1.5f;
+  return thread4(p);
+}
+
+static void bmk20_execute(void) {
+  thread_t *tp;
+  uint32_t n;
+
+  fpu_dummy = fpu_dummy * 1.5f;
+  tp = threads[0] = chThdCreateStatic(wa_fpu, sizeof wa_fpu,
+                                      chThdGetPriorityX()+1,
+                                      thread20, NULL);
+  n = 0;
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    test_bmk_sample_start();
+    chSysLock();
+    chSchWakeupS(tp, MSG_OK);
+    chSchWakeupS(tp, MSG_OK);
+    chSchWakeupS(tp, MSG_OK);
+    chSchWakeupS(tp, MSG_OK);
+    chSysUnlock();
+    test_bmk_sample_end();
+    n += 4;
+    test_poll();
+  } while (!test_timer_done);
+  chSysLock();
+  chSchWakeupS(tp, MSG_TIMEOUT);
+  chSysUnlock();
+
+  test_wait_threads();
+  test_bmk_score(n * 2, "ctxswc/S");
+  test_print("--- Score : ");
+  test_printn(n * 2);
+  test_println(" ctxswc/S");
+}
+
+ROMCONST struct testcase testbmk20 = {
+  "Benchmark, context switch, FPU threads",
+  NULL,
+  NULL,
+  bmk20_execute
+};
+#endif /* PORT_USES_FPU */
+
 /**
  * @brief   Test sequence for benchmarks.
  */
@@ -710,6 +1163,23 @@ ROMCONST struct testcase * ROMCONST patternbmk[] = {
   &testbmk12,
 #endif
   &testbmk13,
+#if CH_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
+  &testbmk14,
+#endif
+#if CH_CFG_USE_RINGBUFFERS || defined(__DOXYGEN__)
+  &testbmk15,
+  &testbmk16,
+#endif
+#if CH_CFG_USE_MEMPOOLS || defined(__DOXYGEN__)
+  &testbmk17,
+#endif
+#if CH_CFG_USE_POOLCACHES || defined(__DOXYGEN__)
+  &testbmk18,
+#endif
+  &testbmk19,
+#if (defined(PORT_USES_FPU) && PORT_USES_FPU) || defined(__DOXYGEN__)
+  &testbmk20,
+#endif
 #endif
   NULL
 };
@@ -0,0 +1,198 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "ch.hpp"
+#include "test.h"
+#include "testcpp.h"
+
+/**
+ * @page test_cpp C++ wrappers test
+ *
+ * File: @ref testcpp.cpp
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the statically initialized
+ * objects of the C++ wrappers.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to verify that the objects declared at
+ * file scope are usable without any run-time initialization.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires a C++11 compiler and the following kernel options:
+ * - @p CH_CFG_USE_SEMAPHORES
+ * - @p CH_CFG_USE_MUTEXES
+ * - @p CH_CFG_USE_MAILBOXES
+ * - @p CH_CFG_USE_MEMPOOLS
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_cpp_001
+ * - @subpage test_cpp_002
+ * .
+ * @file testcpp.cpp
+ * @brief C++ wrappers test source file
+ * @file testcpp.h
+ * @brief C++ wrappers test header file
+ */
+
+#if (__cplusplus >= 201103L) || defined(__DOXYGEN__)
+
+#if (CH_CFG_USE_SEMAPHORES && CH_CFG_USE_MUTEXES) || defined(__DOXYGEN__)
+/**
+ * @page test_cpp_001 Static mutex and semaphore
+ *
+ * <h2>Description</h2>
+ * A statically initialized mutex is locked by the test thread and a thread
+ * blocks trying to lock it, another thread waits on a statically
+ * initialized semaphore. The mutex is unlocked and the semaphore is
+ * signaled.<br>
+ * The test expects both objects to be in their initial state and the
+ * threads to be released in the expected order.
+ */
+
+static STATIC_MUTEX_DECL(m1);
+static STATIC_SEMAPHORE_DECL(s1, 0);
+
+static msg_t thread1(void *p) {
+
+  m1.lock();
+  test_emit_token(*(char *)p);
+  m1.unlock();
+  return 0;
+}
+
+static msg_t thread2(void *p) {
+
+  s1.wait();
+  test_emit_token(*(char *)p);
+  return 0;
+}
+
+static void cpp1_execute(void) {
+  tprio_t prio = chThdGetPriorityX();
+
+  test_assert_lock(1, s1.getCounterI() == 0, "wrong initial counter");
+  test_assert(2, m1.tryLock(), "mutex not free");
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, thread1, (void *)"B");
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+2, thread2, (void *)"C");
+  test_emit_token('A');
+  m1.unlock();
+  s1.signal();
+  test_wait_threads();
+  test_assert_sequence(3, "ABC");
+  test_assert_lock(4, s1.getCounterI() == 0, "wrong final counter");
+  test_assert(5, m1.tryLock(), "mutex not free");
+  m1.unlock();
+}
+
+ROMCONST struct testcase testcpp1 = {
+  "C++ wrappers, static mutex and semaphore",
+  NULL,
+  NULL,
+  cpp1_execute
+};
+#endif /* CH_CFG_USE_SEMAPHORES && CH_CFG_USE_MUTEXES */
+
+#if (CH_CFG_USE_MAILBOXES && CH_CFG_USE_MEMPOOLS) || defined(__DOXYGEN__)
+/**
+ * @page test_cpp_002 Static mailbox and objects pool
+ *
+ * <h2>Description</h2>
+ * All the objects of a statically initialized pool are allocated, tagged
+ * and posted into a statically initialized mailbox, a lower priority
+ * thread fetches the objects and returns them to the pool.<br>
+ * The test expects the pool to be full at startup, the objects to be
+ * received in order and the pool to be full again at the end.
+ */
+
+#define CPP_OBJECTS 4
+
+struct cpp_object {
+  char          token;
+  uint32_t      payload;
+};
+
+static STATIC_MAILBOX_DECL(mb1, cpp_object *, CPP_OBJECTS);
+static chibios_rt::StaticObjectsPool<cpp_object, CPP_OBJECTS> mp1;
+
+static msg_t thread3(void *p) {
+  cpp_object *op;
+
+  (void)p;
+  while ((mb1.fetch(&op, TIME_INFINITE) == MSG_OK) && (op != NULL)) {
+    test_emit_token(op->token);
+    mp1.free(op);
+  }
+  return 0;
+}
+
+static void cpp2_execute(void) {
+  cpp_object *op, *objs[CPP_OBJECTS];
+  unsigned i;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()-1,
+                                 thread3, NULL);
+  for (i = 0; i < CPP_OBJECTS; i++) {
+    op = mp1.alloc();
+    test_assert(1, op != NULL, "pool empty");
+    op->token = 'A' + i;
+    op->payload = i;
+    test_assert(2, mb1.post(op, TIME_INFINITE) == MSG_OK, "post failed");
+  }
+  test_assert(3, mp1.alloc() == NULL, "pool not empty");
+  test_assert_lock(4, mb1.getUsedCountI() == CPP_OBJECTS, "wrong count");
+
+  /* The termination message blocks until the consumer makes room.*/
+  mb1.post(NULL, TIME_INFINITE);
+  test_wait_threads();
+  test_assert_sequence(5, "ABCD");
+  test_assert_lock(6, mb1.getUsedCountI() == 0, "not empty");
+  for (i = 0; i < CPP_OBJECTS; i++) {
+    objs[i] = mp1.alloc();
+    test_assert(7, objs[i] != NULL, "object lost");
+  }
+  test_assert(8, mp1.alloc() == NULL, "pool not empty");
+  for (i = 0; i < CPP_OBJECTS; i++)
+    mp1.free(objs[i]);
+}
+
+ROMCONST struct testcase testcpp2 = {
+  "C++ wrappers, static mailbox and objects pool",
+  NULL,
+  NULL,
+  cpp2_execute
+};
+#endif /* CH_CFG_USE_MAILBOXES && CH_CFG_USE_MEMPOOLS */
+#endif /* __cplusplus >= 201103L */
+
+/**
+ * @brief   Test sequence for the C++ wrappers.
+ */
+ROMCONST struct testcase * ROMCONST patterncpp[] = {
+#if (__cplusplus >= 201103L) || defined(__DOXYGEN__)
+#if (CH_CFG_USE_SEMAPHORES && CH_CFG_USE_MUTEXES) || defined(__DOXYGEN__)
+  &testcpp1,
+#endif
+#if (CH_CFG_USE_MAILBOXES && CH_CFG_USE_MEMPOOLS) || defined(__DOXYGEN__)
+  &testcpp2,
+#endif
+#endif
+  NULL
+};
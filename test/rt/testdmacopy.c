@@ -0,0 +1,345 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "ch.h"
+#include "test.h"
+#include "dmacopy.h"
+
+/**
+ * @page test_dmacopy Asynchronous memory copy test
+ *
+ * File: @ref testdmacopy.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the asynchronous memory
+ * copy service in @p os/various/dmacopy.c.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to verify the requests ordering, the
+ * completion notification methods and the synchronous fallback of the
+ * blocking functions, a benchmark compares the copy throughput with the
+ * C library @p memcpy().
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following options:
+ * - @p TEST_USE_DMACOPY
+ * - @p CH_CFG_USE_EVENTS
+ * - @p CH_CFG_USE_EVENTS_TIMEOUT
+ * .
+ * The application must invoke @p dmacopyInit() before running the test
+ * suite. With the DMA back-end the test buffers must be reachable by the
+ * DMA.<br>
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_dmacopy_001
+ * - @subpage test_dmacopy_002
+ * - @subpage test_dmacopy_003
+ * - @subpage test_dmacopy_004
+ * - @subpage test_dmacopy_005
+ * .
+ * @file testdmacopy.c
+ * @brief Asynchronous memory copy test source file
+ * @file testdmacopy.h
+ * @brief Asynchronous memory copy test header file
+ */
+
+/*
+ * Size of the source and destination areas, the test buffer is split in
+ * two halves.
+ */
+#define DC_SIZE         ((sizeof test.buffer / 2) & ~(size_t)3)
+#define DC_SRC          (&test.buffer[0])
+#define DC_DST          (&test.buffer[DC_SIZE])
+
+static dmacopy_request_t rqs[4];
+static char order[4];
+static unsigned norder;
+static tprio_t prio;
+
+/*
+ * Completion callback, the requests are identified by their position in
+ * the requests array.
+ */
+static void callback(dmacopy_request_t *rqp) {
+
+  order[norder++] = 'A' + (char)(rqp - rqs);
+}
+
+/*
+ * Fills the source area with a known pattern and clears the destination
+ * area.
+ */
+static void dc_setup(void) {
+  size_t i;
+
+  for (i = 0; i < DC_SIZE; i++)
+    DC_SRC[i] = (uint8_t)(i * 7 + 1);
+  memset(DC_DST, 0, DC_SIZE);
+  norder = 0;
+}
+
+/**
+ * @page test_dmacopy_001 Requests ordering
+ *
+ * <h2>Description</h2>
+ * Four copy and fill requests on separate quarters of the destination area
+ * are queued at once, the completion callback records the completion
+ * order.<br>
+ * The test expects the requests to complete in FIFO order and the
+ * destination area to contain the expected data.
+ */
+
+static void dc1_execute(void) {
+  size_t q = DC_SIZE / 4;
+  unsigned i;
+
+  for (i = 0; i < 4; i++)
+    dmacopyObjectInit(&rqs[i], callback);
+
+  chSysLock();
+  dmacopyStartCopyI(&rqs[0], DC_DST, DC_SRC, q);
+  dmacopyStartSetI(&rqs[1], DC_DST + q, 0x55, q);
+  dmacopyStartCopyI(&rqs[2], DC_DST + 2 * q, DC_SRC + 2 * q, q);
+  dmacopyStartSetI(&rqs[3], DC_DST + 3 * q, 0xAA, q);
+  (void)dmacopyWaitS(&rqs[3]);
+  chSysUnlock();
+
+  for (i = 0; i < 4; i++) {
+    test_assert_lock(1, dmacopyIsIdleI(&rqs[i]), "not idle");
+    test_assert_lock(2, dmacopyGetResultI(&rqs[i]) == MSG_OK, "failed");
+  }
+  for (i = 0; i < norder; i++)
+    test_emit_token(order[i]);
+  test_assert_sequence(3, "ABCD");
+
+  test_assert(4, memcmp(DC_DST, DC_SRC, q) == 0, "copy error");
+  test_assert(5, memcmp(DC_DST + 2 * q, DC_SRC + 2 * q, q) == 0,
+              "copy error");
+  for (i = 0; i < q; i++) {
+    test_assert(6, DC_DST[q + i] == 0x55, "fill error");
+    test_assert(7, DC_DST[3 * q + i] == 0xAA, "fill error");
+  }
+}
+
+ROMCONST struct testcase testdmacopy1 = {
+  "DMA copy, requests ordering",
+  dc_setup,
+  NULL,
+  dc1_execute
+};
+
+#if (CH_CFG_USE_EVENTS && CH_CFG_USE_EVENTS_TIMEOUT) || defined(__DOXYGEN__)
+/**
+ * @page test_dmacopy_002 Completion notification
+ *
+ * <h2>Description</h2>
+ * A request with both a completion callback and an event source is queued,
+ * the test thread waits on the event.<br>
+ * The test expects the callback to be invoked and the event to be broadcast
+ * with the specified flags.
+ */
+
+static EVENTSOURCE_DECL(es1);
+
+static void dc2_execute(void) {
+  event_listener_t el1;
+  eventmask_t m;
+
+  chEvtGetAndClearEvents(ALL_EVENTS);
+  chEvtRegisterMask(&es1, &el1, 1);
+
+  dmacopyObjectInit(&rqs[0], callback);
+  dmacopySetEvent(&rqs[0], &es1, 0x5A);
+  chSysLock();
+  dmacopyStartCopyI(&rqs[0], DC_DST, DC_SRC, DC_SIZE);
+  chSysUnlock();
+
+  m = chEvtWaitAnyTimeout(ALL_EVENTS, MS2ST(500));
+  chEvtUnregister(&es1, &el1);
+  test_assert(1, m == 1, "event not received");
+  test_assert(2, chEvtGetAndClearFlags(&el1) == 0x5A, "wrong flags");
+  test_assert(3, norder == 1, "callback not invoked");
+  test_assert_lock(4, dmacopyIsIdleI(&rqs[0]), "not idle");
+  test_assert(5, memcmp(DC_DST, DC_SRC, DC_SIZE) == 0, "copy error");
+}
+
+ROMCONST struct testcase testdmacopy2 = {
+  "DMA copy, completion notification",
+  dc_setup,
+  NULL,
+  dc2_execute
+};
+#endif /* CH_CFG_USE_EVENTS && CH_CFG_USE_EVENTS_TIMEOUT */
+
+/**
+ * @page test_dmacopy_003 Synchronous fallback
+ *
+ * <h2>Description</h2>
+ * A large copy is queued, then blocks below @p DMACOPY_THRESHOLD are
+ * copied and filled using the blocking functions while the test thread
+ * runs at a priority higher than the worker thread.<br>
+ * The test expects the small blocks to be processed by the CPU without
+ * waiting for the queued request and without blocking, with the software
+ * back-end the queued request is still pending when the blocking functions
+ * return.
+ */
+
+static void dc3_execute(void) {
+  size_t half = DC_SIZE / 2;
+  size_t n = DMACOPY_THRESHOLD - 1;
+  msg_t msg;
+
+  if (n > half)
+    n = half;
+
+  prio = chThdSetPriority(DMACOPY_WORKER_PRIORITY + 1);
+  dmacopyObjectInit(&rqs[0], NULL);
+  chSysLock();
+  dmacopyStartCopyI(&rqs[0], DC_DST, DC_SRC, half);
+  chSysUnlock();
+
+  msg = dmacopyMemcpy(DC_DST + half, DC_SRC + half, n);
+  test_assert(1, msg == MSG_OK, "copy failed");
+  test_assert(2, memcmp(DC_DST + half, DC_SRC + half, n) == 0,
+              "copy error");
+#if !DMACOPY_USE_DMA
+  test_assert_lock(3, !dmacopyIsIdleI(&rqs[0]), "queued request completed");
+#endif
+
+  msg = dmacopyMemset(DC_SRC + half, 0x33, n);
+  test_assert(4, msg == MSG_OK, "fill failed");
+  test_assert(5, DC_SRC[half] == 0x33, "fill error");
+  test_assert(6, DC_SRC[half + n - 1] == 0x33, "fill error");
+#if !DMACOPY_USE_DMA
+  test_assert_lock(7, !dmacopyIsIdleI(&rqs[0]), "queued request completed");
+#endif
+
+  chSysLock();
+  msg = dmacopyWaitS(&rqs[0]);
+  chSysUnlock();
+  test_assert(8, msg == MSG_OK, "queued copy failed");
+  test_assert(9, memcmp(DC_DST, DC_SRC, half) == 0, "copy error");
+}
+
+static void dc3_teardown(void) {
+
+  /* The priority is restored even if an assertion failed.*/
+  chSysLock();
+  if (!dmacopyIsIdleI(&rqs[0]))
+    (void)dmacopyWaitS(&rqs[0]);
+  chSysUnlock();
+  chThdSetPriority(prio);
+}
+
+ROMCONST struct testcase testdmacopy3 = {
+  "DMA copy, synchronous fallback",
+  dc_setup,
+  dc3_teardown,
+  dc3_execute
+};
+
+/**
+ * @page test_dmacopy_004 Copy throughput, dmacopyMemcpy()
+ *
+ * <h2>Description</h2>
+ * The source area is copied into the destination area using
+ * @p dmacopyMemcpy() in a loop for one second.<br>
+ * The performance is calculated by measuring the number of bytes copied
+ * after a second of continuous operations, see also
+ * @ref test_dmacopy_005.
+ */
+
+static void dc4_execute(void) {
+  uint32_t n = 0;
+
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    test_bmk_sample_start();
+    (void)dmacopyMemcpy(DC_DST, DC_SRC, DC_SIZE);
+    test_bmk_sample_end();
+    n++;
+    test_poll();
+  } while (!test_timer_done);
+  test_bmk_score(n * DC_SIZE, "bytes/S");
+  test_print("--- Score : ");
+  test_printn(n * DC_SIZE);
+  test_print(" bytes/S, block size ");
+  test_printn(DC_SIZE);
+  test_println("");
+}
+
+ROMCONST struct testcase testdmacopy4 = {
+  "DMA copy, throughput, dmacopyMemcpy()",
+  dc_setup,
+  NULL,
+  dc4_execute
+};
+
+/**
+ * @page test_dmacopy_005 Copy throughput, memcpy()
+ *
+ * <h2>Description</h2>
+ * Same as @ref test_dmacopy_004 using the C library @p memcpy() as a
+ * reference.
+ */
+
+static void dc5_execute(void) {
+  uint32_t n = 0;
+
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    test_bmk_sample_start();
+    memcpy(DC_DST, DC_SRC, DC_SIZE);
+    test_bmk_sample_end();
+    n++;
+    test_poll();
+  } while (!test_timer_done);
+  test_bmk_score(n * DC_SIZE, "bytes/S");
+  test_print("--- Score : ");
+  test_printn(n * DC_SIZE);
+  test_print(" bytes/S, block size ");
+  test_printn(DC_SIZE);
+  test_println("");
+}
+
+ROMCONST struct testcase testdmacopy5 = {
+  "DMA copy, throughput, memcpy()",
+  dc_setup,
+  NULL,
+  dc5_execute
+};
+
+/**
+ * @brief   Test sequence for the asynchronous memory copy.
+ */
+ROMCONST struct testcase * ROMCONST patterndmacopy[] = {
+  &testdmacopy1,
+#if (CH_CFG_USE_EVENTS && CH_CFG_USE_EVENTS_TIMEOUT) || defined(__DOXYGEN__)
+  &testdmacopy2,
+#endif
+  &testdmacopy3,
+#if !TEST_NO_BENCHMARKS
+  &testdmacopy4,
+  &testdmacopy5,
+#endif
+  NULL
+};
@@ -40,6 +40,8 @@
  * - @subpage test_events_001
  * - @subpage test_events_002
  * - @subpage test_events_003
+ * - @subpage test_events_004
+ * - @subpage test_events_005
  * .
  * @file testevt.c
  * @brief Events test source file
@@ -277,6 +279,158 @@ ROMCONST struct testcase testevt3 = {
 };
 #endif /* CH_CFG_USE_EVENTS_TIMEOUT */
 
+/**
+ * @page test_events_004 Events broadcast order and filtering
+ *
+ * <h2>Description</h2>
+ * Five threads with increasing priority register on an event source and
+ * wait, the last one registers with a flags filter.<br>
+ * The test expects the threads to be awakened in priority order by a single
+ * broadcast and the filtered thread to be awakened only when a flag in its
+ * filter is broadcasted.
+ */
+
+static void evt4_setup(void) {
+
+  chEvtGetAndClearEvents(ALL_EVENTS);
+}
+
+static msg_t thread3(void *p) {
+  event_listener_t el;
+
+  chEvtRegisterMask(&es1, &el, 1);
+  chEvtWaitAny(ALL_EVENTS);
+  test_emit_token(*(char *)p);
+  chEvtUnregister(&es1, &el);
+  return 0;
+}
+
+static msg_t thread4(void *p) {
+  event_listener_t el;
+
+  chEvtRegisterMaskWithFlags(&es1, &el, 1, 2);
+  chEvtWaitAny(ALL_EVENTS);
+  test_emit_token(*(char *)p);
+  chEvtUnregister(&es1, &el);
+  return 0;
+}
+
+static void evt4_execute(void) {
+  tprio_t prio = chThdGetPriorityX();
+
+  chEvtObjectInit(&es1);
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, thread4, "E");
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+2, thread3, "D");
+  threads[2] = chThdCreateStatic(wa[2], WA_SIZE, prio+3, thread3, "C");
+  threads[3] = chThdCreateStatic(wa[3], WA_SIZE, prio+4, thread3, "B");
+  threads[4] = chThdCreateStatic(wa[4], WA_SIZE, prio+5, thread3, "A");
+  chEvtBroadcastFlags(&es1, 1);
+  test_assert_sequence(1, "ABCD");
+  chEvtBroadcastFlags(&es1, 2);
+  test_assert_sequence(2, "E");
+  test_wait_threads();
+  test_assert(3, !chEvtIsListeningI(&es1), "stuck listener");
+}
+
+ROMCONST struct testcase testevt4 = {
+  "Events, broadcast order and filtering",
+  evt4_setup,
+  NULL,
+  evt4_execute
+};
+
+#if !TEST_NO_BENCHMARKS || defined(__DOXYGEN__)
+/**
+ * @page test_events_005 Events broadcast performance
+ *
+ * <h2>Description</h2>
+ * An increasing number of listeners, from one to @p EVT_MAX_LISTENERS, is
+ * registered on an event source. Up to @p MAX_THREADS listeners belong to
+ * threads waiting for events, created with priorities not matching the
+ * registration order, the remaining listeners have a flags filter not
+ * matching the broadcasted flags. The event source is broadcasted into a
+ * continuous loop, each broadcast awakens all the threads and skips the
+ * filtered listeners.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations for each listeners count, the time per
+ * broadcast is also reported.
+ */
+
+/*
+ * Maximum number of listeners in the broadcast benchmark.
+ */
+#define EVT_MAX_LISTENERS       64
+
+static event_listener_t els[EVT_MAX_LISTENERS];
+
+static void evt5_setup(void) {
+
+  chEvtGetAndClearEvents(ALL_EVENTS);
+}
+
+static msg_t thread5(void *p) {
+  event_listener_t el;
+
+  (void)p;
+  chEvtRegisterMask(&es1, &el, 1);
+  while (!chThdShouldTerminateX())
+    chEvtWaitAny(ALL_EVENTS);
+  chEvtUnregister(&es1, &el);
+  return 0;
+}
+
+static void evt5_execute(void) {
+  static const tprio_t prios[MAX_THREADS] = {1, 3, 2, 5, 4};
+  tprio_t prio = chThdGetPriorityX();
+  unsigned i, nl, nt;
+
+  chEvtObjectInit(&es1);
+  for (nl = 1; nl <= EVT_MAX_LISTENERS; nl <<= 1) {
+    uint32_t n = 0;
+
+    nt = nl < MAX_THREADS ? nl : MAX_THREADS;
+    for (i = 0; i < nt; i++)
+      threads[i] = chThdCreateStatic(wa[i], WA_SIZE, prio + prios[i],
+                                     thread5, NULL);
+    /* The filtered listeners belong to the test thread, they are never
+       signaled because the broadcasted flags do not match the filter.*/
+    for (i = 0; i < nl - nt; i++)
+      chEvtRegisterMaskWithFlags(&es1, &els[i], 2, 2);
+    test_wait_tick();
+    test_start_timer(1000);
+    do {
+      chEvtBroadcastFlags(&es1, 1);
+      n++;
+      test_poll();
+    } while (!test_timer_done);
+    for (i = 0; i < nl - nt; i++)
+      chEvtUnregister(&es1, &els[i]);
+    for (i = 0; i < nt; i++)
+      chThdTerminate(threads[i]);
+    chEvtBroadcastFlags(&es1, 1);
+    test_wait_threads();
+
+    test_print("--- Score : ");
+    test_printn(n);
+    test_print(" broadcasts/S, ");
+    test_printn(1000000000U / n);
+    test_print(" nS/broadcast, ");
+    test_printn(nl);
+    test_print(" listeners, ");
+    test_printn(nt);
+    test_println(" threads");
+  }
+  test_assert(1, !chEvtIsListeningI(&es1), "stuck listener");
+}
+
+ROMCONST struct testcase testevt5 = {
+  "Events, broadcast performance",
+  evt5_setup,
+  NULL,
+  evt5_execute
+};
+#endif /* !TEST_NO_BENCHMARKS */
+
 /**
  * @brief   Test sequence for events.
  */
@@ -286,6 +440,10 @@ ROMCONST struct testcase * ROMCONST patternevt[] = {
   &testevt2,
 #if CH_CFG_USE_EVENTS_TIMEOUT || defined(__DOXYGEN__)
   &testevt3,
+#endif
+  &testevt4,
+#if !TEST_NO_BENCHMARKS || defined(__DOXYGEN__)
+  &testevt5,
 #endif
 #endif
   NULL
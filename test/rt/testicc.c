@@ -0,0 +1,330 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "test.h"
+#include "icchannel.h"
+
+/**
+ * @page test_icc Inter-core channels test
+ *
+ * File: @ref testicc.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the inter-core channels
+ * in @p os/various/icchannel.c. Both ends of a channel are instantiated
+ * on the local core, the doorbell callback serves the other end directly
+ * instead of raising an interrupt on a remote core.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to verify the ring buffer accounting,
+ * the data and messages ordering across many ring wraparounds and the
+ * wait and doorbell handshake between a producer and a consumer thread.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following options:
+ * - @p TEST_USE_ICCHANNEL
+ * .
+ * The HAL must be enabled because the channels implement the
+ * @p BaseChannel interface, the port must define
+ * @p port_memory_barrier().
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_icc_001
+ * - @subpage test_icc_002
+ * - @subpage test_icc_003
+ * - @subpage test_icc_004
+ * .
+ * @file testicc.c
+ * @brief Inter-core channels test source file
+ * @file testicc.h
+ * @brief Inter-core channels test header file
+ */
+
+#define ALLOWED_DELAY MS2ST(5)
+
+/*
+ * Amount of data and number of messages exchanged by the threads, several
+ * times the ring size in order to exercise the wraparound.
+ */
+#define ICC_STREAM_SIZE         (ICC_BUFFER_SIZE * 8)
+#define ICC_MESSAGES            (ICC_BUFFER_SIZE * 2)
+
+/*
+ * Shared area, the alignment is obtained at runtime in order to not rely
+ * on compiler specific attributes.
+ */
+static uint8_t icc_area[sizeof (icc_shared_t) + ICC_CACHE_LINE_SIZE];
+static icc_shared_t *icc_shp;
+
+static InterCoreChannel icc[2];
+static ICCConfig icc_cfg[2];
+static unsigned doorbells;
+
+/*
+ * Local doorbell, it serves the other end of the channel as the doorbell
+ * ISR would do on the remote core.
+ */
+static void doorbell(InterCoreChannel *icp) {
+
+  doorbells++;
+  iccServeDoorbellI(icp == &icc[0] ? &icc[1] : &icc[0]);
+}
+
+/*
+ * Pseudo-random chunk sizes, a simple LCG makes the sequence repeatable.
+ */
+static uint32_t seed;
+
+static size_t chunk(size_t max) {
+
+  seed = seed * 1103515245U + 12345U;
+  return (size_t)((seed >> 16) % max) + 1U;
+}
+
+static void icc_setup(void) {
+  unsigned i;
+
+  icc_shp = (icc_shared_t *)(((size_t)icc_area + ICC_CACHE_LINE_SIZE - 1U) &
+                             ~(size_t)(ICC_CACHE_LINE_SIZE - 1U));
+  iccSharedInit(icc_shp);
+  for (i = 0; i < 2; i++) {
+    icc_cfg[i].shared   = icc_shp;
+    icc_cfg[i].side     = i;
+    icc_cfg[i].doorbell = doorbell;
+    iccObjectInit(&icc[i], &icc_cfg[i]);
+  }
+  doorbells = 0;
+  seed = 1;
+}
+
+/**
+ * @page test_icc_001 Ring accounting
+ *
+ * <h2>Description</h2>
+ * Data is written to one end and read from the other end without blocking,
+ * the ring is then filled completely and a message is exchanged using the
+ * non-blocking functions.<br>
+ * The test expects the readable and writable counts to be consistent, the
+ * data to be returned unchanged and the full and empty conditions to be
+ * reported without waiting.
+ */
+
+static void icc1_execute(void) {
+  uint8_t *bp = test.buffer;
+  size_t i, n;
+  msg_t msg, rmsg;
+
+  for (i = 0; i < 16; i++)
+    bp[i] = (uint8_t)('A' + i);
+  n = iccWriteTimeout(&icc[0], bp, 16, TIME_IMMEDIATE);
+  test_assert(1, n == 16, "write failed");
+  test_assert(2, iccGetReadableX(&icc[1]) == 16, "wrong readable count");
+  test_assert(3, iccGetWritableX(&icc[0]) == ICC_BUFFER_SIZE - 16,
+              "wrong writable count");
+  test_assert(4, iccGetReadableX(&icc[0]) == 0, "wrong direction");
+
+  memset(bp, 0, 16);
+  n = iccReadTimeout(&icc[1], bp, 16, TIME_IMMEDIATE);
+  test_assert(5, n == 16, "read failed");
+  for (i = 0; i < 16; i++)
+    test_assert(6, bp[i] == (uint8_t)('A' + i), "wrong data");
+  test_assert(7, iccGetReadableX(&icc[1]) == 0, "not empty");
+  test_assert(8, iccGetWritableX(&icc[0]) == ICC_BUFFER_SIZE, "not empty");
+  test_assert(9, doorbells == 0, "unexpected doorbell");
+
+  /* Filling the ring across the buffer boundary.*/
+  memset(bp, 0x55, ICC_BUFFER_SIZE);
+  n = iccWriteTimeout(&icc[0], bp, ICC_BUFFER_SIZE + 1, TIME_IMMEDIATE);
+  test_assert(10, n == ICC_BUFFER_SIZE, "wrong write size");
+  test_assert(11, iccGetWritableX(&icc[0]) == 0, "not full");
+  n = iccReadTimeout(&icc[1], bp, ICC_BUFFER_SIZE + 1, TIME_IMMEDIATE);
+  test_assert(12, n == ICC_BUFFER_SIZE, "wrong read size");
+  test_assert(13, (bp[0] == 0x55) && (bp[ICC_BUFFER_SIZE - 1] == 0x55),
+              "wrong data");
+
+  /* Messages using the non-blocking functions.*/
+  chSysLock();
+  msg = iccPostI(&icc[1], (msg_t)0x12345678);
+  chSysUnlock();
+  test_assert(14, msg == MSG_OK, "post failed");
+  chSysLock();
+  msg = iccFetchI(&icc[0], &rmsg);
+  chSysUnlock();
+  test_assert(15, msg == MSG_OK, "fetch failed");
+  test_assert(16, rmsg == (msg_t)0x12345678, "wrong message");
+  chSysLock();
+  msg = iccFetchI(&icc[0], &rmsg);
+  chSysUnlock();
+  test_assert(17, msg == MSG_TIMEOUT, "not empty");
+}
+
+ROMCONST struct testcase testicc1 = {
+  "Inter-core channels, ring accounting",
+  icc_setup,
+  NULL,
+  icc1_execute
+};
+
+/**
+ * @page test_icc_002 Stream transfer
+ *
+ * <h2>Description</h2>
+ * A producer thread writes a known pattern in chunks of random size, the
+ * test thread reads it back in chunks of different random sizes, the
+ * total amount of data is several times the ring size.<br>
+ * The test expects the data to be received in order and unchanged and the
+ * threads to be woken by the doorbell.
+ */
+
+static msg_t thread1(void *p) {
+  uint8_t buf[37];
+  size_t v = 0;
+
+  (void)p;
+  while (v < ICC_STREAM_SIZE) {
+    size_t i, n = chunk(sizeof buf);
+
+    if (n > ICC_STREAM_SIZE - v)
+      n = ICC_STREAM_SIZE - v;
+    for (i = 0; i < n; i++)
+      buf[i] = (uint8_t)((v + i) * 7);
+    if (iccWriteTimeout(&icc[1], buf, n, TIME_INFINITE) != n)
+      break;
+    v += n;
+  }
+  return 0;
+}
+
+static void icc2_execute(void) {
+  uint8_t buf[53];
+  size_t v = 0;
+  bool ok = true;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX(),
+                                 thread1, NULL);
+  /* The whole stream is received before asserting, the producer would
+     never terminate otherwise.*/
+  while (v < ICC_STREAM_SIZE) {
+    size_t i, n = chunk(sizeof buf);
+
+    if (n > ICC_STREAM_SIZE - v)
+      n = ICC_STREAM_SIZE - v;
+    if (iccReadTimeout(&icc[0], buf, n, MS2ST(500)) != n) {
+      ok = false;
+      break;
+    }
+    for (i = 0; i < n; i++)
+      ok = ok && (buf[i] == (uint8_t)((v + i) * 7));
+    v += n;
+  }
+  test_wait_threads();
+  test_assert(1, v == ICC_STREAM_SIZE, "transfer timeout");
+  test_assert(2, ok, "wrong data");
+  test_assert(3, iccGetReadableX(&icc[0]) == 0, "not empty");
+  test_assert(4, doorbells > 0, "no doorbell");
+}
+
+ROMCONST struct testcase testicc2 = {
+  "Inter-core channels, stream transfer",
+  icc_setup,
+  NULL,
+  icc2_execute
+};
+
+/**
+ * @page test_icc_003 Messages transfer
+ *
+ * <h2>Description</h2>
+ * A producer thread posts a sequence of messages, the test thread fetches
+ * them, the number of messages exceeds the ring capacity.<br>
+ * The test expects the messages to be received in order.
+ */
+
+static msg_t thread2(void *p) {
+  msg_t i;
+
+  (void)p;
+  for (i = 0; i < ICC_MESSAGES; i++) {
+    if (iccPost(&icc[1], i, TIME_INFINITE) != MSG_OK)
+      break;
+  }
+  return 0;
+}
+
+static void icc3_execute(void) {
+  msg_t i, msg;
+  bool ok = true;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX(),
+                                 thread2, NULL);
+  for (i = 0; i < ICC_MESSAGES; i++) {
+    if (iccFetch(&icc[0], &msg, MS2ST(500)) != MSG_OK)
+      break;
+    ok = ok && (msg == i);
+  }
+  test_wait_threads();
+  test_assert(1, i == ICC_MESSAGES, "transfer timeout");
+  test_assert(2, ok, "wrong message order");
+  test_assert(3, doorbells > 0, "no doorbell");
+}
+
+ROMCONST struct testcase testicc3 = {
+  "Inter-core channels, messages transfer",
+  icc_setup,
+  NULL,
+  icc3_execute
+};
+
+/**
+ * @page test_icc_004 Read timeout
+ *
+ * <h2>Description</h2>
+ * The test thread reads from an empty channel with a timeout.<br>
+ * The test expects the read to return no data at the timeout deadline.
+ */
+
+static void icc4_execute(void) {
+  systime_t target;
+  size_t n;
+
+  test_wait_tick();
+  target = chVTGetSystemTime() + MS2ST(10);
+  n = iccReadTimeout(&icc[0], test.buffer, 1, MS2ST(10));
+  test_assert(1, n == 0, "unexpected data");
+  test_assert_time_window(2, target, target + ALLOWED_DELAY);
+}
+
+ROMCONST struct testcase testicc4 = {
+  "Inter-core channels, read timeout",
+  icc_setup,
+  NULL,
+  icc4_execute
+};
+
+/**
+ * @brief   Test sequence for the inter-core channels.
+ */
+ROMCONST struct testcase * ROMCONST patternicc[] = {
+  &testicc1,
+  &testicc2,
+  &testicc3,
+  &testicc4,
+  NULL
+};
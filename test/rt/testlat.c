@@ -0,0 +1,517 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "hal.h"
+#include "test.h"
+
+/**
+ * @page test_latency Interrupt to thread latency
+ *
+ * File: @ref testlat.c
+ *
+ * <h2>Description</h2>
+ * This module implements a series of benchmarks measuring the time from
+ * an interrupt service routine waking up a thread, using one of the I-Class
+ * wakeup primitives, to the woken thread running.<br>
+ * A GPT driver generates a periodic interrupt, the callback takes a
+ * timestamp using the realtime counter then wakes up the tester thread that
+ * takes a second timestamp, the difference is accounted into an histogram.
+ * Each primitive is measured with the system idle and under a synthetic
+ * background load made of lower priority threads continuously entering
+ * short critical zones and yielding.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to provide latency and jitter figures
+ * for the interrupt to thread path, the results are printed as histograms
+ * in realtime counter cycles.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following options:
+ * - @p TEST_USE_GPT_LATENCY
+ * - @p PORT_SUPPORTS_RT
+ * - @p HAL_USE_GPT
+ * - @p TEST_LAT_GPT_DRIVER, pointer to a GPT driver dedicated to the test
+ *   suite, for example @p &GPTD1
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_latency_001
+ * - @subpage test_latency_002
+ * - @subpage test_latency_003
+ * - @subpage test_latency_004
+ * - @subpage test_latency_005
+ * - @subpage test_latency_006
+ * - @subpage test_latency_007
+ * - @subpage test_latency_008
+ * .
+ * @file testlat.c
+ * @brief Interrupt to thread latency source file
+ * @file testlat.h
+ * @brief Interrupt to thread latency header file
+ */
+
+/**
+ * @brief   GPT clock frequency.
+ */
+#if !defined(TEST_LAT_GPT_FREQUENCY) || defined(__DOXYGEN__)
+#define TEST_LAT_GPT_FREQUENCY  1000000
+#endif
+
+/**
+ * @brief   GPT interval in GPT clock cycles.
+ * @note    The default is one interrupt every millisecond.
+ */
+#if !defined(TEST_LAT_GPT_INTERVAL) || defined(__DOXYGEN__)
+#define TEST_LAT_GPT_INTERVAL   1000
+#endif
+
+#if (PORT_SUPPORTS_RT && HAL_USE_GPT && defined(TEST_LAT_GPT_DRIVER)) ||     \
+    defined(__DOXYGEN__)
+
+/*
+ * Number of background load threads and iterations performed into each
+ * load critical zone.
+ */
+#define LAT_LOAD_THREADS        4
+#define LAT_LOAD_CRITICAL       32
+
+/*
+ * Waits time out if an interrupt is lost.
+ */
+#define LAT_TIMEOUT             MS2ST(10)
+
+/*
+ * Descriptor of a wakeup primitive.
+ */
+typedef struct {
+  /* State of the tester thread while waiting on the primitive.*/
+  tstate_t      state;
+  /* I-Class wakeup, invoked from the GPT callback.*/
+  void          (*wakeup)(void);
+  /* Wait function, it returns the realtime counter value taken just after
+     the wakeup.*/
+  msg_t         (*wait)(rtcnt_t *nowp);
+} lat_primitive_t;
+
+static GPTConfig lat_gptcfg;
+static thread_t *lat_tp;
+static const lat_primitive_t *lat_pp;
+static volatile rtcnt_t lat_t0;
+static test_histogram_t lat_hist;
+
+/*
+ * Prints the histogram summary followed by the non-empty buckets.
+ */
+static void lat_hist_print(void) {
+  unsigned i;
+  uint32_t lower = 0;
+
+  test_print("--- Samples: ");
+  test_printn(lat_hist.samples);
+  if (lat_hist.samples == 0) {
+    test_println("");
+    return;
+  }
+  test_print(", min ");
+  test_printn(lat_hist.min);
+  test_print(", p50 ");
+  test_printn(test_hist_percentile(&lat_hist, 50));
+  test_print(", p99 ");
+  test_printn(test_hist_percentile(&lat_hist, 99));
+  test_print(", max ");
+  test_printn(lat_hist.max);
+  test_println("");
+  for (i = 0; i < TEST_HIST_BUCKETS; i++) {
+    if (lat_hist.buckets[i] > 0) {
+      test_print("---   ");
+      test_printn(lower);
+      if (i == TEST_HIST_BUCKETS - 1U)
+        test_print("+");
+      else {
+        test_print("-");
+        test_printn(test_hist_upper(i));
+      }
+      test_print(": ");
+      test_printn(lat_hist.buckets[i]);
+      test_println("");
+    }
+    lower = test_hist_upper(i) + 1U;
+  }
+}
+
+static void lat_cb(GPTDriver *gptp) {
+  rtcnt_t now = chSysGetRealtimeCounterX();
+
+  (void)gptp;
+  chSysLockFromISR();
+  /* The timestamp is only published if the tester thread is really waiting,
+     an interrupt falling while the previous sample is processed is lost.*/
+  if (lat_tp->p_state == lat_pp->state) {
+    lat_t0 = now;
+    lat_pp->wakeup();
+  }
+  chSysUnlockFromISR();
+}
+
+static msg_t lat_load(void *p) {
+  volatile unsigned i;
+
+  (void)p;
+  while (!chThdShouldTerminateX()) {
+    chSysLock();
+    for (i = 0; i < LAT_LOAD_CRITICAL; i++)
+      ;
+    chSysUnlock();
+    chThdYield();
+    test_poll();
+  }
+  return 0;
+}
+
+static void lat_execute(const lat_primitive_t *lpp, bool loaded) {
+  tprio_t prio = chThdGetPriorityX();
+  rtcnt_t now;
+  unsigned i;
+
+  lat_tp = chThdGetSelfX();
+  lat_pp = lpp;
+  test_hist_reset(&lat_hist);
+  if (loaded) {
+    for (i = 0; i < LAT_LOAD_THREADS; i++)
+      threads[i] = chThdCreateStatic(wa[i], WA_SIZE, prio - 1, lat_load, NULL);
+  }
+
+  lat_gptcfg.frequency = TEST_LAT_GPT_FREQUENCY;
+  lat_gptcfg.callback  = lat_cb;
+  test_wait_tick();
+  test_start_timer(1000);
+  gptStart(TEST_LAT_GPT_DRIVER, &lat_gptcfg);
+  gptStartContinuous(TEST_LAT_GPT_DRIVER, TEST_LAT_GPT_INTERVAL);
+  do {
+    if (lpp->wait(&now) == MSG_OK) {
+      test_hist_add(&lat_hist, (uint32_t)(rtcnt_t)(now - lat_t0));
+#if TEST_BMK_LATENCY
+      test_bmk_sample((rtcnt_t)(now - lat_t0));
+#endif
+    }
+  } while (!test_timer_done);
+  gptStopTimer(TEST_LAT_GPT_DRIVER);
+  gptStop(TEST_LAT_GPT_DRIVER);
+  test_terminate_threads();
+  test_wait_threads();
+
+  test_bmk_score(lat_hist.samples, "wakeups/S");
+  lat_hist_print();
+  if (lat_hist.samples > 0) {
+    test_print("--- Jitter : ");
+    test_printn(lat_hist.max - lat_hist.min);
+    test_println(" cycles");
+  }
+  test_assert(1, lat_hist.samples > 0, "no wakeups");
+}
+
+/**
+ * @page test_latency_001 Thread resume from ISR, idle
+ *
+ * <h2>Description</h2>
+ * The tester thread is suspended on a thread reference and resumed by the
+ * interrupt using @p chThdResumeI(), the system is otherwise idle.
+ */
+
+static thread_reference_t lat_tr;
+
+static void lat_resume(void) {
+
+  chThdResumeI(&lat_tr, MSG_OK);
+}
+
+static msg_t lat_resume_wait(rtcnt_t *nowp) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chThdSuspendTimeoutS(&lat_tr, LAT_TIMEOUT);
+  *nowp = chSysGetRealtimeCounterX();
+  chSysUnlock();
+  return msg;
+}
+
+static const lat_primitive_t lat_resume_primitive = {
+  CH_STATE_SUSPENDED,
+  lat_resume,
+  lat_resume_wait
+};
+
+static void lat1_execute(void) {
+
+  lat_execute(&lat_resume_primitive, FALSE);
+}
+
+ROMCONST struct testcase testlat1 = {
+  "Latency, resume from ISR, idle",
+  NULL,
+  NULL,
+  lat1_execute
+};
+
+/**
+ * @page test_latency_002 Thread resume from ISR, loaded
+ *
+ * <h2>Description</h2>
+ * Same as @ref test_latency_001 with background load threads.
+ */
+
+static void lat2_execute(void) {
+
+  lat_execute(&lat_resume_primitive, TRUE);
+}
+
+ROMCONST struct testcase testlat2 = {
+  "Latency, resume from ISR, loaded",
+  NULL,
+  NULL,
+  lat2_execute
+};
+
+/**
+ * @page test_latency_003 Semaphore signal from ISR, idle
+ *
+ * <h2>Description</h2>
+ * The tester thread waits on a semaphore signaled by the interrupt using
+ * @p chSemSignalI(), the system is otherwise idle.
+ */
+
+static semaphore_t lat_sem;
+
+static void lat_sem_wakeup(void) {
+
+  chSemSignalI(&lat_sem);
+}
+
+static msg_t lat_sem_wait(rtcnt_t *nowp) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chSemWaitTimeoutS(&lat_sem, LAT_TIMEOUT);
+  *nowp = chSysGetRealtimeCounterX();
+  chSysUnlock();
+  return msg;
+}
+
+static const lat_primitive_t lat_sem_primitive = {
+  CH_STATE_WTSEM,
+  lat_sem_wakeup,
+  lat_sem_wait
+};
+
+static void lat_sem_setup(void) {
+
+  chSemObjectInit(&lat_sem, 0);
+}
+
+static void lat3_execute(void) {
+
+  lat_execute(&lat_sem_primitive, FALSE);
+}
+
+ROMCONST struct testcase testlat3 = {
+  "Latency, semaphore signal from ISR, idle",
+  lat_sem_setup,
+  NULL,
+  lat3_execute
+};
+
+/**
+ * @page test_latency_004 Semaphore signal from ISR, loaded
+ *
+ * <h2>Description</h2>
+ * Same as @ref test_latency_003 with background load threads.
+ */
+
+static void lat4_execute(void) {
+
+  lat_execute(&lat_sem_primitive, TRUE);
+}
+
+ROMCONST struct testcase testlat4 = {
+  "Latency, semaphore signal from ISR, loaded",
+  lat_sem_setup,
+  NULL,
+  lat4_execute
+};
+
+#if (CH_CFG_USE_EVENTS && CH_CFG_USE_EVENTS_TIMEOUT) || defined(__DOXYGEN__)
+/**
+ * @page test_latency_005 Event signal from ISR, idle
+ *
+ * <h2>Description</h2>
+ * The tester thread waits for an event flag signaled by the interrupt using
+ * @p chEvtSignalI(), the system is otherwise idle.
+ */
+
+static void lat_evt_wakeup(void) {
+
+  chEvtSignalI(lat_tp, EVENT_MASK(0));
+}
+
+static msg_t lat_evt_wait(rtcnt_t *nowp) {
+  eventmask_t m;
+
+  m = chEvtWaitAnyTimeout(EVENT_MASK(0), LAT_TIMEOUT);
+  *nowp = chSysGetRealtimeCounterX();
+  return m != 0 ? MSG_OK : MSG_TIMEOUT;
+}
+
+static const lat_primitive_t lat_evt_primitive = {
+  CH_STATE_WTOREVT,
+  lat_evt_wakeup,
+  lat_evt_wait
+};
+
+static void lat_evt_setup(void) {
+
+  (void)chEvtGetAndClearEvents(ALL_EVENTS);
+}
+
+static void lat5_execute(void) {
+
+  lat_execute(&lat_evt_primitive, FALSE);
+}
+
+ROMCONST struct testcase testlat5 = {
+  "Latency, event signal from ISR, idle",
+  lat_evt_setup,
+  NULL,
+  lat5_execute
+};
+
+/**
+ * @page test_latency_006 Event signal from ISR, loaded
+ *
+ * <h2>Description</h2>
+ * Same as @ref test_latency_005 with background load threads.
+ */
+
+static void lat6_execute(void) {
+
+  lat_execute(&lat_evt_primitive, TRUE);
+}
+
+ROMCONST struct testcase testlat6 = {
+  "Latency, event signal from ISR, loaded",
+  lat_evt_setup,
+  NULL,
+  lat6_execute
+};
+#endif /* CH_CFG_USE_EVENTS && CH_CFG_USE_EVENTS_TIMEOUT */
+
+#if CH_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
+/**
+ * @page test_latency_007 Mailbox post from ISR, idle
+ *
+ * <h2>Description</h2>
+ * The tester thread waits on a mailbox, a message is posted by the interrupt
+ * using @p chMBPostI(), the system is otherwise idle.
+ */
+
+static msg_t lat_mbbuf[1];
+static mailbox_t lat_mb;
+
+static void lat_mb_wakeup(void) {
+
+  (void)chMBPostI(&lat_mb, 0);
+}
+
+static msg_t lat_mb_wait(rtcnt_t *nowp) {
+  msg_t msg, m;
+
+  chSysLock();
+  msg = chMBFetchS(&lat_mb, &m, LAT_TIMEOUT);
+  *nowp = chSysGetRealtimeCounterX();
+  chSysUnlock();
+  return msg;
+}
+
+static const lat_primitive_t lat_mb_primitive = {
+  CH_STATE_WTSEM,
+  lat_mb_wakeup,
+  lat_mb_wait
+};
+
+static void lat_mb_setup(void) {
+
+  chMBObjectInit(&lat_mb, lat_mbbuf, 1);
+}
+
+static void lat7_execute(void) {
+
+  lat_execute(&lat_mb_primitive, FALSE);
+}
+
+ROMCONST struct testcase testlat7 = {
+  "Latency, mailbox post from ISR, idle",
+  lat_mb_setup,
+  NULL,
+  lat7_execute
+};
+
+/**
+ * @page test_latency_008 Mailbox post from ISR, loaded
+ *
+ * <h2>Description</h2>
+ * Same as @ref test_latency_007 with background load threads.
+ */
+
+static void lat8_execute(void) {
+
+  lat_execute(&lat_mb_primitive, TRUE);
+}
+
+ROMCONST struct testcase testlat8 = {
+  "Latency, mailbox post from ISR, loaded",
+  lat_mb_setup,
+  NULL,
+  lat8_execute
+};
+#endif /* CH_CFG_USE_MAILBOXES */
+
+#endif /* PORT_SUPPORTS_RT && HAL_USE_GPT && defined(TEST_LAT_GPT_DRIVER) */
+
+/**
+ * @brief   Test sequence for interrupt to thread latency.
+ */
+ROMCONST struct testcase * ROMCONST patternlat[] = {
+#if !TEST_NO_BENCHMARKS
+#if (PORT_SUPPORTS_RT && HAL_USE_GPT && defined(TEST_LAT_GPT_DRIVER)) ||     \
+    defined(__DOXYGEN__)
+  &testlat1,
+  &testlat2,
+  &testlat3,
+  &testlat4,
+#if (CH_CFG_USE_EVENTS && CH_CFG_USE_EVENTS_TIMEOUT) || defined(__DOXYGEN__)
+  &testlat5,
+  &testlat6,
+#endif
+#if CH_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
+  &testlat7,
+  &testlat8,
+#endif
+#endif
+#endif
+  NULL
+};
@@ -35,7 +35,7 @@
  * The module requires the following kernel options:
  * - @p CH_CFG_USE_MUTEXES
  * - @p CH_CFG_USE_CONDVARS
- * - @p CH_DBG_THREADS_PROFILING
+ * - @p CH_DBG_THREADS_PROFILING or @p CH_DBG_SIMULATED_TIME
  * .
  * In case some of the required options are not enabled then some or all tests
  * may be skipped.
@@ -116,7 +116,7 @@ ROMCONST struct testcase testmtx1 = {
   mtx1_execute
 };
 
-#if CH_DBG_THREADS_PROFILING || defined(__DOXYGEN__)
+#if TEST_USE_CPU_PULSE || defined(__DOXYGEN__)
 /**
  * @page test_mtx_002 Priority inheritance, simple case
  *
@@ -159,7 +159,7 @@ static msg_t thread2L(void *p) {
   (void)p;
   chMtxLock(&m1);
   test_cpu_pulse(40);
-  chMtxUnlock();
+  chMtxUnlock(&m1);
   test_cpu_pulse(10);
   test_emit_token('C');
   return 0;
@@ -182,7 +182,7 @@ static msg_t thread2H(void *p) {
   chThdSleepMilliseconds(40);
   chMtxLock(&m1);
   test_cpu_pulse(10);
-  chMtxUnlock();
+  chMtxUnlock(&m1);
   test_emit_token('A');
   return 0;
 }
@@ -250,7 +250,7 @@ static msg_t thread3LL(void *p) {
   (void)p;
   chMtxLock(&m1);
   test_cpu_pulse(30);
-  chMtxUnlock();
+  chMtxUnlock(&m1);
   test_emit_token('E');
   return 0;
 }
@@ -264,9 +264,9 @@ static msg_t thread3L(void *p) {
   test_cpu_pulse(20);
   chMtxLock(&m1);
   test_cpu_pulse(10);
-  chMtxUnlock();
+  chMtxUnlock(&m1);
   test_cpu_pulse(10);
-  chMtxUnlock();
+  chMtxUnlock(&m2);
   test_emit_token('D');
   return 0;
 }
@@ -278,7 +278,7 @@ static msg_t thread3M(void *p) {
   chThdSleepMilliseconds(20);
   chMtxLock(&m2);
   test_cpu_pulse(10);
-  chMtxUnlock();
+  chMtxUnlock(&m2);
   test_emit_token('C');
   return 0;
 }
@@ -300,7 +300,7 @@ static msg_t thread3HH(void *p) {
   chThdSleepMilliseconds(50);
   chMtxLock(&m2);
   test_cpu_pulse(10);
-  chMtxUnlock();
+  chMtxUnlock(&m2);
   test_emit_token('A');
   return 0;
 }
@@ -326,7 +326,7 @@ ROMCONST struct testcase testmtx3 = {
   NULL,
   mtx3_execute
 };
-#endif /* CH_DBG_THREADS_PROFILING */
+#endif /* TEST_USE_CPU_PULSE */
 
 /**
  * @page test_mtx_004 Priority return verification
@@ -621,7 +621,7 @@ ROMCONST struct testcase testmtx8 = {
 ROMCONST struct testcase * ROMCONST patternmtx[] = {
 #if CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
   &testmtx1,
-#if CH_DBG_THREADS_PROFILING || defined(__DOXYGEN__)
+#if TEST_USE_CPU_PULSE || defined(__DOXYGEN__)
   &testmtx2,
   &testmtx3,
 #endif
@@ -31,12 +31,14 @@
  * <h2>Preconditions</h2>
  * The module requires the following kernel options:
  * - @p CH_CFG_USE_MEMPOOLS
+ * - @p CH_CFG_USE_POOLCACHES
  * .
  * In case some of the required options are not enabled then some or all tests
  * may be skipped.
  *
  * <h2>Test Cases</h2>
  * - @subpage test_pools_001
+ * - @subpage test_pools_002
  * .
  * @file testpools.c
  * @brief Memory Pools test source file
@@ -104,6 +106,114 @@ ROMCONST struct testcase testpools1 = {
   pools1_execute
 };
 
+#if CH_CFG_USE_POOLCACHES || defined(__DOXYGEN__)
+/**
+ * @page test_pools_002 Thread caches
+ *
+ * <h2>Description</h2>
+ * Objects are allocated and released through a pool cache in sequences
+ * designed to trigger the refill and drain paths, the number of objects
+ * in the cache and in the pool is checked after each step. A thread then
+ * caches objects and exits, the objects must be returned to the pool.
+ */
+
+#define POOLS_CACHED_OBJECTS 8
+
+static memory_pool_t mp2;
+static pool_cache_t pc1, pc2;
+static void *objs[POOLS_CACHED_OBJECTS][2];
+
+static cnt_t pool_count(memory_pool_t *mp) {
+  struct pool_header *php;
+  cnt_t n = 0;
+
+  chSysLock();
+  for (php = mp->mp_next; php != NULL; php = php->ph_next)
+    n++;
+  chSysUnlock();
+  return n;
+}
+
+/*
+ * The cache is not disposed, it is static because it is still linked to
+ * the thread when the thread exits.
+ */
+static msg_t thread2(void *p) {
+
+  (void)p;
+  chPoolCacheObjectInit(&pc2, &mp2, 4);
+  chPoolCacheFree(&pc2, chPoolCacheAlloc(&pc2));
+  return 0;
+}
+
+static void pools2_setup(void) {
+
+  chPoolObjectInit(&mp2, sizeof (objs[0]), NULL);
+  chPoolLoadArray(&mp2, objs, POOLS_CACHED_OBJECTS);
+  chPoolCacheObjectInit(&pc1, &mp2, 4);
+}
+
+static void pools2_teardown(void) {
+
+  chPoolCacheDispose(&pc1);
+}
+
+static void pools2_execute(void) {
+  void *o[4];
+  int i;
+
+  /* First allocation, the cache is refilled with half capacity.*/
+  o[0] = chPoolCacheAlloc(&pc1);
+  test_assert(1, o[0] != NULL, "allocation failed");
+  test_assert(2, chPoolCacheGetMissesX(&pc1) == 1, "wrong misses");
+  test_assert(3, pc1.pc_cnt == 2, "wrong cache count");
+  test_assert(4, pool_count(&mp2) == POOLS_CACHED_OBJECTS - 3,
+              "wrong pool count");
+
+  /* Releasing into the cache.*/
+  chPoolCacheFree(&pc1, o[0]);
+  test_assert(5, chPoolCacheGetHitsX(&pc1) == 1, "wrong hits");
+  test_assert(6, pc1.pc_cnt == 3, "wrong cache count");
+
+  /* Emptying the cache and refilling.*/
+  for (i = 0; i < 4; i++)
+    o[i] = chPoolCacheAlloc(&pc1);
+  test_assert(7, o[3] != NULL, "allocation failed");
+  test_assert(8, chPoolCacheGetMissesX(&pc1) == 2, "wrong misses");
+  test_assert(9, pool_count(&mp2) == POOLS_CACHED_OBJECTS - 6,
+              "wrong pool count");
+
+  /* Filling the cache, half of it is drained on overflow.*/
+  for (i = 0; i < 4; i++)
+    chPoolCacheFree(&pc1, o[i]);
+  test_assert(10, chPoolCacheGetMissesX(&pc1) == 3, "wrong misses");
+  test_assert(11, pc1.pc_cnt == 4, "wrong cache count");
+  test_assert(12, pool_count(&mp2) == POOLS_CACHED_OBJECTS - 4,
+              "wrong pool count");
+  test_assert(13, chPoolCacheGetHitRateX(&pc1) == 70, "wrong hit rate");
+
+  /* Flushing.*/
+  chPoolCacheFlush(&pc1);
+  test_assert(14, pc1.pc_cnt == 0, "cache not empty");
+  test_assert(15, pool_count(&mp2) == POOLS_CACHED_OBJECTS,
+              "wrong pool count");
+
+  /* Objects cached by an exiting thread.*/
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX() - 1,
+                                 thread2, NULL);
+  test_wait_threads();
+  test_assert(16, pool_count(&mp2) == POOLS_CACHED_OBJECTS,
+              "objects not returned");
+}
+
+ROMCONST struct testcase testpools2 = {
+  "Memory Pools, thread caches",
+  pools2_setup,
+  pools2_teardown,
+  pools2_execute
+};
+#endif /* CH_CFG_USE_POOLCACHES */
+
 #endif /* CH_CFG_USE_MEMPOOLS */
 
 /*
@@ -112,6 +222,9 @@ ROMCONST struct testcase testpools1 = {
 ROMCONST struct testcase * ROMCONST patternpools[] = {
 #if CH_CFG_USE_MEMPOOLS || defined(__DOXYGEN__)
   &testpools1,
+#endif
+#if CH_CFG_USE_POOLCACHES || defined(__DOXYGEN__)
+  &testpools2,
 #endif
   NULL
 };
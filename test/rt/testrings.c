@@ -0,0 +1,324 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_rings Ring buffers test
+ *
+ * File: @ref testrings.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the @ref ring_buffers
+ * subsystem.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover 100% of the @ref ring_buffers
+ * subsystem code.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_CFG_USE_RINGBUFFERS
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_rings_001
+ * - @subpage test_rings_002
+ * - @subpage test_rings_003
+ * .
+ * @file testrings.c
+ * @brief Ring buffers test source file
+ * @file testrings.h
+ * @brief Ring buffers header file
+ */
+
+#if CH_CFG_USE_RINGBUFFERS || defined(__DOXYGEN__)
+
+#define RB_SIZE 4
+
+static char rbbuf[RB_SIZE];
+static uint32_t rbseq[RB_SIZE];
+
+/*
+ * Note, the static initializers are not really required because the
+ * variables are explicitly initialized in each test case. It is done in order
+ * to test the macros.
+ */
+static RING_BUFFER_DECL(rb1, rbbuf, sizeof (char), RB_SIZE);
+static MP_RING_BUFFER_DECL(mprb1, rbbuf, rbseq, sizeof (char), RB_SIZE);
+
+/**
+ * @page test_rings_001 Single producer queuing and wrapping
+ *
+ * <h2>Description</h2>
+ * Objects are put/got and reserved/fetched in place from a single producer
+ * ring buffer in sequences designed to stimulate the full, empty and
+ * wrap-around conditions.<br>
+ * The test expects to find a consistent ring buffer status after each
+ * operation.
+ */
+
+static void rings1_setup(void) {
+
+  chRBObjectInit(&rb1, rbbuf, sizeof (char), RB_SIZE);
+}
+
+static void rings1_execute(void) {
+  unsigned i;
+  size_t n;
+  char c, *p;
+
+  /*
+   * Testing initial state.
+   */
+  test_assert(1, chRBIsEmptyX(&rb1), "not empty");
+  test_assert(2, chRBGetFreeCountX(&rb1) == RB_SIZE, "wrong size");
+  test_assert(3, chRBGetX(&rb1, &c) == MSG_TIMEOUT, "not empty");
+
+  /*
+   * Testing filling and the full condition.
+   */
+  for (i = 0; i < RB_SIZE; i++) {
+    c = 'A' + i;
+    test_assert(4, chRBPutX(&rb1, &c) == MSG_OK, "put failed");
+  }
+  c = 'X';
+  test_assert(5, chRBPutX(&rb1, &c) == MSG_TIMEOUT, "not full");
+  test_assert(6, chRBGetUsedCountX(&rb1) == RB_SIZE, "wrong count");
+  test_assert(7, chRBReserveX(&rb1, (void **)&p, 1) == 0, "not full");
+
+  /*
+   * Testing emptying.
+   */
+  for (i = 0; i < RB_SIZE; i++) {
+    test_assert(8, chRBGetX(&rb1, &c) == MSG_OK, "get failed");
+    test_emit_token(c);
+  }
+  test_assert_sequence(9, "ABCD");
+  test_assert(10, chRBIsEmptyX(&rb1), "not empty");
+
+  /*
+   * Testing in place access across the buffer end, the counters are moved
+   * in the middle of the buffer first.
+   */
+  c = 'X';
+  (void) chRBPutX(&rb1, &c);
+  (void) chRBPutX(&rb1, &c);
+  (void) chRBGetX(&rb1, &c);
+  (void) chRBGetX(&rb1, &c);
+  n = chRBReserveX(&rb1, (void **)&p, RB_SIZE);
+  test_assert(11, n == RB_SIZE / 2, "wrapped reservation");
+  p[0] = 'A';
+  p[1] = 'B';
+  chRBCommitX(&rb1, n);
+  n = chRBReserveX(&rb1, (void **)&p, RB_SIZE);
+  test_assert(12, n == RB_SIZE / 2, "wrong reservation");
+  test_assert(13, p == rbbuf, "not wrapped");
+  p[0] = 'C';
+  p[1] = 'D';
+  chRBCommitX(&rb1, n);
+  test_assert(14, chRBGetFreeCountX(&rb1) == 0, "not full");
+  n = chRBFetchX(&rb1, (void **)&p, RB_SIZE);
+  test_assert(15, n == RB_SIZE / 2, "wrapped fetch");
+  for (i = 0; i < n; i++)
+    test_emit_token(p[i]);
+  chRBReleaseX(&rb1, n);
+  n = chRBFetchX(&rb1, (void **)&p, RB_SIZE);
+  test_assert(16, n == RB_SIZE / 2, "wrong fetch");
+  for (i = 0; i < n; i++)
+    test_emit_token(p[i]);
+  chRBReleaseX(&rb1, n);
+  test_assert_sequence(17, "ABCD");
+
+  /*
+   * Testing final conditions.
+   */
+  test_assert(18, chRBIsEmptyX(&rb1), "not empty");
+  test_assert(19, chRBFetchX(&rb1, (void **)&p, 1) == 0, "not empty");
+  test_assert(20, chRBWaitTimeout(&rb1, TIME_IMMEDIATE) == MSG_TIMEOUT,
+              "not empty");
+}
+
+ROMCONST struct testcase testrings1 = {
+  "Ring buffers, single producer queuing",
+  rings1_setup,
+  NULL,
+  rings1_execute
+};
+
+/**
+ * @page test_rings_002 Multiple producers out of order commits
+ *
+ * <h2>Description</h2>
+ * Slots are reserved from a multiple producers ring buffer then committed
+ * in reverse order, the consumer must not see any object until the first
+ * reserved slot has been committed. The sequence is repeated across the
+ * buffer end where the fetch is split in two parts.
+ */
+
+static void rings2_setup(void) {
+
+  chMPRBObjectInit(&mprb1, rbbuf, rbseq, sizeof (char), RB_SIZE);
+}
+
+static void rings2_execute(void) {
+  unsigned i, lap;
+  char c, *p1, *p2, *p;
+  size_t n;
+
+  /*
+   * Testing initial state.
+   */
+  test_assert(1, chMPRBIsEmptyX(&mprb1), "not empty");
+  test_assert(2, chMPRBGetX(&mprb1, &c) == MSG_TIMEOUT, "not empty");
+
+  for (lap = 0; lap < 3; lap++) {
+    /*
+     * Two single slot reservations committed in reverse order.
+     */
+    test_assert(3, chMPRBReserveX(&mprb1, (void **)&p1, 1) == 1,
+                "reservation failed");
+    test_assert(4, chMPRBReserveX(&mprb1, (void **)&p2, 1) == 1,
+                "reservation failed");
+    test_assert(5, p1 != p2, "same slot");
+    *p2 = 'B';
+    chMPRBCommitX(&mprb1, p2, 1);
+    test_assert(6, chMPRBIsEmptyX(&mprb1), "out of order object");
+    test_assert(7, chMPRBFetchX(&mprb1, (void **)&p, RB_SIZE) == 0,
+                "out of order object");
+    *p1 = 'A';
+    chMPRBCommitX(&mprb1, p1, 1);
+    test_assert(8, chMPRBGetUsedCountX(&mprb1) == 2, "wrong count");
+    while ((n = chMPRBFetchX(&mprb1, (void **)&p, RB_SIZE)) > 0) {
+      for (i = 0; i < n; i++)
+        test_emit_token(p[i]);
+      chMPRBReleaseX(&mprb1, n);
+    }
+
+    /*
+     * Odd number of objects in order to move the counters across the
+     * buffer end on the next lap.
+     */
+    c = 'C';
+    test_assert(9, chMPRBPutX(&mprb1, &c) == MSG_OK, "put failed");
+    test_assert(10, chMPRBGetX(&mprb1, &c) == MSG_OK, "get failed");
+    test_emit_token(c);
+  }
+  test_assert_sequence(11, "ABCABCABC");
+
+  /*
+   * Testing the full condition.
+   */
+  for (i = 0; i < RB_SIZE; i++) {
+    c = 'A' + i;
+    test_assert(12, chMPRBPutX(&mprb1, &c) == MSG_OK, "put failed");
+  }
+  test_assert(13, chMPRBPutX(&mprb1, &c) == MSG_TIMEOUT, "not full");
+  test_assert(14, chMPRBGetUsedCountX(&mprb1) == RB_SIZE, "wrong count");
+  for (i = 0; i < RB_SIZE; i++) {
+    test_assert(15, chMPRBGetX(&mprb1, &c) == MSG_OK, "get failed");
+    test_emit_token(c);
+  }
+  test_assert_sequence(16, "ABCD");
+
+  /*
+   * Testing final conditions.
+   */
+  test_assert(17, chMPRBIsEmptyX(&mprb1), "not empty");
+  test_assert(18, chMPRBGetUsedCountX(&mprb1) == 0, "wrong count");
+  test_assert(19, chMPRBWaitTimeout(&mprb1, TIME_IMMEDIATE) == MSG_TIMEOUT,
+              "not empty");
+}
+
+ROMCONST struct testcase testrings2 = {
+  "Ring buffers, multiple producers commits",
+  rings2_setup,
+  NULL,
+  rings2_execute
+};
+
+/**
+ * @page test_rings_003 Consumer wakeup
+ *
+ * <h2>Description</h2>
+ * Four producer threads with priority lower than the consumer put one
+ * object each into a multiple producers ring buffer. The consumer waits
+ * on the ring buffer and must be awakened by each put, the objects must
+ * be received in priority order. A final wait must time out.
+ */
+
+static msg_t thread1(void *p) {
+
+  (void) chMPRBPutX(&mprb1, p);
+  return 0;
+}
+
+static void rings3_setup(void) {
+
+  chMPRBObjectInit(&mprb1, rbbuf, rbseq, sizeof (char), RB_SIZE);
+}
+
+static void rings3_execute(void) {
+  static const char objs[] = "ABCD";
+  tprio_t prio = chThdGetPriorityX();
+  unsigned i;
+  msg_t msg;
+  char c;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio - 4, thread1,
+                                 (void *)&objs[3]);
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio - 1, thread1,
+                                 (void *)&objs[0]);
+  threads[2] = chThdCreateStatic(wa[2], WA_SIZE, prio - 3, thread1,
+                                 (void *)&objs[2]);
+  threads[3] = chThdCreateStatic(wa[3], WA_SIZE, prio - 2, thread1,
+                                 (void *)&objs[1]);
+  for (i = 0; i < RB_SIZE; i++) {
+    msg = chMPRBWaitTimeout(&mprb1, TIME_INFINITE);
+    test_assert(1, msg == MSG_OK, "wrong wake-up message");
+    test_assert(2, chMPRBGetX(&mprb1, &c) == MSG_OK, "get failed");
+    test_emit_token(c);
+  }
+  test_wait_threads();
+  test_assert_sequence(3, "ABCD");
+  msg = chMPRBWaitTimeout(&mprb1, MS2ST(10));
+  test_assert(4, msg == MSG_TIMEOUT, "wrong wake-up message");
+  test_assert(5, mprb1.mprb_thread == NULL, "reference not cleared");
+}
+
+ROMCONST struct testcase testrings3 = {
+  "Ring buffers, consumer wakeup",
+  rings3_setup,
+  NULL,
+  rings3_execute
+};
+
+#endif /* CH_CFG_USE_RINGBUFFERS */
+
+/**
+ * @brief   Test sequence for ring buffers.
+ */
+ROMCONST struct testcase * ROMCONST patternrings[] = {
+#if CH_CFG_USE_RINGBUFFERS || defined(__DOXYGEN__)
+  &testrings1,
+  &testrings2,
+  &testrings3,
+#endif
+  NULL
+};
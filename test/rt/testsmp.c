@@ -0,0 +1,219 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_smp SMP mode test
+ *
+ * File: @ref testsmp.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the kernel SMP mode, the
+ * tests only involve the executing core so the sequence also runs on
+ * ports with a single core.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover the SMP specific code paths:
+ * the per-core system data access, the threads binding to the creating
+ * core, the ready list insertion from thread and interrupt context.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_CFG_SMP_MODE
+ * - @p CH_CFG_USE_EVENTS (and dependent options)
+ * - @p CH_CFG_USE_SEMAPHORES (and dependent options)
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_smp_001
+ * - @subpage test_smp_002
+ * - @subpage test_smp_003
+ * .
+ * @file testsmp.c
+ * @brief SMP mode test source file
+ * @file testsmp.h
+ * @brief SMP mode test header file
+ */
+
+#if CH_CFG_SMP_MODE || defined(__DOXYGEN__)
+
+#define ALLOWED_DELAY MS2ST(5)
+
+/**
+ * @page test_smp_001 Core data
+ *
+ * <h2>Description</h2>
+ * The core identifier and the system data of the current core are
+ * checked, then a thread is created and it records the core it is
+ * executed on.<br>
+ * The test expects the system data to match the core identifier and the
+ * created thread to be bound to and executed on the creating core.
+ */
+
+static unsigned core_id;
+static ch_system_t *core_data;
+
+static msg_t thread1(void *p) {
+
+  (void)p;
+  core_id = chSysGetCoreIdX();
+  core_data = chThdGetSelfX()->p_core;
+  return 0;
+}
+
+static void smp1_execute(void) {
+  unsigned id = chSysGetCoreIdX();
+
+  test_assert(1, id < PORT_CORES_NUMBER, "invalid core identifier");
+  test_assert(2, currcore == &ch_cores[id], "wrong system data");
+  test_assert(3, chThdGetSelfX()->p_core == currcore, "wrong thread core");
+  test_assert(4, currp == chThdGetSelfX(), "wrong current thread");
+
+  core_id = PORT_CORES_NUMBER;
+  core_data = NULL;
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()+1,
+                                 thread1, NULL);
+  test_assert(5, threads[0]->p_core == currcore, "not bound to this core");
+  test_wait_threads();
+  test_assert(6, core_id == id, "executed on another core");
+  test_assert(7, core_data == &ch_cores[id], "wrong thread core");
+}
+
+ROMCONST struct testcase testsmp1 = {
+  "SMP, core data",
+  NULL,
+  NULL,
+  smp1_execute
+};
+
+#if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
+/**
+ * @page test_smp_002 Ready list insertion
+ *
+ * <h2>Description</h2>
+ * Five threads with different priorities wait on the same event source,
+ * the event source is broadcast once so all the threads become ready at
+ * the same time.<br>
+ * The test expects the threads to be inserted in the ready list of the
+ * current core in priority order.
+ */
+
+static EVENTSOURCE_DECL(es1);
+
+static msg_t thread2(void *p) {
+  event_listener_t el;
+
+  chEvtRegisterMask(&es1, &el, 1);
+  chEvtWaitAny(ALL_EVENTS);
+  chEvtUnregister(&es1, &el);
+  test_emit_token(*(char *)p);
+  return 0;
+}
+
+static void smp2_setup(void) {
+
+  chEvtObjectInit(&es1);
+}
+
+static void smp2_execute(void) {
+  tprio_t prio = chThdGetPriorityX();
+
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+4, thread2, "B");
+  threads[3] = chThdCreateStatic(wa[3], WA_SIZE, prio+2, thread2, "D");
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+5, thread2, "A");
+  threads[4] = chThdCreateStatic(wa[4], WA_SIZE, prio+1, thread2, "E");
+  threads[2] = chThdCreateStatic(wa[2], WA_SIZE, prio+3, thread2, "C");
+  chEvtBroadcast(&es1);
+  test_wait_threads();
+  test_assert_sequence(1, "ABCDE");
+}
+
+ROMCONST struct testcase testsmp2 = {
+  "SMP, ready list insertion",
+  smp2_setup,
+  NULL,
+  smp2_execute
+};
+#endif /* CH_CFG_USE_EVENTS */
+
+#if CH_CFG_USE_SEMAPHORES || defined(__DOXYGEN__)
+/**
+ * @page test_smp_003 Wakeup from interrupt
+ *
+ * <h2>Description</h2>
+ * The test thread waits on a semaphore signaled by a virtual timer
+ * callback.<br>
+ * The test expects the thread to be made ready from the interrupt context
+ * of the current core and to be resumed at the timer deadline.
+ */
+
+static SEMAPHORE_DECL(sem1, 0);
+static virtual_timer_t vt1;
+
+static void vt1_cb(void *p) {
+
+  (void)p;
+  chSysLockFromISR();
+  chSemSignalI(&sem1);
+  chSysUnlockFromISR();
+}
+
+static void smp3_setup(void) {
+
+  chSemObjectInit(&sem1, 0);
+}
+
+static void smp3_execute(void) {
+  systime_t target;
+  msg_t msg;
+
+  test_wait_tick();
+  target = chVTGetSystemTime() + MS2ST(10);
+  chVTSet(&vt1, MS2ST(10), vt1_cb, NULL);
+  msg = chSemWaitTimeout(&sem1, MS2ST(100));
+  test_assert(1, msg == MSG_OK, "not signaled");
+  test_assert_time_window(2, target, target + ALLOWED_DELAY);
+  test_assert(3, chThdGetSelfX()->p_core == currcore, "wrong thread core");
+}
+
+ROMCONST struct testcase testsmp3 = {
+  "SMP, wakeup from interrupt",
+  smp3_setup,
+  NULL,
+  smp3_execute
+};
+#endif /* CH_CFG_USE_SEMAPHORES */
+#endif /* CH_CFG_SMP_MODE */
+
+/**
+ * @brief   Test sequence for the SMP mode.
+ */
+ROMCONST struct testcase * ROMCONST patternsmp[] = {
+#if CH_CFG_SMP_MODE || defined(__DOXYGEN__)
+  &testsmp1,
+#if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
+  &testsmp2,
+#endif
+#if CH_CFG_USE_SEMAPHORES || defined(__DOXYGEN__)
+  &testsmp3,
+#endif
+#endif
+  NULL
+};
@@ -33,13 +33,21 @@
  * Objective of the test module is to cover 100% of the subsystems code.
  *
  * <h2>Preconditions</h2>
- * None.
+ * The module requires the following kernel options for the stack usage
+ * test:
+ * - @p CH_CFG_USE_REGISTRY
+ * - @p CH_DBG_FILL_THREADS
+ * - @p CH_DBG_ENABLE_STACK_CHECK
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
  *
  * <h2>Test Cases</h2>
  * - @subpage test_threads_001
  * - @subpage test_threads_002
  * - @subpage test_threads_003
  * - @subpage test_threads_004
+ * - @subpage test_threads_005
  * .
  * @file testthd.c
  * @brief Threads and Scheduler test source file
@@ -219,6 +227,53 @@ ROMCONST struct testcase testthd4 = {
   thd4_execute
 };
 
+#if (CH_CFG_USE_REGISTRY && CH_DBG_FILL_THREADS &&                          \
+     CH_DBG_ENABLE_STACK_CHECK) || defined(__DOXYGEN__)
+/**
+ * @page test_threads_005 Threads stack usage test
+ *
+ * <h2>Description</h2>
+ * A thread is created with priority lower than the tester thread and the
+ * unused stack is read before it starts, the thread then uses a known
+ * amount of stack and terminates. The unused stack is expected to be
+ * reduced at least by the amount of stack used.
+ */
+
+#define THD5_STACK_USAGE    (THREADS_STACK_SIZE / 2)
+
+static msg_t thread5(void *p) {
+  volatile uint8_t buf[THD5_STACK_USAGE];
+  unsigned i;
+
+  (void)p;
+  for (i = 0; i < THD5_STACK_USAGE; i++)
+    buf[i] = 0;
+  return (msg_t)buf[0];
+}
+
+static void thd5_execute(void) {
+  thread_t *tp;
+  size_t n1, n2;
+
+  tp = threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()-1,
+                                      thread5, NULL);
+  n1 = chRegGetStackUnusedX(tp);
+  test_assert(1, n1 > 0, "no unused stack");
+  test_assert(2, n1 < WA_SIZE - sizeof (thread_t), "initial context not found");
+  test_wait_threads();
+  n2 = chRegGetStackUnusedX(tp);
+  test_assert(3, n2 + THD5_STACK_USAGE <= n1, "stack usage not detected");
+}
+
+ROMCONST struct testcase testthd5 = {
+  "Threads, stack usage",
+  NULL,
+  NULL,
+  thd5_execute
+};
+#endif /* CH_CFG_USE_REGISTRY && CH_DBG_FILL_THREADS &&
+          CH_DBG_ENABLE_STACK_CHECK */
+
 /**
  * @brief   Test sequence for threads.
  */
@@ -227,5 +282,9 @@ ROMCONST struct testcase * ROMCONST patternthd[] = {
   &testthd2,
   &testthd3,
   &testthd4,
+#if (CH_CFG_USE_REGISTRY && CH_DBG_FILL_THREADS &&                          \
+     CH_DBG_ENABLE_STACK_CHECK) || defined(__DOXYGEN__)
+  &testthd5,
+#endif
   NULL
 };
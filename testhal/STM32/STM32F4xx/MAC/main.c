@@ -0,0 +1,180 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+
+#include "chprintf.h"
+
+/*
+ * Local experimental EtherType used by the test frames.
+ */
+#define TEST_ETHERTYPE          0x88B5
+
+/*
+ * Duration of each measurement in milliseconds.
+ */
+#define TEST_DURATION           1000
+
+static uint8_t macaddr[6] = {0xC2, 0xAF, 0x51, 0x03, 0xCF, 0x46};
+
+/*
+ * MAC configuration.
+ */
+static const MACConfig maccfg = {
+  macaddr
+};
+
+static BaseSequentialStream *chp = (BaseSequentialStream *)&SD6;
+
+/*
+ * Counters updated by the receiver thread.
+ */
+static volatile uint32_t rxpackets, rxbytes;
+
+/*
+ * Receiver thread, the received packets are counted and returned to the
+ * pool.
+ */
+static THD_WORKING_AREA(waReceiver, 256);
+static msg_t Receiver(void *arg) {
+  MACPacket *pkp;
+
+  (void)arg;
+  chRegSetThreadName("receiver");
+  while (macReceivePacket(&ETHD1, &pkp, TIME_INFINITE) == MSG_OK) {
+    rxpackets++;
+    rxbytes += pkp->size;
+    macFreePacket(&ETHD1, pkp);
+  }
+  return 0;
+}
+
+/*
+ * Transmits frames of the specified size for TEST_DURATION milliseconds.
+ */
+static uint32_t transmit(size_t size) {
+  systime_t start, end;
+  uint32_t n = 0;
+
+  start = chVTGetSystemTime();
+  end = start + MS2ST(TEST_DURATION);
+  while (chVTIsSystemTimeWithin(start, end)) {
+    MACPacket *pkp;
+    uint8_t *p;
+
+    pkp = macAllocPacket(&ETHD1, MS2ST(10));
+    if (pkp == NULL)
+      continue;
+    p = (uint8_t *)pkp->buffer;
+    memcpy(p, macaddr, 6);
+    memcpy(p + 6, macaddr, 6);
+    p[12] = TEST_ETHERTYPE >> 8;
+    p[13] = TEST_ETHERTYPE & 0xFF;
+    pkp->size = size;
+    if (macTransmitPacket(&ETHD1, pkp, MS2ST(10)) == MSG_OK)
+      n++;
+    else
+      macFreePacket(&ETHD1, pkp);
+  }
+  return n;
+}
+
+/*
+ * LED blinker thread, times are in milliseconds.
+ */
+static THD_WORKING_AREA(waThread1, 128);
+static msg_t Thread1(void *arg) {
+
+  (void)arg;
+  chRegSetThreadName("blinker");
+  while (TRUE) {
+    palTogglePad(GPIOC, GPIOC_LED);
+    chThdSleepMilliseconds(500);
+  }
+  return 0;
+}
+
+/*
+ * Application entry point.
+ */
+int main(void) {
+  static const size_t sizes[] = {60, 128, 256, 512, 1024, 1514};
+  unsigned i;
+
+  /*
+   * System initializations.
+   * - HAL initialization, this also initializes the configured device drivers
+   *   and performs the board-specific initializations.
+   * - Kernel initialization, the main() function becomes a thread and the
+   *   RTOS is active.
+   */
+  halInit();
+  chSysInit();
+
+  /*
+   * Activates the serial driver 6 using the driver default configuration.
+   */
+  sdStart(&SD6, NULL);
+
+  /*
+   * Creates the blinker thread.
+   */
+  chThdCreateStatic(waThread1, sizeof(waThread1), NORMALPRIO, Thread1, NULL);
+
+  /*
+   * Activates the MAC driver, STM32_MAC_LOOPBACK is enabled in mcuconf.h so
+   * the frames are received back without leaving the MAC and the link is
+   * reported as active without a PHY link.
+   */
+  macStart(&ETHD1, &maccfg);
+  while (!macPollLinkStatus(&ETHD1))
+    chThdSleepMilliseconds(100);
+
+  /*
+   * The receiver runs at higher priority so that the pool is replenished
+   * as soon as the frames are received.
+   */
+  chThdCreateStatic(waReceiver, sizeof(waReceiver), NORMALPRIO + 1,
+                    Receiver, NULL);
+
+  /*
+   * Normal main() thread activity, the measurements are repeated forever.
+   */
+  while (TRUE) {
+    chprintf(chp, "\r\n Size   TX pkt/s   RX pkt/s   RX kbit/s  Dropped\r\n");
+    for (i = 0; i < sizeof sizes / sizeof sizes[0]; i++) {
+      uint32_t tx, rx, bytes, dropped;
+
+      rxpackets = 0;
+      rxbytes = 0;
+      dropped = ETHD1.rxdropped;
+      tx = transmit(sizes[i]) * 1000 / TEST_DURATION;
+
+      /* Frames still in flight are accounted in the current size.*/
+      chThdSleepMilliseconds(10);
+      rx = rxpackets * 1000 / TEST_DURATION;
+      bytes = rxbytes;
+      chprintf(chp, "%5u %10u %10u %11u %8u\r\n",
+               sizes[i], tx, rx,
+               (bytes / 125U) * 1000U / TEST_DURATION,
+               ETHD1.rxdropped - dropped);
+    }
+    chThdSleepMilliseconds(1000);
+  }
+}
@@ -0,0 +1,209 @@
+#!/usr/bin/env python
+#
+#    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+#                 2011,2012,2013 Giovanni Di Sirio.
+#
+#    This file is part of ChibiOS/RT.
+#
+#    ChibiOS/RT is free software; you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation; either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    ChibiOS/RT is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+"""
+Benchmark results comparison.
+
+Compares two result files generated by the test suite in benchmark mode
+(TEST_BMK_MODE = TRUE), both the JSON and CSV formats are accepted and the
+files can contain extra text before and after the results, for example a
+serial port log.
+
+The scores of each run are compared using the Welch's t-test, a benchmark
+is reported as a regression when its mean score decreased more than the
+threshold and the difference is statistically significant. Latency
+percentiles are single values so they are only compared against a
+threshold, by default latency changes are reported without affecting the
+exit status.
+
+The exit status is 1 if regressions have been found.
+
+Usage:
+  bmkcompare.py [--threshold PCT] [--alpha P] [--latency-threshold PCT]
+                [--latency-fail] old_results new_results
+"""
+
+import csv
+import json
+import math
+import sys
+from optparse import OptionParser
+
+def load(fn):
+    """Loads a results file, returns a dictionary of benchmark records."""
+    text = open(fn).read()
+    records = {}
+    start = text.find('{')
+    if start >= 0 and text.find('"benchmarks"') > start:
+        end = text.rfind('}')
+        data = json.loads(text[start:end + 1])
+        for b in data['benchmarks']:
+            records[b['name']] = b
+        return records
+    fields = None
+    lines = [l.strip() for l in text.splitlines()]
+    for cols in csv.reader([l for l in lines if l and not l.startswith('#')]):
+        if fields is None:
+            if cols[0] == 'name':
+                fields = cols
+            continue
+        if len(cols) != len(fields):
+            continue
+        b = dict(zip(fields, cols))
+        b['failed'] = b['failed'] == '1'
+        b['scores'] = [int(x) for x in b['scores'].split(';') if x]
+        for k in ('samples', 'p50', 'p99', 'max'):
+            if b.get(k):
+                b[k] = int(b[k])
+            else:
+                b.pop(k, None)
+        records[b['name']] = b
+    if fields is None:
+        raise ValueError('%s: no benchmark results found' % fn)
+    return records
+
+def mean_var(x):
+    m = float(sum(x)) / len(x)
+    if len(x) < 2:
+        return m, 0.0
+    return m, sum((v - m) ** 2 for v in x) / (len(x) - 1)
+
+def betacf(a, b, x):
+    """Continued fraction for the incomplete beta function (Lentz)."""
+    tiny = 1e-300
+    c = 1.0
+    d = 1.0 - (a + b) * x / (a + 1.0)
+    if abs(d) < tiny:
+        d = tiny
+    d = 1.0 / d
+    h = d
+    for m in range(1, 300):
+        m2 = 2 * m
+        aa = m * (b - m) * x / ((a + m2 - 1.0) * (a + m2))
+        d = 1.0 + aa * d
+        if abs(d) < tiny:
+            d = tiny
+        c = 1.0 + aa / c
+        if abs(c) < tiny:
+            c = tiny
+        d = 1.0 / d
+        h *= d * c
+        aa = -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1.0))
+        d = 1.0 + aa * d
+        if abs(d) < tiny:
+            d = tiny
+        c = 1.0 + aa / c
+        if abs(c) < tiny:
+            c = tiny
+        d = 1.0 / d
+        delta = d * c
+        h *= delta
+        if abs(delta - 1.0) < 1e-12:
+            break
+    return h
+
+def betainc(a, b, x):
+    """Regularized incomplete beta function."""
+    if x <= 0.0:
+        return 0.0
+    if x >= 1.0:
+        return 1.0
+    lbt = math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b) + \
+          a * math.log(x) + b * math.log(1.0 - x)
+    if x < (a + 1.0) / (a + b + 2.0):
+        return math.exp(lbt) * betacf(a, b, x) / a
+    return 1.0 - math.exp(lbt) * betacf(b, a, 1.0 - x) / b
+
+def welch(x, y):
+    """Two-sided Welch's t-test, returns the p-value or None."""
+    if len(x) < 2 or len(y) < 2:
+        return None
+    mx, vx = mean_var(x)
+    my, vy = mean_var(y)
+    sx = vx / len(x)
+    sy = vy / len(y)
+    if sx + sy == 0.0:
+        return 0.0 if mx != my else 1.0
+    t = (mx - my) / math.sqrt(sx + sy)
+    df = (sx + sy) ** 2 / (sx ** 2 / (len(x) - 1) + sy ** 2 / (len(y) - 1))
+    return betainc(df / 2.0, 0.5, df / (df + t * t))
+
+def main():
+    parser = OptionParser(usage='%prog [options] old_results new_results')
+    parser.add_option('--threshold', type='float', default=1.0,
+                      help='minimum score change in percent [%default]')
+    parser.add_option('--alpha', type='float', default=0.05,
+                      help='significance level [%default]')
+    parser.add_option('--latency-threshold', type='float', default=15.0,
+                      help='minimum latency change in percent, the '
+                           'histograms resolution is 12.5%% [%default]')
+    parser.add_option('--latency-fail', action='store_true', default=False,
+                      help='latency regressions affect the exit status')
+    opts, args = parser.parse_args()
+    if len(args) != 2:
+        parser.error('two result files required')
+    old = load(args[0])
+    new = load(args[1])
+
+    regressions = 0
+    print('%-42s %12s %12s %8s %8s  %s' % ('Benchmark', 'Old', 'New',
+                                           'Change', 'p', 'Status'))
+    for name in sorted(set(old) | set(new)):
+        if name not in old or name not in new:
+            print('%-42s %s' % (name, 'only in ' +
+                                (args[0] if name in old else args[1])))
+            continue
+        o = old[name]
+        n = new[name]
+        mo, _ = mean_var(o['scores'])
+        mn, _ = mean_var(n['scores'])
+        change = (mn - mo) * 100.0 / mo if mo else 0.0
+        p = welch(o['scores'], n['scores'])
+        significant = p is None or p < opts.alpha
+        status = []
+        if n.get('failed'):
+            status.append('FAILED')
+            regressions += 1
+        if abs(change) >= opts.threshold and significant:
+            if change < 0:
+                status.append('REGRESSION')
+                regressions += 1
+            else:
+                status.append('improved')
+        if p is None:
+            status.append('single run')
+        for k in ('p50', 'p99'):
+            if k in o and k in n and o[k] > 0:
+                lc = (n[k] - o[k]) * 100.0 / o[k]
+                if lc >= opts.latency_threshold:
+                    status.append('%s latency +%.1f%%' % (k, lc))
+                    if opts.latency_fail:
+                        regressions += 1
+        print('%-42s %12.0f %12.0f %+7.2f%% %8s  %s' %
+              (name, mo, mn, change, '-' if p is None else '%.4f' % p,
+               ', '.join(status)))
+
+    print('')
+    print('%d regression(s) found' % regressions)
+    return 1 if regressions else 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,161 @@
+#!/usr/bin/env python
+#
+#    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+#                 2011,2012,2013 Giovanni Di Sirio.
+#
+#    This file is part of ChibiOS/RT.
+#
+#    ChibiOS/RT is free software; you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation; either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    ChibiOS/RT is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+"""
+DATA segment image compressor.
+
+The input is the raw image of the .data section, as extracted from the
+linked ELF file with "objcopy -O binary -j .data", the output is the same
+image compressed in the LZ4 block format. The stream is decoded by the
+Cortex-M startup code (CRT0_DATA_COMPRESSED) directly into RAM, the decoder
+stops when the end of the DATA segment is reached so the stream carries no
+header or size information.
+
+The compressor is greedy with a single-entry hash table, it is meant to be
+simple and deterministic, the compression ratio is not the objective. The
+output obeys the LZ4 end of block rules, the last 5 bytes are always
+literals, so it can also be verified with the standard LZ4 tools.
+
+The output is decoded again and compared with the input before being
+written.
+
+Usage:
+  lzdata.py data.bin data.lz
+"""
+
+import sys
+from optparse import OptionParser
+
+MIN_MATCH = 4
+MAX_OFFSET = 65535
+LAST_LITERALS = 5
+MF_LIMIT = 12
+HASH_BITS = 12
+
+def put_length(out, n):
+    while n >= 255:
+        out.append(255)
+        n -= 255
+    out.append(n)
+
+def put_sequence(out, literals, mlen, offset):
+    llen = len(literals)
+    token = min(llen, 15) << 4
+    if mlen is not None:
+        token |= min(mlen - MIN_MATCH, 15)
+    out.append(token)
+    if llen >= 15:
+        put_length(out, llen - 15)
+    out.extend(literals)
+    if mlen is not None:
+        out.append(offset & 255)
+        out.append(offset >> 8)
+        if mlen - MIN_MATCH >= 15:
+            put_length(out, mlen - MIN_MATCH - 15)
+
+def compress(data):
+    out = bytearray()
+    n = len(data)
+    table = {}
+    anchor = 0
+    i = 0
+    while i + MF_LIMIT < n:
+        key = bytes(data[i:i + MIN_MATCH])
+        ref = table.get(key)
+        table[key] = i
+        if ref is None or i - ref > MAX_OFFSET:
+            i += 1
+            continue
+        # Extending the match, the last literals are never covered.
+        mlen = MIN_MATCH
+        while i + mlen < n - LAST_LITERALS and \
+              data[ref + mlen] == data[i + mlen]:
+            mlen += 1
+        put_sequence(out, data[anchor:i], mlen, i - ref)
+        i += mlen
+        anchor = i
+    put_sequence(out, data[anchor:], None, 0)
+    return out
+
+def decompress(stream, size):
+    out = bytearray()
+    i = 0
+    while len(out) < size:
+        token = stream[i]
+        i += 1
+        n = token >> 4
+        if n == 15:
+            while True:
+                b = stream[i]
+                i += 1
+                n += b
+                if b != 255:
+                    break
+        out.extend(stream[i:i + n])
+        i += n
+        if len(out) >= size:
+            break
+        offset = stream[i] | (stream[i + 1] << 8)
+        i += 2
+        n = (token & 15) + MIN_MATCH
+        if (token & 15) == 15:
+            while True:
+                b = stream[i]
+                i += 1
+                n += b
+                if b != 255:
+                    break
+        # Byte by byte because the match can overlap the output.
+        for k in range(n):
+            out.append(out[len(out) - offset])
+    return out
+
+def main():
+    parser = OptionParser(usage='%prog [options] data.bin data.lz')
+    parser.add_option('-q', '--quiet', action='store_true', default=False,
+                      help='do not print the compression ratio')
+    opts, args = parser.parse_args()
+    if len(args) != 2:
+        parser.error('input and output files must be specified')
+
+    with open(args[0], 'rb') as f:
+        data = bytearray(f.read())
+    if len(data) & 3:
+        sys.stderr.write('%s: size is not a multiple of 4\n' % args[0])
+        return 1
+    stream = compress(data)
+    if decompress(stream, len(data)) != data:
+        sys.stderr.write('%s: verification failed\n' % args[0])
+        return 1
+
+    # Padded to a word boundary, the padding is never read by the decoder.
+    while len(stream) & 3:
+        stream.append(0)
+    with open(args[1], 'wb') as f:
+        f.write(stream)
+    if not opts.quiet:
+        print('DATA segment: %d bytes, compressed: %d bytes (%d%%)' %
+              (len(data), len(stream),
+               (100 * len(stream) // len(data)) if data else 100))
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
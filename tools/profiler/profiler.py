@@ -0,0 +1,151 @@
+#!/usr/bin/env python
+#
+#    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+#                 2011,2012,2013 Giovanni Di Sirio.
+#
+#    This file is part of ChibiOS/RT.
+#
+#    ChibiOS/RT is free software; you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation; either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    ChibiOS/RT is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+"""
+Sampling profiler report generator.
+
+The input is the output of profDump() as captured from the target stream,
+other lines in the capture are ignored so a whole terminal log can be used.
+If more than one dump is present then the last one is used.
+
+The sampled addresses are resolved against the symbol table of the ELF
+file, the report contains a flat profile by function and a profile for
+each thread. Samples with an unknown PC, taken while the timer interrupted
+another ISR or on ports without PC sampling, are reported as "<unknown>".
+
+Usage:
+  profiler.py [--nm NM] [--limit N] file.elf capture.txt
+"""
+
+import sys
+import bisect
+import subprocess
+from optparse import OptionParser
+
+# Code symbol types as reported by nm.
+CODE_TYPES = set(['T', 't', 'W', 'w'])
+
+class Symbols(object):
+
+    def __init__(self, nm, elf):
+        syms = []
+        out = subprocess.Popen([nm, '-S', '-n', '--defined-only', elf],
+                               stdout=subprocess.PIPE,
+                               universal_newlines=True).communicate()[0]
+        for line in out.splitlines():
+            fields = line.split()
+            # Address, size, type and name, symbols without size are not
+            # functions (labels, section markers).
+            if len(fields) != 4 or fields[2] not in CODE_TYPES:
+                continue
+            # The Thumb bit is not part of the address.
+            addr = int(fields[0], 16) & ~1
+            syms.append((addr, int(fields[1], 16), fields[3]))
+        syms.sort()
+        self.addrs = [s[0] for s in syms]
+        self.syms = syms
+
+    def resolve(self, pc):
+        if pc == 0:
+            return '<unknown>'
+        pc &= ~1
+        i = bisect.bisect_right(self.addrs, pc) - 1
+        if i >= 0:
+            addr, size, name = self.syms[i]
+            if pc < addr + size:
+                return name
+        return '0x%08x' % pc
+
+def read_dump(path):
+    dump = None
+    with open(path) as f:
+        for line in f:
+            fields = line.split(None, 3)
+            if len(fields) < 2 or fields[0] != 'prof':
+                continue
+            if fields[1] == 'begin':
+                dump = {'header': [int(x) for x in line.split()[2:6]],
+                        'entries': [], 'complete': False}
+            elif dump is None:
+                continue
+            elif fields[1] == 'end':
+                dump['complete'] = True
+            elif len(fields) == 4:
+                dump['entries'].append((int(fields[1], 16), int(fields[2]),
+                                        fields[3].strip()))
+    return dump
+
+def print_profile(title, counts, total, limit):
+    print(title)
+    print('  %8s %6s  %s' % ('Samples', '%', 'Function'))
+    rows = sorted(counts.items(), key=lambda x: (-x[1], x[0]))
+    if limit:
+        rows = rows[:limit]
+    for name, n in rows:
+        print('  %8d %6.2f  %s' % (n, 100.0 * n / total, name))
+    print('')
+
+def main():
+    parser = OptionParser(usage='%prog [options] file.elf capture.txt')
+    parser.add_option('--nm', default='arm-none-eabi-nm',
+                      help='nm executable [%default]')
+    parser.add_option('--limit', type='int', default=0,
+                      help='maximum functions listed in each profile')
+    opts, args = parser.parse_args()
+    if len(args) != 2:
+        parser.error('ELF file and capture file must be specified')
+
+    dump = read_dump(args[1])
+    if dump is None:
+        sys.stderr.write('%s: no profiler dump found\n' % args[1])
+        return 1
+    if not dump['complete']:
+        sys.stderr.write('%s: truncated dump\n' % args[1])
+    samples, nopc, lost, rate = dump['header']
+    total = sum(e[1] for e in dump['entries'])
+    if total == 0:
+        sys.stderr.write('%s: no samples\n' % args[1])
+        return 1
+
+    syms = Symbols(opts.nm, args[0])
+    flat = {}
+    threads = {}
+    for pc, n, thread in dump['entries']:
+        name = syms.resolve(pc)
+        flat[name] = flat.get(name, 0) + n
+        per = threads.setdefault(thread, {})
+        per[name] = per.get(name, 0) + n
+
+    print('Samples: %d, unknown PC: %d, lost: %d, rate: %d Hz' %
+          (samples, nopc, lost, rate))
+    if rate:
+        print('Profiled time: %.3f s' % (float(samples) / rate))
+    print('')
+    print_profile('Flat profile:', flat, total, opts.limit)
+    for thread in sorted(threads, key=lambda t: -sum(threads[t].values())):
+        n = sum(threads[thread].values())
+        print_profile('Thread %s: %d samples (%.2f%%)' %
+                      (thread, n, 100.0 * n / total),
+                      threads[thread], n, opts.limit)
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,120 @@
+#!/usr/bin/env python
+#
+#    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+#                 2011,2012,2013 Giovanni Di Sirio.
+#
+#    This file is part of ChibiOS/RT.
+#
+#    ChibiOS/RT is free software; you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation; either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    ChibiOS/RT is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+
+"""
+Shell throughput benchmark.
+
+Sends a script of commands to a target running the ChibiOS shell and
+measures the number of commands executed per second. The shell prompt
+("ch> ") is used as the completion marker of each command.
+
+The commands are taken from a script file, one per line, or a single
+command is repeated. Up to WINDOW commands are sent before waiting for
+their prompts, the window must not exceed what the target input queue
+can absorb, use a window of 1 for targets with small serial buffers.
+
+The serial port is accessed using the pyserial module.
+
+Usage:
+  shellbench.py [--baud N] [--count N] [--window N] [--command CMD]
+                [--script FILE] [--timeout S] port
+"""
+
+import sys
+import time
+from optparse import OptionParser
+
+PROMPT = b'ch> '
+
+def wait_prompts(port, n, timeout):
+    """Waits for n prompts, returns the number of prompts received."""
+    got = 0
+    data = b''
+    deadline = time.time() + timeout
+    while got < n and time.time() < deadline:
+        data += port.read(port.in_waiting or 1)
+        while True:
+            i = data.find(PROMPT)
+            if i < 0:
+                break
+            got += 1
+            data = data[i + len(PROMPT):]
+        data = data[-len(PROMPT):]
+    return got
+
+def main():
+    parser = OptionParser(usage='%prog [options] port')
+    parser.add_option('--baud', type='int', default=115200,
+                      help='serial port baud rate (default 115200)')
+    parser.add_option('--count', type='int', default=1000,
+                      help='number of commands to be sent (default 1000)')
+    parser.add_option('--window', type='int', default=1,
+                      help='commands in flight (default 1)')
+    parser.add_option('--command', default='systime',
+                      help='command to be repeated (default systime)')
+    parser.add_option('--script', default=None,
+                      help='file containing the commands, one per line')
+    parser.add_option('--timeout', type='float', default=5.0,
+                      help='timeout for each window in seconds (default 5)')
+    opts, args = parser.parse_args()
+    if len(args) != 1:
+        parser.error('serial port required')
+    try:
+        import serial
+    except ImportError:
+        sys.stderr.write('the pyserial module is required\n')
+        return 2
+
+    if opts.script is not None:
+        commands = [l.strip() for l in open(opts.script) if l.strip()]
+    else:
+        commands = [opts.command]
+    lines = [(commands[i % len(commands)] + '\r').encode('ascii')
+             for i in range(opts.count)]
+
+    port = serial.Serial(args[0], opts.baud, timeout=0.1)
+    port.reset_input_buffer()
+    port.write(b'\r')
+    if wait_prompts(port, 1, opts.timeout) != 1:
+        sys.stderr.write('no shell prompt from target\n')
+        return 1
+
+    done = 0
+    start = time.time()
+    while done < opts.count:
+        n = min(opts.window, opts.count - done)
+        port.write(b''.join(lines[done:done + n]))
+        got = wait_prompts(port, n, opts.timeout)
+        done += got
+        if got != n:
+            sys.stderr.write('timeout after %d commands\n' % done)
+            break
+    elapsed = time.time() - start
+    port.close()
+
+    print('Commands : %d' % done)
+    print('Time     : %.3f S' % elapsed)
+    print('Score    : %.1f commands/S' % (done / elapsed if elapsed else 0))
+    return 0 if done == opts.count else 1
+
+if __name__ == '__main__':
+    sys.exit(main())
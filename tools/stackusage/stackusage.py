@@ -0,0 +1,251 @@
+#!/usr/bin/env python
+#
+#    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+#                 2011,2012,2013 Giovanni Di Sirio.
+#
+#    This file is part of ChibiOS/RT.
+#
+#    ChibiOS/RT is free software; you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation; either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    ChibiOS/RT is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+"""
+Static worst-case stack usage analysis.
+
+The per-function frame sizes are taken from the .su files generated by GCC
+when compiling with -fstack-usage (USE_STACK_USAGE = yes in the makefile),
+the call graph is rebuilt from the disassembly of the final ELF file so
+only the code actually linked is considered.
+
+The worst-case stack of an entry point is its own frame plus the deepest
+path in the call graph below it. The result is the value to be used as
+stack size in THD_WORKING_AREA(), the port interrupt overhead and the
+thread_t structure are already accounted for by the macro.
+
+Limitations, shown as flags in the report:
+  R  recursion found, the cycle is counted once.
+  I  indirect calls found (function pointers), their targets are unknown.
+  D  dynamic frame size (alloca or VLAs), the static part is counted.
+  U  functions without .su information reached (assembler code, libraries
+     built without -fstack-usage), they are counted as zero.
+
+Tail calls are conservatively counted as normal calls. LTO must be disabled
+because the .su files would be generated for the link-time units. Functions
+cloned by the optimizer (.constprop.N, .isra.N, .part.N suffixes) are matched
+to the .su entry of the clone or, if missing, of the original function.
+
+Usage:
+  stackusage.py [--objdump OD] [--su DIR|FILE]... [--margin N] [--all]
+                file.elf [entry]...
+
+If no entry points are specified then all the functions not directly called
+by other functions are reported, this includes thread functions, interrupt
+handlers and main().
+"""
+
+import os
+import re
+import sys
+import subprocess
+from optparse import OptionParser
+
+# Direct calls, tail calls and indirect calls mnemonics for the supported
+# architectures: ARM, Thumb/Thumb2 and PowerPC/VLE. Register indirect calls
+# take the register as operand, the PowerPC ones implicitly use CTR.
+CALL_OPS = set(['bl', 'blx', 'bl.w', 'e_bl', 'se_bl'])
+JUMP_OPS = set(['b', 'b.w', 'b.n', 'e_b', 'se_b'])
+INDIRECT_OPS = set(['blx', 'bx'])
+INDIRECT_CTR_OPS = set(['bctrl', 'se_bctrl', 'bctr', 'se_bctr'])
+
+FUNC_RE = re.compile(r'^([0-9a-fA-F]+) <([^>]+)>:\s*$')
+TARGET_RE = re.compile(r'<([^>+]+)(\+0x[0-9a-fA-F]+)?>')
+REG_RE = re.compile(r'^(r\d+|ip|sl|fp|ctr)$')
+SU_RE = re.compile(r'^(.*?):(\d+):(\d+):(.*)\t(\d+)\t(\S+)\s*$')
+CLONE_RE = re.compile(r'(\.(constprop|isra|part)(\.\d+)?)+$')
+
+class Function(object):
+
+    def __init__(self, name):
+        self.name = name
+        self.frame = None
+        self.dynamic = False
+        self.calls = set()
+        self.indirect = False
+        # Analysis results.
+        self.total = None
+        self.path = None
+        self.flags = None
+        self.visiting = False
+
+def base_name(name):
+    """Removes the suffixes added to the names of cloned functions."""
+    return CLONE_RE.sub('', name)
+
+def read_su(paths, frames):
+    """Reads the .su files, frames is filled with (size, dynamic) tuples."""
+    files = []
+    for p in paths:
+        if os.path.isdir(p):
+            for root, dirs, names in os.walk(p):
+                files.extend([os.path.join(root, n) for n in names
+                              if n.endswith('.su')])
+        else:
+            files.append(p)
+    for fn in files:
+        for line in open(fn):
+            m = SU_RE.match(line)
+            if m is None:
+                continue
+            size = int(m.group(5))
+            dynamic = m.group(6).startswith('dynamic') and \
+                      m.group(6) != 'dynamic,bounded'
+            # Static functions with the same name in different modules cannot
+            # be distinguished, the biggest frame is taken. Clones are also
+            # recorded under the original name.
+            for name in set([m.group(4), base_name(m.group(4))]):
+                old = frames.get(name, (0, False))
+                frames[name] = (max(old[0], size), old[1] or dynamic)
+    return len(files)
+
+def set_frames(funcs, frames):
+    """Assigns the frame sizes to the functions found in the ELF file."""
+    for name, f in funcs.items():
+        fr = frames.get(name)
+        if fr is None:
+            fr = frames.get(base_name(name))
+        if fr is not None:
+            f.frame, f.dynamic = fr
+
+def read_calls(objdump, elf, funcs):
+    """Rebuilds the call graph from the disassembly."""
+    out = subprocess.Popen([objdump, '-d', '--no-show-raw-insn', elf],
+                           stdout=subprocess.PIPE,
+                           universal_newlines=True).communicate()[0]
+    cur = None
+    for line in out.splitlines():
+        m = FUNC_RE.match(line)
+        if m is not None:
+            cur = funcs.setdefault(m.group(2), Function(m.group(2)))
+            continue
+        if cur is None:
+            continue
+        fields = line.split('\t')
+        if len(fields) < 2 or not fields[0].strip().endswith(':'):
+            continue
+        op = fields[1].strip()
+        args = fields[2].strip() if len(fields) > 2 else ''
+        t = TARGET_RE.search(args)
+        if op in CALL_OPS and t is not None:
+            cur.calls.add(t.group(1))
+        elif op in JUMP_OPS and t is not None and t.group(2) is None and \
+             t.group(1) != cur.name:
+            # Branch to the start of another function, tail call.
+            cur.calls.add(t.group(1))
+        elif op in INDIRECT_OPS and REG_RE.match(args.split(',')[0]):
+            cur.indirect = True
+        elif op in INDIRECT_CTR_OPS:
+            cur.indirect = True
+
+def analyze(f, funcs):
+    """Computes the worst-case stack of a function, depth first."""
+    if f.total is not None:
+        return
+    f.visiting = True
+    flags = set()
+    if f.frame is None:
+        flags.add('U')
+    if f.dynamic:
+        flags.add('D')
+    if f.indirect:
+        flags.add('I')
+    best = 0
+    bestpath = []
+    for name in sorted(f.calls):
+        c = funcs.get(name)
+        if c is None:
+            continue
+        if c.visiting:
+            flags.add('R')
+            continue
+        analyze(c, funcs)
+        flags |= c.flags
+        if c.total > best:
+            best = c.total
+            bestpath = c.path
+    f.visiting = False
+    f.total = (f.frame or 0) + best
+    f.path = [f.name] + bestpath
+    f.flags = flags
+
+def main():
+    parser = OptionParser(usage='%prog [options] file.elf [entry]...')
+    parser.add_option('--objdump', default='arm-none-eabi-objdump',
+                      help='objdump executable [%default]')
+    parser.add_option('--su', action='append', default=[],
+                      help='.su file or directory to be scanned, can be '
+                           'repeated')
+    parser.add_option('--margin', type='int', default=0,
+                      help='bytes added to the suggested stack sizes')
+    parser.add_option('--all', action='store_true', default=False,
+                      help='report all functions, not just entry points')
+    opts, args = parser.parse_args()
+    if len(args) < 1:
+        parser.error('ELF file not specified')
+    elf = args[0]
+    if not opts.su:
+        opts.su = [os.path.dirname(elf) or '.']
+
+    frames = {}
+    if read_su(opts.su, frames) == 0:
+        sys.stderr.write('no .su files found, compile with -fstack-usage\n')
+        return 1
+
+    # Only functions present in the ELF file are considered, functions
+    # removed by the linker only appear in the .su files.
+    funcs = {}
+    read_calls(opts.objdump, elf, funcs)
+    set_frames(funcs, frames)
+    if len(args) > 1:
+        entries = []
+        for name in args[1:]:
+            if name not in funcs:
+                sys.stderr.write('entry point %s not found\n' % name)
+                return 1
+            entries.append(funcs[name])
+    elif opts.all:
+        entries = list(funcs.values())
+    else:
+        called = set()
+        for f in funcs.values():
+            called |= f.calls
+        entries = [f for n, f in funcs.items() if n not in called]
+
+    for f in entries:
+        analyze(f, funcs)
+    entries.sort(key=lambda f: (-f.total, f.name))
+
+    print('%-32s %6s %6s %5s  %s' % ('Entry point', 'Frame', 'Stack',
+                                     'Flags', 'Worst case path'))
+    for f in entries:
+        print('%-32s %6d %6d %5s  %s' % (f.name, f.frame or 0, f.total,
+                                         ''.join(sorted(f.flags)),
+                                         ' > '.join(f.path)))
+    if len(args) > 1:
+        print('')
+        for f in entries:
+            size = (f.total + opts.margin + 7) & ~7
+            print('THD_WORKING_AREA(wa%s, %d);' % (f.name, size))
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,124 @@
+#!/usr/bin/env python
+#
+#    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+#                 2011,2012,2013 Giovanni Di Sirio.
+#
+#    This file is part of ChibiOS/RT.
+#
+#    ChibiOS/RT is free software; you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation; either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    ChibiOS/RT is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+"""
+Kernel statistics export decoder.
+
+The input is the raw output of the "stats bin" shell command as captured
+from the target stream, the data before the export header is ignored so a
+whole terminal log can be used. If more than one export is present then
+the last one is used. The byte order is detected from the header magic
+number.
+
+The layout of the header and of the records is documented in chstats.h,
+the records are padded to the alignment of their 64 bits field, 8 bytes
+on most targets, use --align if the target aligns it differently.
+
+Usage:
+  stats.py [--align N] capture.bin
+"""
+
+import sys
+import struct
+from optparse import OptionParser
+
+# "CHS1" in the target memory order.
+MAGIC = 0x31534843
+MAGIC_LE = struct.pack('<I', MAGIC)
+MAGIC_BE = struct.pack('>I', MAGIC)
+
+# Records identifiers.
+ID_NAMES = {0: 'crit_thd', 1: 'crit_isr', 2: 'resched'}
+ID_IRQ_BASE = 3
+ID_END = 0xFFFFFFFF
+
+# Record fields before the histogram: cumulative, id, n, best, worst, last
+# and caller.
+RECORD_FIELDS = 'QIIIIII'
+
+def find_export(data):
+    pos = max(data.rfind(MAGIC_LE), data.rfind(MAGIC_BE))
+    if pos < 0:
+        return None, None
+    if data[pos:pos + 4] == MAGIC_LE:
+        return pos, '<'
+    return pos, '>'
+
+def read_export(data, align):
+    pos, order = find_export(data)
+    if pos is None:
+        raise ValueError('no statistics export found')
+    magic, bins, shift = struct.unpack_from(order + 'IHH', data, pos)
+    pos += 8
+    fmt = order + RECORD_FIELDS + 'I' * bins
+    size = struct.calcsize(fmt)
+    size = (size + align - 1) // align * align
+    records = []
+    while True:
+        if pos + size > len(data):
+            raise ValueError('truncated export')
+        fields = struct.unpack_from(fmt, data, pos)
+        pos += size
+        if fields[1] == ID_END:
+            break
+        records.append(fields)
+    return bins, shift, records
+
+def record_name(rid):
+    if rid in ID_NAMES:
+        return ID_NAMES[rid]
+    return 'irq%u' % (rid - ID_IRQ_BASE)
+
+def main():
+    parser = OptionParser(usage='%prog [options] capture.bin')
+    parser.add_option('--align', type='int', default=8,
+                      help='alignment of the records [%default]')
+    opts, args = parser.parse_args()
+    if len(args) != 1:
+        parser.error('capture file must be specified')
+
+    with open(args[0], 'rb') as f:
+        data = f.read()
+    try:
+        bins, shift, records = read_export(data, opts.align)
+    except ValueError as e:
+        sys.stderr.write('%s: %s\n' % (args[0], e))
+        return 1
+
+    print('Histogram bins: %d, first bin below %d cycles' %
+          (bins, 1 << shift))
+    print('')
+    for r in records:
+        cumulative, rid, n, best, worst, last, caller = r[:7]
+        hist = r[7:]
+        line = '%-8s n=%u best=%u worst=%u last=%u avg=%u' % \
+               (record_name(rid), n, best, worst, last, cumulative // n)
+        if caller:
+            line += ' caller=%08x' % caller
+        print(line)
+        cells = ['<%u:%u' % (1 << (shift + i), hist[i])
+                 for i in range(bins - 1)]
+        cells.append('>=%u:%u' % (1 << (shift + bins - 1), hist[-1]))
+        print('         ' + ' '.join(cells))
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())